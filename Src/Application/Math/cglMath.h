@@ -19,6 +19,7 @@
 
 typedef cglmath::TCamera<float> camera_t;
 typedef cglmath::TVector<float> vec_t;
+typedef cglmath::TVector<double> dvec_t;
 typedef cglmath::TMatrix<float> matrix_t;
 typedef cglmath::TTransform<float> transform_t;
 typedef cglmath::TColor<float> color_t;
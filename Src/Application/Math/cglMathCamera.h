@@ -10,8 +10,9 @@
 #define __CGLMATHCAMERA_INCLUDED__
 
 #include <math.h>
+#include <string.h>
 
-#include "cglmathdef.h"
+#include "cglMathDef.h"
 
 namespace cglmath
 {
@@ -32,19 +33,40 @@ namespace cglmath
     TYPE height;              /* height of project plane */
     TYPE saved_PPH;           /* Saved width of project plane */
     TYPE saved_PPW;           /* Saved height of project plane */
-    TYPE far_clip;            /* far_clip distance */
+    TYPE far_clip;            /* far_clip distance, ignored with infinite far plane */
+    bool is_reversed_depth;   /* near plane maps to depth 1, far one to 0 */
+    bool is_infinite_far;     /* far plane at infinity */
     TYPE aspect;              /* Ration aspect of project plane */
-    INT screen_width;         /* Screen width */
-    INT screen_height;        /* Screen height */
-    
-    /*** Camera matrices ***/
-    TTransform<TYPE> camera_matrix;       /* Camera coordinate system translate */
-    TTransform<TYPE> projection_matrix;        /* Perspective projection matrix */
+    int screen_width;         /* Screen width */
+    int screen_height;        /* Screen height */
+
+    /* World space frustum planes a * x + b * y + c * z + d >= 0 inside, normals are unit.
+     * Order: left, right, bottom, top, near, far */
+    struct frustum_t
+    {
+      TYPE planes[6][4];
+
+      /* Sphere is at least partially inside */
+      bool is_visible( TVector<TYPE> const &center, TYPE radius ) const
+      {
+        for (int i = 0; i < 6; ++i)
+          if (planes[i][0] * center.x + planes[i][1] * center.y + planes[i][2] * center.z + planes[i][3] < -radius)
+            return false;
+        return true;
+      }
+    };
 
     /*** Camera constructors ***/
     
     /* Empty constructor */
-    TCamera() {}
+    TCamera()
+      : width(0.4), height(0.3), saved_PPH(0.3), saved_PPW(0.4)
+      , is_reversed_depth(false), is_infinite_far(false)
+      , screen_width(320), screen_height(240)
+      , m_frustum(), m_is_view_dirty(true), m_is_projection_dirty(true), m_is_combined_dirty(true)
+    {
+      clear_cache();
+    }
     
     /* Camera constructor
      * pos        - camera position
@@ -56,12 +78,19 @@ namespace cglmath
     TCamera( TVector<TYPE> & pos, TVector<TYPE> & at_vec, TVector<TYPE> & up_vec, bool is_look_at,
              TYPE project_plane_w = 0.4, TYPE project_plane_h = 0.3,
              TYPE proj_dist = 1.0, TYPE far_dist = 10000.0,
-             INT  screen_w = 320, INT screen_h = 240) 
+             int  screen_w = 320, int screen_h = 240) 
       : location(pos.x, pos.y, pos.z), up(up_vec.x, up_vec.y, up_vec.z)
       , far_clip(far_dist)
+      , is_reversed_depth(false)
+      , is_infinite_far(false)
       , screen_width(screen_w)
       , screen_height(screen_h)
+      , m_frustum()
+      , m_is_view_dirty(true)
+      , m_is_projection_dirty(true)
+      , m_is_combined_dirty(true)
     {
+      clear_cache();
       saved_PPH = height = project_plane_h;
       saved_PPW = width = project_plane_w;
 
@@ -86,14 +115,45 @@ namespace cglmath
 
     /*** Camera methods ***/
 
-    TMatrix<TYPE> get_projection_matrix()
+    /* Matrices are rebuilt on the first request after a change, later requests return the
+     * cached ones. Lazy rebuilds write the cache, so a camera shared by threads must be
+     * queried once before */
+    TMatrix<TYPE> const & get_projection_matrix( void ) const
+    {
+      update_projection_cache();
+      return m_projection;
+    }
+
+    TMatrix<TYPE> const & get_view_matrix( void ) const
+    {
+      update_view_cache();
+      return m_view.matrix;
+    }
+
+    TMatrix<TYPE> const & get_inv_view_matrix( void ) const
+    {
+      update_view_cache();
+      return m_view.inv_matrix;
+    }
+
+    /* View followed by projection */
+    TMatrix<TYPE> const & get_view_projection_matrix( void ) const
     {
-      return projection_matrix.matrix;
+      update_combined_cache();
+      return m_view_projection;
     }
 
-    TMatrix<TYPE> get_view_matrix()
+    /* Clip space to world space */
+    TMatrix<TYPE> const & get_inv_view_projection_matrix( void ) const
     {
-      return camera_matrix.matrix;
+      update_combined_cache();
+      return m_inv_view_projection;
+    }
+
+    frustum_t const & get_frustum( void ) const
+    {
+      update_combined_cache();
+      return m_frustum;
     }
 
     /***
@@ -140,20 +200,11 @@ namespace cglmath
       return *this;
     }
 
-    /* Update camera matrices function */
+    /* Update camera matrices function: they are rebuilt on request */
     TCamera & update_matrices( void )
     {
-      /* Make view transformation matrix */
-      camera_matrix.matrix = TMatrix<TYPE>(right.x,      up.x,      direction.x,
-                                           right.y,      up.y,      direction.y,
-                                           right.z,      up.z,      direction.z,
-                                           -location & right, -location & up, -location & direction);
-
-      /* Make inverse transformation matrix */
-      camera_matrix.inv_matrix = TMatrix<TYPE>(right.x, right.y, right.z,
-                                               up.x,    up.y,    up.z,
-                                               direction.x,   direction.y,   direction.z,
-                                               location.x,   location.y,   location.z);
+      m_is_view_dirty = true;
+      m_is_combined_dirty = true;
 
       return *this;
     }
@@ -176,14 +227,9 @@ namespace cglmath
 
       aspect = width / height;
 
-      /* Evaluate perspective projection matrix */
-      projection_matrix =
-        TMatrix<TYPE>(static_cast<TYPE>(2.0 * projection_distance / width),      0,             0,
-                        0,          static_cast<TYPE>(2.0 * projection_distance / height),      0,
-                        0,                  0,       static_cast<TYPE>(far_clip / (far_clip - projection_distance)),
-                        0,                  0,       static_cast<TYPE>(far_clip * projection_distance / (projection_distance - far_clip)),
-                        0,                  0,             1, 0);
-
+      /* Perspective projection matrix is rebuilt on request */
+      m_is_projection_dirty = true;
+      m_is_combined_dirty = true;
     }
 
     /* Set project plane parameters function */
@@ -209,13 +255,34 @@ namespace cglmath
       return *this;
     }
 
-    /* Set camera parameters constructor */
+    /* Set depth mapping function. Reversed depth keeps float depth buffer precision at distance,
+     * the depth test becomes D3DCMP_GREATEREQUAL and depth is cleared to 0 */
+    TCamera & set_depth_mode( bool reversed, bool infinite_far )
+    {
+      is_reversed_depth = reversed;
+      is_infinite_far = infinite_far;
+      update_proj_data();
+
+      return *this;
+    }
+
+    /* Depth of the empty depth buffer */
+    TYPE get_clear_depth( void ) const
+    {
+      return is_reversed_depth ? 0 : 1;
+    }
+
+    /* Set camera parameters constructor, depth mode is kept */
     void set_camera( TVector<TYPE> & pos, TVector<TYPE> & at_vec, TVector<TYPE> & up_vec, bool is_look_at,
                      TYPE project_plane_w = 0.4, TYPE project_plane_h = 0.3,
                      TYPE proj_dist = 1.0, TYPE far_dist = 10000.0,
-                     INT screen_w = 320, INT screen_h = 240)
+                     int screen_w = 320, int screen_h = 240)
     {
+      bool const reversed = is_reversed_depth, infinite_far = is_infinite_far;
+
       *this = TCamera(pos, at_vec, up_vec, is_look_at, project_plane_w, project_plane_h, proj_dist, far_dist, screen_w, screen_h);
+      is_reversed_depth = reversed;
+      is_infinite_far = infinite_far;
     }
 
     /***
@@ -235,7 +302,7 @@ namespace cglmath
     /* Move camera forward without moving look at point function */
     TCamera & move_to_look_at( TYPE distance, TYPE epsilon = c_threshold )
     {
-      vec_t tmp = location + direction * distance;
+      TVector<TYPE> tmp = location + direction * distance;
       if ((tmp - look_at).length() > epsilon)
       {
         location = tmp;
@@ -264,6 +331,16 @@ namespace cglmath
       return *this;
     }
 
+    /* Move camera without turning function */
+    TCamera & shift( TVector<TYPE> const &offset )
+    {
+      location += offset;
+      look_at += offset;
+      update_matrices();
+
+      return *this;
+    }
+
     /* Rotate camera right function */
     TCamera & rotate_right( TYPE angle )
     {
@@ -351,6 +428,109 @@ namespace cglmath
       location = look_at - direction * length;
       update_dir_loc_up();
     }
+  private:
+    /*** Cached matrices ***/
+    mutable TTransform<TYPE> m_view;              /* View and inverse view matrices */
+    mutable TMatrix<TYPE> m_projection;           /* Perspective projection matrix */
+    mutable TMatrix<TYPE> m_view_projection;
+    mutable TMatrix<TYPE> m_inv_view_projection;
+    mutable frustum_t m_frustum;
+    mutable bool m_is_view_dirty;
+    mutable bool m_is_projection_dirty;
+    mutable bool m_is_combined_dirty;             /* view projection, its inverse and frustum */
+
+    /* Caches are read only after an update, they are set so that copies (set_camera()) copy defined values */
+    void clear_cache( void )
+    {
+      m_projection.set_unit();
+      m_view_projection.set_unit();
+      m_inv_view_projection.set_unit();
+    }
+
+    void update_view_cache( void ) const
+    {
+      if (!m_is_view_dirty)
+        return;
+
+      /* Make view transformation matrix */
+      m_view.matrix = TMatrix<TYPE>(right.x,      up.x,      direction.x,
+                                    right.y,      up.y,      direction.y,
+                                    right.z,      up.z,      direction.z,
+                                    -location & right, -location & up, -location & direction);
+
+      /* Inverse of the orthonormal basis is its transpose */
+      m_view.inv_matrix = TMatrix<TYPE>(right.x, right.y, right.z,
+                                        up.x,    up.y,    up.z,
+                                        direction.x,   direction.y,   direction.z,
+                                        location.x,   location.y,   location.z);
+      m_is_view_dirty = false;
+    }
+
+    void update_projection_cache( void ) const
+    {
+      if (!m_is_projection_dirty)
+        return;
+
+      /* View depth z maps to a + b / z: 0 at near and 1 at far, or the reverse */
+      double const n = projection_distance, f = far_clip;
+      double a, b;
+      if (is_reversed_depth)
+      {
+        a = is_infinite_far ? 0.0 : n / (n - f);
+        b = is_infinite_far ? n : f * n / (f - n);
+      }
+      else
+      {
+        a = is_infinite_far ? 1.0 : f / (f - n);
+        b = is_infinite_far ? -n : f * n / (n - f);
+      }
+      m_projection =
+        TMatrix<TYPE>(static_cast<TYPE>(2.0 * projection_distance / width),      0,             0,
+                        0,          static_cast<TYPE>(2.0 * projection_distance / height),      0,
+                        0,                  0,       static_cast<TYPE>(a),
+                        0,                  0,       static_cast<TYPE>(b),
+                        0,                  0,             1, 0);
+      m_is_projection_dirty = false;
+    }
+
+    void update_combined_cache( void ) const
+    {
+      if (!m_is_combined_dirty)
+        return;
+      update_view_cache();
+      update_projection_cache();
+
+      TMatrix<TYPE>::multiply(m_view.matrix, m_projection, m_view_projection);
+
+      /* Projection (x, y, z, w) -> (sx x, sy y, a z + b w, z) is inverted directly:
+       * x = x' / sx, y = y' / sy, z = w', w = (z' - a w') / b */
+      TMatrix<TYPE> inv_projection;
+      memset(inv_projection.M, 0, sizeof(inv_projection.M));
+      inv_projection.M[0][0] = 1 / m_projection.M[0][0];
+      inv_projection.M[1][1] = 1 / m_projection.M[1][1];
+      inv_projection.M[3][2] = 1;
+      inv_projection.M[2][3] = 1 / m_projection.M[3][2];
+      inv_projection.M[3][3] = -m_projection.M[2][2] / m_projection.M[3][2];
+      TMatrix<TYPE>::multiply(inv_projection, m_view.inv_matrix, m_inv_view_projection);
+
+      /* Clip volume -w < x, y < w, 0 < z < w of row vectors p * M */
+      int const rows[6][2] = {{0, 1}, {0, -1}, {1, 1}, {1, -1}, {2, 0}, {2, -1}};
+      for (int i = 0; i < 6; ++i)
+      {
+        TYPE *plane = m_frustum.planes[i];
+        for (int j = 0; j < 4; ++j)
+        {
+          TYPE const axis = m_view_projection.M[j][rows[i][0]];
+          TYPE const w = m_view_projection.M[j][3];
+          plane[j] = rows[i][1] == 0 ? axis : w + rows[i][1] * axis;
+        }
+        TYPE const length = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0)
+          for (int j = 0; j < 4; ++j)
+            plane[j] /= length;
+      }
+      m_is_combined_dirty = false;
+    }
   };
 }
 
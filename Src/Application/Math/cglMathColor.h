@@ -10,10 +10,10 @@
 #define __CGLMATHCOLOR_INCLUDED__
 
 #define CGL_MAKELONG0123(B0, B1, B2, B3) \
-                        (DWORD)((((DWORD)((BYTE)(B3))) << 24) | \
-                        (((DWORD)((BYTE)(B2))) << 16) | \
-                        (((DWORD)((BYTE)(B1))) << 8) | \
-                        (DWORD)((BYTE)(B0)))
+                        (unsigned long)((((unsigned long)((unsigned char)(B3))) << 24) | \
+                        (((unsigned long)((unsigned char)(B2))) << 16) | \
+                        (((unsigned long)((unsigned char)(B1))) << 8) | \
+                        (unsigned long)((unsigned char)(B0)))
 #define CGL_MAX(A, B)         (((A) > (B)) ? (A) : (B))
 #define CGL_MIN(A, B)         (((A) < (B)) ? (A) : (B))
 
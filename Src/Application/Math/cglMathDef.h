@@ -11,7 +11,8 @@
 
 #include <math.h>
 
-#ifndef __NO_USE_SINCOS_ASM__
+/* x87 inline assembler is only available on 32-bit MSVC */
+#if !defined(__NO_USE_SINCOS_ASM__) && defined(_MSC_VER) && defined(_M_IX86)
 #define __USE_SINCOS_ASM__
 #endif /* __NO_USE_SINCOS_ASM__ */
 
@@ -166,8 +167,8 @@ namespace cglmath
   }
 
   /* Construct 3x3 matrix of rotation around arbitrary axis function */
-  template<class TYPE, INT N>
-  VOID BuildRotateMatrix3x3(TYPE RotMatr[N][N], const TYPE AngleInDegree,
+  template<class TYPE, int N>
+  void BuildRotateMatrix3x3(TYPE RotMatr[N][N], const TYPE AngleInDegree,
     const TYPE AxisX, const TYPE AxisY, const TYPE AxisZ)
   {
     TYPE
@@ -190,8 +191,8 @@ namespace cglmath
         fstp h    /* sin -> sine */
     }
 #else /* __USE_SINCOS_ASM__ */
-    s = cos(AngleInDegree);
-    h = sin(AngleInDegree);
+    s = (TYPE)cos(Angle * c_degree2radian);
+    h = (TYPE)sin(Angle * c_degree2radian);
 #endif /* __USE_SINCOS_ASM__ */
 
     if (Abs(len) > c_threshold && Abs(len - 1) > c_threshold)
@@ -238,8 +239,8 @@ namespace cglmath
       fstp h      /* sin -> sine */
     }
 #else /* __USE_SINCOS_ASM__ */
-    s = cos(AngleInDegree);
-    h = sin(AngleInDegree);
+    s = cos(angle_in_radians);
+    h = sin(angle_in_radians);
 #endif /* __USE_SINCOS_ASM__ */
     sine = h;
     cosine = s;
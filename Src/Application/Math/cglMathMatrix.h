@@ -12,7 +12,7 @@
 #include <string.h>
 #include <math.h>
 
-#include "cglmathdef.h"
+#include "cglMathDef.h"
 
 namespace cglmath
 {
@@ -34,12 +34,6 @@ namespace cglmath
 
     TMatrix( void ) {}
 
-    /* Constructor by matrix */
-    TMatrix( const TMatrix &matr )
-    {
-      memcpy(M, &matr.M, sizeof(M));
-    }
-
     /* Constructor by components */
     TMatrix( TYPE M00, TYPE M01, TYPE M02, 
              TYPE M10, TYPE M11, TYPE M12, 
@@ -147,6 +141,19 @@ namespace cglmath
       return *this;
     }
 
+    /* Full 4x4 product of projective matrices (operator* is affine only), result must not be an argument */
+    static void multiply( TYPE const a[4][4], TYPE const b[4][4], TYPE result[4][4] )
+    {
+      for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+          result[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
+    }
+
+    static void multiply( TMatrix const &a, TMatrix const &b, TMatrix &result )
+    {
+      multiply(a.M, b.M, result.M);
+    }
+
     /* Inverse matrix function */
     bool inverse( void )
     {
@@ -182,11 +189,11 @@ namespace cglmath
 
       /* Check determinant value */
       if (determinant == 0)
-        return FALSE;
+        return false;
       /* Copy result matrix */
       *this = tmp;
       if (determinant == 1.0)
-        return TRUE;
+        return true;
       M[0][0] /= determinant;
       M[0][1] /= determinant;
       M[0][2] /= determinant;
@@ -199,7 +206,7 @@ namespace cglmath
       M[3][0] /= determinant;
       M[3][1] /= determinant;
       M[3][2] /= determinant;
-      return TRUE;
+      return true;
     }
 
     /* inversing matrix function */
@@ -544,7 +551,7 @@ namespace cglmath
     /* Rotate around 'x' axis matrix function */
     TMatrix & rotate_x( TYPE angle_in_degree )
     { 
-      TYPE sine_val, cossine_val;
+      TYPE sine_val, cosine_val;
 
 #ifdef __USE_SINCOS_ASM__
       /* Assembler sine and cosine calculate */
@@ -926,7 +933,7 @@ namespace cglmath
 
       TYPE sine_val, cosine_val;
 
-      angle /= 2;
+      angle = angle_in_degree / 2;
 #ifdef __USE_SINCOS_ASM__
       /* Assembler sine and cosine calculate */
       _asm {
@@ -939,13 +946,13 @@ namespace cglmath
         fstp h
       }
 #else /* __NOUSE_SINCOS_ASM__ */
-      double angle = Deg2Rad(angle_in_degree); 
+      double angle_in_radians = Deg2Rad(angle); 
 
       h = sin(angle_in_radians), s = cos(angle_in_radians);
 #endif /* __USE_SINCOS_ASM__ */ 
 
       len = axis_x * axis_x + axis_y * axis_y + axis_z * axis_z;
-      if (COM_ABS(len) > Threshold && COM_ABS(len - 1) > Threshold)
+      if (Abs(len) > c_threshold && Abs(len - 1) > c_threshold)
       {
         len = sqrt(len);
         vx = axis_x * h / len;
@@ -1026,13 +1033,13 @@ namespace cglmath
     /* Transformation matrix by specified transformation function */
     TMatrix transformation( TTransform<TYPE> const &trans ) const
     {
-      return *this * trans.M;
+      return *this * trans.matrix;
     }
 
     /* Inverse transformation matrix by specified transformation function */
     TMatrix inv_transformation( TTransform<TYPE> const &trans )
     {
-      return trans.InvM * *this;
+      return trans.inv_matrix * *this;
     }
   };
 
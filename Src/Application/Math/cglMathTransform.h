@@ -46,9 +46,16 @@ namespace cglmath
     }
 
     /* Copying constructor */
-    TTransform( const TTransform &trans )
+    TTransform( const TTransform &trans ) : matrix(trans.matrix), inv_matrix(trans.inv_matrix)
     {
-      memcpy(this, &trans, sizeof(TTransform));
+    }
+
+    /* Assignment */
+    TTransform & operator=( const TTransform &trans )
+    {
+      matrix = trans.matrix;
+      inv_matrix = trans.inv_matrix;
+      return *this;
     }
 
     /***
@@ -78,7 +85,7 @@ namespace cglmath
                            vec.x * inv_matrix.M[1][0] + vec.y * inv_matrix.M[1][1] +
                            vec.z * inv_matrix.M[1][2],
                            vec.x * inv_matrix.M[2][0] + vec.y * inv_matrix.M[2][1] +
-                           vec.z * inv_matrix.M[2][2]).Normalize();
+                           vec.z * inv_matrix.M[2][2]).normalizing();
     }
 
     /* Inverse transform 3D point function */
@@ -107,7 +114,7 @@ namespace cglmath
                            vec.x * matrix.M[1][0] + vec.y * matrix.M[1][1] +
                            vec.z * matrix.M[1][2],
                            vec.x * matrix.M[2][0] + vec.y * matrix.M[2][1] +
-                           vec.z * matrix.M[2][2]).Normalize();
+                           vec.z * matrix.M[2][2]).normalizing();
     }
 
     /***
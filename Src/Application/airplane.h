@@ -1,7 +1,12 @@
 #ifndef __AIRPLANE_INCLUDED__
 #define __AIRPLANE_INCLUDED__
 
-#include <d3d9.h>
+#include <cmath>
+#include <memory>
+
+#include "d3d_api.h"
+#include "animation.h"
+#include "light_clusters.h"
 #include "meshes.h"
 #include "lights.h"
 #include "Math/cglMath.h"
@@ -10,34 +15,85 @@
 class airplane_t : public IAnimationUnit
 {
 public:
-  airplane_t( LPDIRECT3DDEVICE9 device )
+  /* Flight clip node 0 moves the airplane and its spot light around the parent origin */
+  airplane_t( LPDIRECT3DDEVICE9 device, IAnimationUnitPtr mesh, std::shared_ptr<animation_clip_t const> const &flight )
     : m_spot(vec_t(0, 0.6f, 1), vec_t(0, -1, 0), cglmath::Deg2Rad(120.f), cglmath::Deg2Rad(130.f), 500, 1.f)
+    , m_flight(flight)
   {
-    x_mesh_t *mesh = new x_mesh_t();
-
-    mesh->load( L"Res/airplane00.x", device );
-
     m_spot.set_falloff(0.5);
     m_spot.set_attenuation1(0.1f);
     m_spot.set_ambient(color_t(0.01f, 0.01f, 0));
     m_spot.set_diffuse(color_t(1.f, 1.f, 0));
     m_spot.set_specular(color_t(0, 0, 0));
-    m_spot.set(device, 1);
+    m_spot.set_managed();
     m_spot.enable(device);
 
     transform().scale(0.1f).rotate_y(90).translate(0, 2.f, 1 );
-    *this << IAnimationUnitPtr(mesh);
-  } 
+    *this << std::move(mesh);
+
+    m_placement = get_transform();
+    m_spot_position = m_spot.soft_light().position;
+    m_spot_direction = m_spot.soft_light().direction;
+  }
+
+  /* Circle around the origin in 7.2 seconds bobbing up and down twice on the way */
+  static std::shared_ptr<animation_clip_t> default_flight( void )
+  {
+    std::shared_ptr<animation_clip_t> clip(new animation_clip_t());
+    float const duration = 7.2f;
+    float times[9], heights[9 * 3], slopes[9 * 3], rotations[5 * 4];
+
+    clip->reset(1, duration, true);
+    for (int k = 0; k < 9; ++k)
+    {
+      float const phase = 4 * cglmath::c_pif * k / 8;
+
+      times[k] = duration * k / 8;
+      heights[k * 3] = heights[k * 3 + 2] = slopes[k * 3] = slopes[k * 3 + 2] = 0;
+      heights[k * 3 + 1] = sinf(phase) * 0.04f;
+      slopes[k * 3 + 1] = cosf(phase) * 0.04f * 4 * cglmath::c_pif / duration;
+    }
+    clip->add_track(0, animation_clip_t::TRANSLATION, animation_clip_t::HERMITE, 9, times, heights, slopes);
+
+    /* Quarter turns: slerp keeps the angular velocity constant */
+    for (int k = 0; k < 5; ++k)
+    {
+      quat_t const q = quat_t::axis_angle(vec_t(0, 1, 0), 90.f * k);
+
+      times[k] = duration * k / 4;
+      rotations[k * 4] = q.x;
+      rotations[k * 4 + 1] = q.y;
+      rotations[k * 4 + 2] = q.z;
+      rotations[k * 4 + 3] = q.w;
+    }
+    clip->add_track(0, animation_clip_t::ROTATION, animation_clip_t::SLERP, 5, times, rotations);
+    return clip;
+  }
+
+  void add_lights( light_manager_t & lights )
+  {
+    lights.add(m_spot);
+  }
 
   void response( recursive_data_t & rd )
   {
-    transform_t t = transform_t().rotate_y(rd.timer.getDelta() * 50).translate(0, sin(rd.timer.getTime() ) * 0.04f, 0);
-    transform().transform(t);
-    m_spot.transform(t);
-    m_spot.update(rd.device);
+    if (m_flight == NULL)
+      return;
+
+    m_flight->evaluate(rd.frame.time, m_pose);
+    transform_t const flight = m_pose.transform(0);
+    set_transform(transform_t(m_placement).transform(flight));
+    m_spot.set_position(flight.transform_point(m_spot_position));
+    m_spot.set_direction(flight.transform_vector(m_spot_direction));
   }
 private:
   spot_light_t m_spot;
+  std::shared_ptr<animation_clip_t const> m_flight;
+  animation_pose_t m_pose;
+  /* Transforms the flight starts from */
+  transform_t m_placement;
+  vec_t m_spot_position;
+  vec_t m_spot_direction;
 
 };
 
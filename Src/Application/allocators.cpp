@@ -0,0 +1,279 @@
+/**
+@file     allocators.cpp
+@brief    Scene units pools, frame linear allocator and heap allocations counting implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstdlib>
+#include <new>
+
+#include "allocators.h"
+
+namespace
+{
+  /* Counted by the replaced global operator new, plain integers are zero before any constructor runs */
+  std::atomic<unsigned long long> s_heap_count;
+  std::atomic<unsigned long long> s_heap_bytes;
+  unsigned long long s_frame_heap_count;
+  unsigned long long s_frame_heap_bytes;
+
+  void * heap_allocate( size_t size )
+  {
+    s_heap_count++;
+    s_heap_bytes += size;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == NULL)
+      throw std::bad_alloc();
+    return p;
+  }
+
+  unsigned char * align_up( unsigned char *p, size_t alignment )
+  {
+    return (unsigned char *)(((size_t)p + alignment - 1) & ~(alignment - 1));
+  }
+
+  /* Pool blocks alignment and units size classes step */
+  const size_t c_pool_alignment = 16;
+  const size_t c_unit_classes_count = 32;
+
+  /* Pools are never destroyed: units may be released by static destructors of other modules */
+  struct unit_pools_t
+  {
+    pool_allocator_t *pools[c_unit_classes_count];
+
+    unit_pools_t()
+    {
+      for (size_t i = 0; i < c_unit_classes_count; ++i)
+        pools[i] = new pool_allocator_t((i + 1) * c_pool_alignment);
+    }
+  };
+
+  unit_pools_t s_unit_pools;
+  frame_allocator_t s_frame_memory;
+}
+
+void * operator new( size_t size )
+{
+  return heap_allocate(size);
+}
+
+void * operator new[]( size_t size )
+{
+  return heap_allocate(size);
+}
+
+void * operator new( size_t size, std::nothrow_t const & ) throw()
+{
+  s_heap_count++;
+  s_heap_bytes += size;
+  return malloc(size == 0 ? 1 : size);
+}
+
+void * operator new[]( size_t size, std::nothrow_t const & ) throw()
+{
+  s_heap_count++;
+  s_heap_bytes += size;
+  return malloc(size == 0 ? 1 : size);
+}
+
+void operator delete( void *p ) throw()
+{
+  free(p);
+}
+
+void operator delete[]( void *p ) throw()
+{
+  free(p);
+}
+
+void operator delete( void *p, size_t ) throw()
+{
+  free(p);
+}
+
+void operator delete[]( void *p, size_t ) throw()
+{
+  free(p);
+}
+
+void operator delete( void *p, std::nothrow_t const & ) throw()
+{
+  free(p);
+}
+
+void operator delete[]( void *p, std::nothrow_t const & ) throw()
+{
+  free(p);
+}
+
+/* Pool */
+pool_allocator_t::pool_allocator_t( size_t block_size, size_t page_size )
+  : m_block_size((block_size + c_pool_alignment - 1) / c_pool_alignment * c_pool_alignment)
+  , m_page_size(page_size > m_block_size ? page_size : m_block_size)
+  , m_free(NULL)
+  , m_page_used(0)
+  , m_blocks_count(0)
+{
+}
+
+pool_allocator_t::~pool_allocator_t()
+{
+  for (size_t i = 0; i < m_pages.size(); ++i)
+    ::operator delete(m_pages[i]);
+}
+
+void * pool_allocator_t::allocate( void )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_blocks_count++;
+  if (m_free != NULL)
+  {
+    free_block_t *block = m_free;
+    m_free = block->next;
+    return block;
+  }
+
+  /* Pages are 16 bytes aligned inside their allocation */
+  if (m_pages.empty() || m_page_used + m_block_size > m_page_size)
+  {
+    m_pages.push_back((unsigned char *)::operator new(m_page_size + c_pool_alignment));
+    m_page_used = 0;
+  }
+  void *block = align_up(m_pages.back(), c_pool_alignment) + m_page_used;
+  m_page_used += m_block_size;
+  return block;
+}
+
+void pool_allocator_t::free( void *block )
+{
+  if (block == NULL)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  free_block_t *freed = static_cast<free_block_t *>(block);
+  freed->next = m_free;
+  m_free = freed;
+  m_blocks_count--;
+}
+
+size_t pool_allocator_t::pages_bytes( void ) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pages.size() * (m_page_size + c_pool_alignment);
+}
+
+size_t pool_allocator_t::blocks_count( void ) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_blocks_count;
+}
+
+void * unit_allocate( size_t size )
+{
+  size_t const size_class = (size + c_pool_alignment - 1) / c_pool_alignment;
+  if (size_class == 0 || size_class > c_unit_classes_count)
+    return ::operator new(size);
+  return s_unit_pools.pools[size_class - 1]->allocate();
+}
+
+void unit_free( void *unit, size_t size )
+{
+  size_t const size_class = (size + c_pool_alignment - 1) / c_pool_alignment;
+  if (size_class == 0 || size_class > c_unit_classes_count)
+    ::operator delete(unit);
+  else
+    s_unit_pools.pools[size_class - 1]->free(unit);
+}
+
+/* Frame allocator */
+frame_allocator_t::frame_allocator_t( size_t capacity )
+  : m_block((unsigned char *)::operator new(capacity))
+  , m_capacity(capacity)
+  , m_used(0)
+  , m_peak(0)
+  , m_overflow_bytes(0)
+{
+}
+
+frame_allocator_t::~frame_allocator_t()
+{
+  reset();
+  ::operator delete(m_block);
+}
+
+void * frame_allocator_t::allocate( size_t size, size_t alignment )
+{
+  /* Alignment padding is reserved together with the size, so concurrent bumps never overlap */
+  size_t const reserved = size + alignment - 1;
+  size_t const offset = m_used.fetch_add(reserved);
+  if (offset + reserved <= m_capacity)
+    return align_up(m_block + offset, alignment);
+
+  std::lock_guard<std::mutex> lock(m_overflow_mutex);
+  void *block = ::operator new(reserved);
+  m_overflow.push_back(block);
+  m_overflow_bytes += reserved;
+  return align_up((unsigned char *)block, alignment);
+}
+
+void frame_allocator_t::reset( void )
+{
+  size_t const used = this->used();
+  m_peak = used > m_peak ? used : m_peak;
+
+  if (!m_overflow.empty())
+  {
+    for (size_t i = 0; i < m_overflow.size(); ++i)
+      ::operator delete(m_overflow[i]);
+    m_overflow.clear();
+
+    /* Next frames fit into one block */
+    size_t const capacity = m_capacity + m_overflow_bytes;
+    ::operator delete(m_block);
+    m_block = (unsigned char *)::operator new(capacity * 2);
+    m_capacity = capacity * 2;
+    m_overflow_bytes = 0;
+  }
+  m_used = 0;
+}
+
+size_t frame_allocator_t::used( void ) const
+{
+  size_t const used = m_used;
+  return (used < m_capacity ? used : m_capacity) + m_overflow_bytes;
+}
+
+frame_allocator_t & frame_memory( void )
+{
+  return s_frame_memory;
+}
+
+memory_stats_t memory_stats( void )
+{
+  memory_stats_t stats;
+
+  stats.heap_count = s_heap_count;
+  stats.heap_bytes = s_heap_bytes;
+  stats.frame_heap_count = (unsigned int)(stats.heap_count - s_frame_heap_count);
+  stats.frame_heap_bytes = stats.heap_bytes - s_frame_heap_bytes;
+  stats.frame_memory_used = s_frame_memory.used();
+  stats.frame_memory_capacity = s_frame_memory.capacity();
+  stats.units_count = 0;
+  stats.units_pool_bytes = 0;
+  for (size_t i = 0; i < c_unit_classes_count; ++i)
+  {
+    stats.units_count += s_unit_pools.pools[i]->blocks_count();
+    stats.units_pool_bytes += s_unit_pools.pools[i]->pages_bytes();
+  }
+  return stats;
+}
+
+void memory_begin_frame( void )
+{
+  s_frame_memory.reset();
+  s_frame_heap_count = s_heap_count;
+  s_frame_heap_bytes = s_heap_bytes;
+}
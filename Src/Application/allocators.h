@@ -0,0 +1,117 @@
+/**
+@file     allocators.h
+@brief    Scene units pools, frame linear allocator and heap allocations counting definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __ALLOCATORS_INCLUDED__
+#define __ALLOCATORS_INCLUDED__
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/* Fixed size blocks carved from pages, freed blocks are reused by next allocations.
+ * Pages are kept until the pool is destroyed. Thread safe */
+class pool_allocator_t
+{
+public:
+  pool_allocator_t( size_t block_size, size_t page_size = 64 * 1024 );
+  ~pool_allocator_t();
+
+  void * allocate( void );
+  void free( void *block );
+
+  size_t block_size( void ) const { return m_block_size; }
+  size_t pages_bytes( void ) const;
+  size_t blocks_count( void ) const;  /* allocated and not freed */
+private:
+  pool_allocator_t( pool_allocator_t const & );
+  pool_allocator_t & operator=( pool_allocator_t const & );
+
+  struct free_block_t
+  {
+    free_block_t *next;
+  };
+
+  size_t m_block_size;
+  size_t m_page_size;
+  std::vector<unsigned char *> m_pages;
+  free_block_t *m_free;
+  size_t m_page_used;           /* bytes of the last page given out */
+  size_t m_blocks_count;
+  mutable std::mutex m_mutex;
+};
+
+/* Scene units memory: one pool per 16 bytes size class, so every unit type is allocated
+ * next to the units of the same type. Larger objects go to the heap */
+void * unit_allocate( size_t size );
+void unit_free( void *unit, size_t size );
+
+/* Linear memory of one frame: allocation is a pointer bump, everything is released at once
+ * by reset(). Blocks overflowing the capacity come from the heap and make the next frame
+ * start with one block of the total size, so steady frames do no heap allocations.
+ * allocate() is thread safe, reset() is called between frames */
+class frame_allocator_t
+{
+public:
+  explicit frame_allocator_t( size_t capacity = 256 * 1024 );
+  ~frame_allocator_t();
+
+  /* Memory lives until reset(), alignment is a power of two up to 64 */
+  void * allocate( size_t size, size_t alignment = 16 );
+
+  /* Uninitialized array for trivially destructible types */
+  template<class TYPE>
+  TYPE * allocate_array( size_t count )
+  {
+    size_t const alignment = std::alignment_of<TYPE>::value;
+    return static_cast<TYPE *>(allocate(count * sizeof(TYPE), alignment > 16 ? alignment : 16));
+  }
+
+  void reset( void );
+
+  size_t used( void ) const;
+  size_t capacity( void ) const { return m_capacity; }
+  size_t peak( void ) const { return m_peak; }
+private:
+  frame_allocator_t( frame_allocator_t const & );
+  frame_allocator_t & operator=( frame_allocator_t const & );
+
+  unsigned char *m_block;
+  size_t m_capacity;
+  std::atomic<size_t> m_used;
+  size_t m_peak;
+
+  std::mutex m_overflow_mutex;
+  std::vector<void *> m_overflow;
+  size_t m_overflow_bytes;
+};
+
+/* Transient data of the rendered frame, reset by memory_begin_frame() */
+frame_allocator_t & frame_memory( void );
+
+struct memory_stats_t
+{
+  /* Global operator new calls since start, all threads */
+  unsigned long long heap_count;
+  unsigned long long heap_bytes;
+  /* Current frame */
+  unsigned int frame_heap_count;
+  unsigned long long frame_heap_bytes;
+  size_t frame_memory_used;
+  size_t frame_memory_capacity;
+  /* Units pools */
+  size_t units_count;
+  size_t units_pool_bytes;
+};
+
+memory_stats_t memory_stats( void );
+/* Reset frame statistics and frame_memory() */
+void memory_begin_frame( void );
+
+#endif /* __ALLOCATORS_INCLUDED__ */
@@ -0,0 +1,640 @@
+/**
+@file     animation.cpp
+@brief    Keyframe animation clips and their batched evaluation implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "files.h"
+#include "simd_math.h"
+#include "stopwatch.h"
+#include "animation.h"
+
+namespace
+{
+  /* Quaternions closer than this are interpolated linearly, slerp weights are unstable there */
+  const float c_slerp_linear_dot = 0.9995f;
+
+  /* Append 16 bytes aligned blob and return its offset */
+  unsigned int append_blob( std::vector<unsigned char> &data, void const *blob, size_t size )
+  {
+    data.resize((data.size() + 15) & ~(size_t)15);
+
+    unsigned int const offset = (unsigned int)data.size();
+    if (size > 0)
+    {
+      data.resize(data.size() + size);
+      memcpy(&data[offset], blob, size);
+    }
+    return offset;
+  }
+
+  /* Check blob lies inside the data */
+  bool is_blob_valid( size_t offset, size_t count, size_t element_size, size_t size )
+  {
+    return offset <= size && count <= (size - offset) / element_size;
+  }
+
+  void normalize( float q[4] )
+  {
+    float const length2 = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    float const scale = length2 > 0 ? 1 / sqrtf(length2) : 0;
+
+    for (int c = 0; c < 4; ++c)
+      q[c] *= scale;
+  }
+
+  /*** SSE helpers ***/
+
+  __m128 hermite_ps( __m128 t, __m128 a, __m128 b, __m128 ta, __m128 tb )
+  {
+    __m128 const t2 = _mm_mul_ps(t, t);
+    __m128 const t3 = _mm_mul_ps(t2, t);
+    __m128 const two = _mm_set1_ps(2.f), three = _mm_set1_ps(3.f);
+    /* h00 = 2t^3 - 3t^2 + 1, h10 = t^3 - 2t^2 + t, h01 = 1 - h00, h11 = t^3 - t^2 */
+    __m128 const h01 = _mm_sub_ps(_mm_mul_ps(three, t2), _mm_mul_ps(two, t3));
+    __m128 const h10 = _mm_add_ps(_mm_sub_ps(t3, _mm_mul_ps(two, t2)), t);
+    __m128 const h11 = _mm_sub_ps(t3, t2);
+
+    return _mm_add_ps(_mm_add_ps(a, _mm_mul_ps(h01, _mm_sub_ps(b, a))), _mm_add_ps(_mm_mul_ps(h10, ta), _mm_mul_ps(h11, tb)));
+  }
+}
+
+/*** Quaternion ***/
+
+quat_t quat_t::axis_angle( vec_t const &axis, float angle_in_degree )
+{
+  vec_t const unit = axis.normalizing();
+  float const half = cglmath::Deg2Rad(angle_in_degree) * 0.5f;
+  float const sine = sinf(half);
+
+  return quat_t(unit.x * sine, unit.y * sine, unit.z * sine, cosf(half));
+}
+
+quat_t quat_t::slerp( quat_t const &a, quat_t const &b, float t )
+{
+  float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+  float const sign = dot < 0 ? -1.f : 1.f;
+  float wa = 1 - t, wb = t;
+
+  dot *= sign;
+  if (dot < c_slerp_linear_dot)
+  {
+    float const theta = acosf(dot);
+    float const inv_sine = 1 / sinf(theta);
+
+    wa = sinf(wa * theta) * inv_sine;
+    wb = sinf(wb * theta) * inv_sine;
+  }
+  wb *= sign;
+
+  float q[4] = {wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z, wa * a.w + wb * b.w};
+  normalize(q);
+  return quat_t(q[0], q[1], q[2], q[3]);
+}
+
+/*** Pose ***/
+
+void animation_pose_t::reset( unsigned int nodes_count )
+{
+  for (int c = 0; c < 3; ++c)
+  {
+    translation[c].assign(nodes_count, 0.f);
+    scale[c].assign(nodes_count, 1.f);
+  }
+  for (int c = 0; c < 4; ++c)
+    rotation[c].assign(nodes_count, c == 3 ? 1.f : 0.f);
+}
+
+transform_t animation_pose_t::transform( unsigned int node ) const
+{
+  float const x = rotation[0][node], y = rotation[1][node], z = rotation[2][node], w = rotation[3][node];
+  float const rotate[3][3] =
+  {
+    {1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)},
+    {2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)},
+    {2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)}
+  };
+  float const s[3] = {scale[0][node], scale[1][node], scale[2][node]};
+  float const inv_s[3] = {s[0] != 0 ? 1 / s[0] : 0, s[1] != 0 ? 1 / s[1] : 0, s[2] != 0 ? 1 / s[2] : 0};
+  float const t[3] = {translation[0][node], translation[1][node], translation[2][node]};
+  transform_t result;
+
+  /* Rows are scaled rotation rows, the inverse is transposed rotation with inverse scaled columns */
+  for (int row = 0; row < 3; ++row)
+    for (int column = 0; column < 3; ++column)
+    {
+      result.matrix.M[row][column] = s[row] * rotate[row][column];
+      result.inv_matrix.M[row][column] = rotate[column][row] * inv_s[column];
+    }
+  for (int column = 0; column < 3; ++column)
+  {
+    result.matrix.M[3][column] = t[column];
+    result.inv_matrix.M[3][column] = -(t[0] * result.inv_matrix.M[0][column] + t[1] * result.inv_matrix.M[1][column] +
+                                       t[2] * result.inv_matrix.M[2][column]);
+  }
+  return result;
+}
+
+/*** Clip ***/
+
+animation_clip_t::animation_clip_t()
+  : m_nodes_count(0)
+  , m_duration(0)
+  , m_is_looping(false)
+{
+  pack_tracks();
+}
+
+void animation_clip_t::reset( unsigned int nodes_count, float duration, bool is_looping )
+{
+  m_nodes_count = nodes_count;
+  m_duration = duration;
+  m_is_looping = is_looping;
+  m_tracks.clear();
+  m_times.clear();
+  for (int c = 0; c < 4; ++c)
+    m_values[c].clear();
+  for (int c = 0; c < 3; ++c)
+    m_tangents[c].clear();
+  pack_tracks();
+}
+
+bool animation_clip_t::add_track( unsigned int node, channel_t channel, interpolation_t interpolation, unsigned int keys_count,
+                                  float const *times, float const *values, float const *tangents )
+{
+  if (node >= m_nodes_count || keys_count == 0 || (channel == ROTATION) != (interpolation == SLERP))
+    return false;
+  for (unsigned int k = 1; k < keys_count; ++k)
+    if (times[k] < times[k - 1])
+      return false;
+
+  track_t track;
+  track.node = node;
+  track.channel = channel;
+  track.interpolation = interpolation;
+  track.first_key = (unsigned int)m_times.size();
+  track.keys_count = keys_count;
+
+  unsigned int const components = channel == ROTATION ? 4 : 3;
+  for (unsigned int k = 0; k < keys_count; ++k)
+  {
+    float value[4] = {0, 0, 0, 0};
+
+    memcpy(value, values + k * components, components * sizeof(float));
+    if (channel == ROTATION)
+      normalize(value);
+    m_times.push_back(times[k]);
+    for (int c = 0; c < 4; ++c)
+      m_values[c].push_back(value[c]);
+
+    for (int c = 0; c < 3; ++c)
+    {
+      float tangent = 0;
+
+      if (interpolation != HERMITE || keys_count == 1)
+        tangent = 0;
+      else if (tangents != NULL)
+        tangent = tangents[k * 3 + c];
+      else
+      {
+        /* Catmull-Rom, one sided at the ends */
+        unsigned int const prev = k > 0 ? k - 1 : k, next = k + 1 < keys_count ? k + 1 : k;
+        float const dt = times[next] - times[prev];
+
+        tangent = dt > 0 ? (values[next * 3 + c] - values[prev * 3 + c]) / dt : 0;
+      }
+      m_tangents[c].push_back(tangent);
+    }
+  }
+
+  m_tracks.push_back(track);
+  add_to_block((unsigned int)m_tracks.size() - 1);
+  return true;
+}
+
+void animation_clip_t::pack_tracks( void )
+{
+  m_blocks.clear();
+  m_block_times.clear();
+  m_block_values.clear();
+  for (int i = 0; i < 3; ++i)
+    m_open_blocks[i] = ~0U;
+  for (unsigned int i = 0; i < m_tracks.size(); ++i)
+    add_to_block(i);
+}
+
+float animation_clip_t::clip_time( float time ) const
+{
+  if (!m_is_looping || m_duration <= 0)
+    return time;
+
+  float const wrapped = fmodf(time, m_duration);
+  return wrapped < 0 ? wrapped + m_duration : wrapped;
+}
+
+void animation_clip_t::find_segment( track_t const &track, float time, unsigned int &key, float &t, float &dt ) const
+{
+  float const *times = &m_times[track.first_key];
+
+  key = track.first_key;
+  t = 0;
+  dt = 0;
+  if (track.keys_count == 1)
+    return;
+
+  /* Last key not after time, clamped to the first and the next to last keys */
+  unsigned int index = (unsigned int)(std::upper_bound(times, times + track.keys_count, time) - times);
+  index = index > 0 ? index - 1 : 0;
+  index = index < track.keys_count - 2 ? index : track.keys_count - 2;
+
+  key += index;
+  dt = times[index + 1] - times[index];
+  if (dt > 0)
+    t = cglmath::Clamp((time - times[index]) / dt, 0.f, 1.f);
+}
+
+unsigned int animation_clip_t::key_stride( unsigned int interpolation )
+{
+  /* Four lanes of every component, Hermite tangents follow values */
+  return interpolation == SLERP ? 16 : interpolation == HERMITE ? 24 : 12;
+}
+
+void animation_clip_t::add_to_block( unsigned int track_index )
+{
+  track_t const &track = m_tracks[track_index];
+  unsigned int const stride = key_stride(track.interpolation);
+  unsigned int &open = m_open_blocks[track.interpolation];
+
+  bool is_shared = open < m_blocks.size() && m_blocks[open].lanes_count < 4 && m_blocks[open].keys_count == track.keys_count;
+  for (unsigned int k = 0; is_shared && k < track.keys_count; ++k)
+    is_shared = m_block_times[m_blocks[open].first_key + k] == m_times[track.first_key + k];
+  if (!is_shared)
+  {
+    block_t block;
+
+    block.interpolation = track.interpolation;
+    block.lanes_count = 0;
+    block.first_key = (unsigned int)m_block_times.size();
+    block.keys_count = track.keys_count;
+    block.first_value = (unsigned int)m_block_values.size();
+    m_block_times.insert(m_block_times.end(), m_times.begin() + track.first_key,
+                         m_times.begin() + track.first_key + track.keys_count);
+    /* Unused lanes interpolate zero vectors and identity quaternions */
+    m_block_values.resize(m_block_values.size() + track.keys_count * stride, 0.f);
+    if (track.interpolation == SLERP)
+      for (unsigned int k = 0; k < track.keys_count; ++k)
+        for (int lane = 0; lane < 4; ++lane)
+          m_block_values[block.first_value + k * stride + 3 * 4 + lane] = 1;
+
+    open = (unsigned int)m_blocks.size();
+    m_blocks.push_back(block);
+  }
+
+  block_t &block = m_blocks[open];
+  unsigned int const lane = block.lanes_count++;
+  unsigned int const components = track.interpolation == SLERP ? 4 : 3;
+  block.tracks[lane] = track_index;
+  for (unsigned int k = 0; k < track.keys_count; ++k)
+  {
+    float *key = &m_block_values[block.first_value + k * stride];
+
+    for (unsigned int c = 0; c < components; ++c)
+      key[c * 4 + lane] = m_values[c][track.first_key + k];
+    if (track.interpolation == HERMITE)
+      for (unsigned int c = 0; c < 3; ++c)
+        key[(3 + c) * 4 + lane] = m_tangents[c][track.first_key + k];
+  }
+}
+
+void animation_clip_t::evaluate( float time, animation_pose_t &pose ) const
+{
+  if (pose.size() != m_nodes_count)
+    pose.reset(m_nodes_count);
+
+  float const local_time = clip_time(time);
+  for (size_t i = 0; i < m_blocks.size(); ++i)
+    evaluate_block(m_blocks[i], local_time, pose);
+}
+
+void animation_clip_t::evaluate_block( block_t const &block, float time, animation_pose_t &pose ) const
+{
+  float const *times = &m_block_times[block.first_key];
+  unsigned int const last = block.keys_count - 1;
+  unsigned int key = 0;
+  float t = 0, dt = 0;
+
+  if (last > 0)
+  {
+    /* Keys are usually evenly spaced: start from the proportional guess and walk to the segment */
+    float const span = times[last] - times[0];
+    float const guess = span > 0 ? (time - times[0]) / span * last : 0;
+    key = guess <= 0 ? 0 : guess >= last - 1 ? last - 1 : (unsigned int)guess;
+    while (key + 1 < last && times[key + 1] <= time)
+      ++key;
+    while (key > 0 && times[key] > time)
+      --key;
+
+    dt = times[key + 1] - times[key];
+    if (dt > 0)
+      t = cglmath::Clamp((time - times[key]) / dt, 0.f, 1.f);
+  }
+
+  unsigned int const stride = key_stride(block.interpolation);
+  float const *a = &m_block_values[block.first_value + key * stride];
+  float const *b = last > 0 ? a + stride : a;
+  __m128 const t4 = _mm_set1_ps(t);
+  float result[4][4];
+
+  if (block.interpolation == SLERP)
+  {
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 qa[4], qb[4];
+
+    for (int c = 0; c < 4; ++c)
+    {
+      qa[c] = _mm_loadu_ps(a + c * 4);
+      qb[c] = _mm_loadu_ps(b + c * 4);
+    }
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qa[0], qb[0]), _mm_mul_ps(qa[1], qb[1])),
+                            _mm_add_ps(_mm_mul_ps(qa[2], qb[2]), _mm_mul_ps(qa[3], qb[3])));
+    /* Shortest arc: b is negated with negative dot */
+    __m128 const sign = _mm_and_ps(dot, _mm_set1_ps(-0.f));
+    dot = _mm_min_ps(_mm_xor_ps(dot, sign), one);
+
+    __m128 const theta = acos_positive_ps(dot);
+    __m128 const inv_sine = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(dot, dot)), _mm_set1_ps(1e-30f))));
+    __m128 sine_a, sine_b, unused;
+    sincos_ps(_mm_mul_ps(_mm_sub_ps(one, t4), theta), sine_a, unused);
+    sincos_ps(_mm_mul_ps(t4, theta), sine_b, unused);
+
+    __m128 const is_linear = _mm_cmpge_ps(dot, _mm_set1_ps(c_slerp_linear_dot));
+    __m128 const wa = _mm_or_ps(_mm_and_ps(is_linear, _mm_sub_ps(one, t4)), _mm_andnot_ps(is_linear, _mm_mul_ps(sine_a, inv_sine)));
+    __m128 const wb = _mm_xor_ps(_mm_or_ps(_mm_and_ps(is_linear, t4), _mm_andnot_ps(is_linear, _mm_mul_ps(sine_b, inv_sine))), sign);
+
+    __m128 q[4];
+    for (int c = 0; c < 4; ++c)
+      q[c] = _mm_add_ps(_mm_mul_ps(wa, qa[c]), _mm_mul_ps(wb, qb[c]));
+    __m128 const length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q[0], q[0]), _mm_mul_ps(q[1], q[1])),
+                                      _mm_add_ps(_mm_mul_ps(q[2], q[2]), _mm_mul_ps(q[3], q[3])));
+    __m128 const inv_length = _mm_div_ps(one, _mm_sqrt_ps(length2));
+    for (int c = 0; c < 4; ++c)
+      _mm_storeu_ps(result[c], _mm_mul_ps(q[c], inv_length));
+
+    for (unsigned int lane = 0; lane < block.lanes_count; ++lane)
+    {
+      unsigned int const node = m_tracks[block.tracks[lane]].node;
+
+      for (int c = 0; c < 4; ++c)
+        pose.rotation[c][node] = result[c][lane];
+    }
+    return;
+  }
+
+  /* Tangents in value units per unit segment parameter */
+  __m128 const dt4 = _mm_set1_ps(dt);
+  for (int c = 0; c < 3; ++c)
+  {
+    __m128 const a4 = _mm_loadu_ps(a + c * 4), b4 = _mm_loadu_ps(b + c * 4);
+
+    if (block.interpolation == HERMITE)
+      _mm_storeu_ps(result[c], hermite_ps(t4, a4, b4, _mm_mul_ps(_mm_loadu_ps(a + (3 + c) * 4), dt4),
+                                          _mm_mul_ps(_mm_loadu_ps(b + (3 + c) * 4), dt4)));
+    else
+      _mm_storeu_ps(result[c], _mm_add_ps(a4, _mm_mul_ps(_mm_sub_ps(b4, a4), t4)));
+  }
+
+  for (unsigned int lane = 0; lane < block.lanes_count; ++lane)
+  {
+    track_t const &track = m_tracks[block.tracks[lane]];
+    std::vector<float> *channel = track.channel == TRANSLATION ? pose.translation : pose.scale;
+
+    for (int c = 0; c < 3; ++c)
+      channel[c][track.node] = result[c][lane];
+  }
+}
+
+void animation_clip_t::evaluate_reference( float time, animation_pose_t &pose ) const
+{
+  if (pose.size() != m_nodes_count)
+    pose.reset(m_nodes_count);
+
+  float const local_time = clip_time(time);
+  for (size_t i = 0; i < m_tracks.size(); ++i)
+  {
+    track_t const &track = m_tracks[i];
+    unsigned int key;
+    float t, dt;
+
+    find_segment(track, local_time, key, t, dt);
+    unsigned int const next = track.keys_count > 1 ? key + 1 : key;
+
+    if (track.interpolation == SLERP)
+    {
+      quat_t const q = quat_t::slerp(quat_t(m_values[0][key], m_values[1][key], m_values[2][key], m_values[3][key]),
+                                     quat_t(m_values[0][next], m_values[1][next], m_values[2][next], m_values[3][next]), t);
+
+      pose.rotation[0][track.node] = q.x;
+      pose.rotation[1][track.node] = q.y;
+      pose.rotation[2][track.node] = q.z;
+      pose.rotation[3][track.node] = q.w;
+      continue;
+    }
+
+    std::vector<float> *channel = track.channel == TRANSLATION ? pose.translation : pose.scale;
+    for (int c = 0; c < 3; ++c)
+    {
+      float const a = m_values[c][key], b = m_values[c][next];
+      float value = a + (b - a) * t;
+
+      if (track.interpolation == HERMITE)
+      {
+        float const t2 = t * t, t3 = t2 * t;
+
+        value = (2 * t3 - 3 * t2 + 1) * a + (t3 - 2 * t2 + t) * m_tangents[c][key] * dt + (3 * t2 - 2 * t3) * b +
+                (t3 - t2) * m_tangents[c][next] * dt;
+      }
+      channel[c][track.node] = value;
+    }
+  }
+}
+
+/*** Clip file ***/
+
+void animation_clip_t::write( std::vector<unsigned char> &data ) const
+{
+  animation_clip_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "CGLA", 4);
+  header.version = c_animation_clip_version;
+  header.nodes_count = m_nodes_count;
+  header.tracks_count = (unsigned int)m_tracks.size();
+  header.keys_count = (unsigned int)m_times.size();
+  header.is_looping = m_is_looping ? 1 : 0;
+  header.duration = m_duration;
+
+  size_t const keys_size = m_times.size() * sizeof(float);
+  data.assign(sizeof(header), 0);
+  header.tracks_offset = append_blob(data, m_tracks.empty() ? NULL : &m_tracks[0], m_tracks.size() * sizeof(track_t));
+  header.times_offset = append_blob(data, m_times.empty() ? NULL : &m_times[0], keys_size);
+  header.values_offset = append_blob(data, m_times.empty() ? NULL : &m_values[0][0], keys_size);
+  for (int c = 1; c < 4; ++c)
+    append_blob(data, m_times.empty() ? NULL : &m_values[c][0], keys_size);
+  header.tangents_offset = append_blob(data, m_times.empty() ? NULL : &m_tangents[0][0], keys_size);
+  for (int c = 1; c < 3; ++c)
+    append_blob(data, m_times.empty() ? NULL : &m_tangents[c][0], keys_size);
+
+  memcpy(&data[0], &header, sizeof(header));
+}
+
+bool animation_clip_t::read( void const *data, size_t size )
+{
+  if (size < sizeof(animation_clip_header_t))
+    return false;
+
+  animation_clip_header_t const *header = (animation_clip_header_t const *)data;
+  unsigned char const *bytes = (unsigned char const *)data;
+  /* Arrays of keys follow each other 16 bytes aligned */
+  size_t const keys_stride = (header->keys_count * sizeof(float) + 15) & ~(size_t)15;
+  if (memcmp(header->magic, "CGLA", 4) != 0 || header->version != c_animation_clip_version ||
+      !is_blob_valid(header->tracks_offset, header->tracks_count, sizeof(track_t), size) ||
+      !is_blob_valid(header->times_offset, header->keys_count, sizeof(float), size) ||
+      !is_blob_valid(header->values_offset + 3 * keys_stride, header->keys_count, sizeof(float), size) ||
+      !is_blob_valid(header->tangents_offset + 2 * keys_stride, header->keys_count, sizeof(float), size))
+    return false;
+
+  track_t const *tracks = (track_t const *)(bytes + header->tracks_offset);
+  for (unsigned int i = 0; i < header->tracks_count; ++i)
+    if (tracks[i].node >= header->nodes_count || tracks[i].channel > SCALE || tracks[i].interpolation > SLERP ||
+        (tracks[i].channel == ROTATION) != (tracks[i].interpolation == SLERP) || tracks[i].keys_count == 0 ||
+        tracks[i].first_key > header->keys_count || tracks[i].keys_count > header->keys_count - tracks[i].first_key)
+      return false;
+
+  m_nodes_count = header->nodes_count;
+  m_duration = header->duration;
+  m_is_looping = header->is_looping != 0;
+  m_tracks.assign(tracks, tracks + header->tracks_count);
+
+  float const *times = (float const *)(bytes + header->times_offset);
+  m_times.assign(times, times + header->keys_count);
+  for (int c = 0; c < 4; ++c)
+  {
+    float const *values = (float const *)(bytes + header->values_offset + c * keys_stride);
+    m_values[c].assign(values, values + header->keys_count);
+  }
+  for (int c = 0; c < 3; ++c)
+  {
+    float const *tangents = (float const *)(bytes + header->tangents_offset + c * keys_stride);
+    m_tangents[c].assign(tangents, tangents + header->keys_count);
+  }
+  pack_tracks();
+  return true;
+}
+
+bool animation_clip_t::save( wchar_t const *file_name ) const
+{
+  std::vector<unsigned char> data;
+
+  write(data);
+  return save_file(file_name, &data[0], data.size());
+}
+
+bool animation_clip_t::load( wchar_t const *file_name )
+{
+  mapped_file_t file;
+
+  return file.open(file_name) && read(file.data(), file.size());
+}
+
+/*** Benchmark ***/
+
+animation_benchmark_t benchmark_animation( unsigned int nodes_count, unsigned int frames_count )
+{
+  animation_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.nodes_count = nodes_count;
+  result.frames_count = frames_count;
+  if (nodes_count == 0 || frames_count == 0)
+    return result;
+
+  /* Deterministic pseudo random tracks: 8 translation, 8 rotation and 4 scale keys per node */
+  unsigned int seed = 12345;
+  struct random_t
+  {
+    static float next( unsigned int &seed )
+    {
+      seed = seed * 1664525U + 1013904223U;
+      return (seed >> 8) / 16777216.f;
+    }
+  };
+
+  animation_clip_t clip;
+  float const duration = 4;
+  clip.reset(nodes_count, duration, true);
+  for (unsigned int node = 0; node < nodes_count; ++node)
+  {
+    float times[8], translations[8 * 3], rotations[8 * 4], scales[4 * 3];
+
+    for (int k = 0; k < 8; ++k)
+    {
+      quat_t const q = quat_t::axis_angle(vec_t(random_t::next(seed) - 0.5f, random_t::next(seed) - 0.5f, random_t::next(seed) - 0.5f),
+                                          random_t::next(seed) * 360 - 180);
+
+      times[k] = duration * k / 7;
+      for (int c = 0; c < 3; ++c)
+        translations[k * 3 + c] = random_t::next(seed) * 10 - 5;
+      rotations[k * 4] = q.x;
+      rotations[k * 4 + 1] = q.y;
+      rotations[k * 4 + 2] = q.z;
+      rotations[k * 4 + 3] = q.w;
+    }
+    for (int k = 0; k < 4 * 3; ++k)
+      scales[k] = 0.5f + random_t::next(seed);
+
+    float const scale_times[4] = {0, duration / 3, duration * 2 / 3, duration};
+    clip.add_track(node, animation_clip_t::TRANSLATION, animation_clip_t::HERMITE, 8, times, translations);
+    clip.add_track(node, animation_clip_t::ROTATION, animation_clip_t::SLERP, 8, times, rotations);
+    clip.add_track(node, animation_clip_t::SCALE, animation_clip_t::LINEAR, 4, scale_times, scales);
+  }
+
+  std::vector<unsigned char> data;
+  animation_clip_t read_clip;
+  clip.write(data);
+  result.file_size = data.size();
+  if (!read_clip.read(&data[0], data.size()))
+  {
+    result.max_error = 1e30f;
+    return result;
+  }
+
+  animation_pose_t simd, reference, read;
+  stopwatch_t timer;
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    clip.evaluate(frame / 60.f, simd);
+  result.simd_ms = timer.elapsed_ms();
+
+  timer.restart();
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    clip.evaluate_reference(frame / 60.f, reference);
+  result.reference_ms = timer.elapsed_ms();
+
+  read_clip.evaluate((frames_count - 1) / 60.f, read);
+  for (unsigned int node = 0; node < nodes_count; ++node)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      result.max_error = cglmath::Max(result.max_error, fabsf(simd.translation[c][node] - reference.translation[c][node]));
+      result.max_error = cglmath::Max(result.max_error, fabsf(simd.scale[c][node] - reference.scale[c][node]));
+      result.max_error = cglmath::Max(result.max_error, fabsf(simd.translation[c][node] - read.translation[c][node]));
+    }
+    for (int c = 0; c < 4; ++c)
+      result.max_error = cglmath::Max(result.max_error, fabsf(simd.rotation[c][node] - reference.rotation[c][node]));
+  }
+  return result;
+}
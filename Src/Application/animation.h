@@ -0,0 +1,178 @@
+/**
+@file     animation.h
+@brief    Keyframe animation clips and their batched evaluation definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __ANIMATION_INCLUDED__
+#define __ANIMATION_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "Math/cglMath.h"
+
+/* Unit quaternion, D3DX convention: rotation matrix of it equals rotate() one for the same axis and angle */
+struct quat_t
+{
+  float x, y, z, w;
+
+  quat_t() : x(0), y(0), z(0), w(1) {}
+  quat_t( float _x, float _y, float _z, float _w ) : x(_x), y(_y), z(_z), w(_w) {}
+
+  static quat_t axis_angle( vec_t const &axis, float angle_in_degree );
+  /* Spherical interpolation along the shortest arc */
+  static quat_t slerp( quat_t const &a, quat_t const &b, float t );
+};
+
+/* Local translation, rotation and scale of every clip node in structure of arrays layout.
+ * Nodes without a track of some channel keep identity for it */
+struct animation_pose_t
+{
+  std::vector<float> translation[3];
+  std::vector<float> rotation[4];
+  std::vector<float> scale[3];
+
+  void reset( unsigned int nodes_count );
+  size_t size( void ) const { return translation[0].size(); }
+
+  /* Scale, rotation, then translation with the inverse matrix */
+  transform_t transform( unsigned int node ) const;
+};
+
+/* Tracks of node translations, rotations and scales. Tracks of the same interpolation and key
+ * times are packed by four into blocks: every key of a block holds each component of the four
+ * tracks together, so evaluate() finds one segment per block and interpolates it with SSE */
+class animation_clip_t
+{
+public:
+  enum channel_t
+  {
+    TRANSLATION,
+    ROTATION,
+    SCALE
+  };
+
+  enum interpolation_t
+  {
+    LINEAR,                     /* translation and scale */
+    HERMITE,                    /* translation and scale, cubic with key tangents */
+    SLERP                       /* rotation */
+  };
+
+  animation_clip_t();
+
+  /* Empty clip of 'duration' seconds, looping clips wrap time */
+  void reset( unsigned int nodes_count, float duration, bool is_looping );
+
+  /* Add track of 'keys_count' keys with ascending times. Values are 3 floats per key or
+   * quaternion x, y, z, w for rotations. Hermite tangents are 3 floats per key in value
+   * units per second, Catmull-Rom ones are used for NULL. Returns false for invalid track */
+  bool add_track( unsigned int node, channel_t channel, interpolation_t interpolation, unsigned int keys_count,
+                  float const *times, float const *values, float const *tangents = NULL );
+
+  unsigned int nodes_count( void ) const { return m_nodes_count; }
+  size_t tracks_count( void ) const { return m_tracks.size(); }
+  size_t keys_count( void ) const { return m_times.size(); }
+  float duration( void ) const { return m_duration; }
+  bool is_looping( void ) const { return m_is_looping; }
+
+  /* Pose of all nodes at 'time' by blocks, the pose is reset for another nodes count */
+  void evaluate( float time, animation_pose_t &pose ) const;
+  /* Same pose track by track */
+  void evaluate_reference( float time, animation_pose_t &pose ) const;
+
+  /* Binary clip file, see animation_clip_header_t */
+  bool save( wchar_t const *file_name ) const;
+  bool load( wchar_t const *file_name );
+  void write( std::vector<unsigned char> &data ) const;
+  bool read( void const *data, size_t size );
+private:
+  struct track_t
+  {
+    unsigned int node;
+    unsigned int channel;
+    unsigned int interpolation;
+    unsigned int first_key;
+    unsigned int keys_count;
+  };
+
+  /* Four tracks sharing key times */
+  struct block_t
+  {
+    unsigned int interpolation;
+    unsigned int lanes_count;
+    unsigned int tracks[4];
+    unsigned int first_key;     /* in m_block_times */
+    unsigned int keys_count;
+    unsigned int first_value;   /* in m_block_values, key_stride() floats per key */
+  };
+
+  /* Clip local time of 'time' */
+  float clip_time( float time ) const;
+  /* Segment of the track containing time and parameter in it */
+  void find_segment( track_t const &track, float time, unsigned int &key, float &t, float &dt ) const;
+
+  static unsigned int key_stride( unsigned int interpolation );
+  /* Put track into the last block of its interpolation or a new one */
+  void add_to_block( unsigned int track_index );
+  void pack_tracks( void );
+  void evaluate_block( block_t const &block, float time, animation_pose_t &pose ) const;
+
+  unsigned int m_nodes_count;
+  float m_duration;
+  bool m_is_looping;
+  std::vector<track_t> m_tracks;
+
+  /* Keys of all tracks as stored in file, evaluate_reference() reads them */
+  std::vector<float> m_times;
+  std::vector<float> m_values[4];
+  std::vector<float> m_tangents[3];
+
+  std::vector<block_t> m_blocks;
+  unsigned int m_open_blocks[3];  /* last block of every interpolation */
+  std::vector<float> m_block_times;
+  std::vector<float> m_block_values;
+};
+
+/* Clip file format version, increase on any layout change */
+const unsigned int c_animation_clip_version = 1;
+
+/* Clip file header. Blobs follow the header, every blob is 16 bytes aligned */
+struct animation_clip_header_t
+{
+  char magic[4];                /* 'CGLA' */
+  unsigned int version;
+  unsigned int nodes_count;
+  unsigned int tracks_count;
+  unsigned int keys_count;
+  unsigned int is_looping;
+  float duration;
+  unsigned int reserved;
+  unsigned int tracks_offset;   /* node, channel, interpolation, first key, keys count per track */
+  unsigned int times_offset;
+  unsigned int values_offset;   /* 4 arrays of keys_count floats */
+  unsigned int tangents_offset; /* 3 arrays of keys_count floats */
+};
+
+/* Clip of 'nodes_count' nodes with translation, rotation and scale tracks evaluated for
+ * 'frames_count' frames in batches and track by track on one thread */
+struct animation_benchmark_t
+{
+  unsigned int nodes_count;
+  unsigned int frames_count;
+  size_t file_size;             /* written clip */
+  double simd_ms;
+  double reference_ms;
+  float max_error;              /* largest pose component difference, including read clip */
+
+  /* Millions of nodes per second */
+  double simd_rate( void ) const { return simd_ms > 0 ? (double)nodes_count * frames_count / simd_ms / 1000 : 0; }
+  double reference_rate( void ) const { return reference_ms > 0 ? (double)nodes_count * frames_count / reference_ms / 1000 : 0; }
+};
+
+animation_benchmark_t benchmark_animation( unsigned int nodes_count, unsigned int frames_count );
+
+#endif /* __ANIMATION_INCLUDED__ */
@@ -0,0 +1,372 @@
+/**
+@file     benchmarks.cpp
+@brief    Named subsystem benchmarks printed by headless mode implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstring>
+
+#include "animation.h"
+#include "frame_context.h"
+#include "light_clusters.h"
+#include "lighting.h"
+#include "mesh_cache.h"
+#include "mesh_lod.h"
+#include "mipmap.h"
+#include "occlusion.h"
+#include "parallel.h"
+#include "petal_animation.h"
+#include "scene.h"
+#include "skinning.h"
+#include "soft_raster.h"
+#include "terrain.h"
+#include "texture_cache.h"
+#include "vertex_format.h"
+#include "x_parser.h"
+#include "benchmarks.h"
+
+namespace
+{
+  /* CPU lighting throughput against scalar reference */
+  void print_lighting( void )
+  {
+    unsigned int const lights_counts[] = {1, 8, 32};
+
+    printf("Lighting, 65536 vertices, M vertex-lights/s:\n%-8s %10s %10s %10s\n", "lights", "SSE", "scalar", "error");
+    for (size_t i = 0; i < sizeof(lights_counts) / sizeof(lights_counts[0]); ++i)
+    {
+      light_benchmark_t const result = benchmark_lighting(65536, lights_counts[i]);
+
+      printf("%-8u %10.1f %10.1f %10.1e\n", result.lights_count, result.simd_rate(), result.reference_rate(), result.max_error);
+    }
+  }
+
+  /* Clustered lights build and selection times */
+  void print_clusters( void )
+  {
+    unsigned int const lights_counts[] = {10, 100, 1000, 10000};
+
+    printf("Light clusters on %u threads:\n%-8s %10s %10s %12s\n", parallel_threads_count(), "lights", "build ms", "select us",
+           "per cluster");
+    for (size_t i = 0; i < sizeof(lights_counts) / sizeof(lights_counts[0]); ++i)
+    {
+      light_cluster_benchmark_t const result = benchmark_light_clusters(lights_counts[i], 0);
+
+      printf("%-8u %10.2f %10.1f %12.1f\n", result.lights_count, result.build_ms, result.select_us, result.mean_cluster_lights);
+    }
+  }
+
+  /* Vertex formats pack/unpack times and precision loss */
+  void print_vertex_formats( void )
+  {
+    vertex_format_t const formats[] =
+    {
+      vertex_format_t(),
+      vertex_format_t(vertex_format_t::POSITION_FLOAT3, vertex_format_t::NORMAL_DEC3N, vertex_format_t::UV_HALF2),
+      vertex_format_t::device_compact(),
+      vertex_format_t::compact()
+    };
+
+    printf("Vertex formats, 250000 vertices, max errors of position, normal degrees and uv:\n%-32s %6s %8s %10s %9s %9s %9s\n",
+           "format", "bytes", "pack ms", "unpack ms", "position", "normal", "uv");
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+    {
+      vertex_format_benchmark_t const result = benchmark_vertex_format(formats[i], 250000, 0);
+
+      printf("%-32s %6u %8.2f %10.2f %9.1e %9.3f %9.1e\n", result.format.name().c_str(), result.format.stride(), result.pack_ms,
+             result.unpack_ms, result.error.max_position, result.error.max_normal, result.error.max_uv);
+    }
+  }
+
+  /* LOD chains build times of growing meshes on one and all threads */
+  void print_lod( void )
+  {
+    unsigned int const grid_sizes[] = {50, 200, 500};
+
+    printf("LOD build on 1/%u threads:\n%-10s %8s %8s %8s %10s\n", parallel_threads_count(), "triangles", "1 ms", "all ms",
+           "levels", "coarsest");
+    for (size_t i = 0; i < sizeof(grid_sizes) / sizeof(grid_sizes[0]); ++i)
+    {
+      mesh_lod_benchmark_t const single = benchmark_mesh_lod(grid_sizes[i], 1);
+      mesh_lod_benchmark_t const all = benchmark_mesh_lod(grid_sizes[i], 0);
+
+      printf("%-10u %8.1f %8.1f %8u %10u\n", single.triangles_count, single.build_ms, all.build_ms, all.levels_count - 1,
+             all.levels_triangles[all.levels_count - 1]);
+    }
+  }
+
+  /* Terrain chunks builds and selection on growing extents */
+  void print_terrain( void )
+  {
+    float const sizes[] = {500.f, 4000.f, 16000.f};
+    unsigned int const levels[] = {5, 8, 10};
+
+    printf("Terrain flight, 200 frames:\n%-8s %7s %8s %9s %10s %8s %11s %11s\n", "size m", "levels", "chunks", "build ms",
+           "select ms", "drawn", "triangles", "full");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+      terrain_benchmark_t const result = benchmark_terrain(sizes[i], levels[i], 200);
+
+      printf("%-8.0f %7u %8u %9.1f %10.3f %8.0f %11.0f %11.0f\n", result.size, result.levels, result.built_count, result.build_ms,
+             result.select_ms, result.visible_chunks, result.visible_triangles, result.full_triangles);
+    }
+  }
+
+  /* Petal animation kernel throughput against transform construction */
+  void print_petals( void )
+  {
+    unsigned int const petals_counts[] = {1200, 120000, 1200000};
+    unsigned int const frames_counts[] = {1000, 10, 1};
+
+    printf("Petal animation on 1 thread, M petals/s:\n%-8s %10s %10s %10s\n", "petals", "SSE", "scalar", "error");
+    for (size_t i = 0; i < sizeof(petals_counts) / sizeof(petals_counts[0]); ++i)
+    {
+      petal_benchmark_t const result = benchmark_petals(petals_counts[i], frames_counts[i]);
+
+      printf("%-8u %10.1f %10.1f %10.1e\n", result.petals_count, result.simd_rate(), result.reference_rate(), result.max_error);
+    }
+  }
+
+  /* Keyframe clip evaluation throughput against track by track one */
+  void print_animation( void )
+  {
+    unsigned int const nodes_counts[] = {100, 1000, 10000};
+    unsigned int const frames_counts[] = {1000, 100, 10};
+
+    printf("Keyframe clips on 1 thread, M nodes/s:\n%-8s %10s %10s %8s %10s\n", "nodes", "SSE", "scalar", "KB", "error");
+    for (size_t i = 0; i < sizeof(nodes_counts) / sizeof(nodes_counts[0]); ++i)
+    {
+      animation_benchmark_t const result = benchmark_animation(nodes_counts[i], frames_counts[i]);
+
+      printf("%-8u %10.1f %10.1f %8.0f %10.1e\n", result.nodes_count, result.simd_rate(), result.reference_rate(),
+             result.file_size / 1024.0, result.max_error);
+    }
+  }
+
+  /* Skinning kernel throughput on one and all threads against scalar one */
+  void print_skinning( void )
+  {
+    unsigned int const vertices_counts[] = {10000, 100000, 1000000};
+    unsigned int const frames_counts[] = {100, 20, 2};
+
+    printf("Skinning, 32 bones, M vertices/s:\n%-9s %10s %10s %10s %8s %10s\n", "vertices", "SSE", "per core", "scalar", "threads",
+           "error");
+    for (size_t i = 0; i < sizeof(vertices_counts) / sizeof(vertices_counts[0]); ++i)
+    {
+      skinning_benchmark_t const result = benchmark_skinning(vertices_counts[i], 32, frames_counts[i]);
+
+      printf("%-9u %10.1f %10.1f %10.1f %8u %10.1e\n", result.vertices_count, result.simd_rate(), result.per_core_rate(),
+             result.reference_rate(), result.threads_count, result.max_error);
+    }
+  }
+
+  /* Units traversal cost per unit against copying frame data by value */
+  void print_traversal( void )
+  {
+    unsigned int const nodes_counts[] = {1000, 10000, 100000};
+    unsigned int const frames_counts[] = {1000, 100, 10};
+    double context_us = 0;
+
+    printf("Traversal, ns per unit:\n%-8s %14s %10s\n", "units", "frame context", "by value");
+    for (size_t i = 0; i < sizeof(nodes_counts) / sizeof(nodes_counts[0]); ++i)
+    {
+      traversal_benchmark_t const result = benchmark_traversal(nodes_counts[i], 4, frames_counts[i]);
+
+      printf("%-8u %14.1f %10.1f\n", result.nodes_count, result.traversal_ns(), result.by_value_ns());
+      context_us = result.context_us;
+    }
+    printf("Frame context construction %.2f us\n", context_us);
+  }
+
+  /* Mipmap chains of growing images by filter on one and all threads */
+  void print_mipmap( void )
+  {
+    unsigned int const sizes[] = {256, 1024, 4096, 8192};
+    mip_filter_t const filters[] = {MIP_FILTER_BOX, MIP_FILTER_KAISER};
+
+    printf("Mipmap chains, sRGB RGBA8, base Mpixels/s on 1/%u threads:\n%-6s %-7s %10s %10s %10s %10s\n",
+           parallel_threads_count(), "size", "filter", "1 ms", "all ms", "1 rate", "all rate");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+      for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); ++f)
+      {
+        mip_benchmark_t const single = benchmark_mip_chain(sizes[i], filters[f], 1);
+        mip_benchmark_t const all = benchmark_mip_chain(sizes[i], filters[f], 0);
+
+        printf("%-6u %-7s %10.1f %10.1f %10.1f %10.1f\n", sizes[i], filters[f] == MIP_FILTER_BOX ? "box" : "kaiser",
+               single.build_ms, all.build_ms, single.rate(), all.rate());
+      }
+  }
+
+  /* Occluders build and box test costs of a terrain flight by threads count */
+  void print_occlusion( void )
+  {
+    unsigned int const threads[] = {1, 2, 4};
+
+    printf("Occlusion, terrain flight with 2000 boxes, 200 frames:\n%-8s %12s %10s %10s %10s\n",
+           "threads", "triangles", "culled %", "build ms", "test us");
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i)
+    {
+      occlusion_benchmark_t const result = benchmark_occlusion(2000, 200, threads[i]);
+
+      printf("%-8u %12.0f %10.1f %10.3f %10.3f\n", result.threads_count, result.triangles, result.culled_percent,
+             result.build_ms, result.test_us);
+    }
+  }
+
+  /* .x files of the application parse throughput */
+  void print_xparse( void )
+  {
+    wchar_t const *const files[] = {L"Res/airplane00.x", L"Res/car00.x", L"Res/heli.x"};
+
+    printf(".x parsing, mean of 20 parses:\n%-20s %8s %9s %9s %9s %8s\n", "file", "KB", "vertices", "faces", "ms", "MB/s");
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+    {
+      x_parse_benchmark_t const result = benchmark_x_parse(files[i], 20);
+
+      if (!result.is_parsed)
+        printf("%-20ls %8s\n", files[i], "failed");
+      else
+        printf("%-20ls %8.1f %9u %9u %9.2f %8.1f\n", files[i], result.file_size / 1024.0, result.vertices_count,
+               result.faces_count, result.parse_ms, result.rate());
+    }
+  }
+
+  /* Cold .x meshes load against mapped cooked ones */
+  void print_mesh( void )
+  {
+    wchar_t const *const files[] = {L"Res/airplane00.x", L"Res/car00.x", L"Res/heli.x"};
+
+    printf("Mesh load, mean of 20 loads:\n%-20s %8s %10s %9s %8s %10s %8s\n", "file", ".x KB", "cooked KB", "cold ms",
+           "cook ms", "cooked ms", "speedup");
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+    {
+      mesh_cache_benchmark_t const result = benchmark_mesh_cache(files[i], 20);
+
+      if (!result.is_loaded)
+        printf("%-20ls %8s\n", files[i], "failed");
+      else
+        printf("%-20ls %8.1f %10.1f %9.2f %8.2f %10.3f %8.1f\n", files[i], result.source_size / 1024.0,
+               result.cooked_size / 1024.0, result.cold_ms, result.cook_ms, result.cooked_ms, result.speedup());
+    }
+  }
+
+  /* Decoded textures load against cooked ones, sources are the golden frames */
+  void print_texture( void )
+  {
+    wchar_t const *const files[] = {L"Res/golden/frame_0000.png", L"Res/golden/frame_0001.png", L"Res/golden/frame_0002.png"};
+
+    printf("Texture load, mean of 20 loads:\n%-26s %9s %7s %10s %10s %8s %10s %8s\n", "file", "size", "format",
+           "cooked KB", "decode ms", "cook ms", "cooked ms", "speedup");
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+    {
+      texture_cache_benchmark_t const result = benchmark_texture_cache(files[i], 20);
+      char size[32];
+
+      sprintf(size, "%ux%u", result.width, result.height);
+      if (!result.is_loaded)
+        printf("%-26ls %9s %7s\n", files[i], size, "failed");
+      else
+        printf("%-26ls %9s %7s %10.1f %10.2f %8.2f %10.3f %8.1f\n", files[i], size,
+               result.format == BLOCK_FORMAT_BC3 ? "BC3" : "BC1", result.cooked_size / 1024.0, result.decoded_ms,
+               result.cook_ms, result.cooked_ms, result.speedup());
+    }
+  }
+
+  /* Software rasterizer throughput of the scene frame on 1, 2, 4, ... threads */
+  void print_raster( void )
+  {
+    unsigned int const frames_count = 10;
+    scene_t scene(NULL);
+    camera_t camera;
+    soft_rasterizer_t rasterizer;
+
+    scene.wait_loaded();
+    scene.update();
+    scene_t::reset_camera(camera);
+    rasterizer.resize(1280, 720);
+
+    /* Same collected frame is rendered by every threads count */
+    rasterizer.begin_frame(camera.get_view_matrix(), camera.get_projection_matrix(), scene_t::c_clear_color);
+    frame_context_t const frame(camera, 0, 0, dvec_t(0, 0, 0));
+    recursive_data_t rd(NULL, frame);
+    rd.rasterizer = &rasterizer;
+    scene.render(rd);
+
+    unsigned int const max_threads = parallel_threads_count();
+    printf("Software rasterizer, scene at 1280x720, mean of %u frames:\n%-8s %10s %10s %10s %10s %10s\n", frames_count,
+           "threads", "frame ms", "vertex ms", "setup ms", "raster ms", "Mtris/s");
+    for (unsigned int threads = 1; ; threads *= 2)
+    {
+      double frame_ms = 0, vertex_ms = 0, setup_ms = 0, raster_ms = 0;
+
+      if (threads > max_threads)
+        threads = max_threads;
+      rasterizer.set_threads(threads);
+      for (unsigned int i = 0; i < frames_count; ++i)
+      {
+        rasterizer.end_frame();
+        frame_ms += rasterizer.stats().frame_ms;
+        vertex_ms += rasterizer.stats().vertex_ms;
+        setup_ms += rasterizer.stats().setup_ms;
+        raster_ms += rasterizer.stats().raster_ms;
+      }
+      printf("%-8u %10.2f %10.2f %10.2f %10.2f %10.1f\n", threads, frame_ms / frames_count, vertex_ms / frames_count,
+             setup_ms / frames_count, raster_ms / frames_count,
+             frame_ms > 0 ? rasterizer.stats().triangles_count * frames_count / frame_ms / 1000 : 0.);
+      if (threads == max_threads)
+        break;
+    }
+  }
+
+  struct benchmark_entry_t
+  {
+    char const *name;
+    void (*print)( void );
+  };
+
+  benchmark_entry_t const s_benchmarks[] =
+  {
+    {"mipmap", print_mipmap},
+    {"lighting", print_lighting},
+    {"clusters", print_clusters},
+    {"vertex-formats", print_vertex_formats},
+    {"lod", print_lod},
+    {"terrain", print_terrain},
+    {"petals", print_petals},
+    {"animation", print_animation},
+    {"skinning", print_skinning},
+    {"traversal", print_traversal},
+    {"occlusion", print_occlusion},
+    {"xparse", print_xparse},
+    {"mesh", print_mesh},
+    {"texture", print_texture},
+    {"raster", print_raster}
+  };
+
+  size_t const c_benchmarks_count = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+}
+
+bool print_benchmark( char const *name )
+{
+  bool const all = strcmp(name, "all") == 0;
+  bool found = false;
+
+  for (size_t i = 0; i < c_benchmarks_count; ++i)
+    if (all || strcmp(name, s_benchmarks[i].name) == 0)
+    {
+      if (found)
+        printf("\n");
+      s_benchmarks[i].print();
+      found = true;
+    }
+  return found;
+}
+
+void print_benchmark_names( FILE *file )
+{
+  for (size_t i = 0; i < c_benchmarks_count; ++i)
+    fprintf(file, "%s ", s_benchmarks[i].name);
+  fprintf(file, "all");
+}
@@ -0,0 +1,21 @@
+/**
+@file     benchmarks.h
+@brief    Named subsystem benchmarks printed by headless mode definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __BENCHMARKS_INCLUDED__
+#define __BENCHMARKS_INCLUDED__
+
+#include <cstdio>
+
+/* Run benchmark of given name ('all' runs every one) and print its table to stdout.
+ * Returns false on unknown name */
+bool print_benchmark( char const *name );
+
+/* Space separated benchmark names for usage messages */
+void print_benchmark_names( FILE *file );
+
+#endif /* __BENCHMARKS_INCLUDED__ */
@@ -1,7 +1,8 @@
 #ifndef __CAR_INCLUDED__
 #define __CAR_INCLUDED__
 
-#include <d3d9.h>
+#include "d3d_api.h"
+#include "light_clusters.h"
 #include "meshes.h"
 #include "lights.h"
 #include "Math/cglMath.h"
@@ -9,7 +10,7 @@
 class car_t
 {
 public:
-  car_t( LPDIRECT3DDEVICE9 device, unsigned int light1, unsigned int light2 )
+  car_t( LPDIRECT3DDEVICE9 device )
      : m_headlight_right( vec_t( 8.5f, -0.3f, 2 ), vec_t( 1, 0, 0 ), cglmath::Deg2Rad( 25.f ), cglmath::Deg2Rad( 35.f ) )
      , m_headlight_left( vec_t( 8.5f, -0.3f, -2 ), vec_t( 1, 0, 0 ), cglmath::Deg2Rad( 25.f ), cglmath::Deg2Rad( 35.f ) )
   {
@@ -22,14 +23,14 @@ public:
     m_headlight_left.set_diffuse( color_t( 1, 1, 0 ) );
     m_headlight_left.set_specular( color_t( 1, 1, 0 ) );
     m_headlight_left.set_attenuation1( 0.1f );
-    m_headlight_left.set( device, light1 );
+    m_headlight_left.set_managed();
     m_headlight_left.enable( device );
 
     m_headlight_right.set_ambient( color_t( 1, 1, 0 ) );
     m_headlight_right.set_diffuse( color_t( 1, 1, 0 ) );
     m_headlight_right.set_specular( color_t( 1, 1, 0 ) );
     m_headlight_right.set_attenuation1( 0.1f );
-    m_headlight_right.set( device, light2 );
+    m_headlight_right.set_managed();
     m_headlight_right.enable( device );
   }
 
@@ -40,10 +41,14 @@ public:
     m_headlight_right.transform( t );
   }
 
+  void add_lights( light_manager_t & lights )
+  {
+    lights.add( m_headlight_left );
+    lights.add( m_headlight_right );
+  }
+
   void render( LPDIRECT3DDEVICE9 device )
   {
-    m_headlight_left.update( device );
-    m_headlight_right.update( device );
     m_car_geometry.render( device );
   }
 
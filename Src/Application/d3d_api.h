@@ -0,0 +1,22 @@
+/**
+@file     d3d_api.h
+@brief    Direct3D 9 and D3DX API of device code paths
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __D3D_API_INCLUDED__
+#define __D3D_API_INCLUDED__
+
+/* Device bound headers include this one instead of the SDK headers. Builds without
+ * Direct3D (headless Linux CI) get declarations only: devices are always NULL there,
+ * so device code compiles but never runs */
+#ifdef _WIN32
+#include <d3d9.h>
+#include <d3dx9.h>
+#else /* _WIN32 */
+#include "d3d_null.h"
+#endif /* _WIN32 */
+
+#endif /* __D3D_API_INCLUDED__ */
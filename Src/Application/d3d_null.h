@@ -0,0 +1,469 @@
+/**
+@file     d3d_null.h
+@brief    Direct3D 9 and D3DX declarations for builds without Direct3D
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __D3D_NULL_INCLUDED__
+#define __D3D_NULL_INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The subset of the SDK used by the tree, values and layouts match the SDK headers.
+ * Interfaces have no implementation and D3DX functions fail, so loaders keep their
+ * system memory paths. Include d3d_api.h rather than this header */
+
+/*** Windows types ***/
+
+typedef uint32_t DWORD;
+typedef uint16_t WORD;
+typedef uint8_t BYTE;
+typedef int BOOL;
+typedef int INT;
+typedef unsigned int UINT;
+typedef int32_t LONG;
+typedef int32_t HRESULT;
+typedef float FLOAT;
+typedef char *LPSTR;
+typedef char const *LPCSTR;
+typedef wchar_t const *LPCWSTR;
+typedef void *HANDLE;
+typedef void *HWND;
+
+struct RECT
+{
+  LONG left, top, right, bottom;
+};
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif /* TRUE */
+
+#define ERROR_SUCCESS 0L
+#define S_OK ((HRESULT)0)
+#define E_NOTIMPL ((HRESULT)0x80004001L)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+
+/*** Direct3D 9 ***/
+
+#define D3D_OK S_OK
+
+typedef DWORD D3DCOLOR;
+#define D3DCOLOR_ARGB(a, r, g, b) ((D3DCOLOR)((((a) & 0xff) << 24) | (((r) & 0xff) << 16) | (((g) & 0xff) << 8) | ((b) & 0xff)))
+#define D3DCOLOR_XRGB(r, g, b) D3DCOLOR_ARGB(0xff, r, g, b)
+
+struct D3DVECTOR
+{
+  float x, y, z;
+};
+
+struct D3DCOLORVALUE
+{
+  float r, g, b, a;
+};
+
+struct D3DMATRIX
+{
+  float m[4][4];
+};
+
+enum D3DLIGHTTYPE
+{
+  D3DLIGHT_POINT = 1,
+  D3DLIGHT_SPOT = 2,
+  D3DLIGHT_DIRECTIONAL = 3
+};
+
+struct D3DLIGHT9
+{
+  D3DLIGHTTYPE Type;
+  D3DCOLORVALUE Diffuse;
+  D3DCOLORVALUE Specular;
+  D3DCOLORVALUE Ambient;
+  D3DVECTOR Position;
+  D3DVECTOR Direction;
+  float Range;
+  float Falloff;
+  float Attenuation0;
+  float Attenuation1;
+  float Attenuation2;
+  float Theta;
+  float Phi;
+};
+
+struct D3DMATERIAL9
+{
+  D3DCOLORVALUE Diffuse;
+  D3DCOLORVALUE Ambient;
+  D3DCOLORVALUE Specular;
+  D3DCOLORVALUE Emissive;
+  float Power;
+};
+
+enum D3DFORMAT
+{
+  D3DFMT_UNKNOWN = 0,
+  D3DFMT_R8G8B8 = 20,
+  D3DFMT_A8R8G8B8 = 21,
+  D3DFMT_X8R8G8B8 = 22,
+  D3DFMT_R5G6B5 = 23,
+  D3DFMT_D24S8 = 75,
+  D3DFMT_D24X8 = 77,
+  D3DFMT_D16 = 80,
+  D3DFMT_D32F_LOCKABLE = 82,
+  D3DFMT_D24FS8 = 83,
+  D3DFMT_INDEX16 = 101,
+  D3DFMT_INDEX32 = 102,
+  D3DFMT_A32B32G32R32F = 116,
+  D3DFMT_DXT1 = 0x31545844,
+  D3DFMT_DXT5 = 0x35545844
+};
+
+enum D3DPOOL
+{
+  D3DPOOL_DEFAULT = 0,
+  D3DPOOL_MANAGED = 1,
+  D3DPOOL_SYSTEMMEM = 2
+};
+
+enum D3DTRANSFORMSTATETYPE
+{
+  D3DTS_VIEW = 2,
+  D3DTS_PROJECTION = 3,
+  D3DTS_WORLD = 256
+};
+
+enum D3DPRIMITIVETYPE
+{
+  D3DPT_POINTLIST = 1,
+  D3DPT_LINELIST = 2,
+  D3DPT_TRIANGLELIST = 4,
+  D3DPT_TRIANGLESTRIP = 5
+};
+
+enum D3DRENDERSTATETYPE
+{
+  D3DRS_ZENABLE = 7,
+  D3DRS_FILLMODE = 8,
+  D3DRS_ZWRITEENABLE = 14,
+  D3DRS_ALPHATESTENABLE = 15,
+  D3DRS_SRCBLEND = 19,
+  D3DRS_DESTBLEND = 20,
+  D3DRS_CULLMODE = 22,
+  D3DRS_ZFUNC = 23,
+  D3DRS_ALPHAREF = 24,
+  D3DRS_ALPHAFUNC = 25,
+  D3DRS_ALPHABLENDENABLE = 27,
+  D3DRS_SPECULARENABLE = 29,
+  D3DRS_TEXTUREFACTOR = 60,
+  D3DRS_LIGHTING = 137,
+  D3DRS_AMBIENT = 139,
+  D3DRS_COLORVERTEX = 141,
+  D3DRS_NORMALIZENORMALS = 143,
+  D3DRS_DIFFUSEMATERIALSOURCE = 145,
+  D3DRS_AMBIENTMATERIALSOURCE = 147,
+  D3DRS_EMISSIVEMATERIALSOURCE = 148
+};
+
+enum D3DSAMPLERSTATETYPE
+{
+  D3DSAMP_ADDRESSU = 1,
+  D3DSAMP_ADDRESSV = 2,
+  D3DSAMP_MAGFILTER = 5,
+  D3DSAMP_MINFILTER = 6,
+  D3DSAMP_MIPFILTER = 7,
+  D3DSAMP_MIPMAPLODBIAS = 8
+};
+
+enum D3DTEXTURESTAGESTATETYPE
+{
+  D3DTSS_COLOROP = 1,
+  D3DTSS_COLORARG1 = 2,
+  D3DTSS_COLORARG2 = 3,
+  D3DTSS_ALPHAOP = 4,
+  D3DTSS_ALPHAARG1 = 5,
+  D3DTSS_ALPHAARG2 = 6
+};
+
+enum D3DDECLTYPE
+{
+  D3DDECLTYPE_FLOAT1 = 0,
+  D3DDECLTYPE_FLOAT2 = 1,
+  D3DDECLTYPE_FLOAT3 = 2,
+  D3DDECLTYPE_FLOAT4 = 3,
+  D3DDECLTYPE_D3DCOLOR = 4,
+  D3DDECLTYPE_SHORT2N = 9,
+  D3DDECLTYPE_SHORT4N = 10,
+  D3DDECLTYPE_DEC3N = 14,
+  D3DDECLTYPE_FLOAT16_2 = 15,
+  D3DDECLTYPE_UNUSED = 17
+};
+
+enum D3DDECLUSAGE
+{
+  D3DDECLUSAGE_POSITION = 0,
+  D3DDECLUSAGE_NORMAL = 3,
+  D3DDECLUSAGE_TEXCOORD = 5,
+  D3DDECLUSAGE_COLOR = 10
+};
+
+enum D3DDECLMETHOD
+{
+  D3DDECLMETHOD_DEFAULT = 0
+};
+
+#define D3DTEXF_NONE 0
+#define D3DTEXF_POINT 1
+#define D3DTEXF_LINEAR 2
+#define D3DCULL_NONE 1
+#define D3DFILL_WIREFRAME 2
+#define D3DFILL_SOLID 3
+#define D3DCMP_LESSEQUAL 4
+#define D3DCMP_GREATER 5
+#define D3DCMP_GREATEREQUAL 7
+#define D3DMCS_MATERIAL 0
+#define D3DMCS_COLOR1 1
+#define D3DBLEND_SRCALPHA 5
+#define D3DBLEND_INVSRCALPHA 6
+#define D3DTOP_SELECTARG1 2
+#define D3DTOP_MODULATE 4
+#define D3DTA_DIFFUSE 0
+#define D3DTA_TEXTURE 2
+#define D3DTA_TFACTOR 3
+#define D3DFVF_XYZ 0x002
+#define D3DFVF_NORMAL 0x010
+#define D3DFVF_DIFFUSE 0x040
+#define D3DFVF_TEX1 0x100
+#define D3DUSAGE_DEPTHSTENCIL 0x2
+#define D3DUSAGE_WRITEONLY 0x8
+#define D3DUSAGE_DYNAMIC 0x200
+#define D3DLOCK_READONLY 0x10
+#define D3DLOCK_DISCARD 0x2000
+#define D3DCLEAR_TARGET 0x1
+#define D3DCLEAR_ZBUFFER 0x2
+#define D3DDTCAPS_SHORT4N 0x8
+#define D3DDTCAPS_DEC3N 0x80
+#define D3DDTCAPS_FLOAT16_2 0x100
+
+struct D3DLOCKED_RECT
+{
+  INT Pitch;
+  void *pBits;
+};
+
+struct D3DSURFACE_DESC
+{
+  D3DFORMAT Format;
+  UINT Width;
+  UINT Height;
+};
+
+struct D3DCAPS9
+{
+  DWORD DevCaps;
+  DWORD MaxActiveLights;
+  DWORD DeclTypes;
+};
+
+struct D3DVERTEXELEMENT9
+{
+  WORD Stream;
+  WORD Offset;
+  BYTE Type;
+  BYTE Method;
+  BYTE Usage;
+  BYTE UsageIndex;
+};
+
+#define D3DDECL_END() {0xFF, 0, D3DDECLTYPE_UNUSED, 0, 0, 0}
+
+struct IUnknown
+{
+  virtual unsigned long AddRef( void ) = 0;
+  virtual unsigned long Release( void ) = 0;
+protected:
+  ~IUnknown() {}
+};
+
+struct IDirect3DResource9 : IUnknown
+{
+};
+
+struct IDirect3DBaseTexture9 : IDirect3DResource9
+{
+  virtual DWORD GetLevelCount( void ) = 0;
+};
+
+struct IDirect3DSurface9 : IDirect3DResource9
+{
+  virtual HRESULT LockRect( D3DLOCKED_RECT *locked, RECT const *rect, DWORD flags ) = 0;
+  virtual HRESULT UnlockRect( void ) = 0;
+  virtual HRESULT GetDesc( D3DSURFACE_DESC *desc ) = 0;
+};
+
+struct IDirect3DTexture9 : IDirect3DBaseTexture9
+{
+  virtual HRESULT GetSurfaceLevel( UINT level, IDirect3DSurface9 **surface ) = 0;
+  virtual HRESULT LockRect( UINT level, D3DLOCKED_RECT *locked, RECT const *rect, DWORD flags ) = 0;
+  virtual HRESULT UnlockRect( UINT level ) = 0;
+  virtual HRESULT GetLevelDesc( UINT level, D3DSURFACE_DESC *desc ) = 0;
+};
+
+struct IDirect3DVertexBuffer9 : IDirect3DResource9
+{
+  virtual HRESULT Lock( UINT offset, UINT size, void **data, DWORD flags ) = 0;
+  virtual HRESULT Unlock( void ) = 0;
+};
+
+struct IDirect3DIndexBuffer9 : IDirect3DResource9
+{
+  virtual HRESULT Lock( UINT offset, UINT size, void **data, DWORD flags ) = 0;
+  virtual HRESULT Unlock( void ) = 0;
+};
+
+struct IDirect3DVertexDeclaration9 : IUnknown
+{
+};
+
+struct IDirect3DDevice9 : IUnknown
+{
+  virtual HRESULT SetTransform( D3DTRANSFORMSTATETYPE state, D3DMATRIX const *matrix ) = 0;
+  virtual HRESULT SetRenderState( D3DRENDERSTATETYPE state, DWORD value ) = 0;
+  virtual HRESULT GetRenderState( D3DRENDERSTATETYPE state, DWORD *value ) = 0;
+  virtual HRESULT SetSamplerState( DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value ) = 0;
+  virtual HRESULT SetTextureStageState( DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value ) = 0;
+  virtual HRESULT GetTextureStageState( DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD *value ) = 0;
+  virtual HRESULT SetLight( DWORD index, D3DLIGHT9 const *light ) = 0;
+  virtual HRESULT LightEnable( DWORD index, BOOL enable ) = 0;
+  virtual HRESULT SetMaterial( D3DMATERIAL9 const *material ) = 0;
+  virtual HRESULT GetMaterial( D3DMATERIAL9 *material ) = 0;
+  virtual HRESULT SetTexture( DWORD stage, IDirect3DBaseTexture9 *texture ) = 0;
+  virtual HRESULT GetTexture( DWORD stage, IDirect3DBaseTexture9 **texture ) = 0;
+  virtual HRESULT SetFVF( DWORD fvf ) = 0;
+  virtual HRESULT SetIndices( IDirect3DIndexBuffer9 *indices ) = 0;
+  virtual HRESULT SetStreamSource( UINT stream, IDirect3DVertexBuffer9 *vertices, UINT offset, UINT stride ) = 0;
+  virtual HRESULT SetVertexDeclaration( IDirect3DVertexDeclaration9 *declaration ) = 0;
+  virtual HRESULT DrawPrimitive( D3DPRIMITIVETYPE type, UINT start, UINT count ) = 0;
+  virtual HRESULT DrawIndexedPrimitive( D3DPRIMITIVETYPE type, INT base, UINT min_index, UINT vertices_count,
+                                        UINT start, UINT count ) = 0;
+  virtual HRESULT DrawPrimitiveUP( D3DPRIMITIVETYPE type, UINT count, void const *data, UINT stride ) = 0;
+  virtual HRESULT CreateVertexBuffer( UINT length, DWORD usage, DWORD fvf, D3DPOOL pool, IDirect3DVertexBuffer9 **buffer,
+                                      HANDLE *shared ) = 0;
+  virtual HRESULT CreateIndexBuffer( UINT length, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9 **buffer,
+                                     HANDLE *shared ) = 0;
+  virtual HRESULT CreateTexture( UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool,
+                                 IDirect3DTexture9 **texture, HANDLE *shared ) = 0;
+  virtual HRESULT CreateVertexDeclaration( D3DVERTEXELEMENT9 const *elements, IDirect3DVertexDeclaration9 **declaration ) = 0;
+  virtual HRESULT UpdateTexture( IDirect3DBaseTexture9 *source, IDirect3DBaseTexture9 *destination ) = 0;
+  virtual HRESULT GetDeviceCaps( D3DCAPS9 *caps ) = 0;
+};
+
+typedef IDirect3DDevice9 *LPDIRECT3DDEVICE9;
+typedef IDirect3DTexture9 *LPDIRECT3DTEXTURE9;
+
+/*** D3DX ***/
+
+#define D3DX_DEFAULT ((UINT)-1)
+#define D3DX_DEFAULT_NONPOW2 ((UINT)-2)
+#define D3DX_FILTER_NONE 1
+#define D3DXMESH_32BIT 0x001
+#define D3DXMESH_MANAGED 0x220
+#define D3DXMESHOPT_COMPACT 0x01000000
+#define D3DXMESHOPT_ATTRSORT 0x02000000
+
+struct D3DXIMAGE_INFO
+{
+  UINT Width;
+  UINT Height;
+  UINT Depth;
+  UINT MipLevels;
+  D3DFORMAT Format;
+};
+
+struct D3DXMATERIAL
+{
+  D3DMATERIAL9 MatD3D;
+  LPSTR pTextureFilename;
+};
+
+struct D3DXATTRIBUTERANGE
+{
+  DWORD AttribId;
+  DWORD FaceStart;
+  DWORD FaceCount;
+  DWORD VertexStart;
+  DWORD VertexCount;
+};
+
+struct ID3DXBuffer : IUnknown
+{
+  virtual void * GetBufferPointer( void ) = 0;
+  virtual DWORD GetBufferSize( void ) = 0;
+};
+
+struct ID3DXMesh : IUnknown
+{
+  virtual HRESULT DrawSubset( DWORD attribute ) = 0;
+  virtual DWORD GetNumFaces( void ) = 0;
+  virtual DWORD GetNumVertices( void ) = 0;
+  virtual DWORD GetFVF( void ) = 0;
+  virtual DWORD GetNumBytesPerVertex( void ) = 0;
+  virtual DWORD GetOptions( void ) = 0;
+  virtual HRESULT GetVertexBuffer( IDirect3DVertexBuffer9 **buffer ) = 0;
+  virtual HRESULT CloneMeshFVF( DWORD options, DWORD fvf, IDirect3DDevice9 *device, ID3DXMesh **mesh ) = 0;
+  virtual HRESULT LockVertexBuffer( DWORD flags, void **data ) = 0;
+  virtual HRESULT UnlockVertexBuffer( void ) = 0;
+  virtual HRESULT LockIndexBuffer( DWORD flags, void **data ) = 0;
+  virtual HRESULT UnlockIndexBuffer( void ) = 0;
+  virtual HRESULT GetAttributeTable( D3DXATTRIBUTERANGE *table, DWORD *size ) = 0;
+  virtual HRESULT LockAttributeBuffer( DWORD flags, DWORD **data ) = 0;
+  virtual HRESULT UnlockAttributeBuffer( void ) = 0;
+  virtual HRESULT OptimizeInplace( DWORD flags, DWORD const *adjacency_in, DWORD *adjacency_out, DWORD *face_remap,
+                                   ID3DXBuffer **vertex_remap ) = 0;
+  virtual HRESULT SetAttributeTable( D3DXATTRIBUTERANGE const *table, DWORD size ) = 0;
+};
+
+inline HRESULT D3DXCreateTexture( IDirect3DDevice9 *, UINT, UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DTexture9 ** )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXCreateTextureFromFile( IDirect3DDevice9 *, LPCWSTR, IDirect3DTexture9 ** )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXCreateTextureFromFileEx( IDirect3DDevice9 *, LPCWSTR, UINT, UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, DWORD,
+                                            DWORD, D3DCOLOR, D3DXIMAGE_INFO *, void *, IDirect3DTexture9 ** )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXGetImageInfoFromFile( LPCWSTR, D3DXIMAGE_INFO * )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXLoadSurfaceFromFile( IDirect3DSurface9 *, void const *, RECT const *, LPCWSTR, RECT const *, DWORD,
+                                        D3DCOLOR, D3DXIMAGE_INFO * )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXLoadMeshFromX( LPCWSTR, DWORD, IDirect3DDevice9 *, ID3DXBuffer **, ID3DXBuffer **, ID3DXBuffer **,
+                                  DWORD *, ID3DXMesh ** )
+{
+  return E_NOTIMPL;
+}
+
+inline HRESULT D3DXCreateMeshFVF( DWORD, DWORD, DWORD, DWORD, IDirect3DDevice9 *, ID3DXMesh ** )
+{
+  return E_NOTIMPL;
+}
+
+#endif /* __D3D_NULL_INCLUDED__ */
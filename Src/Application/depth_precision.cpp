@@ -0,0 +1,107 @@
+/**
+@file     depth_precision.cpp
+@brief    Depth buffer resolution measurement of camera projections implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+
+#include "depth_precision.h"
+
+namespace
+{
+  /* Smallest normalized exponent of 1.m * 2^e values of D3DFMT_D24FS8 depth */
+  const int c_float24_min_exponent = -15;
+  const int c_float24_mantissa_bits = 20;
+
+  /* Bisection steps of the resolution search */
+  const int c_search_steps = 40;
+}
+
+char const * depth_format_name( depth_format_t format )
+{
+  switch (format)
+  {
+  case DEPTH_FORMAT_UNORM24:
+    return "D24";
+  case DEPTH_FORMAT_FLOAT24:
+    return "D24F";
+  case DEPTH_FORMAT_FLOAT32:
+    return "F32";
+  default:
+    return "?";
+  }
+}
+
+double quantize_depth( double depth, depth_format_t format )
+{
+  switch (format)
+  {
+  case DEPTH_FORMAT_UNORM24:
+  {
+    double const max_value = (1 << 24) - 1;
+    return floor(cglmath::Clamp(depth, 0.0, 1.0) * max_value + 0.5) / max_value;
+  }
+  case DEPTH_FORMAT_FLOAT24:
+  {
+    if (depth <= 0)
+      return 0;
+    int exponent;
+    frexp(depth, &exponent);
+    double const step = ldexp(1.0, cglmath::Max(exponent - 1, c_float24_min_exponent) - c_float24_mantissa_bits);
+    return floor(depth / step + 0.5) * step;
+  }
+  default:
+    return (float)depth;
+  }
+}
+
+float projected_depth( matrix_t const &projection, float distance )
+{
+  float const z = distance * projection.M[2][2] + projection.M[3][2];
+  float const w = distance * projection.M[2][3] + projection.M[3][3];
+  return z / w;
+}
+
+float depth_resolution( camera_t const &camera, depth_format_t format, float distance )
+{
+  if (distance < camera.projection_distance || (!camera.is_infinite_far && distance > camera.far_clip))
+    return 0;
+
+  matrix_t const &projection = camera.get_projection_matrix();
+  double const stored = quantize_depth(projected_depth(projection, distance), format);
+
+  /* Doubling steps find a changing one, bisection narrows it down */
+  double low = 0, high = distance * 1e-9;
+  while (quantize_depth(projected_depth(projection, (float)(distance + high)), format) == stored)
+  {
+    low = high;
+    high *= 2;
+    if (high > distance)
+      return 0;
+  }
+  for (int i = 0; i < c_search_steps; ++i)
+  {
+    double const middle = (low + high) / 2;
+    if (quantize_depth(projected_depth(projection, (float)(distance + middle)), format) == stored)
+      low = middle;
+    else
+      high = middle;
+  }
+  return (float)high;
+}
+
+depth_precision_t measure_depth_precision( camera_t const &camera, depth_format_t format )
+{
+  depth_precision_t result;
+
+  float distance = 1;
+  for (size_t i = 0; i < depth_precision_t::c_distances_count; ++i, distance *= 10)
+  {
+    result.distances[i] = distance;
+    result.steps[i] = depth_resolution(camera, format, distance);
+  }
+  return result;
+}
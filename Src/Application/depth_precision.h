@@ -0,0 +1,50 @@
+/**
+@file     depth_precision.h
+@brief    Depth buffer resolution measurement of camera projections definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __DEPTH_PRECISION_INCLUDED__
+#define __DEPTH_PRECISION_INCLUDED__
+
+#include <cstddef>
+
+#include "Math/cglMath.h"
+
+enum depth_format_t
+{
+  DEPTH_FORMAT_UNORM24,         /* D3DFMT_D24S8 */
+  DEPTH_FORMAT_FLOAT24,         /* D3DFMT_D24FS8, 4 bits exponent and 20 bits mantissa */
+  DEPTH_FORMAT_FLOAT32,         /* software rasterizer */
+  DEPTH_FORMAT_COUNT
+};
+
+char const * depth_format_name( depth_format_t format );
+
+/* Value of 'depth' in [0, 1] as stored by the format */
+double quantize_depth( double depth, depth_format_t format );
+
+/* Depth of a point 'distance' ahead of the camera as the rasterizers compute it in floats */
+float projected_depth( matrix_t const &projection, float distance );
+
+/* Smallest view distance step after 'distance' which changes the stored depth, 0 when the
+ * distance is beyond the far plane or the depth stays the same for steps up to 'distance' */
+float depth_resolution( camera_t const &camera, depth_format_t format, float distance );
+
+/* Resolution of the camera projection at decimal distances from 1 to 1e6 */
+struct depth_precision_t
+{
+  static const size_t c_distances_count = 7;
+
+  float distances[c_distances_count];
+  float steps[c_distances_count];         /* depth_resolution(), 0 - not resolved */
+
+  /* Step relative to the distance */
+  float relative( size_t i ) const { return steps[i] > 0 ? steps[i] / distances[i] : 0; }
+};
+
+depth_precision_t measure_depth_precision( camera_t const &camera, depth_format_t format );
+
+#endif /* __DEPTH_PRECISION_INCLUDED__ */
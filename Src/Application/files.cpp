@@ -0,0 +1,201 @@
+/**
+@file     files.cpp
+@brief    Files access helpers implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#else /* _WIN32 */
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* _WIN32 */
+
+#include <string>
+
+#include "files.h"
+
+#ifndef _WIN32
+/* POSIX calls take narrow file names */
+static std::string narrow_file_name( wchar_t const *file_name )
+{
+  std::string result;
+  size_t const length = wcstombs(NULL, file_name, 0);
+
+  if (length != (size_t)-1)
+  {
+    result.resize(length);
+    if (length > 0)
+      wcstombs(&result[0], file_name, length);
+  }
+  return result;
+}
+#endif /* _WIN32 */
+
+bool get_file_stamp( wchar_t const *file_name, file_stamp_t &stamp )
+{
+#ifdef _WIN32
+  struct _stat64 info;
+  if (_wstat64(file_name, &info) != 0)
+    return false;
+#else /* _WIN32 */
+  struct stat info;
+  if (stat(narrow_file_name(file_name).c_str(), &info) != 0)
+    return false;
+#endif /* _WIN32 */
+  stamp.size = (unsigned long long)info.st_size;
+  stamp.write_time = (unsigned long long)info.st_mtime;
+  return true;
+}
+
+FILE * open_file( wchar_t const *file_name, char const *mode )
+{
+#ifdef _WIN32
+  wchar_t wide_mode[8] = {0};
+  for (int i = 0; i < 7 && mode[i] != 0; ++i)
+    wide_mode[i] = mode[i];
+  return _wfopen(file_name, wide_mode);
+#else /* _WIN32 */
+  return fopen(narrow_file_name(file_name).c_str(), mode);
+#endif /* _WIN32 */
+}
+
+bool remove_file( wchar_t const *file_name )
+{
+#ifdef _WIN32
+  return _wremove(file_name) == 0;
+#else /* _WIN32 */
+  return remove(narrow_file_name(file_name).c_str()) == 0;
+#endif /* _WIN32 */
+}
+
+bool rename_file( wchar_t const *old_name, wchar_t const *new_name )
+{
+#ifdef _WIN32
+  return _wrename(old_name, new_name) == 0;
+#else /* _WIN32 */
+  return rename(narrow_file_name(old_name).c_str(), narrow_file_name(new_name).c_str()) == 0;
+#endif /* _WIN32 */
+}
+
+bool create_directory( wchar_t const *path )
+{
+#ifdef _WIN32
+  return _wmkdir(path) == 0 || errno == EEXIST;
+#else /* _WIN32 */
+  return mkdir(narrow_file_name(path).c_str(), 0755) == 0 || errno == EEXIST;
+#endif /* _WIN32 */
+}
+
+bool save_file( wchar_t const *file_name, void const *data, size_t size )
+{
+  std::wstring const temp_name = std::wstring(file_name) + L".tmp";
+  FILE *file = open_file(temp_name.c_str(), "wb");
+  if (file == NULL)
+    return false;
+
+  bool ok = fwrite(data, size, 1, file) == 1;
+  ok = fclose(file) == 0 && ok;
+
+  if (ok)
+  {
+    remove_file(file_name);
+    ok = rename_file(temp_name.c_str(), file_name);
+  }
+  if (!ok)
+    remove_file(temp_name.c_str());
+  return ok;
+}
+
+mapped_file_t::mapped_file_t()
+  : m_data(NULL)
+  , m_size(0)
+#ifdef _WIN32
+  , m_file(INVALID_HANDLE_VALUE)
+  , m_mapping(NULL)
+#endif /* _WIN32 */
+{
+}
+
+mapped_file_t::~mapped_file_t()
+{
+  close();
+}
+
+bool mapped_file_t::open( wchar_t const *file_name )
+{
+  close();
+#ifdef _WIN32
+  m_file = CreateFileW(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (m_file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+  {
+    close();
+    return false;
+  }
+  m_size = (size_t)size.QuadPart;
+
+  m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (m_mapping == NULL)
+  {
+    close();
+    return false;
+  }
+  m_data = (unsigned char const *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else /* _WIN32 */
+  int const fd = ::open(narrow_file_name(file_name).c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0)
+  {
+    ::close(fd);
+    return false;
+  }
+  m_size = (size_t)info.st_size;
+
+  void *data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  m_data = data == MAP_FAILED ? NULL : (unsigned char const *)data;
+#endif /* _WIN32 */
+  if (m_data == NULL)
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void mapped_file_t::close( void )
+{
+#ifdef _WIN32
+  if (m_data != NULL)
+    UnmapViewOfFile(m_data);
+  if (m_mapping != NULL)
+    CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+  m_mapping = NULL;
+  m_file = INVALID_HANDLE_VALUE;
+#else /* _WIN32 */
+  if (m_data != NULL)
+    munmap((void *)m_data, m_size);
+#endif /* _WIN32 */
+  m_data = NULL;
+  m_size = 0;
+}
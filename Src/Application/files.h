@@ -0,0 +1,70 @@
+/**
+@file     files.h
+@brief    Files access helpers definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __FILES_INCLUDED__
+#define __FILES_INCLUDED__
+
+#include <cstdio>
+#include <cstddef>
+
+/* Source file identity used to validate cooked data */
+struct file_stamp_t
+{
+  unsigned long long size;
+  unsigned long long write_time;
+
+  file_stamp_t() : size(0), write_time(0) {}
+
+  bool operator==( file_stamp_t const & other ) const
+  {
+    return size == other.size && write_time == other.write_time;
+  }
+};
+
+/* Get file size and last write time. Returns false if file does not exist */
+bool get_file_stamp( wchar_t const *file_name, file_stamp_t &stamp );
+
+/* fopen() analogue for wide file names */
+FILE * open_file( wchar_t const *file_name, char const *mode );
+
+/* remove() and rename() analogues for wide file names */
+bool remove_file( wchar_t const *file_name );
+bool rename_file( wchar_t const *old_name, wchar_t const *new_name );
+
+/* Create directory, succeeds if it already exists. Parent directory must exist */
+bool create_directory( wchar_t const *path );
+
+/* Write whole file through temporary one, so existing file is replaced only by complete data */
+bool save_file( wchar_t const *file_name, void const *data, size_t size );
+
+/* Read only memory mapped file */
+class mapped_file_t
+{
+public:
+  mapped_file_t();
+  ~mapped_file_t();
+
+  bool open( wchar_t const *file_name );
+  void close( void );
+
+  bool is_open( void ) const { return m_data != NULL; }
+  unsigned char const * data( void ) const { return m_data; }
+  size_t size( void ) const { return m_size; }
+private:
+  mapped_file_t( mapped_file_t const & );
+  mapped_file_t & operator=( mapped_file_t const & );
+
+  unsigned char const *m_data;
+  size_t m_size;
+#ifdef _WIN32
+  void *m_file;
+  void *m_mapping;
+#endif /* _WIN32 */
+};
+
+#endif /* __FILES_INCLUDED__ */
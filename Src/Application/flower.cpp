@@ -7,13 +7,11 @@ petal2_shared_data_t::petal2_shared_data_t( IDirect3DDevice9 * device, flower_pa
   m_vertices_num = 4;
   m_triangles_num = 2;
 
-  device->CreateVertexBuffer(sizeof(flower_vertex_t) * m_vertices_num, D3DUSAGE_WRITEONLY, FLOWER_FVF, D3DPOOL_DEFAULT, &m_vertices_buf, NULL);
-  device->CreateIndexBuffer(sizeof(int) * m_triangles_num * 3, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+  m_vertices.resize(m_vertices_num);
+  m_indices.resize(m_triangles_num * 3);
 
-  flower_vertex_t *vertices_buf;
-  int             *indices_buf;
-  m_vertices_buf->Lock(0, 0, (void **)&vertices_buf, 0);
-  m_index_buf->Lock(0, 0, (void **)&indices_buf, 0);
+  flower_vertex_t *vertices_buf = &m_vertices[0];
+  unsigned int    *indices_buf = &m_indices[0];
 
   vertices_buf[0].V = vec_t(-params.petal1_width / 2, 0, 0);
   vertices_buf[0].N = vec_t(0, 1, 0);
@@ -43,21 +41,20 @@ petal2_shared_data_t::petal2_shared_data_t( IDirect3DDevice9 * device, flower_pa
   indices_buf[4] = 1;
   indices_buf[5] = 2;
 
-  m_vertices_buf->Unlock();
-  m_index_buf->Unlock();
+  create_buffers(device);
 }
 
-petal2_t::petal2_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase )
-  : m_params(params)
-  , m_phase(phase)
+geometry_params_t petal2_shared_data_t::cache_params( flower_params_t const & params )
 {
-  m_shared_data = create_singleton<petal2_shared_data_t>(device, params);
+  return geometry_params_t() << params.petal1_width << params.petal2_width << params.petal2_height << params.petal2_color;
 }
 
-void petal2_t::response( recursive_data_t & rd )
+petal2_t::petal2_t( IDirect3DDevice9 *device, flower_params_t const & params )
 {
-  float const t = sin( rd.timer.getTime() * m_params.velocity + m_phase ) * 0.5f + 0.5f;
-  set_transform( transform_t().rotate_x(-t * m_params.petal2_angle_max - (1 - t) * m_params.petal2_angle_min ).translate(0, 0, m_params.petal1_height) );
+  m_shared_data = geometry_cache().get<petal2_shared_data_t>(petal2_shared_data_t::cache_params(params), [&]()
+  {
+    return std::make_shared<petal2_shared_data_t>(device, params);
+  });
 }
 
 /* First petal */
@@ -66,13 +63,11 @@ petal1_shared_data_t::petal1_shared_data_t( IDirect3DDevice9 * device, flower_pa
   m_vertices_num = 4;
   m_triangles_num = 2;
 
-  device->CreateVertexBuffer(sizeof(flower_vertex_t) * m_vertices_num, D3DUSAGE_WRITEONLY, FLOWER_FVF, D3DPOOL_DEFAULT, &m_vertices_buf, NULL);
-  device->CreateIndexBuffer(sizeof(int) * m_triangles_num * 3, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+  m_vertices.resize(m_vertices_num);
+  m_indices.resize(m_triangles_num * 3);
 
-  flower_vertex_t *vertices_buf;
-  int             *indices_buf;
-  m_vertices_buf->Lock(0, 0, (void **)&vertices_buf, 0);
-  m_index_buf->Lock(0, 0, (void **)&indices_buf, 0);
+  flower_vertex_t *vertices_buf = &m_vertices[0];
+  unsigned int    *indices_buf = &m_indices[0];
 
   float width = 2 * params.receptacle_radius * sin(cglmath::c_pif / params.petals_count);
 
@@ -104,31 +99,30 @@ petal1_shared_data_t::petal1_shared_data_t( IDirect3DDevice9 * device, flower_pa
   indices_buf[4] = 1;
   indices_buf[5] = 2;
 
-  m_vertices_buf->Unlock();
-  m_index_buf->Unlock();
+  create_buffers(device);
 }
 
-petal1_t::petal1_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase )
-  : m_params(params)
-  , m_phase(phase)
+geometry_params_t petal1_shared_data_t::cache_params( flower_params_t const & params )
 {
-  m_shared_data = create_singleton<petal1_shared_data_t>(device, params);
+  return geometry_params_t() << params.receptacle_radius << params.petals_count << params.petal1_width << params.petal1_height <<
+         params.petal1_color;
 }
 
-void petal1_t::response( recursive_data_t & rd )
+petal1_t::petal1_t( IDirect3DDevice9 *device, flower_params_t const & params )
 {
-  float const t = sin(rd.timer.getTime() * m_params.velocity + m_phase) * 0.5f + 0.5f;
-  set_transform(transform_t().rotate_x(-t * m_params.petal1_angle_max - (1 - t) * m_params.petal1_angle_min));
+  m_shared_data = geometry_cache().get<petal1_shared_data_t>(petal1_shared_data_t::cache_params(params), [&]()
+  {
+    return std::make_shared<petal1_shared_data_t>(device, params);
+  });
 }
 
 /* Petal */
-petal_t::petal_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase )
+petal_t::petal_t( IDirect3DDevice9 *device, flower_params_t const & params )
+  : m_petal1(new petal1_t( device, params ))
+  , m_petal2(new petal2_t( device, params ))
 {
-  petal1_t *petal1 = new petal1_t( device, params, phase );
-  petal2_t *petal2 = new petal2_t( device, params, phase );
-
-  *petal1 << IAnimationUnitPtr( petal2 );
-  *this << IAnimationUnitPtr( petal1 );
+  *m_petal1 << IAnimationUnitPtr( m_petal2 );
+  *this << IAnimationUnitPtr( m_petal1 );
 }
 
 void petal_t::response( recursive_data_t & rd )
@@ -145,13 +139,11 @@ receptacle_shared_data_t::receptacle_shared_data_t( IDirect3DDevice9 * device, f
   m_vertices_num = params.petals_count + 1;
   m_triangles_num = params.petals_count;
 
-  device->CreateVertexBuffer(sizeof(flower_vertex_t) * m_vertices_num, D3DUSAGE_WRITEONLY, FLOWER_FVF, D3DPOOL_DEFAULT, &m_vertices_buf, NULL);
-  device->CreateIndexBuffer(sizeof(int) * m_triangles_num * 3, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+  m_vertices.resize(m_vertices_num);
+  m_indices.resize(m_triangles_num * 3);
 
-  flower_vertex_t *vertices_buf;
-  int             *indices_buf;
-  m_vertices_buf->Lock(0, 0, (void **)&vertices_buf, 0);
-  m_index_buf->Lock(0, 0, (void **)&indices_buf, 0);
+  flower_vertex_t *vertices_buf = &m_vertices[0];
+  unsigned int    *indices_buf = &m_indices[0];
 
   float const delta = 2 * cglmath::c_pif / params.petals_count;
   for (unsigned int i = 0; i < m_triangles_num; ++i)
@@ -170,13 +162,20 @@ receptacle_shared_data_t::receptacle_shared_data_t( IDirect3DDevice9 * device, f
   vertices_buf[m_vertices_num - 1].u = 0.5; vertices_buf[0].v = 0.5;
   vertices_buf[m_vertices_num - 1].Color = params.receptacle_color;
 
-  m_vertices_buf->Unlock();
-  m_index_buf->Unlock();
+  create_buffers(device);
+}
+
+geometry_params_t receptacle_shared_data_t::cache_params( flower_params_t const & params )
+{
+  return geometry_params_t() << params.petals_count << params.receptacle_radius << params.receptacle_color;
 }
 
 receptacle_t::receptacle_t( IDirect3DDevice9 *device, flower_params_t const & params )
 {
-  m_shared_data = create_singleton<receptacle_shared_data_t>(device, params);
+  m_shared_data = geometry_cache().get<receptacle_shared_data_t>(receptacle_shared_data_t::cache_params(params), [&]()
+  {
+    return std::make_shared<receptacle_shared_data_t>(device, params);
+  });
 }
 
 void receptacle_t::response( recursive_data_t & rd )
@@ -187,10 +186,19 @@ void receptacle_t::response( recursive_data_t & rd )
 stem_shared_data_t::stem_shared_data_t( IDirect3DDevice9 * device, flower_params_t const & params )
   : m_geometry(device, 50, 50, CylinderFactory(params.stem_length, params.stem_thickness), params.stem_color)
 {
+  m_geometry.set_static(true);
+}
+
+geometry_params_t stem_shared_data_t::cache_params( flower_params_t const & params )
+{
+  return geometry_params_t() << params.stem_length << params.stem_thickness << params.stem_color;
 }
 
 stem_t::stem_t( IDirect3DDevice9 *device, flower_params_t const & params )
-  : m_shared_data(create_singleton<stem_shared_data_t>(device, params))
+  : m_shared_data(geometry_cache().get<stem_shared_data_t>(stem_shared_data_t::cache_params(params), [&]()
+    {
+      return std::make_shared<stem_shared_data_t>(device, params);
+    }))
 {
 }
 
@@ -213,19 +221,69 @@ flower_t::flower_t( IDirect3DDevice9 *device, flower_params_t const & params )
   float const delta = 360.f / params.petals_count;
   for (size_t i = 0; i < params.petals_count; ++i)
   {
-    petal_t *petal = new petal_t(device, params, sin(i * cglmath::c_pif / params.petals_count));
+    petal_t *petal = new petal_t(device, params);
     petal->transform().translate(0, 0, params.receptacle_radius * cos(cglmath::Deg2Rad(delta * 0.5f))).rotate_y(90.f - (i + 0.5f) * delta);
     *receptacle << IAnimationUnitPtr(petal);
+
+    m_petals.add(sin(i * cglmath::c_pif / params.petals_count), params.velocity, params.petal1_angle_min, params.petal1_angle_max,
+                 params.petal2_angle_min, params.petal2_angle_max, params.petal1_height);
+    m_petal1_poses.push_back(&petal->petal1()->transform());
+    m_petal2_poses.push_back(&petal->petal2()->transform());
   }
 
   *stem << IAnimationUnitPtr(receptacle);
   *this << IAnimationUnitPtr(stem);
+
+  /* Stem with the longest petals around its top */
+  float const petal_height = params.petal1_height > params.petal2_height ? params.petal1_height : params.petal2_height;
+  m_bounds_center = vec_t(0, params.stem_length * 0.5f, 0);
+  m_bounds_radius = params.stem_length * 0.5f + params.receptacle_radius + petal_height;
+
+  /* Stem grid, receptacle fan and two quads per petal */
+  m_draws_count = 2 + 2 * params.petals_count;
+  m_vertices_count = 50 * 50 + params.petals_count + 1 + 2 * 4 * params.petals_count;
+  m_is_impostor = false;
+}
+
+bool flower_t::get_bounds( vec_t & center, float & radius ) const
+{
+  center = m_bounds_center;
+  radius = m_bounds_radius;
+  return true;
+}
+
+bool flower_t::get_subtree_bounds( vec_t & box_min, vec_t & box_max ) const
+{
+  vec_t const extent(m_bounds_radius, m_bounds_radius, m_bounds_radius);
+
+  box_min = m_bounds_center - extent;
+  box_max = m_bounds_center + extent;
+  return true;
 }
 
 void flower_t::render( recursive_data_t & rd )
 {
+  /* Software rasterizer does not sample textures, it also bakes the impostors */
+  m_is_impostor = false;
+  if (m_impostor == NULL || rd.rasterizer != NULL || rd.device == NULL)
+    return;
+
+  float const fade = m_impostor->fade(rd.frame, rd.world());
+  if (fade <= 0)
+    return;
+  m_impostor->add(rd.frame, rd.world(), fade, m_draws_count, m_vertices_count);
+  m_is_impostor = fade >= 1;
+}
+
+bool flower_t::is_expanded( recursive_data_t & )
+{
+  return !m_is_impostor;
 }
 
 void flower_t::response( recursive_data_t & rd )
 {
+  /* Impostor only flowers do not draw their petals */
+  if (m_is_impostor || m_petals.size() == 0)
+    return;
+  animate_petals(m_petals, rd.frame.time, &m_petal1_poses[0], &m_petal2_poses[0]);
 }
@@ -1,11 +1,17 @@
 #ifndef __FLOWER_INCLUDED__
 #define __FLOWER_INCLUDED__
 
+#include <cstring>
 #include <memory>
+#include <vector>
 #include "unit.h"
+#include "soft_raster.h"
 #include "texture.h"
-#include "singletone.h"
+#include "geometry_cache.h"
 #include "geometry.h"
+#include "impostor.h"
+#include "petal_animation.h"
+#include "terrain.h"
 
 struct flower_params_t
 {
@@ -54,13 +60,40 @@ struct flower_geometry_shared_data_t
 public:
   virtual ~flower_geometry_shared_data_t()
   {
-    m_vertices_buf->Release();
-    m_index_buf->Release();
+    if (m_index_buf != NULL)
+      m_index_buf->Release();
   }
-  IDirect3DVertexBuffer9 *m_vertices_buf;
+
+  /* Device buffers and their system memory copies */
+  size_t memory_size( void ) const
+  {
+    return m_vertices_num * sizeof(flower_vertex_t) + m_device_vertices.memory_size() + 2 * m_triangles_num * 3 * sizeof(int);
+  }
+
+  /* Create device buffers from filled m_vertices and m_indices, none for NULL device (headless mode) */
+  void create_buffers( IDirect3DDevice9 * device )
+  {
+    void *buf;
+
+    m_index_buf = NULL;
+    if (device == NULL)
+      return;
+
+    m_device_vertices.create(device, &m_vertices[0], sizeof(flower_vertex_t), m_vertices_num, FLOWER_FVF);
+    device->CreateIndexBuffer(sizeof(int) * m_triangles_num * 3, D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+
+    m_index_buf->Lock(0, 0, &buf, 0);
+    memcpy(buf, &m_indices[0], m_indices.size() * sizeof(unsigned int));
+    m_index_buf->Unlock();
+  }
+
+  device_vertices_t m_device_vertices;
   IDirect3DIndexBuffer9 *m_index_buf;
   unsigned int m_vertices_num;
   unsigned int m_triangles_num;
+  /* Copies for software rasterizer, device buffers are write only */
+  std::vector<flower_vertex_t> m_vertices;
+  std::vector<unsigned int> m_indices;
 };
 typedef std::shared_ptr<flower_geometry_shared_data_t> flower_geometry_shared_data_ptr_t;
 
@@ -69,9 +102,21 @@ struct flower_geometry_t : public IAnimationUnit
 public:
   void render( recursive_data_t & rd )
   {
-    rd.device->SetFVF(FLOWER_FVF);
+    if (rd.rasterizer != NULL)
+    {
+      soft_mesh_t mesh;
+
+      mesh.vertices = &m_shared_data->m_vertices[0];
+      mesh.vertex_size = sizeof(flower_vertex_t);
+      mesh.vertices_count = m_shared_data->m_vertices_num;
+      mesh.indices = &m_shared_data->m_indices[0];
+      mesh.triangles_count = m_shared_data->m_triangles_num;
+      rd.rasterizer->draw(mesh, rd.world().matrix);
+      return;
+    }
+
+    m_shared_data->m_device_vertices.bind(rd.device, rd.world());
     rd.device->SetIndices(m_shared_data->m_index_buf);
-    rd.device->SetStreamSource(0, m_shared_data->m_vertices_buf, 0, sizeof(flower_vertex_t));
     rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_shared_data->m_vertices_num, 0, m_shared_data->m_triangles_num);
   }
 protected:
@@ -82,18 +127,15 @@ protected:
 struct petal2_shared_data_t : flower_geometry_shared_data_t
 {
   petal2_shared_data_t( IDirect3DDevice9 * device, flower_params_t const & params );
+  static geometry_params_t cache_params( flower_params_t const & params );
 };
 typedef std::shared_ptr<petal2_shared_data_t> petal2_shared_data_ptr_t;
 
+/* Posed by its flower */
 class petal2_t : public flower_geometry_t
 {
 public:
-  petal2_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase );
-
-  void response( recursive_data_t & rd );
-private:
-  flower_params_t m_params;
-  float m_phase;
+  petal2_t( IDirect3DDevice9 *device, flower_params_t const & params );
 };
 
 /* Petal 1 */
@@ -101,27 +143,30 @@ struct petal1_shared_data_t : flower_geometry_shared_data_t
 {
 public:
   petal1_shared_data_t( IDirect3DDevice9 * device, flower_params_t const & params );
+  static geometry_params_t cache_params( flower_params_t const & params );
 };
 typedef std::shared_ptr<petal1_shared_data_t> petal1_shared_data_ptr_t;
 
+/* Posed by its flower */
 class petal1_t : public flower_geometry_t
 {
 public:
-  petal1_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase );
-  void response( recursive_data_t & rd );
-private:
-  flower_params_t m_params;
-  float m_phase;
+  petal1_t( IDirect3DDevice9 *device, flower_params_t const & params );
 };
 
 class petal_t : public IAnimationUnit
 {
 public:
-  petal_t( IDirect3DDevice9 *device, flower_params_t const & params, float phase );
+  petal_t( IDirect3DDevice9 *device, flower_params_t const & params );
   void response( recursive_data_t & rd );
   void render( recursive_data_t & rd );
+
+  /* Swinging parts, owned by the petal */
+  petal1_t * petal1( void ) const { return m_petal1; }
+  petal2_t * petal2( void ) const { return m_petal2; }
 private:
-  flower_params_t m_params;
+  petal1_t *m_petal1;
+  petal2_t *m_petal2;
 };
 
 /* Receptacle */
@@ -129,6 +174,7 @@ struct receptacle_shared_data_t : flower_geometry_shared_data_t
 {
 public:
   receptacle_shared_data_t( IDirect3DDevice9 * device, flower_params_t const & params );
+  static geometry_params_t cache_params( flower_params_t const & params );
 };
 typedef std::shared_ptr<receptacle_shared_data_t> receptacle_shared_data_ptr_t;
 
@@ -145,6 +191,13 @@ struct stem_shared_data_t
 {
 public:
   stem_shared_data_t( IDirect3DDevice9 * device, flower_params_t const & params );
+  static geometry_params_t cache_params( flower_params_t const & params );
+
+  size_t memory_size( void ) const
+  {
+    return m_geometry.memory_size();
+  }
+
   base_geometry_t m_geometry;
 };
 typedef std::shared_ptr<stem_shared_data_t> stem_shared_data_ptr_t;
@@ -166,26 +219,76 @@ public:
   flower_t( IDirect3DDevice9 *device, flower_params_t const & params );
   void render( recursive_data_t & rd );
   void response( recursive_data_t & rd );
+  bool get_bounds( vec_t & center, float & radius ) const;
+  /* Box around the bounding sphere, it covers swinging petals */
+  bool get_subtree_bounds( vec_t & box_min, vec_t & box_max ) const;
+  bool is_expanded( recursive_data_t & rd );
+
+  /* Distant flowers are drawn by impostor quads of the atlas baked for their params */
+  void set_impostor( std::shared_ptr<impostor_atlas_t> const &impostor ) { m_impostor = impostor; }
+private:
+  vec_t m_bounds_center;
+  float m_bounds_radius;
+  /* Full detail draw calls and vertices */
+  unsigned int m_draws_count;
+  unsigned int m_vertices_count;
+  std::shared_ptr<impostor_atlas_t> m_impostor;
+  bool m_is_impostor;           /* geometry is not drawn this frame */
+  /* Petal swings, posed together by response() before the petals are drawn */
+  petal_batch_t m_petals;
+  std::vector<transform_t *> m_petal1_poses;
+  std::vector<transform_t *> m_petal2_poses;
 };
 
 class base_plane_t : public IAnimationUnit
 {
 public:
-  base_plane_t( IDirect3DDevice9 * device )
-    : m_geom( device, 500, 500, VerticesFactory() )
-    , m_texture(device, L"Res/ground00.bmp")
+  base_plane_t( IDirect3DDevice9 * device, std::shared_ptr<texture_t> const &texture )
+    : m_terrain(device, terrain_params(device))
+    , m_texture(texture)
   {
-    transform().rotate_x( -90 ).translate( -0.5f, 0, 0.5f ).scale( 50 ).translate( 0, -0.1f, 0 );
+    transform().translate( 0, -0.1f, 0 );
+    m_terrain.set_static(true);
   }
 
   void render( recursive_data_t &rd )
   {
-    auto_texture_binder_t(rd.device, m_texture, 0);
-    m_geom.render(rd);
+    if (rd.rasterizer != NULL)
+    {
+      m_terrain.render(rd);
+      return;
+    }
+
+    auto_texture_binder_t(rd.device, *m_texture, 0);
+    m_terrain.render(rd);
+  }
+
+  bool get_bounds( vec_t & center, float & radius ) const
+  {
+    return m_terrain.get_bounds(center, radius);
+  }
+
+  void add_occluders( occlusion_culler_t & culler, transform_t const & world )
+  {
+    m_terrain.add_occluders(culler, world);
   }
 private:
-  base_geometry_t m_geom;
-  texture_t m_texture;
+  /* 50 x 50 ground of the former 500 x 500 grid resolution at the finest level */
+  static terrain_params_t terrain_params( IDirect3DDevice9 * device )
+  {
+    terrain_params_t params;
+
+    params.size = 50;
+    params.levels = 5;
+    params.chunk_quads = 32;
+    params.texture_size = 50;
+    /* Headless frames are reproducible when chunks are built as they are needed */
+    params.streaming = device != NULL;
+    return params;
+  }
+
+  terrain_t m_terrain;
+  std::shared_ptr<texture_t> m_texture;
 };
 
 #endif /* __FLOWER_INCLUDED__ */
@@ -0,0 +1,172 @@
+/**
+@file     frame_context.cpp
+@brief    Immutable frame data implementation and units traversal benchmark
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstring>
+#include <vector>
+
+#include "../Library/cglTimer.h"
+#include "stopwatch.h"
+#include "unit.h"
+
+namespace
+{
+  /* Visits checksum destination, keeps the measured loops alive */
+  volatile float s_sink;
+
+  /* Unit without drawing, visits read the world so the traversal is not optimized away.
+   * Children are linked a second time for the by value traversal */
+  class traversal_unit_t : public IAnimationUnit
+  {
+  public:
+    traversal_unit_t( unsigned int index ) : first_child(NULL), last_child(NULL), next_sibling(NULL), checksum(0)
+    {
+      m_transform.rotate_y(0.01f * (index % 7)).translate(0.1f * (index % 3), 0.f, 0.f);
+    }
+
+    void render( recursive_data_t &rd )
+    {
+      visit(rd.world(), rd.frame.time);
+    }
+
+    void visit( transform_t const &world, float time )
+    {
+      checksum += world.matrix.M[3][0] + time;
+    }
+
+    traversal_unit_t *first_child;
+    traversal_unit_t *last_child;
+    traversal_unit_t *next_sibling;
+    float checksum;
+  };
+
+  /* recursive_data_t before frame contexts: camera and timer copied into it every frame,
+   * the saved world copied on every unit */
+  struct by_value_data_t
+  {
+    transform_t world_transform;
+    camera_t camera;
+    cglTimer timer;
+  };
+
+  void treat_by_value( traversal_unit_t *unit, by_value_data_t &data )
+  {
+    transform_t const saved_transform = data.world_transform;
+
+    data.world_transform = unit->get_transform() * data.world_transform;
+    unit->visit(data.world_transform, data.timer.getTime());
+    for (traversal_unit_t *child = unit->first_child; child != NULL; child = child->next_sibling)
+      treat_by_value(child, data);
+    data.world_transform = saved_transform;
+  }
+}
+
+frame_context_t::frame_context_t()
+  : origin(0, 0, 0)
+  , eye(0, 0, 0)
+  , direction(0, 0, 1)
+  , right(1, 0, 0)
+  , up(0, 1, 0)
+  , near_distance(0)
+  , far_distance(0)
+  , screen_width(0)
+  , screen_height(0)
+  , is_reversed_depth(false)
+  , time(0)
+  , delta(0)
+{
+  view.set_unit();
+  projection.set_unit();
+  view_projection.set_unit();
+}
+
+frame_context_t::frame_context_t( camera_t const &camera, float _time, float _delta, dvec_t const &_origin )
+  : origin(_origin)
+  , view(camera.get_view_matrix())
+  , projection(camera.get_projection_matrix())
+  , view_projection(camera.get_view_projection_matrix())
+  , eye(camera.location)
+  , direction(camera.direction)
+  , right(camera.right)
+  , up(camera.up)
+  , near_distance(camera.projection_distance)
+  , far_distance(camera.far_clip)
+  , screen_width(camera.screen_width)
+  , screen_height(camera.screen_height)
+  , is_reversed_depth(camera.is_reversed_depth)
+  , time(_time)
+  , delta(_delta)
+{
+}
+
+traversal_benchmark_t benchmark_traversal( unsigned int nodes_count, unsigned int fanout, unsigned int frames_count )
+{
+  traversal_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.nodes_count = nodes_count;
+  result.frames_count = frames_count;
+  if (nodes_count == 0 || fanout == 0 || frames_count == 0)
+    return result;
+
+  /* Breadth first tree, children of unit i are units fanout * i + 1 ... fanout * i + fanout */
+  std::vector<traversal_unit_t *> units(nodes_count);
+  std::vector<unsigned int> depths(nodes_count, 1);
+  for (unsigned int i = 0; i < nodes_count; ++i)
+    units[i] = new traversal_unit_t(i);
+  for (unsigned int i = 1; i < nodes_count; ++i)
+  {
+    traversal_unit_t *parent = units[(i - 1) / fanout];
+    (parent->last_child != NULL ? parent->last_child->next_sibling : parent->first_child) = units[i];
+    parent->last_child = units[i];
+    *parent << IAnimationUnitPtr(units[i]);
+    depths[i] = depths[(i - 1) / fanout] + 1;
+  }
+  result.depth = depths[nodes_count - 1];
+  IAnimationUnitPtr root(units[0]);
+  if (result.depth >= world_stack_t::c_max_depth)
+    return result;
+
+  camera_t camera;
+  vec_t location(5, 5, 5), at(0, 0, 0), up(0, 1, 0);
+  camera.set_camera(location, at, up, true);
+  camera.set_near_far(0.5f, 10000.f);
+
+  stopwatch_t timer;
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+  {
+    frame_context_t const context(camera, frame * 0.01f, 0.01f);
+    recursive_data_t rd(NULL, context);
+    root->treat_as_unit(rd);
+  }
+  result.traversal_ms = timer.elapsed_ms();
+
+  cglTimer const frame_timer;
+  timer.restart();
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+  {
+    by_value_data_t data;
+    data.camera = camera;
+    data.timer = frame_timer;
+    treat_by_value(units[0], data);
+  }
+  result.by_value_ms = timer.elapsed_ms();
+
+  unsigned int const contexts_count = 10000;
+  float sink = 0;
+  timer.restart();
+  for (unsigned int i = 0; i < contexts_count; ++i)
+  {
+    frame_context_t const context(camera, (float)i, 0);
+    sink += context.view_projection.M[3][3];
+  }
+  result.context_us = timer.elapsed_ms() * 1000 / contexts_count;
+
+  for (unsigned int i = 0; i < nodes_count; ++i)
+    sink += units[i]->checksum;
+  s_sink = sink;
+  return result;
+}
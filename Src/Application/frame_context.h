@@ -0,0 +1,109 @@
+/**
+@file     frame_context.h
+@brief    Immutable frame data and units traversal world transforms stack definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __FRAME_CONTEXT_INCLUDED__
+#define __FRAME_CONTEXT_INCLUDED__
+
+#include <cassert>
+#include <cstddef>
+
+#include "Math/cglMath.h"
+#include "world_origin.h"
+
+/* Camera and time of one rendered frame, built once and shared by all units of the frame.
+ * Matrices, eye and unit worlds are in render space: world space moved by -origin */
+struct frame_context_t
+{
+  dvec_t origin;                /* world position of render space origin */
+  matrix_t view;
+  matrix_t projection;
+  matrix_t view_projection;     /* view followed by projection */
+  vec_t eye;
+  vec_t direction;
+  vec_t right;
+  vec_t up;
+  float near_distance;
+  float far_distance;
+  int screen_width;
+  int screen_height;
+  bool is_reversed_depth;       /* depth test is D3DCMP_GREATEREQUAL, depth is cleared to 0 */
+  float time;                   /* seconds */
+  float delta;                  /* seconds since the previous frame */
+
+  /* Identity matrices at time 0 */
+  frame_context_t();
+  /* Camera location is in render space of 'origin' */
+  frame_context_t( camera_t const &camera, float time, float delta, dvec_t const &origin = dvec_t(0, 0, 0) );
+};
+
+/* World transforms of the units being traversed: top is the current unit world, the root
+ * transform is at the bottom. Storage is a member array, so pushes neither copy the saved
+ * worlds nor allocate. Units of the root are placed relative to the render space origin */
+class world_stack_t
+{
+public:
+  static const size_t c_max_depth = 32;
+
+  explicit world_stack_t( transform_t const &root = transform_t(), dvec_t const &origin = dvec_t(0, 0, 0) )
+    : m_origin(origin), m_depth(0)
+  {
+    m_transforms[0] = root;
+  }
+
+  transform_t const & top( void ) const
+  {
+    return m_transforms[m_depth];
+  }
+
+  /* Compose 'local' followed by translation to parent space 'position' with the top, false
+   * when the stack is full (asserted: deeper scenes need a larger c_max_depth). Only positions
+   * of root units are large, they are taken relative to the origin in doubles */
+  bool push( transform_t const &local, dvec_t const &position )
+  {
+    assert(m_depth + 1 < c_max_depth);
+    if (m_depth + 1 >= c_max_depth)
+      return false;
+    transform_t &world = m_transforms[m_depth + 1];
+    world = local;
+    world.translate(m_depth == 0 ? relative_position(position, m_origin) :
+                                   vec_t((float)position.x, (float)position.y, (float)position.z));
+    world.transform(m_transforms[m_depth]);
+    m_depth++;
+    return true;
+  }
+
+  void pop( void )
+  {
+    m_depth--;
+  }
+
+  size_t depth( void ) const { return m_depth; }
+private:
+  dvec_t m_origin;
+  transform_t m_transforms[c_max_depth];
+  size_t m_depth;
+};
+
+/* Tree of 'nodes_count' empty units, 'fanout' children each, traversed 'frames_count' times */
+struct traversal_benchmark_t
+{
+  unsigned int nodes_count;
+  unsigned int depth;
+  unsigned int frames_count;
+  double traversal_ms;          /* frame context and world stack */
+  double by_value_ms;           /* camera, timer and saved world copied as before frame contexts */
+  double context_us;            /* one frame context construction */
+
+  /* Nanoseconds per visited unit */
+  double traversal_ns( void ) const { return nodes_count > 0 ? traversal_ms * 1e6 / ((double)nodes_count * frames_count) : 0; }
+  double by_value_ns( void ) const { return nodes_count > 0 ? by_value_ms * 1e6 / ((double)nodes_count * frames_count) : 0; }
+};
+
+traversal_benchmark_t benchmark_traversal( unsigned int nodes_count, unsigned int fanout, unsigned int frames_count );
+
+#endif /* __FRAME_CONTEXT_INCLUDED__ */
@@ -6,10 +6,17 @@
   @author   Sergeev Artemiy
 */
 
+#include <cstring>
+
+#include "light_bake.h"
+#include "soft_raster.h"
 #include "geometry.h"
 
 const int base_geometry_t::c_FVF = D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_DIFFUSE | D3DFVF_TEX1;
 
+/* Smaller grids are not worth LOD levels */
+static const unsigned int c_lod_min_triangles = 2048;
+
 static DWORD vec_to_color( vec_t const & v)
 {
   vec_t norm_v = (v.normalizing() * 0.5 + vec_t(0.5)) * 255;
@@ -19,17 +26,17 @@ static DWORD vec_to_color( vec_t const & v)
 base_geometry_t::base_geometry_t( LPDIRECT3DDEVICE9 device, unsigned int M, unsigned int N, VerticesFactory const &f, color_t const &color )
   : m_vertices_num(M * N)
   , m_triangles_num((M - 1) * (N - 1) * 2)
+  , m_index_buf(NULL)
+  , m_color(color)
+  , m_is_static(false)
 {
   float const delta_u = 1.f / (M - 1);
   float const delta_v = 1.f / (N - 1);
-  vertex_t *vertices_buf;
-  int      *indices_buf;
-
-  device->CreateVertexBuffer(sizeof(vertex_t) * M * N, D3DUSAGE_WRITEONLY, c_FVF, D3DPOOL_DEFAULT, &m_vertices_buf, NULL);
-  device->CreateIndexBuffer(sizeof(int) * 2 * 3 * (M - 1) * (N - 1), D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+  m_vertices.resize(M * N);
+  m_indices.resize(2 * 3 * (M - 1) * (N - 1));
 
-  m_vertices_buf->Lock(0, 0, (void **)&vertices_buf, 0);
-  m_index_buf->Lock(0, 0, (void **)&indices_buf, 0);
+  vertex_t     *vertices_buf = &m_vertices[0];
+  unsigned int *indices_buf = &m_indices[0];
 
   for (unsigned int i = 0; i < M - 1; ++i)
   {
@@ -70,20 +77,82 @@ base_geometry_t::base_geometry_t( LPDIRECT3DDEVICE9 device, unsigned int M, unsi
     vertices_buf[i * N + N - 1].Color = color;
   }
 
-  m_vertices_buf->Unlock();
+  vec_t box_min = m_vertices[0].V, box_max = m_vertices[0].V;
+  for (unsigned int i = 1; i < m_vertices_num; ++i)
+  {
+    vec_t const &v = m_vertices[i].V;
+    box_min = vec_t(cglmath::Min(box_min.x, v.x), cglmath::Min(box_min.y, v.y), cglmath::Min(box_min.z, v.z));
+    box_max = vec_t(cglmath::Max(box_max.x, v.x), cglmath::Max(box_max.y, v.y), cglmath::Max(box_max.z, v.z));
+  }
+  m_bounds_center = (box_min + box_max) * 0.5f;
+  m_bounds_radius = (box_max - box_min).length() * 0.5f;
+
+  /* Headless mode: system memory copies only */
+  if (device == NULL)
+    return;
+
+  void *buf;
+  m_device_vertices.create(device, &m_vertices[0], sizeof(vertex_t), m_vertices_num, c_FVF);
+  device->CreateIndexBuffer(sizeof(int) * 2 * 3 * (M - 1) * (N - 1), D3DUSAGE_WRITEONLY, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &m_index_buf, NULL);
+
+  m_index_buf->Lock(0, 0, &buf, 0);
+  memcpy(buf, &m_indices[0], m_indices.size() * sizeof(unsigned int));
   m_index_buf->Unlock();
+
+  if (m_triangles_num >= c_lod_min_triangles)
+    m_lod.build(device, &m_vertices[0], sizeof(vertex_t), m_vertices_num, &m_indices[0], m_indices.size(), NULL, 0);
 }
 
 base_geometry_t::~base_geometry_t()
 {
-  m_vertices_buf->Release();
-  m_index_buf->Release();
+  /* Baked copies are keyed by this address, which may be reused by the next geometry */
+  light_bake_cache().forget(this);
+  if (m_index_buf != NULL)
+    m_index_buf->Release();
 }
 
 void base_geometry_t::render( recursive_data_t & rd )
 {
-  rd.device->SetFVF(c_FVF);
-  rd.device->SetIndices(m_index_buf);
-  rd.device->SetStreamSource(0, m_vertices_buf, 0, sizeof(vertex_t));
-  rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_vertices_num, 0, m_triangles_num);
+  if (rd.rasterizer != NULL)
+  {
+    soft_mesh_t mesh;
+
+    mesh.vertices = &m_vertices[0];
+    mesh.vertex_size = sizeof(vertex_t);
+    mesh.vertices_count = m_vertices_num;
+    mesh.indices = &m_indices[0];
+    mesh.triangles_count = m_triangles_num;
+    rd.rasterizer->draw(mesh, rd.world().matrix);
+    return;
+  }
+
+  size_t const level = m_lod.select(rd.frame, rd.world(), m_bounds_center, m_bounds_radius);
+  m_lod.count_draw(level);
+  if (m_is_static && rd.static_lighting != NULL && rd.lights != NULL)
+  {
+    IDirect3DVertexBuffer9 *baked = light_bake_cache().get(rd.device, this, &m_vertices[0], sizeof(vertex_t), m_vertices_num,
+                                                           c_FVF, rd.world(), *rd.static_lighting);
+    if (baked != NULL)
+    {
+      baked_lighting_binder_t binder(rd, m_color);
+      rd.device->SetFVF(c_FVF);
+      rd.device->SetStreamSource(0, baked, 0, sizeof(vertex_t));
+      draw(rd.device, level);
+      return;
+    }
+  }
+  m_device_vertices.bind(rd.device, rd.world());
+  draw(rd.device, level);
+}
+
+void base_geometry_t::draw( IDirect3DDevice9 *device, size_t level )
+{
+  if (level > 0)
+  {
+    device->SetIndices(m_lod.level(level).buffer);
+    device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_vertices_num, 0, m_lod.level(level).triangles_count);
+    return;
+  }
+  device->SetIndices(m_index_buf);
+  device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_vertices_num, 0, m_triangles_num);
 }
\ No newline at end of file
@@ -11,8 +11,10 @@
 
 #include <vector>
 
-#include <d3d9.h>
+#include "d3d_api.h"
+#include "mesh_lod.h"
 #include "unit.h"
+#include "vertex_format.h"
 #include "Math/cglMath.h"
 
 class VerticesFactory
@@ -138,11 +140,33 @@ public:
   virtual ~base_geometry_t();
 
   virtual void render( recursive_data_t & rd );
+
+  /* Static geometry is drawn on device with static lights baked into vertex colors */
+  void set_static( bool is_static ) { m_is_static = is_static; }
+
+  /* Device buffers and their system memory copies */
+  size_t memory_size( void ) const
+  {
+    return m_vertices_num * sizeof(vertex_t) + m_device_vertices.memory_size() + 2 * m_triangles_num * 3 * sizeof(int) +
+           m_lod.memory_size();
+  }
 protected:
   unsigned int m_vertices_num;
   unsigned int m_triangles_num;
-  IDirect3DVertexBuffer9 *m_vertices_buf;
+  device_vertices_t m_device_vertices;
   IDirect3DIndexBuffer9 *m_index_buf;
+  /* Copies for software rasterizer, device buffers are write only */
+  std::vector<vertex_t> m_vertices;
+  std::vector<unsigned int> m_indices;
+  color_t m_color;
+  bool m_is_static;
+  /* Simplified levels for device drawing, software rasterizer draws full detail */
+  mesh_lod_t m_lod;
+  vec_t m_bounds_center;
+  float m_bounds_radius;
+private:
+  /* Draw LOD level with bound vertices */
+  void draw( IDirect3DDevice9 *device, size_t level );
 
 };
 
@@ -0,0 +1,48 @@
+/**
+@file     geometry_cache.cpp
+@brief    Shared geometry cache keyed by type and construction parameters implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include "geometry_cache.h"
+
+namespace
+{
+  /* File scope, not a function local static: VS2013 (v120) does not make local statics
+   * initialization thread safe, and units are created by loading jobs */
+  geometry_cache_t s_geometry_cache;
+}
+
+geometry_cache_t & geometry_cache( void )
+{
+  return s_geometry_cache;
+}
+
+geometry_cache_t::geometry_cache_t()
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+geometry_cache_stats_t geometry_cache_t::stats( void ) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  geometry_cache_stats_t stats = m_stats;
+
+  stats.entries = 0;
+  stats.memory = 0;
+  for (std::map<cache_key_t, entry_t>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    if (!it->second.geometry.expired())
+    {
+      stats.entries++;
+      stats.memory += it->second.memory;
+    }
+  return stats;
+}
+
+void geometry_cache_t::clear( void )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
@@ -0,0 +1,188 @@
+/**
+@file     geometry_cache.h
+@brief    Shared geometry cache keyed by type and construction parameters definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __GEOMETRY_CACHE_INCLUDED__
+#define __GEOMETRY_CACHE_INCLUDED__
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+
+/* FNV-1a hash of construction parameters that affect built geometry */
+class params_hash_t
+{
+public:
+  params_hash_t() : m_hash(14695981039346656037ULL) {}
+
+  template<class T>
+  params_hash_t & operator<<( T const &value )
+  {
+    unsigned char bytes[sizeof(T)];
+
+    memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i)
+      m_hash = (m_hash ^ bytes[i]) * 1099511628211ULL;
+    return *this;
+  }
+
+  unsigned long long value( void ) const { return m_hash; }
+private:
+  unsigned long long m_hash;
+};
+
+/* Construction parameters that affect built geometry: their bytes and hash.
+ * Equal hashes of different parameters are told apart by the bytes */
+class geometry_params_t
+{
+public:
+  template<class T>
+  geometry_params_t & operator<<( T const &value )
+  {
+    m_hash << value;
+    m_bytes.append(reinterpret_cast<char const *>(&value), sizeof(T));
+    return *this;
+  }
+
+  bool operator<( geometry_params_t const &other ) const
+  {
+    if (m_hash.value() != other.m_hash.value())
+      return m_hash.value() < other.m_hash.value();
+    return m_bytes < other.m_bytes;
+  }
+private:
+  params_hash_t m_hash;
+  std::string m_bytes;
+};
+
+struct geometry_cache_stats_t
+{
+  unsigned int requests;
+  unsigned int hits;            /* found alive or being built by another thread */
+  unsigned int in_flight_waits; /* hits which waited for another thread build */
+  unsigned int builds;
+  unsigned int entries;         /* alive geometries */
+  size_t memory;                /* bytes of alive vertex and index data */
+};
+
+/* Geometry shared between units. Every distinct (type, parameters) is built once,
+ * concurrent requests of a geometry being built wait for the first build.
+ * The cache does not own geometry: it lives while its users hold it, and
+ * a request after the last user released it builds it again */
+class geometry_cache_t
+{
+public:
+  geometry_cache_t();
+
+  /* Get cached geometry or build it with 'build' functor returning std::shared_ptr<T>.
+   * T must provide size_t memory_size() const. An exception of 'build' is passed
+   * to the caller and to the waiting requests, the next request builds again */
+  template<class T, class BUILDER>
+  std::shared_ptr<T> get( geometry_params_t const &params, BUILDER const &build )
+  {
+    cache_key_t const key(std::type_index(typeid(T)), params);
+    std::shared_future<std::shared_ptr<void> > future;
+    std::promise<std::shared_ptr<void> > promise;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::map<cache_key_t, entry_t>::iterator it = m_entries.find(key);
+
+      m_stats.requests++;
+      if (it != m_entries.end() && it->second.building.valid())
+      {
+        m_stats.hits++;
+        m_stats.in_flight_waits++;
+        future = it->second.building;
+      }
+      else
+      {
+        std::shared_ptr<void> const geometry = it != m_entries.end() ? it->second.geometry.lock() : std::shared_ptr<void>();
+
+        if (geometry)
+        {
+          m_stats.hits++;
+          return std::static_pointer_cast<T>(geometry);
+        }
+
+        entry_t &entry = m_entries[key];
+
+        entry.building = promise.get_future().share();
+        entry.geometry.reset();
+        entry.memory = 0;
+        m_stats.builds++;
+      }
+    }
+
+    if (future.valid())
+      return std::static_pointer_cast<T>(future.get());
+
+    /* Build outside the lock, so different geometries are built concurrently */
+    std::shared_ptr<T> geometry;
+
+    try
+    {
+      geometry = build();
+    }
+    catch (...)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key);
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    size_t const memory = geometry->memory_size();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::map<cache_key_t, entry_t>::iterator it = m_entries.find(key);
+
+      if (it != m_entries.end())
+      {
+        /* Drop the future, it holds the geometry alive */
+        it->second.building = std::shared_future<std::shared_ptr<void> >();
+        it->second.geometry = geometry;
+        it->second.memory = memory;
+      }
+    }
+    promise.set_value(geometry);
+    return geometry;
+  }
+
+  geometry_cache_stats_t stats( void ) const;
+
+  /* Forget all entries, geometry stays alive with its users */
+  void clear( void );
+private:
+  geometry_cache_t( geometry_cache_t const & );
+  geometry_cache_t & operator=( geometry_cache_t const & );
+
+  typedef std::pair<std::type_index, geometry_params_t> cache_key_t;
+
+  struct entry_t
+  {
+    std::shared_future<std::shared_ptr<void> > building; /* valid while the first request builds */
+    std::weak_ptr<void> geometry;
+    size_t memory;
+  };
+
+  mutable std::mutex m_mutex;
+  std::map<cache_key_t, entry_t> m_entries;
+  geometry_cache_stats_t m_stats;
+};
+
+/* Application wide geometry cache */
+geometry_cache_t & geometry_cache( void );
+
+#endif /* __GEOMETRY_CACHE_INCLUDED__ */
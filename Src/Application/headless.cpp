@@ -0,0 +1,399 @@
+/**
+@file     headless.cpp
+@brief    Headless render to file mode with golden images comparison implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../Library/cglTimer.h"
+#include "allocators.h"
+#include "benchmarks.h"
+#include "depth_precision.h"
+#include "files.h"
+#include "image_io.h"
+#include "occlusion.h"
+#include "scene.h"
+#include "soft_raster.h"
+#include "stopwatch.h"
+#include "world_origin.h"
+#include "headless.h"
+
+namespace
+{
+  /* One frame timings and comparison result */
+  struct frame_record_t
+  {
+    float time;
+    double scene_ms;              /* animation and draws collection */
+    soft_raster_stats_t raster;
+    unsigned int heap_count;      /* operator new calls of scene rendering and rasterization */
+    occlusion_stats_t occlusion;
+    double write_ms;
+    double compare_ms;
+    bool compared;
+    image_diff_t diff;
+    bool passed;
+  };
+
+  std::wstring widen( char const *str )
+  {
+    return std::wstring(str, str + strlen(str));
+  }
+
+  void print_usage( void )
+  {
+    fprintf(stderr, "Usage: -headless [-frames N] [-step SECONDS] [-size WxH] [-threads N] [-ppm] [-out DIR]\n"
+                    "                 [-golden DIR] [-update-golden] [-tolerance T] [-max-bad RATIO] [-max-frame-ms MS]\n"
+                    "                 [-max-frame-heap N]\n"
+                    "                 [-reversed-z] [-infinite-far] [-depth-precision]\n"
+                    "                 [-world-offset METERS] [-no-rebase] [-position-error]\n"
+                    "                 [-occlusion] [-bench NAME]\n"
+                    "Benchmarks: ");
+    print_benchmark_names(stderr);
+    fprintf(stderr, "\n");
+  }
+
+  bool write_report( std::wstring const &file_name, std::vector<frame_record_t> const &records )
+  {
+    FILE *file = open_file(file_name.c_str(), "wt");
+    if (file == NULL)
+      return false;
+
+    fprintf(file, "frame,time,scene_ms,vertex_ms,setup_ms,raster_ms,end_frame_ms,write_ms,compare_ms,"
+                  "triangles,visible,heap_allocations,occlusion_ms,occluder_triangles,occlusion_tests,occluded,max_delta,mean_delta,bad_pixels,passed\n");
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+      frame_record_t const &r = records[i];
+
+      fprintf(file, "%u,%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u,%.3f,%u,%u,%u,", (unsigned int)i, r.time, r.scene_ms,
+              r.raster.vertex_ms, r.raster.setup_ms, r.raster.raster_ms, r.raster.frame_ms, r.write_ms, r.compare_ms,
+              r.raster.triangles_count, r.raster.visible_count, r.heap_count, r.occlusion.build_ms + r.occlusion.test_ms,
+              r.occlusion.triangles_count, r.occlusion.tests_count, r.occlusion.culled_count);
+      if (r.compared)
+        fprintf(file, "%u,%.4f,%u,%d\n", r.diff.max_delta, r.diff.mean_delta, r.diff.bad_pixels, r.passed ? 1 : 0);
+      else
+        fprintf(file, ",,,%d\n", r.passed ? 1 : 0);
+    }
+    return fclose(file) == 0;
+  }
+
+  /* Smallest resolved view distance steps relative to distance, for every depth mode and format */
+  void print_depth_precision( camera_t camera )
+  {
+    printf("Depth precision, near %g, far %g, relative step at distance:\n%-27s", camera.projection_distance, camera.far_clip, "");
+    float distance = 1;
+    for (size_t i = 0; i < depth_precision_t::c_distances_count; ++i, distance *= 10)
+      printf(" %9g", distance);
+    printf("\n");
+
+    for (int mode = 0; mode < 4; ++mode)
+    {
+      bool const reversed = mode >= 2, infinite_far = mode % 2 == 1;
+
+      camera.set_depth_mode(reversed, infinite_far);
+      for (int format = 0; format < DEPTH_FORMAT_COUNT; ++format)
+      {
+        depth_precision_t const precision = measure_depth_precision(camera, (depth_format_t)format);
+
+        printf("%-12s %-9s %-4s", reversed ? "reversed" : "conventional", infinite_far ? "infinite" : "", depth_format_name((depth_format_t)format));
+        for (size_t i = 0; i < depth_precision_t::c_distances_count; ++i)
+          if (precision.steps[i] > 0)
+            printf(" %9.2e", precision.relative(i));
+          else
+            printf(" %9s", "-");
+        printf("\n");
+      }
+    }
+  }
+
+  /* Largest vertex errors of units near a camera far from the world origin */
+  void print_position_error( void )
+  {
+    printf("Position error, meters, units up to 100 m from the camera:\n%-10s %12s %12s\n", "distance", "world", "rebased");
+    for (double distance = 100; distance <= 1e7; distance *= 10)
+    {
+      position_error_t const error = measure_position_error(distance, 1000);
+
+      printf("%-10g %12.2e %12.2e\n", error.distance, error.absolute_error, error.relative_error);
+    }
+  }
+}
+
+bool parse_headless_args( int argc, char const * const *argv, headless_params_t &params )
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    char const *arg = argv[i];
+    char const *value = i + 1 < argc ? argv[i + 1] : 0;
+    bool ok = true;
+
+    if (strcmp(arg, "-headless") == 0)
+      params.enabled = true;
+    else if (strcmp(arg, "-ppm") == 0)
+      params.png = false;
+    else if (strcmp(arg, "-update-golden") == 0)
+      params.update_golden = true;
+    else if (strcmp(arg, "-reversed-z") == 0)
+      params.reversed_depth = true;
+    else if (strcmp(arg, "-infinite-far") == 0)
+      params.infinite_far = true;
+    else if (strcmp(arg, "-depth-precision") == 0)
+      params.depth_precision = true;
+    else if (strcmp(arg, "-no-rebase") == 0)
+      params.rebase = false;
+    else if (strcmp(arg, "-position-error") == 0)
+      params.position_error = true;
+    else if (strcmp(arg, "-occlusion") == 0)
+      params.occlusion = true;
+    else if (value == 0)
+      ok = false;
+    else
+    {
+      i++;
+      if (strcmp(arg, "-frames") == 0)
+        ok = sscanf(value, "%u", &params.frames) == 1;
+      else if (strcmp(arg, "-step") == 0)
+        ok = sscanf(value, "%f", &params.time_step) == 1 && params.time_step >= 0;
+      else if (strcmp(arg, "-size") == 0)
+        ok = sscanf(value, "%ux%u", &params.width, &params.height) == 2 && params.width > 0 && params.height > 0;
+      else if (strcmp(arg, "-threads") == 0)
+        ok = sscanf(value, "%u", &params.threads) == 1;
+      else if (strcmp(arg, "-out") == 0)
+        params.output_dir = widen(value);
+      else if (strcmp(arg, "-golden") == 0)
+        params.golden_dir = widen(value);
+      else if (strcmp(arg, "-tolerance") == 0)
+        ok = sscanf(value, "%u", &params.tolerance) == 1;
+      else if (strcmp(arg, "-max-bad") == 0)
+        ok = sscanf(value, "%lf", &params.max_bad_ratio) == 1;
+      else if (strcmp(arg, "-max-frame-ms") == 0)
+        ok = sscanf(value, "%lf", &params.max_frame_ms) == 1;
+      else if (strcmp(arg, "-max-frame-heap") == 0)
+        ok = sscanf(value, "%d", &params.max_frame_heap) == 1;
+      else if (strcmp(arg, "-world-offset") == 0)
+        ok = sscanf(value, "%lf", &params.world_offset) == 1;
+      else if (strcmp(arg, "-bench") == 0)
+        params.benchmark = value;
+      else
+        ok = false;
+    }
+
+    if (!ok)
+    {
+      fprintf(stderr, "Bad argument '%s'\n", arg);
+      print_usage();
+      return false;
+    }
+  }
+  if (params.update_golden && params.golden_dir.empty())
+  {
+    fprintf(stderr, "-update-golden requires -golden DIR\n");
+    return false;
+  }
+  return true;
+}
+
+int run_headless( headless_params_t const &params )
+{
+  if (params.depth_precision)
+  {
+    camera_t camera;
+    scene_t::reset_camera(camera);
+    print_depth_precision(camera);
+    return 0;
+  }
+  if (params.position_error)
+  {
+    print_position_error();
+    return 0;
+  }
+  if (!params.benchmark.empty())
+  {
+    if (print_benchmark(params.benchmark.c_str()))
+      return 0;
+    fprintf(stderr, "Unknown benchmark '%s', known ones: ", params.benchmark.c_str());
+    print_benchmark_names(stderr);
+    fprintf(stderr, "\n");
+    return 2;
+  }
+
+  if (!create_directory(params.output_dir.c_str()) ||
+      (params.update_golden && !create_directory(params.golden_dir.c_str())))
+  {
+    fprintf(stderr, "Can not create output directories\n");
+    return 2;
+  }
+
+  /* All units are loaded before the first frame, so every run renders the same frames */
+  stopwatch_t load_timer;
+  dvec_t const world_offset(params.world_offset, 0, params.world_offset);
+  scene_t scene(NULL, world_offset);
+  scene.wait_loaded();
+  scene.update();
+  double const load_ms = load_timer.elapsed_ms();
+
+  camera_t camera;
+  scene_t::reset_camera(camera);
+  camera.set_depth_mode(params.reversed_depth, params.infinite_far);
+
+  /* Camera stays at the same place relative to the scene. Rebased origin starts at the scene
+   * offset, as if the camera had flown there, and then follows the camera by rebase() every frame
+   * as in the windowed application. Without rebasing render space is world space */
+  world_origin_t origin;
+  if (params.rebase)
+    origin.set_position(world_offset);
+  camera.shift(relative_position(world_offset, origin.position()));
+
+  soft_rasterizer_t rasterizer;
+  rasterizer.set_reversed_depth(params.reversed_depth);
+  rasterizer.resize(params.width, params.height);
+  rasterizer.set_threads(params.threads);
+
+  occlusion_params_t occlusion_params;
+  occlusion_params.threads = params.threads;
+  occlusion_culler_t occlusion;
+  occlusion.set_params(occlusion_params);
+
+  cglTimer timer;
+  transform_t const world;
+  std::vector<frame_record_t> records(params.frames);
+  image_t image, golden, diff_image;
+  int result = 0;
+
+  for (unsigned int i = 0; i < params.frames; ++i)
+  {
+    frame_record_t &record = records[i];
+    wchar_t name[32];
+
+    memset(&record, 0, sizeof(record));
+    record.passed = true;
+
+    /* Fixed simulated time step instead of wall clock */
+    timer.step(params.time_step);
+    record.time = timer.getTime();
+
+    /* Frame view is built after the rebase, the camera is shifted by it */
+    stopwatch_t stage_timer;
+    if (params.rebase)
+      origin.rebase(camera);
+    rasterizer.begin_frame(camera.get_view_matrix(), camera.get_projection_matrix(), scene_t::c_clear_color);
+    frame_context_t const frame(camera, timer.getTime(), timer.getDelta(), origin.position());
+    recursive_data_t rd(NULL, frame, world);
+    rd.rasterizer = &rasterizer;
+    rd.occlusion = params.occlusion ? &occlusion : NULL;
+    scene.render(rd);
+    record.scene_ms = stage_timer.elapsed_ms();
+    if (params.occlusion)
+      record.occlusion = occlusion.stats();
+
+    rasterizer.end_frame();
+    record.raster = rasterizer.stats();
+    record.heap_count = memory_stats().frame_heap_count;
+
+    stage_timer.restart();
+    swprintf(name, sizeof(name) / sizeof(name[0]), params.png ? L"frame_%04u.png" : L"frame_%04u.ppm", i);
+    image_from_argb(rasterizer.color_buffer(), rasterizer.width(), rasterizer.height(), rasterizer.stride(), image);
+    std::wstring const frame_name = params.output_dir + L"/" + name;
+    std::wstring const golden_name = params.golden_dir + L"/" + name;
+    bool written = params.png ? save_png(frame_name.c_str(), image) : save_ppm(frame_name.c_str(), image);
+    if (written && params.update_golden)
+      written = params.png ? save_png(golden_name.c_str(), image) : save_ppm(golden_name.c_str(), image);
+    record.write_ms = stage_timer.elapsed_ms();
+    if (!written)
+    {
+      fprintf(stderr, "Can not write frame %u\n", i);
+      record.passed = false;
+      result = 2;
+      continue;
+    }
+
+    if (params.golden_dir.empty() || params.update_golden)
+      continue;
+
+    stage_timer.restart();
+    record.compared = true;
+    if (!load_image(golden_name.c_str(), golden))
+    {
+      fprintf(stderr, "Can not read golden frame %u\n", i);
+      record.passed = false;
+      result = 2;
+      continue;
+    }
+    if (!compare_images(image, golden, params.tolerance, record.diff, &diff_image) ||
+        record.diff.bad_ratio > params.max_bad_ratio)
+    {
+      fprintf(stderr, "Frame %u differs from golden one: %u bad pixels (%.3f%%), max delta %u, mean delta %.3f\n",
+              i, record.diff.bad_pixels, record.diff.bad_ratio * 100, record.diff.max_delta, record.diff.mean_delta);
+      record.passed = false;
+      if (result == 0)
+        result = 1;
+
+      swprintf(name, sizeof(name) / sizeof(name[0]), params.png ? L"diff_%04u.png" : L"diff_%04u.ppm", i);
+      std::wstring const diff_name = params.output_dir + L"/" + name;
+      if (diff_image.width > 0)
+        params.png ? save_png(diff_name.c_str(), diff_image) : save_ppm(diff_name.c_str(), diff_image);
+    }
+    record.compare_ms = stage_timer.elapsed_ms();
+  }
+
+  if (!write_report(params.output_dir + L"/report.csv", records))
+  {
+    fprintf(stderr, "Can not write timings report\n");
+    result = 2;
+  }
+
+  /* Means of all frames */
+  double scene_ms = 0, vertex_ms = 0, setup_ms = 0, raster_ms = 0, end_frame_ms = 0, write_ms = 0;
+  double occlusion_ms = 0;
+  unsigned int failed = 0, occlusion_tests = 0, occluded = 0;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    occlusion_ms += records[i].occlusion.build_ms + records[i].occlusion.test_ms;
+    occlusion_tests += records[i].occlusion.tests_count;
+    occluded += records[i].occlusion.culled_count;
+    scene_ms += records[i].scene_ms;
+    vertex_ms += records[i].raster.vertex_ms;
+    setup_ms += records[i].raster.setup_ms;
+    raster_ms += records[i].raster.raster_ms;
+    end_frame_ms += records[i].raster.frame_ms;
+    write_ms += records[i].write_ms;
+    failed += records[i].passed ? 0 : 1;
+  }
+  double const count = records.empty() ? 1 : (double)records.size();
+  double const frame_ms = (scene_ms + end_frame_ms) / count;
+
+  printf("Headless: %u frames %ux%u on %u threads, load %.1f ms\n"
+         "Mean ms: frame %.2f (scene %.2f, vertex %.2f, setup %.2f, raster %.2f), write %.2f\n"
+         "Heap allocations: first frame %u, last frame %u\n"
+         "Frames failed: %u\n",
+         params.frames, params.width, params.height, records.empty() ? 0 : records[0].raster.threads_count, load_ms,
+         frame_ms, scene_ms / count, vertex_ms / count, setup_ms / count, raster_ms / count, write_ms / count,
+         records.empty() ? 0 : records[0].heap_count, records.empty() ? 0 : records.back().heap_count, failed);
+  if (params.occlusion)
+    printf("Occlusion: %.3f ms per frame, %u of %u units culled (%.1f%%)\n", occlusion_ms / count, occluded, occlusion_tests,
+           occlusion_tests > 0 ? 100.0 * occluded / occlusion_tests : 0.0);
+
+  if (params.max_frame_ms > 0 && frame_ms > params.max_frame_ms)
+  {
+    fprintf(stderr, "Mean frame time %.2f ms exceeds %.2f ms budget\n", frame_ms, params.max_frame_ms);
+    if (result == 0)
+      result = 1;
+  }
+
+  /* First frame fills the pools and frame memory */
+  for (size_t i = 1; params.max_frame_heap >= 0 && i < records.size(); ++i)
+    if (records[i].heap_count > (unsigned int)params.max_frame_heap)
+    {
+      fprintf(stderr, "Frame %u made %u heap allocations, budget is %d\n", (unsigned int)i, records[i].heap_count,
+              params.max_frame_heap);
+      if (result == 0)
+        result = 1;
+    }
+  return result;
+}
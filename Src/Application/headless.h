@@ -0,0 +1,64 @@
+/**
+@file     headless.h
+@brief    Headless render to file mode with golden images comparison definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __HEADLESS_INCLUDED__
+#define __HEADLESS_INCLUDED__
+
+#include <string>
+
+/* Headless run parameters */
+struct headless_params_t
+{
+  bool enabled;                 /* '-headless' is given */
+  unsigned int width;
+  unsigned int height;
+  unsigned int frames;
+  float time_step;              /* simulated seconds per frame */
+  unsigned int threads;         /* rasterizer threads, 0 - all hardware threads */
+  bool png;                     /* frames format, PPM otherwise */
+  std::wstring output_dir;      /* frames, failed frames diffs and timings report */
+  std::wstring golden_dir;      /* empty - frames are not compared */
+  bool update_golden;           /* write frames to golden_dir instead of comparing */
+  unsigned int tolerance;       /* acceptable channel difference */
+  double max_bad_ratio;         /* acceptable fraction of pixels above tolerance */
+  double max_frame_ms;          /* mean scene and raster time budget, 0 - no budget */
+  int max_frame_heap;           /* heap allocations budget of every frame but the first, -1 - no budget */
+  bool reversed_depth;          /* near plane maps to depth 1, far one to 0 */
+  bool infinite_far;
+  bool depth_precision;         /* print depth resolution of all depth modes and formats instead of rendering */
+  double world_offset;          /* scene and camera are moved along x and z by it, meters */
+  bool rebase;                  /* render space origin follows the camera, world space floats otherwise */
+  bool position_error;          /* print view space error far from the world origin instead of rendering */
+  bool occlusion;               /* units hidden behind occluders are skipped */
+  std::string benchmark;        /* print named benchmark table instead of rendering, see benchmarks.h */
+
+  headless_params_t()
+    : enabled(false), width(1000), height(700), frames(10), time_step(1.f / 30), threads(0), png(true)
+    , output_dir(L"headless"), update_golden(false), tolerance(8), max_bad_ratio(0.001), max_frame_ms(0), max_frame_heap(-1)
+    , reversed_depth(false), infinite_far(false), depth_precision(false), world_offset(0), rebase(true), position_error(false)
+    , occlusion(false)
+  {
+  }
+};
+
+/* Parse command line:
+ *   -headless [-frames N] [-step SECONDS] [-size WxH] [-threads N] [-ppm] [-out DIR]
+ *             [-golden DIR] [-update-golden] [-tolerance T] [-max-bad RATIO] [-max-frame-ms MS] [-max-frame-heap N]
+ *             [-reversed-z] [-infinite-far] [-depth-precision] [-world-offset METERS] [-no-rebase] [-position-error]
+ *             [-occlusion] [-bench NAME]
+ * Returns false and prints usage on malformed arguments */
+bool parse_headless_args( int argc, char const * const *argv, headless_params_t &params );
+
+/* Render frames of the scene at fixed time step by software rasterizer without window and device,
+ * write them and per stage timings (report.csv) to output directory and compare them with golden ones.
+ * Returns process exit code: 0 - passed, 1 - frames differ from golden ones or time budget is exceeded,
+ * 2 - files could not be read or written. '-depth-precision', '-position-error' and
+ * '-bench' only print their tables and return 0 */
+int run_headless( headless_params_t const &params );
+
+#endif /* __HEADLESS_INCLUDED__ */
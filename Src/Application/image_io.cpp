@@ -0,0 +1,667 @@
+/**
+@file     image_io.cpp
+@brief    PPM and PNG images reading, writing and comparison implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "files.h"
+#include "image_io.h"
+
+namespace
+{
+  unsigned char const s_png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+  /* Largest deflate stored block payload */
+  size_t const s_max_stored_block = 65535;
+
+  class crc32_table_t
+  {
+  public:
+    crc32_table_t()
+    {
+      for (unsigned int n = 0; n < 256; ++n)
+      {
+        unsigned int c = n;
+        for (int k = 0; k < 8; ++k)
+          c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        m_table[n] = c;
+      }
+    }
+
+    unsigned int update( unsigned int crc, unsigned char const *data, size_t size ) const
+    {
+      crc = ~crc;
+      for (size_t i = 0; i < size; ++i)
+        crc = m_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+      return ~crc;
+    }
+  private:
+    unsigned int m_table[256];
+  };
+
+  /* Built before main, writers on loading threads only read it */
+  crc32_table_t const s_crc32;
+
+  unsigned int adler32( unsigned char const *data, size_t size )
+  {
+    unsigned int a = 1, b = 0;
+
+    while (size > 0)
+    {
+      /* 5552 is the largest block which can not overflow 32 bit sums */
+      size_t const block = size < 5552 ? size : 5552;
+      for (size_t i = 0; i < block; ++i)
+      {
+        a += data[i];
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+      data += block;
+      size -= block;
+    }
+    return (b << 16) | a;
+  }
+
+  void put_u32( std::vector<unsigned char> &out, unsigned int value )
+  {
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+  }
+
+  unsigned int get_u32( unsigned char const *data )
+  {
+    return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) | ((unsigned int)data[2] << 8) | data[3];
+  }
+
+  void put_chunk( std::vector<unsigned char> &out, char const *type, unsigned char const *data, size_t size )
+  {
+    put_u32(out, (unsigned int)size);
+    size_t const start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0)
+      out.insert(out.end(), data, data + size);
+    put_u32(out, s_crc32.update(0, &out[start], size + 4));
+  }
+
+  bool read_file( wchar_t const *file_name, std::vector<unsigned char> &data )
+  {
+    mapped_file_t file;
+
+    if (!file.open(file_name))
+      return false;
+    data.assign(file.data(), file.data() + file.size());
+    return true;
+  }
+
+  /*** Inflate (RFC 1951), canonical Huffman decoding as in zlib's puff ***/
+
+  class bit_reader_t
+  {
+  public:
+    bit_reader_t( unsigned char const *data, size_t size )
+      : m_data(data), m_size(size), m_pos(0), m_bits(0), m_bits_count(0), m_failed(false)
+    {
+    }
+
+    unsigned int bits( unsigned int count )
+    {
+      unsigned int value = m_bits;
+
+      while (m_bits_count < count)
+      {
+        if (m_pos == m_size)
+        {
+          m_failed = true;
+          return 0;
+        }
+        value |= (unsigned int)m_data[m_pos++] << m_bits_count;
+        m_bits_count += 8;
+      }
+      m_bits = value >> count;
+      m_bits_count -= count;
+      return value & ((1U << count) - 1);
+    }
+
+    /* Skip to byte boundary */
+    void align( void )
+    {
+      m_bits = 0;
+      m_bits_count = 0;
+    }
+
+    unsigned char const * bytes( size_t count )
+    {
+      if (m_size - m_pos < count)
+      {
+        m_failed = true;
+        return 0;
+      }
+      m_pos += count;
+      return m_data + m_pos - count;
+    }
+
+    bool failed( void ) const { return m_failed; }
+  private:
+    unsigned char const *m_data;
+    size_t m_size, m_pos;
+    unsigned int m_bits, m_bits_count;
+    bool m_failed;
+  };
+
+  enum
+  {
+    MAX_CODE_BITS = 15,
+    MAX_LITERAL_CODES = 288,
+    MAX_DISTANCE_CODES = 30
+  };
+
+  struct huffman_t
+  {
+    unsigned short counts[MAX_CODE_BITS + 1];
+    unsigned short symbols[MAX_LITERAL_CODES];
+
+    /* Returns false for over subscribed code sets */
+    bool build( unsigned char const *lengths, unsigned int count )
+    {
+      unsigned short offsets[MAX_CODE_BITS + 1];
+      int left = 1;
+
+      memset(counts, 0, sizeof(counts));
+      for (unsigned int i = 0; i < count; ++i)
+        counts[lengths[i]]++;
+      for (int len = 1; len <= MAX_CODE_BITS; ++len)
+      {
+        left = (left << 1) - counts[len];
+        if (left < 0)
+          return false;
+      }
+
+      offsets[1] = 0;
+      for (int len = 1; len < MAX_CODE_BITS; ++len)
+        offsets[len + 1] = offsets[len] + counts[len];
+      for (unsigned int i = 0; i < count; ++i)
+        if (lengths[i] != 0)
+          symbols[offsets[lengths[i]]++] = (unsigned short)i;
+      return true;
+    }
+
+    /* Returns -1 on error */
+    int decode( bit_reader_t &reader ) const
+    {
+      int code = 0, first = 0, index = 0;
+
+      for (int len = 1; len <= MAX_CODE_BITS; ++len)
+      {
+        code |= reader.bits(1);
+        int const count = counts[len];
+        if (code - count < first)
+          return reader.failed() ? -1 : symbols[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+      }
+      return -1;
+    }
+  };
+
+  unsigned short const s_length_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  unsigned char const s_length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  unsigned short const s_distance_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                              257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  unsigned char const s_distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                              7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  bool inflate_codes( bit_reader_t &reader, huffman_t const &literals, huffman_t const &distances, std::vector<unsigned char> &out )
+  {
+    for (;;)
+    {
+      int symbol = literals.decode(reader);
+      if (symbol < 0)
+        return false;
+      if (symbol < 256)
+      {
+        out.push_back((unsigned char)symbol);
+        continue;
+      }
+      if (symbol == 256)
+        return true;
+
+      symbol -= 257;
+      if (symbol >= 29)
+        return false;
+      size_t const length = s_length_base[symbol] + reader.bits(s_length_extra[symbol]);
+
+      symbol = distances.decode(reader);
+      if (symbol < 0 || symbol >= MAX_DISTANCE_CODES)
+        return false;
+      size_t const distance = s_distance_base[symbol] + reader.bits(s_distance_extra[symbol]);
+      if (reader.failed() || distance > out.size())
+        return false;
+
+      /* Byte by byte: source and destination overlap for runs */
+      size_t from = out.size() - distance;
+      for (size_t i = 0; i < length; ++i)
+        out.push_back(out[from++]);
+    }
+  }
+
+  bool inflate_fixed( bit_reader_t &reader, std::vector<unsigned char> &out )
+  {
+    unsigned char lengths[MAX_LITERAL_CODES];
+    huffman_t literals, distances;
+    unsigned int i = 0;
+
+    for (; i < 144; ++i)
+      lengths[i] = 8;
+    for (; i < 256; ++i)
+      lengths[i] = 9;
+    for (; i < 280; ++i)
+      lengths[i] = 7;
+    for (; i < MAX_LITERAL_CODES; ++i)
+      lengths[i] = 8;
+    literals.build(lengths, MAX_LITERAL_CODES);
+    for (i = 0; i < MAX_DISTANCE_CODES; ++i)
+      lengths[i] = 5;
+    distances.build(lengths, MAX_DISTANCE_CODES);
+    return inflate_codes(reader, literals, distances, out);
+  }
+
+  bool inflate_dynamic( bit_reader_t &reader, std::vector<unsigned char> &out )
+  {
+    static unsigned char const order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    unsigned char lengths[MAX_LITERAL_CODES + MAX_DISTANCE_CODES];
+    huffman_t lengths_code, literals, distances;
+
+    unsigned int const literals_count = reader.bits(5) + 257;
+    unsigned int const distances_count = reader.bits(5) + 1;
+    unsigned int const code_lengths_count = reader.bits(4) + 4;
+    if (reader.failed() || literals_count > MAX_LITERAL_CODES || distances_count > MAX_DISTANCE_CODES)
+      return false;
+
+    memset(lengths, 0, sizeof(lengths));
+    for (unsigned int i = 0; i < code_lengths_count; ++i)
+      lengths[order[i]] = (unsigned char)reader.bits(3);
+    if (reader.failed() || !lengths_code.build(lengths, 19))
+      return false;
+
+    unsigned int index = 0;
+    while (index < literals_count + distances_count)
+    {
+      int symbol = lengths_code.decode(reader);
+      if (symbol < 0)
+        return false;
+      if (symbol < 16)
+      {
+        lengths[index++] = (unsigned char)symbol;
+        continue;
+      }
+
+      unsigned char value = 0;
+      unsigned int repeat;
+      if (symbol == 16)
+      {
+        if (index == 0)
+          return false;
+        value = lengths[index - 1];
+        repeat = 3 + reader.bits(2);
+      }
+      else if (symbol == 17)
+        repeat = 3 + reader.bits(3);
+      else
+        repeat = 11 + reader.bits(7);
+      if (reader.failed() || index + repeat > literals_count + distances_count)
+        return false;
+      while (repeat-- > 0)
+        lengths[index++] = value;
+    }
+
+    if (lengths[256] == 0 || !literals.build(lengths, literals_count) ||
+        !distances.build(lengths + literals_count, distances_count))
+      return false;
+    return inflate_codes(reader, literals, distances, out);
+  }
+
+  /* Decode zlib stream (RFC 1950) */
+  bool zlib_inflate( unsigned char const *data, size_t size, std::vector<unsigned char> &out )
+  {
+    if (size < 6 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0)
+      return false;
+
+    bit_reader_t reader(data + 2, size - 6);
+    unsigned int is_last;
+    do
+    {
+      is_last = reader.bits(1);
+      unsigned int const type = reader.bits(2);
+      bool ok;
+
+      if (type == 0)
+      {
+        reader.align();
+        unsigned char const *header = reader.bytes(4);
+        if (header == 0)
+          return false;
+        unsigned int const length = header[0] | (header[1] << 8);
+        if ((length ^ 0xFFFF) != (unsigned int)(header[2] | (header[3] << 8)))
+          return false;
+        unsigned char const *block = reader.bytes(length);
+        ok = block != 0;
+        if (ok)
+          out.insert(out.end(), block, block + length);
+      }
+      else if (type == 1)
+        ok = inflate_fixed(reader, out);
+      else if (type == 2)
+        ok = inflate_dynamic(reader, out);
+      else
+        ok = false;
+      if (!ok || reader.failed())
+        return false;
+    } while (!is_last);
+
+    return adler32(out.empty() ? 0 : &out[0], out.size()) == get_u32(data + size - 4);
+  }
+
+  int paeth( int a, int b, int c )
+  {
+    int const p = a + b - c;
+    int const pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+      return a;
+    return pb <= pc ? b : c;
+  }
+
+  bool load_png( std::vector<unsigned char> const &file, image_t &image )
+  {
+    size_t pos = sizeof(s_png_signature);
+    unsigned int width = 0, height = 0, channels = 0;
+    std::vector<unsigned char> compressed;
+
+    while (pos + 12 <= file.size())
+    {
+      unsigned int const length = get_u32(&file[pos]);
+      char const *type = (char const *)&file[pos + 4];
+      unsigned char const *data = &file[pos + 8];
+
+      if (length > file.size() - pos - 12 || s_crc32.update(0, &file[pos + 4], length + 4) != get_u32(data + length))
+        return false;
+
+      if (memcmp(type, "IHDR", 4) == 0)
+      {
+        /* 8 bit depth, RGB or RGBA, deflate, adaptive filtering, no interlace */
+        if (length != 13 || data[8] != 8 || (data[9] != 2 && data[9] != 6) || data[10] != 0 || data[11] != 0 || data[12] != 0)
+          return false;
+        width = get_u32(data);
+        height = get_u32(data + 4);
+        channels = data[9] == 2 ? 3 : 4;
+      }
+      else if (memcmp(type, "IDAT", 4) == 0)
+        compressed.insert(compressed.end(), data, data + length);
+      else if (memcmp(type, "IEND", 4) == 0)
+        break;
+      pos += length + 12;
+    }
+
+    std::vector<unsigned char> raw;
+    size_t const row_size = (size_t)width * channels;
+    if (width == 0 || height == 0 || compressed.empty() || !zlib_inflate(&compressed[0], compressed.size(), raw) ||
+        raw.size() != (row_size + 1) * height)
+      return false;
+
+    /* Undo rows filtering in place, previous row is already unfiltered */
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      unsigned char const filter = raw[y * (row_size + 1)];
+      unsigned char *row = &raw[y * (row_size + 1) + 1];
+      unsigned char const *prior = y > 0 ? row - row_size - 1 : 0;
+
+      for (size_t x = 0; x < row_size; ++x)
+      {
+        int const a = x >= channels ? row[x - channels] : 0;
+        int const b = prior != 0 ? prior[x] : 0;
+        int const c = prior != 0 && x >= channels ? prior[x - channels] : 0;
+
+        switch (filter)
+        {
+        case 0: break;
+        case 1: row[x] = (unsigned char)(row[x] + a); break;
+        case 2: row[x] = (unsigned char)(row[x] + b); break;
+        case 3: row[x] = (unsigned char)(row[x] + (a + b) / 2); break;
+        case 4: row[x] = (unsigned char)(row[x] + paeth(a, b, c)); break;
+        default: return false;
+        }
+      }
+    }
+
+    image = image_t(width, height, PIXEL_FORMAT_RGBA8);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      unsigned char const *src = &raw[y * (row_size + 1) + 1];
+      unsigned char *dst = image.row(y);
+
+      for (unsigned int x = 0; x < width; ++x, src += channels, dst += 4)
+      {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+      }
+    }
+    return true;
+  }
+
+  /* Skip whitespace and comments, read decimal header field */
+  bool read_ppm_field( std::vector<unsigned char> const &file, size_t &pos, unsigned int &value )
+  {
+    for (;;)
+    {
+      while (pos < file.size() && isspace(file[pos]))
+        pos++;
+      if (pos < file.size() && file[pos] == '#')
+      {
+        while (pos < file.size() && file[pos] != '\n')
+          pos++;
+        continue;
+      }
+      break;
+    }
+    if (pos == file.size() || !isdigit(file[pos]))
+      return false;
+    value = 0;
+    while (pos < file.size() && isdigit(file[pos]))
+      value = value * 10 + (file[pos++] - '0');
+    return true;
+  }
+
+  bool load_ppm( std::vector<unsigned char> const &file, image_t &image )
+  {
+    size_t pos = 2;
+    unsigned int width, height, max_value;
+
+    if (!read_ppm_field(file, pos, width) || !read_ppm_field(file, pos, height) || !read_ppm_field(file, pos, max_value) ||
+        max_value != 255 || pos == file.size() || (size_t)width * height * 3 > file.size() - pos - 1)
+      return false;
+
+    /* Single whitespace separates header from pixels */
+    pos++;
+    image = image_t(width, height, PIXEL_FORMAT_RGBA8);
+    for (size_t i = 0; i < (size_t)width * height; ++i)
+    {
+      image.data[i * 4] = file[pos + i * 3];
+      image.data[i * 4 + 1] = file[pos + i * 3 + 1];
+      image.data[i * 4 + 2] = file[pos + i * 3 + 2];
+      image.data[i * 4 + 3] = 255;
+    }
+    return true;
+  }
+}
+
+void image_from_argb( unsigned int const *pixels, unsigned int width, unsigned int height, unsigned int stride, image_t &image )
+{
+  image = image_t(width, height, PIXEL_FORMAT_RGBA8);
+  for (unsigned int y = 0; y < height; ++y)
+  {
+    unsigned int const *src = pixels + y * stride;
+    unsigned char *dst = image.row(y);
+
+    for (unsigned int x = 0; x < width; ++x, dst += 4)
+    {
+      dst[0] = (unsigned char)(src[x] >> 16);
+      dst[1] = (unsigned char)(src[x] >> 8);
+      dst[2] = (unsigned char)src[x];
+      dst[3] = (unsigned char)(src[x] >> 24);
+    }
+  }
+}
+
+bool save_ppm( wchar_t const *file_name, image_t const &image )
+{
+  if (image.format != PIXEL_FORMAT_RGBA8)
+    return false;
+
+  char header[64];
+  int const header_size = sprintf(header, "P6\n%u %u\n255\n", image.width, image.height);
+  std::vector<unsigned char> data(header, header + header_size);
+
+  data.reserve(header_size + (size_t)image.width * image.height * 3);
+  for (size_t i = 0; i < (size_t)image.width * image.height; ++i)
+    data.insert(data.end(), &image.data[i * 4], &image.data[i * 4] + 3);
+  return save_file(file_name, &data[0], data.size());
+}
+
+bool save_png( wchar_t const *file_name, image_t const &image )
+{
+  if (image.format != PIXEL_FORMAT_RGBA8 || image.width == 0 || image.height == 0)
+    return false;
+
+  /* Filter type 'None' byte and RGB triples per row */
+  size_t const row_size = (size_t)image.width * 3 + 1;
+  std::vector<unsigned char> raw(row_size * image.height);
+  for (unsigned int y = 0; y < image.height; ++y)
+  {
+    unsigned char const *src = image.row(y);
+    unsigned char *dst = &raw[y * row_size];
+
+    *dst++ = 0;
+    for (unsigned int x = 0; x < image.width; ++x, src += 4, dst += 3)
+    {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+    }
+  }
+
+  /* zlib stream of stored blocks */
+  std::vector<unsigned char> stream;
+  stream.reserve(raw.size() + raw.size() / s_max_stored_block * 5 + 16);
+  stream.push_back(0x78);
+  stream.push_back(0x01);
+  for (size_t pos = 0; pos < raw.size(); pos += s_max_stored_block)
+  {
+    size_t const length = raw.size() - pos < s_max_stored_block ? raw.size() - pos : s_max_stored_block;
+
+    stream.push_back(pos + length == raw.size() ? 1 : 0);
+    stream.push_back((unsigned char)length);
+    stream.push_back((unsigned char)(length >> 8));
+    stream.push_back((unsigned char)~length);
+    stream.push_back((unsigned char)(~length >> 8));
+    stream.insert(stream.end(), raw.begin() + pos, raw.begin() + pos + length);
+  }
+  put_u32(stream, adler32(&raw[0], raw.size()));
+
+  std::vector<unsigned char> header;
+  put_u32(header, image.width);
+  put_u32(header, image.height);
+  header.push_back(8);      /* bit depth */
+  header.push_back(2);      /* RGB */
+  header.push_back(0);      /* deflate */
+  header.push_back(0);      /* adaptive filtering */
+  header.push_back(0);      /* no interlace */
+
+  std::vector<unsigned char> data(s_png_signature, s_png_signature + sizeof(s_png_signature));
+  data.reserve(stream.size() + 64);
+  put_chunk(data, "IHDR", &header[0], header.size());
+  put_chunk(data, "IDAT", &stream[0], stream.size());
+  put_chunk(data, "IEND", 0, 0);
+  return save_file(file_name, &data[0], data.size());
+}
+
+bool load_image( wchar_t const *file_name, image_t &image )
+{
+  std::vector<unsigned char> file;
+
+  if (!read_file(file_name, file))
+    return false;
+  if (file.size() > sizeof(s_png_signature) && memcmp(&file[0], s_png_signature, sizeof(s_png_signature)) == 0)
+    return load_png(file, image);
+  if (file.size() > 2 && file[0] == 'P' && file[1] == '6')
+    return load_ppm(file, image);
+  return false;
+}
+
+bool compare_images( image_t const &image, image_t const &reference, unsigned int tolerance,
+                     image_diff_t &diff, image_t *diff_image )
+{
+  memset(&diff, 0, sizeof(diff));
+  if (image.format != PIXEL_FORMAT_RGBA8 || reference.format != PIXEL_FORMAT_RGBA8 ||
+      image.width != reference.width || image.height != reference.height)
+    return false;
+
+  size_t const pixels_count = (size_t)image.width * image.height;
+  unsigned long long delta_sum = 0;
+
+  if (diff_image != 0)
+    *diff_image = image_t(image.width, image.height, PIXEL_FORMAT_RGBA8);
+  for (size_t i = 0; i < pixels_count; ++i)
+  {
+    unsigned char const *a = &image.data[i * 4];
+    unsigned char const *b = &reference.data[i * 4];
+    unsigned int pixel_delta = 0;
+
+    for (int c = 0; c < 3; ++c)
+    {
+      unsigned int const delta = a[c] > b[c] ? a[c] - b[c] : b[c] - a[c];
+
+      delta_sum += delta;
+      if (delta > pixel_delta)
+        pixel_delta = delta;
+    }
+    if (pixel_delta > diff.max_delta)
+      diff.max_delta = pixel_delta;
+    if (pixel_delta > tolerance)
+      diff.bad_pixels++;
+
+    if (diff_image != 0)
+    {
+      unsigned char *d = &diff_image->data[i * 4];
+
+      if (pixel_delta > tolerance)
+      {
+        d[0] = 255;
+        d[1] = d[2] = 0;
+      }
+      else
+        d[0] = d[1] = d[2] = (unsigned char)((b[0] + b[1] + b[2]) / 12);
+      d[3] = 255;
+    }
+  }
+
+  diff.mean_delta = pixels_count > 0 ? (double)delta_sum / (pixels_count * 3) : 0;
+  diff.bad_ratio = pixels_count > 0 ? (double)diff.bad_pixels / pixels_count : 0;
+  return true;
+}
@@ -0,0 +1,40 @@
+/**
+@file     image_io.h
+@brief    PPM and PNG images reading, writing and comparison definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __IMAGE_IO_INCLUDED__
+#define __IMAGE_IO_INCLUDED__
+
+#include "mipmap.h"
+
+/* Images are PIXEL_FORMAT_RGBA8, alpha is not saved and is set to 255 on load */
+
+/* Convert 0xAARRGGBB pixels with rows 'stride' pixels apart */
+void image_from_argb( unsigned int const *pixels, unsigned int width, unsigned int height, unsigned int stride, image_t &image );
+
+/* Binary PPM (P6) */
+bool save_ppm( wchar_t const *file_name, image_t const &image );
+/* 8 bit RGB PNG with uncompressed deflate blocks: no zlib dependency, files are PPM sized */
+bool save_png( wchar_t const *file_name, image_t const &image );
+/* Binary PPM or 8 bit non interlaced RGB/RGBA PNG of any deflate compression, format is detected by contents */
+bool load_image( wchar_t const *file_name, image_t &image );
+
+/* Difference of two images */
+struct image_diff_t
+{
+  unsigned int max_delta;       /* maximum channel difference */
+  double mean_delta;            /* mean channel difference */
+  unsigned int bad_pixels;      /* pixels with any channel difference above tolerance */
+  double bad_ratio;             /* bad pixels fraction */
+};
+
+/* Compare color channels, returns false if sizes or formats differ.
+ * Optional 'diff_image' shows bad pixels in red over darkened reference */
+bool compare_images( image_t const &image, image_t const &reference, unsigned int tolerance,
+                     image_diff_t &diff, image_t *diff_image = 0 );
+
+#endif /* __IMAGE_IO_INCLUDED__ */
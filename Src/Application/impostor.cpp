@@ -0,0 +1,367 @@
+/**
+@file     impostor.cpp
+@brief    Billboard impostors baked by software rasterizer implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "soft_raster.h"
+#include "stopwatch.h"
+#include "impostor.h"
+
+const DWORD impostor_atlas_t::c_FVF = D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1;
+
+namespace
+{
+  /* Empty texels get colors of covered neighbours, so filtering does not darken the silhouettes */
+  const unsigned int c_dilate_passes = 4;
+  /* Mipmaps stop while views are a few texels apart */
+  const unsigned int c_mip_levels = 3;
+  const DWORD c_alpha_ref = 8;
+
+  std::mutex s_stats_mutex;
+  impostor_stats_t s_stats;
+
+  /* Largest axis scale of transform */
+  float max_scale( transform_t const &world )
+  {
+    float scale = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      float const length = vec_t(world.matrix.M[axis][0], world.matrix.M[axis][1], world.matrix.M[axis][2]).length();
+      scale = length > scale ? length : scale;
+    }
+    return scale;
+  }
+
+  void dilate_cell( image_t &image, unsigned int x0, unsigned int y0, unsigned int size )
+  {
+    std::vector<unsigned char> filled(size * size);
+    for (unsigned int y = 0; y < size; ++y)
+      for (unsigned int x = 0; x < size; ++x)
+        filled[y * size + x] = image.row(y0 + y)[(x0 + x) * 4 + 3] != 0;
+
+    std::vector<unsigned char> next;
+    for (unsigned int pass = 0; pass < c_dilate_passes; ++pass)
+    {
+      next = filled;
+      for (unsigned int y = 0; y < size; ++y)
+        for (unsigned int x = 0; x < size; ++x)
+        {
+          if (filled[y * size + x])
+            continue;
+
+          int const offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+          unsigned int sum[3] = {0, 0, 0}, count = 0;
+          for (int i = 0; i < 4; ++i)
+          {
+            int const nx = (int)x + offsets[i][0], ny = (int)y + offsets[i][1];
+            if (nx < 0 || ny < 0 || nx >= (int)size || ny >= (int)size || !filled[ny * size + nx])
+              continue;
+            unsigned char const *texel = image.row(y0 + ny) + (x0 + nx) * 4;
+            sum[0] += texel[0];
+            sum[1] += texel[1];
+            sum[2] += texel[2];
+            count++;
+          }
+          if (count == 0)
+            continue;
+
+          unsigned char *texel = image.row(y0 + y) + (x0 + x) * 4;
+          for (int c = 0; c < 3; ++c)
+            texel[c] = (unsigned char)(sum[c] / count);
+          next[y * size + x] = 1;
+        }
+      filled.swap(next);
+    }
+  }
+}
+
+impostor_atlas_t::impostor_atlas_t()
+  : m_center(0.f)
+  , m_radius(0)
+  , m_is_baked(false)
+  , m_vertices_buf(NULL)
+  , m_capacity(0)
+{
+}
+
+impostor_atlas_t::~impostor_atlas_t()
+{
+  if (m_vertices_buf != NULL)
+    m_vertices_buf->Release();
+  if (m_is_baked)
+  {
+    std::lock_guard<std::mutex> lock(s_stats_mutex);
+    s_stats.atlases_count--;
+    s_stats.views_count -= m_params.azimuths * m_params.elevations;
+  }
+}
+
+bool impostor_atlas_t::bake( IDirect3DDevice9 *device, IAnimationUnit &unit, std::vector<soft_light_t> const &lights,
+                             float time, impostor_params_t const &params )
+{
+  stopwatch_t bake_timer;
+  vec_t center;
+  float radius;
+
+  if (m_is_baked || !unit.get_bounds(center, radius) || params.azimuths == 0 || params.elevations == 0)
+    return false;
+
+  unsigned int const cell = params.cell_size;
+  image_t image(cell * params.azimuths, cell * params.elevations, PIXEL_FORMAT_RGBA8);
+  soft_rasterizer_t rasterizer;
+  rasterizer.resize(cell, cell);
+  rasterizer.set_threads(params.threads);
+
+  /* Orthographic projection of the bounding sphere seen from its diameter distance */
+  matrix_t const projection(1 / radius, 0, 0,
+                            0, 1 / radius, 0,
+                            0, 0, 0.5f / radius,
+                            0, 0, -0.5f);
+  /* Unit transform is undone: views are in its local space */
+  transform_t const world(unit.get_transform().inv_matrix, unit.get_transform().matrix);
+
+  /* Children may be posed by their response() after they are drawn: one pass without rendering sets the pose */
+  {
+    frame_context_t frame;
+    frame.time = time;
+    recursive_data_t rd(NULL, frame, world);
+    rd.rasterizer = &rasterizer;
+    rasterizer.begin_frame(matrix_t().set_unit(), projection, 0);
+    unit.treat_as_unit(rd);
+  }
+
+  for (unsigned int row = 0; row < params.elevations; ++row)
+    for (unsigned int column = 0; column < params.azimuths; ++column)
+    {
+      float const elevation = params.elevations > 1 ? cglmath::Deg2Rad(params.max_elevation) * row / (params.elevations - 1) : 0.f;
+      float const azimuth = 2 * cglmath::c_pif * column / params.azimuths;
+      vec_t const direction(cosf(elevation) * cosf(azimuth), sinf(elevation), cosf(elevation) * sinf(azimuth));
+      vec_t location = center + direction * (2 * radius), at = center, up(0, 1, 0);
+      camera_t camera;
+
+      camera.set_camera(location, at, up, true);
+      rasterizer.begin_frame(camera.get_view_matrix(), projection, 0);
+      for (size_t i = 0; i < lights.size(); ++i)
+        rasterizer.add_light(lights[i]);
+
+      frame_context_t const frame(camera, time, 0);
+      recursive_data_t rd(NULL, frame, world);
+      rd.rasterizer = &rasterizer;
+      unit.treat_as_unit(rd);
+      rasterizer.end_frame();
+
+      for (unsigned int y = 0; y < cell; ++y)
+      {
+        unsigned int const *source = rasterizer.color_buffer() + y * rasterizer.stride();
+        unsigned char *texel = image.row(row * cell + y) + column * cell * 4;
+        for (unsigned int x = 0; x < cell; ++x, texel += 4)
+        {
+          texel[0] = (unsigned char)(source[x] >> 16);
+          texel[1] = (unsigned char)(source[x] >> 8);
+          texel[2] = (unsigned char)source[x];
+          texel[3] = (unsigned char)(source[x] >> 24);
+        }
+      }
+      dilate_cell(image, column * cell, row * cell, cell);
+    }
+
+  if (device != NULL)
+  {
+    mip_params_t mip_params;
+    mip_params.max_levels = c_mip_levels;
+    mip_params.threads = params.threads;
+    if (!m_texture.create(device, image, mip_params))
+      return false;
+  }
+
+  m_params = params;
+  m_center = center;
+  m_radius = radius;
+  m_image.width = image.width;
+  m_image.height = image.height;
+  m_image.data.swap(image.data);
+  m_is_baked = true;
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.atlases_count++;
+  s_stats.views_count += params.azimuths * params.elevations;
+  s_stats.bake_ms += bake_timer.elapsed_ms();
+  return true;
+}
+
+float impostor_atlas_t::fade( frame_context_t const &frame, transform_t const &world ) const
+{
+  if (!m_is_baked)
+    return 0;
+
+  float const distance = (world.transform_point(m_center) - frame.eye).length();
+  if (m_params.fade <= 0)
+    return distance > m_params.distance ? 1.f : 0.f;
+  return cglmath::Min(cglmath::Max((distance - m_params.distance) / m_params.fade, 0.f), 1.f);
+}
+
+void impostor_atlas_t::view_cell( vec_t const &direction, unsigned int &column, unsigned int &row ) const
+{
+  float azimuth = atan2f(direction.z, direction.x);
+  if (azimuth < 0)
+    azimuth += 2 * cglmath::c_pif;
+  column = (unsigned int)floorf(azimuth * m_params.azimuths / (2 * cglmath::c_pif) + 0.5f) % m_params.azimuths;
+
+  row = 0;
+  if (m_params.elevations > 1)
+  {
+    float const elevation = asinf(cglmath::Min(cglmath::Max(direction.y, -1.f), 1.f));
+    float const step = cglmath::Deg2Rad(m_params.max_elevation) / (m_params.elevations - 1);
+    float const index = floorf(elevation / step + 0.5f);
+    row = index <= 0 ? 0 : cglmath::Min((unsigned int)index, m_params.elevations - 1);
+  }
+}
+
+void impostor_atlas_t::add( frame_context_t const &frame, transform_t const &world, float alpha, unsigned int draws, unsigned int vertices )
+{
+  vec_t const center = world.transform_point(m_center);
+  float const radius = m_radius * max_scale(world);
+  vec_t direction = center - frame.eye;
+  float const distance = direction.length();
+  if (distance <= 0)
+    return;
+  direction *= 1 / distance;
+
+  /* Basis of the baking camera which looked at the same direction */
+  vec_t right = direction % vec_t(0, 1, 0);
+  if (right.length() < 1e-4f)
+    right = frame.right;
+  right.normalize();
+  vec_t const up = right % direction;
+
+  unsigned int column, row;
+  view_cell(-world.inv_transform_vector(direction).normalizing(), column, row);
+
+  /* Half texel inset keeps bilinear filtering inside the cell */
+  float const inset_u = 0.5f / m_image.width, inset_v = 0.5f / m_image.height;
+  float const u0 = (float)column / m_params.azimuths + inset_u, u1 = (float)(column + 1) / m_params.azimuths - inset_u;
+  float const v0 = (float)row / m_params.elevations + inset_v, v1 = (float)(row + 1) / m_params.elevations - inset_v;
+  DWORD const color = D3DCOLOR_ARGB((int)(alpha * 255 + 0.5f), 255, 255, 255);
+
+  vertex_t const top_left = {center + (up - right) * radius, color, u0, v0};
+  vertex_t const top_right = {center + (up + right) * radius, color, u1, v0};
+  vertex_t const bottom_left = {center - (up + right) * radius, color, u0, v1};
+  vertex_t const bottom_right = {center + (right - up) * radius, color, u1, v1};
+
+  quad_t quad;
+  quad.distance = distance;
+  quad.vertices[0] = top_left;
+  quad.vertices[1] = top_right;
+  quad.vertices[2] = bottom_left;
+  quad.vertices[3] = bottom_left;
+  quad.vertices[4] = top_right;
+  quad.vertices[5] = bottom_right;
+  m_quads.push_back(quad);
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.quads_count++;
+  if (alpha < 1)
+  {
+    s_stats.faded_count++;
+    return;
+  }
+  s_stats.draws_saved += draws;
+  s_stats.vertices_saved += vertices > 6 ? vertices - 6 : 0;
+}
+
+void impostor_atlas_t::flush( recursive_data_t &rd )
+{
+  IDirect3DDevice9 *device = rd.device;
+  if (m_quads.empty() || device == NULL || !m_is_baked)
+  {
+    m_quads.clear();
+    return;
+  }
+
+  unsigned int const count = (unsigned int)m_quads.size();
+  if (count > m_capacity)
+  {
+    if (m_vertices_buf != NULL)
+      m_vertices_buf->Release();
+    m_vertices_buf = NULL;
+    m_capacity = cglmath::Max(count, 2 * m_capacity);
+    if (FAILED(device->CreateVertexBuffer(m_capacity * 6 * sizeof(vertex_t), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, c_FVF,
+                                          D3DPOOL_DEFAULT, &m_vertices_buf, NULL)))
+    {
+      m_capacity = 0;
+      m_quads.clear();
+      return;
+    }
+  }
+
+  /* Back to front for blending */
+  m_order.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    m_order[i] = &m_quads[i];
+  std::sort(m_order.begin(), m_order.end(), []( quad_t const *a, quad_t const *b ) { return a->distance > b->distance; });
+
+  void *buf;
+  if (FAILED(m_vertices_buf->Lock(0, count * 6 * sizeof(vertex_t), &buf, D3DLOCK_DISCARD)))
+  {
+    m_quads.clear();
+    return;
+  }
+  for (unsigned int i = 0; i < count; ++i)
+    memcpy((vertex_t *)buf + i * 6, m_order[i]->vertices, 6 * sizeof(vertex_t));
+  m_vertices_buf->Unlock();
+
+  D3DRENDERSTATETYPE const states[] = {D3DRS_LIGHTING, D3DRS_ALPHABLENDENABLE, D3DRS_SRCBLEND, D3DRS_DESTBLEND,
+                                       D3DRS_ALPHATESTENABLE, D3DRS_ALPHAREF, D3DRS_ALPHAFUNC};
+  DWORD const values[] = {FALSE, TRUE, D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA, TRUE, c_alpha_ref, D3DCMP_GREATER};
+  size_t const states_count = sizeof(states) / sizeof(states[0]);
+  DWORD saved[states_count], saved_alpha_op;
+
+  for (size_t i = 0; i < states_count; ++i)
+  {
+    device->GetRenderState(states[i], &saved[i]);
+    device->SetRenderState(states[i], values[i]);
+  }
+  device->GetTextureStageState(0, D3DTSS_ALPHAOP, &saved_alpha_op);
+  device->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+  {
+    auto_texture_binder_t(device, m_texture, 0);
+    matrix_t const identity = transform_t().matrix;
+
+    device->SetTransform(D3DTS_WORLD, (D3DMATRIX *)identity.M);
+    device->SetFVF(c_FVF);
+    device->SetStreamSource(0, m_vertices_buf, 0, sizeof(vertex_t));
+    device->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 2 * count);
+  }
+  device->SetTextureStageState(0, D3DTSS_ALPHAOP, saved_alpha_op);
+  for (size_t i = 0; i < states_count; ++i)
+    device->SetRenderState(states[i], saved[i]);
+
+  m_quads.clear();
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.draws_count++;
+}
+
+impostor_stats_t impostor_stats( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  return s_stats;
+}
+
+void impostor_begin_frame( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.quads_count = 0;
+  s_stats.faded_count = 0;
+  s_stats.draws_count = 0;
+  s_stats.draws_saved = 0;
+  s_stats.vertices_saved = 0;
+}
@@ -0,0 +1,119 @@
+/**
+@file     impostor.h
+@brief    Billboard impostors baked by software rasterizer definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __IMPOSTOR_INCLUDED__
+#define __IMPOSTOR_INCLUDED__
+
+#include <atomic>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "lighting.h"
+#include "mipmap.h"
+#include "texture.h"
+#include "unit.h"
+
+struct impostor_params_t
+{
+  unsigned int azimuths;        /* views around y axis */
+  unsigned int elevations;      /* view rows from horizontal up to max_elevation */
+  float max_elevation;          /* degrees */
+  unsigned int cell_size;       /* view pixels, power of 2 */
+  float distance;               /* impostors fade in beyond it */
+  float fade;                   /* cross-fade band after distance, geometry is drawn in it too */
+  unsigned int threads;         /* baking threads, 0 means all hardware threads */
+
+  impostor_params_t()
+    : azimuths(8), elevations(4), max_elevation(67.5f), cell_size(64), distance(15), fade(3), threads(0)
+  {
+  }
+};
+
+/* Views of a unit over a set of directions in one texture, and camera facing quads of
+ * its instances collected during a frame and drawn by one call with flush().
+ * Views are rendered by software rasterizer in unit local space with lights given
+ * for baking, instances keep the baked lighting: units must be only translated.
+ * Quads are drawn unlit with alpha blending, the alpha is the cross-fade weight */
+class impostor_atlas_t
+{
+public:
+  impostor_atlas_t();
+  ~impostor_atlas_t();
+
+  /* Bake views of the unit tree at animation 'time', 'device' may be NULL to bake image only */
+  bool bake( IDirect3DDevice9 *device, IAnimationUnit &unit, std::vector<soft_light_t> const &lights, float time,
+             impostor_params_t const &params = impostor_params_t() );
+  bool is_baked( void ) const { return m_is_baked; }
+
+  impostor_params_t const & params( void ) const { return m_params; }
+  /* Views, RGBA8 with coverage in alpha */
+  image_t const & image( void ) const { return m_image; }
+
+  /* Cross-fade weight of the unit at world transform: 0 for geometry only, 1 for impostor only */
+  float fade( frame_context_t const &frame, transform_t const &world ) const;
+  /* Queue quad of the unit instance. Geometry of 'draws' calls and 'vertices' vertices
+   * it replaces is counted as saved when the quad is opaque */
+  void add( frame_context_t const &frame, transform_t const &world, float alpha, unsigned int draws, unsigned int vertices );
+  /* Draw queued quads with one call, on device only */
+  void flush( recursive_data_t &rd );
+private:
+  impostor_atlas_t( impostor_atlas_t const & );
+  impostor_atlas_t & operator=( impostor_atlas_t const & );
+
+#pragma pack(push)
+#pragma pack(1)
+  struct vertex_t
+  {
+    vec_t V;
+    DWORD Color;
+    float u, v;
+  };
+#pragma pack(pop)
+  static const DWORD c_FVF;
+
+  struct quad_t
+  {
+    float distance;
+    vertex_t vertices[6];        /* two triangles */
+  };
+
+  /* Nearest view cell to unit local direction towards the camera */
+  void view_cell( vec_t const &direction, unsigned int &column, unsigned int &row ) const;
+
+  impostor_params_t m_params;
+  vec_t m_center;               /* local bounding sphere of the baked unit */
+  float m_radius;
+  image_t m_image;
+  texture_t m_texture;
+  std::atomic<bool> m_is_baked;
+
+  std::vector<quad_t> m_quads;
+  std::vector<quad_t const *> m_order;
+  IDirect3DVertexBuffer9 *m_vertices_buf;
+  unsigned int m_capacity;      /* quads of m_vertices_buf */
+};
+
+struct impostor_stats_t
+{
+  unsigned int atlases_count;
+  unsigned int views_count;
+  double bake_ms;
+  /* Current frame */
+  unsigned int quads_count;
+  unsigned int faded_count;     /* drawn with geometry during cross-fade */
+  unsigned int draws_count;     /* flush() calls with quads */
+  unsigned int draws_saved;
+  unsigned int vertices_saved;
+};
+
+impostor_stats_t impostor_stats( void );
+/* Reset frame statistics */
+void impostor_begin_frame( void );
+
+#endif /* __IMPOSTOR_INCLUDED__ */
@@ -0,0 +1,332 @@
+/**
+@file     job_graph.cpp
+@brief    Jobs with dependencies running on a threads pool implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include "parallel.h"
+#include "job_graph.h"
+
+namespace
+{
+  /* File scope, not a function local static: VS2013 (v120) does not make local statics
+   * initialization thread safe */
+  job_pool_t s_job_pool;
+}
+
+/* Pool */
+job_pool_t::job_pool_t()
+  : m_first(NULL)
+  , m_last(NULL)
+  , m_is_exiting(false)
+{
+}
+
+job_pool_t::~job_pool_t()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_is_exiting = true;
+  }
+  m_task_cond.notify_all();
+  for (size_t i = 0; i < m_threads.size(); ++i)
+    m_threads[i].join();
+}
+
+void job_pool_t::start( task_t &task, void (*run)( void *context ), void *context, unsigned int slots )
+{
+  task.run = run;
+  task.context = context;
+  task.slots = 0;
+  task.active = 0;
+  task.next = NULL;
+  if (slots == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_threads.empty())
+    for (unsigned int i = 0; i < workers_count(); ++i)
+      m_threads.push_back(std::thread(&job_pool_t::worker, this));
+
+  /* More slots than threads would only make the same threads rejoin */
+  task.slots = slots < m_threads.size() ? slots : (unsigned int)m_threads.size();
+  if (m_last != NULL)
+    m_last->next = &task;
+  else
+    m_first = &task;
+  m_last = &task;
+  for (unsigned int i = 0; i < task.slots; ++i)
+    m_task_cond.notify_one();
+}
+
+void job_pool_t::finish( task_t &task )
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  /* Unlink task if it still has free slots */
+  for (task_t *prev = NULL, *cur = m_first; cur != NULL; prev = cur, cur = cur->next)
+    if (cur == &task)
+    {
+      (prev != NULL ? prev->next : m_first) = cur->next;
+      if (m_last == cur)
+        m_last = prev;
+      break;
+    }
+  task.slots = 0;
+  while (task.active > 0)
+    m_done_cond.wait(lock);
+}
+
+void job_pool_t::help( bool (*is_over)( void *context ), void *context, task_t const &own )
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (!is_over(context))
+  {
+    task_t *task = take_slot(&own);
+
+    if (task != NULL)
+      run_slot(lock, *task);
+    else
+      m_task_cond.wait(lock);
+  }
+  /* Pass on a task wakeup this thread may have taken */
+  if (m_first != NULL)
+    m_task_cond.notify_one();
+}
+
+void job_pool_t::wake( void )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_task_cond.notify_all();
+}
+
+unsigned int job_pool_t::threads_count( void )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_threads.empty() ? workers_count() : (unsigned int)m_threads.size();
+}
+
+unsigned int job_pool_t::workers_count( void )
+{
+  unsigned int const count = parallel_threads_count();
+  return count > 1 ? count - 1 : 1;
+}
+
+job_pool_t::task_t * job_pool_t::take_slot( task_t const *skip )
+{
+  task_t *prev = NULL, *task = m_first;
+
+  while (task != NULL && task == skip)
+  {
+    prev = task;
+    task = task->next;
+  }
+  if (task == NULL)
+    return NULL;
+
+  /* Task leaves the queue with its last slot */
+  if (--task->slots == 0)
+  {
+    (prev != NULL ? prev->next : m_first) = task->next;
+    if (m_last == task)
+      m_last = prev;
+  }
+  task->active++;
+  return task;
+}
+
+void job_pool_t::run_slot( std::unique_lock<std::mutex> &lock, task_t &task )
+{
+  lock.unlock();
+  task.run(task.context);
+  lock.lock();
+
+  if (--task.active == 0)
+    m_done_cond.notify_all();
+}
+
+void job_pool_t::worker( void )
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for (;;)
+  {
+    while (m_first == NULL && !m_is_exiting)
+      m_task_cond.wait(lock);
+    if (m_is_exiting)
+      break;
+    run_slot(lock, *take_slot(NULL));
+  }
+}
+
+job_pool_t & job_pool( void )
+{
+  return s_job_pool;
+}
+
+/* Graph */
+job_graph_t::job_graph_t()
+  : m_is_started(false)
+  , m_done_count(0)
+  , m_threads_count(0)
+  , m_finish_ms(0)
+{
+}
+
+job_graph_t::~job_graph_t()
+{
+  wait();
+}
+
+job_graph_t::job_id_t job_graph_t::add( std::string const &name, work_t const &work, std::vector<job_id_t> const &dependencies )
+{
+  job_t job;
+  job_id_t const id = m_jobs.size();
+
+  job.name = name;
+  job.work = work;
+  job.dependencies = dependencies;
+  job.waiting_count = (unsigned int)dependencies.size();
+  job.is_done = false;
+  job.start_ms = job.end_ms = 0;
+  m_jobs.push_back(job);
+
+  for (size_t i = 0; i < dependencies.size(); ++i)
+    m_jobs[dependencies[i]].dependents.push_back(id);
+  return id;
+}
+
+void job_graph_t::run( unsigned int threads )
+{
+  m_timer.restart();
+  for (job_id_t id = 0; id < m_jobs.size(); ++id)
+    if (m_jobs[id].waiting_count == 0)
+      m_ready.push_back(id);
+
+  unsigned int const count = threads > 0 ? threads : parallel_threads_count();
+  m_threads_count = count < m_jobs.size() ? count : (unsigned int)m_jobs.size();
+  m_is_started = true;
+  job_pool().start(m_task, &job_graph_t::run_worker, this, m_threads_count);
+}
+
+void job_graph_t::wait( void )
+{
+  if (!m_is_started)
+    return;
+  worker();
+  job_pool().finish(m_task);
+  m_is_started = false;
+}
+
+void job_graph_t::run_worker( void *graph )
+{
+  static_cast<job_graph_t *>(graph)->worker();
+}
+
+bool job_graph_t::is_done( void ) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_done_count == m_jobs.size();
+}
+
+bool job_graph_t::is_waiting_over( void *graph )
+{
+  job_graph_t &self = *static_cast<job_graph_t *>(graph);
+  std::lock_guard<std::mutex> lock(self.m_mutex);
+
+  return !self.m_ready.empty() || self.m_done_count == self.m_jobs.size();
+}
+
+void job_graph_t::worker( void )
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for (;;)
+  {
+    /* Help other pool tasks, such as loops nested in running jobs, instead of sleeping:
+     * a graph worker blocking a pool thread could starve them */
+    while (m_ready.empty() && m_done_count < m_jobs.size())
+    {
+      lock.unlock();
+      job_pool().help(&job_graph_t::is_waiting_over, this, m_task);
+      lock.lock();
+    }
+    if (m_ready.empty())
+      break;
+
+    job_id_t const id = m_ready.back();
+    m_ready.pop_back();
+    m_jobs[id].start_ms = m_timer.elapsed_ms();
+
+    lock.unlock();
+    m_jobs[id].work();
+    lock.lock();
+
+    job_t &job = m_jobs[id];
+    bool wake_helpers = m_done_count + 1 == m_jobs.size();
+
+    job.end_ms = m_timer.elapsed_ms();
+    job.is_done = true;
+    m_finish_ms = job.end_ms;
+    m_done_count++;
+    for (size_t i = 0; i < job.dependents.size(); ++i)
+      if (--m_jobs[job.dependents[i]].waiting_count == 0)
+      {
+        m_ready.push_back(job.dependents[i]);
+        wake_helpers = true;
+      }
+
+    /* Wake up helping workers for new ready jobs, or everybody to exit after the last one */
+    if (wake_helpers)
+    {
+      lock.unlock();
+      job_pool().wake();
+      lock.lock();
+    }
+  }
+}
+
+job_graph_stats_t job_graph_t::stats( void ) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  job_graph_stats_t stats;
+
+  stats.jobs_count = (unsigned int)m_jobs.size();
+  stats.done_count = m_done_count;
+  stats.threads_count = m_threads_count;
+  stats.wall_ms = m_done_count == m_jobs.size() ? m_finish_ms : m_timer.elapsed_ms();
+  stats.work_ms = stats.critical_path_ms = 0;
+
+  /* Jobs are added after their dependencies, so one pass in order finds the longest chains */
+  std::vector<double> path_ms(m_jobs.size(), 0);
+  std::vector<job_id_t> path_prev(m_jobs.size(), m_jobs.size());
+  job_id_t path_end = m_jobs.size();
+  for (job_id_t id = 0; id < m_jobs.size(); ++id)
+  {
+    job_t const &job = m_jobs[id];
+    if (!job.is_done)
+      continue;
+
+    double const duration = job.end_ms - job.start_ms;
+    stats.work_ms += duration;
+    for (size_t i = 0; i < job.dependencies.size(); ++i)
+      if (path_ms[job.dependencies[i]] > path_ms[id])
+      {
+        path_ms[id] = path_ms[job.dependencies[i]];
+        path_prev[id] = job.dependencies[i];
+      }
+    path_ms[id] += duration;
+    if (path_ms[id] > stats.critical_path_ms)
+    {
+      stats.critical_path_ms = path_ms[id];
+      path_end = id;
+    }
+  }
+
+  for (job_id_t id = path_end; id < m_jobs.size(); id = path_prev[id])
+    stats.critical_path = m_jobs[id].name + (stats.critical_path.empty() ? "" : " -> ") + stats.critical_path;
+  return stats;
+}
@@ -0,0 +1,141 @@
+/**
+@file     job_graph.h
+@brief    Jobs with dependencies running on a threads pool definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __JOB_GRAPH_INCLUDED__
+#define __JOB_GRAPH_INCLUDED__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stopwatch.h"
+
+/* Persistent worker threads shared by jobs graphs and parallel loops. Threads start on the
+ * first task and live until exit, so running a task does not start threads or allocate.
+ * Submitters run their tasks too, so the pool has one thread less than the hardware
+ * (but at least one, so started work goes on without its submitter) */
+class job_pool_t
+{
+public:
+  /* Work several pool threads may join, owned by the submitter until finish() returns */
+  struct task_t
+  {
+    void (*run)( void *context );
+    void *context;
+    unsigned int slots;     /* pool threads still allowed to join */
+    unsigned int active;    /* pool threads inside run() */
+    task_t *next;
+  };
+
+  job_pool_t();
+  /* Stops and joins threads, all tasks must be finished */
+  ~job_pool_t();
+
+  /* Let up to 'slots' pool threads call run(context), returns immediately */
+  void start( task_t &task, void (*run)( void *context ), void *context, unsigned int slots );
+  /* Stop threads joining the task and wait for the joined ones to return */
+  void finish( task_t &task );
+  /* Run queued tasks except 'own' until is_over(context) returns true, instead of sleeping.
+   * is_over is called under the pool lock, code changing its result must call wake() then */
+  void help( bool (*is_over)( void *context ), void *context, task_t const &own );
+  /* Wake threads in help() to check their conditions */
+  void wake( void );
+  unsigned int threads_count( void );
+private:
+  job_pool_t( job_pool_t const & );
+  job_pool_t & operator=( job_pool_t const & );
+
+  void worker( void );
+  /* Take a slot of the first queued task except 'skip', NULL if none. Called under the lock */
+  task_t * take_slot( task_t const *skip );
+  /* Run taken slot unlocking for its duration */
+  void run_slot( std::unique_lock<std::mutex> &lock, task_t &task );
+  static unsigned int workers_count( void );
+
+  std::mutex m_mutex;
+  std::condition_variable m_task_cond;    /* task queued, exit or wake() */
+  std::condition_variable m_done_cond;    /* thread left a task */
+  std::vector<std::thread> m_threads;
+  task_t *m_first;
+  task_t *m_last;
+  bool m_is_exiting;
+};
+
+/* Pool of the application */
+job_pool_t & job_pool( void );
+
+/* Jobs graph statistics */
+struct job_graph_stats_t
+{
+  unsigned int jobs_count;
+  unsigned int done_count;
+  unsigned int threads_count;
+  double wall_ms;               /* from run() to the last finished job */
+  double work_ms;               /* sum of all jobs durations */
+  double critical_path_ms;      /* longest dependency chain of finished jobs */
+  std::string critical_path;    /* names of the chain jobs */
+};
+
+/* Jobs are declared with dependencies and run asynchronously, every job starts
+ * as soon as all of its dependencies are finished */
+class job_graph_t
+{
+public:
+  typedef size_t job_id_t;
+  typedef std::function<void ()> work_t;
+
+  job_graph_t();
+  /* Waits for all jobs */
+  ~job_graph_t();
+
+  /* Declare job, only jobs added before run() can be dependencies */
+  job_id_t add( std::string const &name, work_t const &work, std::vector<job_id_t> const &dependencies = std::vector<job_id_t>() );
+
+  /* Start jobs on the pool, threads count 0 means hardware concurrency */
+  void run( unsigned int threads = 0 );
+  /* Calling thread takes part in the remaining jobs, and in other pool tasks
+   * while no jobs are ready */
+  void wait( void );
+  bool is_done( void ) const;
+
+  job_graph_stats_t stats( void ) const;
+private:
+  job_graph_t( job_graph_t const & );
+  job_graph_t & operator=( job_graph_t const & );
+
+  struct job_t
+  {
+    std::string name;
+    work_t work;
+    std::vector<job_id_t> dependents;
+    std::vector<job_id_t> dependencies;
+    unsigned int waiting_count;     /* unfinished dependencies */
+    bool is_done;
+    double start_ms;
+    double end_ms;
+  };
+
+  void worker( void );
+  static void run_worker( void *graph );
+  static bool is_waiting_over( void *graph );
+
+  mutable std::mutex m_mutex;
+  std::vector<job_t> m_jobs;
+  std::vector<job_id_t> m_ready;
+  job_pool_t::task_t m_task;
+  bool m_is_started;
+  unsigned int m_done_count;
+  unsigned int m_threads_count;
+  stopwatch_t m_timer;
+  double m_finish_ms;
+};
+
+#endif /* __JOB_GRAPH_INCLUDED__ */
@@ -0,0 +1,245 @@
+/**
+@file     light_bake.cpp
+@brief    Static lights baking into vertex colors implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include "geometry_cache.h"
+#include "light_clusters.h"
+#include "parallel.h"
+#include "stopwatch.h"
+#include "light_bake.h"
+
+namespace
+{
+  /* Vertices lit by one light_evaluator_t call */
+  const unsigned int c_bake_batch = 64;
+  /* Vertices baked by one task */
+  const unsigned int c_vertices_per_task = 4096;
+
+  /* base_geometry_t::vertex_t layout */
+  const unsigned int c_normal_offset = 12;
+  const unsigned int c_color_offset = 24;
+
+  unsigned int to_argb( unsigned int alpha, float r, float g, float b )
+  {
+    return (alpha << 24) | ((unsigned int)(r * 255 + 0.5f) << 16) | ((unsigned int)(g * 255 + 0.5f) << 8) |
+           (unsigned int)(b * 255 + 0.5f);
+  }
+
+  light_bake_cache_t s_light_bake_cache;
+}
+
+unsigned long long static_lighting_t::key( void ) const
+{
+  params_hash_t hash;
+
+  hash << ambient << lights.size();
+  for (size_t i = 0; i < lights.size(); ++i)
+    hash << lights[i];
+  return hash.value();
+}
+
+bool static_lighting_t::is_positional( void ) const
+{
+  for (size_t i = 0; i < lights.size(); ++i)
+    if (lights[i].type != soft_light_t::DIRECTIONAL)
+      return true;
+  return false;
+}
+
+void bake_vertex_colors( static_lighting_t const &lighting, transform_t const &world_transform, void const *vertices,
+                         unsigned int vertex_size, unsigned int count, void *baked, unsigned int threads )
+{
+  light_evaluator_t evaluator;
+  evaluator.set_lights(lighting.lights.empty() ? NULL : &lighting.lights[0], lighting.lights.size());
+  evaluator.set_ambient(lighting.ambient);
+
+  float const (&world)[4][4] = world_transform.matrix.M;
+  parallel_for(0, count, c_vertices_per_task, [&]( size_t begin, size_t end )
+  {
+    float x[c_bake_batch], y[c_bake_batch], z[c_bake_batch];
+    float nx[c_bake_batch], ny[c_bake_batch], nz[c_bake_batch];
+    float r[c_bake_batch], g[c_bake_batch], b[c_bake_batch];
+    float lit_r[c_bake_batch], lit_g[c_bake_batch], lit_b[c_bake_batch];
+    light_batch_t batch = {x, y, z, nx, ny, nz, r, g, b, 0};
+    light_output_t const output = {lit_r, lit_g, lit_b, NULL, NULL, NULL};
+    light_material_t const material;
+
+    for (size_t first = begin; first < end; first += c_bake_batch)
+    {
+      unsigned int const batch_count = (unsigned int)(end - first < c_bake_batch ? end - first : c_bake_batch);
+      unsigned char const *src = (unsigned char const *)vertices + first * vertex_size;
+
+      for (unsigned int i = 0; i < batch_count; ++i, src += vertex_size)
+      {
+        float const *p = (float const *)src;
+        x[i] = p[0] * world[0][0] + p[1] * world[1][0] + p[2] * world[2][0] + world[3][0];
+        y[i] = p[0] * world[0][1] + p[1] * world[1][1] + p[2] * world[2][1] + world[3][1];
+        z[i] = p[0] * world[0][2] + p[1] * world[1][2] + p[2] * world[2][2] + world[3][2];
+
+        /* Same normals as software rasterizer and D3DRS_NORMALIZENORMALS give */
+        float const *n = (float const *)(src + c_normal_offset);
+        vec_t normal(n[0] * world[0][0] + n[1] * world[1][0] + n[2] * world[2][0],
+                     n[0] * world[0][1] + n[1] * world[1][1] + n[2] * world[2][1],
+                     n[0] * world[0][2] + n[1] * world[1][2] + n[2] * world[2][2]);
+        float const length2 = normal.length2();
+        if (length2 > 0)
+          normal *= 1 / sqrt(length2);
+        nx[i] = normal.x;
+        ny[i] = normal.y;
+        nz[i] = normal.z;
+
+        unsigned int const argb = *(unsigned int const *)(src + c_color_offset);
+        r[i] = ((argb >> 16) & 0xFF) / 255.f;
+        g[i] = ((argb >> 8) & 0xFF) / 255.f;
+        b[i] = (argb & 0xFF) / 255.f;
+      }
+
+      batch.count = batch_count;
+      evaluator.evaluate(batch, material, output);
+
+      src = (unsigned char const *)vertices + first * vertex_size;
+      unsigned char *dst = (unsigned char *)baked + first * vertex_size;
+      memcpy(dst, src, (size_t)batch_count * vertex_size);
+      for (unsigned int i = 0; i < batch_count; ++i, dst += vertex_size)
+      {
+        unsigned int *color = (unsigned int *)(dst + c_color_offset);
+        *color = to_argb(*color >> 24, lit_r[i], lit_g[i], lit_b[i]);
+      }
+    }
+  }, threads);
+}
+
+light_bake_cache_t & light_bake_cache( void )
+{
+  return s_light_bake_cache;
+}
+
+light_bake_cache_t::light_bake_cache_t() : m_lighting_key(0)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+IDirect3DVertexBuffer9 * light_bake_cache_t::get( IDirect3DDevice9 *device, void const *geometry, void const *vertices,
+                                                  unsigned int vertex_size, unsigned int count, unsigned int fvf,
+                                                  transform_t const &world, static_lighting_t const &lighting )
+{
+  if (device == NULL || count == 0)
+    return NULL;
+
+  /* Previous lighting bakes are never drawn again */
+  unsigned long long const lighting_key = lighting.key();
+  if (lighting_key != m_lighting_key)
+  {
+    clear();
+    m_lighting_key = lighting_key;
+  }
+
+  /* Directional lights do not depend on geometry position, translated instances share one bake */
+  params_hash_t hash;
+  hash << geometry << lighting_key;
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      hash << world.matrix.M[i][j];
+  if (lighting.is_positional())
+    hash << world.matrix.M[3][0] << world.matrix.M[3][1] << world.matrix.M[3][2];
+
+  m_stats.requests++;
+  std::map<unsigned long long, entry_t>::iterator it = m_entries.find(hash.value());
+  if (it != m_entries.end())
+    return it->second.buffer;
+
+  entry_t entry;
+  entry.geometry = geometry;
+  entry.buffer = NULL;
+  entry.memory = (size_t)vertex_size * count;
+  if (FAILED(device->CreateVertexBuffer((UINT)entry.memory, D3DUSAGE_WRITEONLY, fvf, D3DPOOL_MANAGED, &entry.buffer, NULL)))
+    return NULL;
+
+  void *buf;
+  if (FAILED(entry.buffer->Lock(0, 0, &buf, 0)))
+  {
+    entry.buffer->Release();
+    return NULL;
+  }
+  stopwatch_t timer;
+  bake_vertex_colors(lighting, world, vertices, vertex_size, count, buf);
+  m_stats.bake_ms += timer.elapsed_ms();
+  entry.buffer->Unlock();
+
+  m_entries.insert(std::make_pair(hash.value(), entry));
+  m_stats.bakes++;
+  m_stats.entries++;
+  m_stats.baked_vertices += count;
+  m_stats.memory += entry.memory;
+  return entry.buffer;
+}
+
+void light_bake_cache_t::forget( void const *geometry )
+{
+  for (std::map<unsigned long long, entry_t>::iterator it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (it->second.geometry != geometry)
+    {
+      ++it;
+      continue;
+    }
+    it->second.buffer->Release();
+    m_stats.entries--;
+    m_stats.memory -= it->second.memory;
+    m_entries.erase(it++);
+  }
+}
+
+void light_bake_cache_t::clear( void )
+{
+  for (std::map<unsigned long long, entry_t>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    it->second.buffer->Release();
+  m_entries.clear();
+  m_lighting_key = 0;
+  m_stats.entries = 0;
+  m_stats.memory = 0;
+}
+
+baked_lighting_binder_t::baked_lighting_binder_t( recursive_data_t &rd, color_t const &albedo ) : m_rd(rd)
+{
+  IDirect3DDevice9 *device = rd.device;
+
+  m_is_lit = rd.lights->reapply(device, true) > 0;
+  if (!m_is_lit)
+  {
+    /* Baked colors are the final ones */
+    device->SetRenderState(D3DRS_LIGHTING, FALSE);
+    return;
+  }
+
+  D3DMATERIAL9 material;
+  memset(&material, 0, sizeof(material));
+  material.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&albedo);
+  material.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&albedo);
+  device->GetMaterial(&m_saved_material);
+  device->SetMaterial(&material);
+  device->SetRenderState(D3DRS_EMISSIVEMATERIALSOURCE, D3DMCS_COLOR1);
+  device->SetRenderState(D3DRS_DIFFUSEMATERIALSOURCE, D3DMCS_MATERIAL);
+}
+
+baked_lighting_binder_t::~baked_lighting_binder_t()
+{
+  IDirect3DDevice9 *device = m_rd.device;
+
+  if (m_is_lit)
+  {
+    device->SetRenderState(D3DRS_EMISSIVEMATERIALSOURCE, D3DMCS_MATERIAL);
+    device->SetRenderState(D3DRS_DIFFUSEMATERIALSOURCE, D3DMCS_COLOR1);
+    device->SetMaterial(&m_saved_material);
+  }
+  else
+    device->SetRenderState(D3DRS_LIGHTING, TRUE);
+  m_rd.lights->reapply(device, false);
+}
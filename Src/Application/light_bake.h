@@ -0,0 +1,106 @@
+/**
+@file     light_bake.h
+@brief    Static lights baking into vertex colors definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __LIGHT_BAKE_INCLUDED__
+#define __LIGHT_BAKE_INCLUDED__
+
+#include <map>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "lighting.h"
+#include "unit.h"
+
+/* Lights which do not change while static geometry is drawn, with D3DRS_AMBIENT */
+struct static_lighting_t
+{
+  std::vector<soft_light_t> lights;
+  color_t ambient;
+
+  static_lighting_t() : ambient(0.f) {}
+
+  /* Baked colors stay valid while the key is the same */
+  unsigned long long key( void ) const;
+  /* Point or spot lights make baked colors depend on geometry position */
+  bool is_positional( void ) const;
+};
+
+/* Replace colors of vertices by their diffuse and ambient lighting by static lights.
+ * Vertices have base_geometry_t::vertex_t layout: position, normal and ARGB color at 0, 12, 24,
+ * vertex colors are the material. Specular term depends on the view and is not baked.
+ * 'baked' receives copies of vertices, it may be locked device buffer. Runs on worker threads. */
+void bake_vertex_colors( static_lighting_t const &lighting, transform_t const &world, void const *vertices,
+                         unsigned int vertex_size, unsigned int count, void *baked, unsigned int threads = 0 );
+
+struct light_bake_stats_t
+{
+  unsigned int requests;
+  unsigned int bakes;
+  unsigned int entries;
+  unsigned int baked_vertices;
+  double bake_ms;               /* all bakes since start */
+  size_t memory;                /* bytes of baked vertex buffers */
+};
+
+/* Device vertex buffers with baked static lighting keyed by geometry, lighting and world
+ * transform. Entries are dropped when static lighting changes. Render thread only. */
+class light_bake_cache_t
+{
+public:
+  light_bake_cache_t();
+
+  /* Baked copy of geometry vertices, NULL if it can not be created */
+  IDirect3DVertexBuffer9 * get( IDirect3DDevice9 *device, void const *geometry, void const *vertices,
+                                unsigned int vertex_size, unsigned int count, unsigned int fvf,
+                                transform_t const &world, static_lighting_t const &lighting );
+
+  light_bake_stats_t const & stats( void ) const { return m_stats; }
+
+  /* Release bakes of geometry, must be called before its vertices are destroyed or reused */
+  void forget( void const *geometry );
+
+  /* Release all baked buffers, must be called before device destruction */
+  void clear( void );
+private:
+  light_bake_cache_t( light_bake_cache_t const & );
+  light_bake_cache_t & operator=( light_bake_cache_t const & );
+
+  struct entry_t
+  {
+    void const *geometry;
+    IDirect3DVertexBuffer9 *buffer;
+    size_t memory;
+  };
+
+  std::map<unsigned long long, entry_t> m_entries;
+  unsigned long long m_lighting_key;
+  light_bake_stats_t m_stats;
+};
+
+/* Application wide baked lighting cache */
+light_bake_cache_t & light_bake_cache( void );
+
+/* Device state for drawing geometry with baked colors: they become emissive, uniform
+ * material color is lit by dynamic lights only, lighting is off when there are none.
+ * Previous lights selection, material and render states are restored on destruction. */
+class baked_lighting_binder_t
+{
+public:
+  baked_lighting_binder_t( recursive_data_t &rd, color_t const &albedo );
+  ~baked_lighting_binder_t();
+private:
+  baked_lighting_binder_t( baked_lighting_binder_t const & );
+  baked_lighting_binder_t & operator=( baked_lighting_binder_t const & );
+
+  recursive_data_t &m_rd;
+  D3DMATERIAL9 m_saved_material;
+  bool m_is_lit;
+};
+
+#endif /* __LIGHT_BAKE_INCLUDED__ */
@@ -0,0 +1,601 @@
+/**
+@file     light_clusters.cpp
+@brief    Clustered lights manager implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "lights.h"
+#include "parallel.h"
+#include "stopwatch.h"
+#include "light_clusters.h"
+
+namespace
+{
+  /* Lights weaker than this at the draw are not selected */
+  const float c_min_contribution = 1e-3f;
+
+  vec_t view_point( matrix_t const &m, vec_t const &p )
+  {
+    return vec_t(p.x * m.M[0][0] + p.y * m.M[1][0] + p.z * m.M[2][0] + m.M[3][0],
+                 p.x * m.M[0][1] + p.y * m.M[1][1] + p.z * m.M[2][1] + m.M[3][1],
+                 p.x * m.M[0][2] + p.y * m.M[1][2] + p.z * m.M[2][2] + m.M[3][2]);
+  }
+
+  vec_t view_vector( matrix_t const &m, vec_t const &v )
+  {
+    return vec_t(v.x * m.M[0][0] + v.y * m.M[1][0] + v.z * m.M[2][0],
+                 v.x * m.M[0][1] + v.y * m.M[1][1] + v.z * m.M[2][1],
+                 v.x * m.M[0][2] + v.y * m.M[1][2] + v.z * m.M[2][2]);
+  }
+
+  float dot( vec_t const &a, vec_t const &b )
+  {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+
+  /* Squared distance from point to box */
+  float distance2( vec_t const &p, vec_t const &box_min, vec_t const &box_max )
+  {
+    float const dx = p.x < box_min.x ? box_min.x - p.x : p.x > box_max.x ? p.x - box_max.x : 0;
+    float const dy = p.y < box_min.y ? box_min.y - p.y : p.y > box_max.y ? p.y - box_max.y : 0;
+    float const dz = p.z < box_min.z ? box_min.z - p.z : p.z > box_max.z ? p.z - box_max.z : 0;
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  /* Does the cone (apex, unit axis, half angle, height) miss the sphere */
+  bool cone_culls_sphere( vec_t const &apex, vec_t const &axis, float cos_cone, float sin_cone, float height,
+                          vec_t const &center, float radius )
+  {
+    vec_t const v = center - apex;
+    float const length2 = dot(v, v);
+    float const along = dot(v, axis);
+    float const closest = cos_cone * sqrtf(std::max(length2 - along * along, 0.f)) - along * sin_cone;
+
+    return closest > radius || along > height + radius || along < -radius;
+  }
+
+  float luminance( color_t const &c )
+  {
+    return 0.299f * c.r + 0.587f * c.g + 0.114f * c.b;
+  }
+
+  /* Tile of normalized device coordinate, clamped to the grid */
+  unsigned int tile_of( float ndc, unsigned int tiles )
+  {
+    float const t = (ndc + 1) * 0.5f * tiles;
+    return t <= 0 ? 0 : t >= tiles ? tiles - 1 : (unsigned int)t;
+  }
+
+  float random( float min, float max )
+  {
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+  }
+}
+
+light_manager_t::light_manager_t()
+   : m_frame_memory(&frame_memory()), m_offset(0, 0, 0), m_scale_x(1), m_scale_y(1), m_near(1), m_far(2), m_log_far_near(1), m_applied_radius(0)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+  memset(m_slots, 0, sizeof(m_slots));
+}
+
+void light_manager_t::set_params( light_cluster_params_t const &params )
+{
+  m_params = params;
+  if (m_params.tiles_x == 0)
+    m_params.tiles_x = 1;
+  if (m_params.tiles_y == 0)
+    m_params.tiles_y = 1;
+  if (m_params.slices == 0)
+    m_params.slices = 1;
+  m_cluster_min.clear();
+}
+
+void light_manager_t::begin_frame( void )
+{
+  m_lights.clear();
+  m_sources.clear();
+  m_offset = vec_t(0, 0, 0);
+  m_global.clear();
+  m_stats.selections_count = 0;
+  m_stats.uploads_count = 0;
+  m_stats.uploads_avoided = 0;
+  m_stats.enables_count = 0;
+}
+
+unsigned int light_manager_t::add( soft_light_t const &light, bool is_static )
+{
+  light_source_t const source = {NULL, 0, is_static};
+
+  m_lights.push_back(light);
+  if (light.type != soft_light_t::DIRECTIONAL)
+    m_lights.back().position += m_offset;
+  m_sources.push_back(source);
+  return (unsigned int)m_lights.size() - 1;
+}
+
+void light_manager_t::add( light_t const &light, bool is_static )
+{
+  if (!light.get_state())
+    return;
+  if (m_offset.x != 0 || m_offset.y != 0 || m_offset.z != 0)
+  {
+    add(light.soft_light(), is_static);
+    return;
+  }
+
+  light_source_t const source = {&light, light.version(), is_static};
+  m_lights.push_back(light.soft_light());
+  m_sources.push_back(source);
+}
+
+unsigned int light_manager_t::slice_of( float z ) const
+{
+  if (z <= m_near)
+    return 0;
+  float const s = logf(z / m_near) / m_log_far_near * m_params.slices;
+  return s >= m_params.slices ? m_params.slices - 1 : (unsigned int)s;
+}
+
+void light_manager_t::update_clusters( matrix_t const &projection )
+{
+  /* Perspective projection maps view depth z to a + b / z, near and far planes are where it is
+   * 0 and 1 in either order (reversed depth). Infinite far plane is cut at 1e4 near distances */
+  float const a = projection.M[2][2], b = projection.M[3][2];
+  float const zero_z = a != 0 ? -b / a : 0, one_z = a != 1 ? b / (1 - a) : 0;
+  float near_z, far_z;
+  if (zero_z > 0 && one_z > 0)
+  {
+    near_z = cglmath::Min(zero_z, one_z);
+    far_z = cglmath::Max(zero_z, one_z);
+  }
+  else
+  {
+    near_z = zero_z > 0 ? zero_z : one_z > 0 ? one_z : 1;
+    far_z = near_z * 1e4f;
+  }
+
+  if (!m_cluster_min.empty() && m_scale_x == projection.M[0][0] && m_scale_y == projection.M[1][1] &&
+      m_near == near_z && m_far == far_z)
+    return;
+
+  m_scale_x = projection.M[0][0];
+  m_scale_y = projection.M[1][1];
+  m_near = near_z > 0 ? near_z : 1e-3f;
+  m_far = far_z > m_near ? far_z : m_near * 2;
+  m_log_far_near = logf(m_far / m_near);
+
+  /* View space box of every cluster */
+  unsigned int const tiles_x = m_params.tiles_x, tiles_y = m_params.tiles_y, slices = m_params.slices;
+  m_cluster_min.resize(tiles_x * tiles_y * slices);
+  m_cluster_max.resize(m_cluster_min.size());
+  for (unsigned int s = 0; s < slices; ++s)
+  {
+    float const z0 = m_near * expf(m_log_far_near * s / slices);
+    float const z1 = m_near * expf(m_log_far_near * (s + 1) / slices);
+
+    for (unsigned int y = 0; y < tiles_y; ++y)
+      for (unsigned int x = 0; x < tiles_x; ++x)
+      {
+        float const x0 = -1 + 2.f * x / tiles_x, x1 = -1 + 2.f * (x + 1) / tiles_x;
+        float const y0 = -1 + 2.f * y / tiles_y, y1 = -1 + 2.f * (y + 1) / tiles_y;
+        unsigned int const cluster = (s * tiles_y + y) * tiles_x + x;
+
+        m_cluster_min[cluster] = vec_t(std::min(x0 * z0, x0 * z1) / m_scale_x, std::min(y0 * z0, y0 * z1) / m_scale_y, z0);
+        m_cluster_max[cluster] = vec_t(std::max(x1 * z0, x1 * z1) / m_scale_x, std::max(y1 * z0, y1 * z1) / m_scale_y, z1);
+      }
+  }
+}
+
+bool light_manager_t::bound_light( soft_light_t const &light, light_bounds_t &bounds ) const
+{
+  vec_t const position = view_point(m_view, light.position);
+  float const half_cone = light.phi * 0.5f;
+
+  bounds.is_spot = light.type == soft_light_t::SPOT && half_cone < cglmath::c_pif * 0.5f;
+  bounds.position = position;
+  bounds.center = position;
+  bounds.radius = light.range;
+  if (bounds.is_spot)
+  {
+    vec_t axis = view_vector(m_view, light.direction);
+    float const length = sqrtf(dot(axis, axis));
+
+    if (length <= 0)
+      return false;
+    axis /= length;
+    bounds.axis = axis;
+    bounds.cos_cone = cosf(half_cone);
+    bounds.sin_cone = sinf(half_cone);
+
+    /* Smallest sphere around the cone */
+    if (half_cone > cglmath::c_pif * 0.25f)
+    {
+      bounds.center = position + axis * (light.range * bounds.cos_cone);
+      bounds.radius = light.range * bounds.sin_cone;
+    }
+    else
+    {
+      bounds.radius = light.range / (2 * bounds.cos_cone);
+      bounds.center = position + axis * bounds.radius;
+    }
+  }
+
+  vec_t const &c = bounds.center;
+  float const r = bounds.radius;
+  float const z_min = std::max(c.z - r, m_near), z_max = std::min(c.z + r, m_far);
+  if (z_min > z_max)
+    return false;
+
+  /* Screen extents of the sphere box, smallest depth gives widest projection of far from axis side */
+  float const x_lo = c.x - r, x_hi = c.x + r, y_lo = c.y - r, y_hi = c.y + r;
+  float const ndc_x0 = x_lo * m_scale_x / (x_lo < 0 ? z_min : z_max);
+  float const ndc_x1 = x_hi * m_scale_x / (x_hi > 0 ? z_min : z_max);
+  float const ndc_y0 = y_lo * m_scale_y / (y_lo < 0 ? z_min : z_max);
+  float const ndc_y1 = y_hi * m_scale_y / (y_hi > 0 ? z_min : z_max);
+  if (ndc_x0 > 1 || ndc_x1 < -1 || ndc_y0 > 1 || ndc_y1 < -1)
+    return false;
+
+  bounds.slice_min = slice_of(z_min);
+  bounds.slice_max = slice_of(z_max);
+  bounds.tile_min_x = tile_of(ndc_x0, m_params.tiles_x);
+  bounds.tile_max_x = tile_of(ndc_x1, m_params.tiles_x);
+  bounds.tile_min_y = tile_of(ndc_y0, m_params.tiles_y);
+  bounds.tile_max_y = tile_of(ndc_y1, m_params.tiles_y);
+  return true;
+}
+
+unsigned int const * light_manager_t::assign_slice( unsigned int slice, unsigned int *counts, size_t &indices_count ) const
+{
+  unsigned int const tiles_x = m_params.tiles_x, slice_clusters = m_params.tiles_x * m_params.tiles_y;
+  unsigned int const first_cluster = slice * slice_clusters;
+
+  /* Pairs are bounded by the tiles of lights crossing the slice */
+  size_t max_pairs = 0;
+  for (unsigned int i = 0; i < m_bounds.size(); ++i)
+  {
+    light_bounds_t const &b = m_bounds[i];
+    if (b.visible && slice >= b.slice_min && slice <= b.slice_max)
+      max_pairs += (b.tile_max_x - b.tile_min_x + 1) * (b.tile_max_y - b.tile_min_y + 1);
+  }
+
+  /* (cluster in slice, light) pairs, then counting sort by cluster keeps lights order */
+  unsigned int *pairs = m_frame_memory->allocate_array<unsigned int>(2 * max_pairs);
+  size_t pairs_count = 0;
+  memset(counts, 0, slice_clusters * sizeof(unsigned int));
+  for (unsigned int i = 0; i < m_bounds.size(); ++i)
+  {
+    light_bounds_t const &b = m_bounds[i];
+    if (!b.visible || slice < b.slice_min || slice > b.slice_max)
+      continue;
+
+    float const range = m_lights[i].range, radius2 = b.radius * b.radius;
+    for (unsigned int y = b.tile_min_y; y <= b.tile_max_y; ++y)
+      for (unsigned int x = b.tile_min_x; x <= b.tile_max_x; ++x)
+      {
+        unsigned int const local = y * tiles_x + x;
+        vec_t const &box_min = m_cluster_min[first_cluster + local], &box_max = m_cluster_max[first_cluster + local];
+
+        if (distance2(b.center, box_min, box_max) > radius2)
+          continue;
+        if (b.is_spot)
+        {
+          vec_t const center = (box_min + box_max) * 0.5f;
+          vec_t const half = (box_max - box_min) * 0.5f;
+          if (cone_culls_sphere(b.position, b.axis, b.cos_cone, b.sin_cone, range, center, sqrtf(dot(half, half))))
+            continue;
+        }
+        pairs[pairs_count++] = local;
+        pairs[pairs_count++] = i;
+        counts[local]++;
+      }
+  }
+
+  unsigned int *offsets = m_frame_memory->allocate_array<unsigned int>(slice_clusters);
+  offsets[0] = 0;
+  for (unsigned int c = 1; c < slice_clusters; ++c)
+    offsets[c] = offsets[c - 1] + counts[c - 1];
+  indices_count = pairs_count / 2;
+  unsigned int *indices = m_frame_memory->allocate_array<unsigned int>(indices_count);
+  for (size_t p = 0; p < pairs_count; p += 2)
+    indices[offsets[pairs[p]]++] = pairs[p + 1];
+  return indices;
+}
+
+void light_manager_t::build( matrix_t const &view, matrix_t const &projection )
+{
+  stopwatch_t timer;
+
+  m_view = view;
+  update_clusters(projection);
+
+  /* Device parameters of all lights at once, light_t keeps them converted between changes */
+  m_device_lights.resize(m_lights.size());
+  for (size_t i = 0; i < m_lights.size(); ++i)
+    m_device_lights[i] = m_sources[i].light != NULL ? m_sources[i].light->device_light() : device_light(m_lights[i]);
+
+  /* Directional lights affect everything */
+  m_global.clear();
+  m_bounds.resize(m_lights.size());
+  for (unsigned int i = 0; i < m_lights.size(); ++i)
+    if (m_lights[i].type == soft_light_t::DIRECTIONAL)
+      m_global.push_back(i);
+
+  unsigned int const threads = m_params.threads;
+  parallel_for(0, m_lights.size(), 256, [&]( size_t begin, size_t end )
+  {
+    for (size_t i = begin; i < end; ++i)
+      m_bounds[i].visible = m_lights[i].type != soft_light_t::DIRECTIONAL && bound_light(m_lights[i], m_bounds[i]);
+  }, threads);
+
+  /* Slices are independent, each one is assigned on its own thread into frame memory */
+  unsigned int const slices = m_params.slices, slice_clusters = m_params.tiles_x * m_params.tiles_y;
+  unsigned int const **slice_indices = m_frame_memory->allocate_array<unsigned int const *>(slices);
+  size_t *slice_sizes = m_frame_memory->allocate_array<size_t>(slices);
+  unsigned int *slice_counts = m_frame_memory->allocate_array<unsigned int>(slices * slice_clusters);
+  parallel_for(0, slices, 1, [&]( size_t begin, size_t end )
+  {
+    for (size_t s = begin; s < end; ++s)
+      slice_indices[s] = assign_slice((unsigned int)s, slice_counts + s * slice_clusters, slice_sizes[s]);
+  }, threads);
+
+  m_offsets.resize(slices * slice_clusters);
+  m_counts.resize(slices * slice_clusters);
+  m_indices.clear();
+  m_stats.max_cluster_lights = 0;
+  for (unsigned int s = 0; s < slices; ++s)
+  {
+    unsigned int offset = (unsigned int)m_indices.size();
+    for (unsigned int c = 0; c < slice_clusters; ++c)
+    {
+      unsigned int const cluster = s * slice_clusters + c;
+      m_offsets[cluster] = offset;
+      m_counts[cluster] = slice_counts[cluster];
+      offset += m_counts[cluster];
+      m_stats.max_cluster_lights = std::max(m_stats.max_cluster_lights, m_counts[cluster]);
+    }
+    m_indices.insert(m_indices.end(), slice_indices[s], slice_indices[s] + slice_sizes[s]);
+  }
+
+  m_stats.lights_count = (unsigned int)m_lights.size();
+  m_stats.global_count = (unsigned int)m_global.size();
+  m_stats.visible_count = 0;
+  for (size_t i = 0; i < m_bounds.size(); ++i)
+    m_stats.visible_count += m_bounds[i].visible ? 1 : 0;
+  m_stats.entries_count = (unsigned int)m_indices.size();
+  m_stats.build_ms = timer.elapsed_ms();
+}
+
+int light_manager_t::cluster_index( vec_t const &view_point ) const
+{
+  if (m_cluster_min.empty() || view_point.z < m_near || view_point.z > m_far)
+    return -1;
+
+  float const ndc_x = view_point.x * m_scale_x / view_point.z, ndc_y = view_point.y * m_scale_y / view_point.z;
+  if (ndc_x < -1 || ndc_x > 1 || ndc_y < -1 || ndc_y > 1)
+    return -1;
+  return (int)((slice_of(view_point.z) * m_params.tiles_y + tile_of(ndc_y, m_params.tiles_y)) * m_params.tiles_x +
+               tile_of(ndc_x, m_params.tiles_x));
+}
+
+unsigned int const * light_manager_t::cluster_lights( unsigned int cluster, size_t &count ) const
+{
+  if (cluster >= m_counts.size() || m_counts[cluster] == 0)
+  {
+    count = 0;
+    return NULL;
+  }
+  count = m_counts[cluster];
+  return &m_indices[m_offsets[cluster]];
+}
+
+size_t light_manager_t::select( vec_t const &center, float radius, unsigned int *indices, size_t max_count,
+                                bool dynamic_only ) const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < m_global.size() && count < max_count; ++i)
+    if (!dynamic_only || !m_sources[m_global[i]].is_static)
+      indices[count++] = m_global[i];
+  if (count == max_count || m_cluster_min.empty())
+    return count;
+
+  /* Candidates are lights of clusters overlapped by the draw sphere */
+  light_bounds_t draw;
+  soft_light_t sphere;
+  sphere.type = soft_light_t::POINT;
+  sphere.position = center;
+  sphere.range = radius;
+  sphere.phi = 0;
+  if (!bound_light(sphere, draw))
+    return count;
+
+  unsigned int *clusters = m_frame_memory->allocate_array<unsigned int>(
+    (draw.slice_max - draw.slice_min + 1) * (draw.tile_max_y - draw.tile_min_y + 1) * (draw.tile_max_x - draw.tile_min_x + 1));
+  size_t clusters_count = 0, max_candidates = 0;
+  for (unsigned int s = draw.slice_min; s <= draw.slice_max; ++s)
+    for (unsigned int y = draw.tile_min_y; y <= draw.tile_max_y; ++y)
+      for (unsigned int x = draw.tile_min_x; x <= draw.tile_max_x; ++x)
+      {
+        unsigned int const cluster = (s * m_params.tiles_y + y) * m_params.tiles_x + x;
+        if (distance2(draw.center, m_cluster_min[cluster], m_cluster_max[cluster]) <= radius * radius)
+        {
+          clusters[clusters_count++] = cluster;
+          max_candidates += m_counts[cluster];
+        }
+      }
+
+  unsigned int *candidates = m_frame_memory->allocate_array<unsigned int>(max_candidates);
+  unsigned int *candidates_end = candidates;
+  for (size_t i = 0; i < clusters_count; ++i)
+    candidates_end = std::copy(m_indices.begin() + m_offsets[clusters[i]],
+                               m_indices.begin() + m_offsets[clusters[i]] + m_counts[clusters[i]], candidates_end);
+  std::sort(candidates, candidates_end);
+  size_t const candidates_count = std::unique(candidates, candidates_end) - candidates;
+
+  /* Rank by attenuated intensity at the nearest point of the sphere */
+  std::pair<float, unsigned int> *ranked = m_frame_memory->allocate_array<std::pair<float, unsigned int> >(candidates_count);
+  size_t ranked_count = 0;
+  for (size_t i = 0; i < candidates_count; ++i)
+  {
+    soft_light_t const &light = m_lights[candidates[i]];
+    light_bounds_t const &b = m_bounds[candidates[i]];
+    vec_t const to_draw = draw.center - b.position;
+    float const distance = std::max(sqrtf(dot(to_draw, to_draw)) - radius, 0.f);
+
+    if (distance > light.range || (dynamic_only && m_sources[candidates[i]].is_static))
+      continue;
+    if (b.is_spot && cone_culls_sphere(b.position, b.axis, b.cos_cone, b.sin_cone, light.range, draw.center, radius))
+      continue;
+
+    float const attenuation = light.attenuation0 + (light.attenuation1 + light.attenuation2 * distance) * distance;
+    float const contribution = (luminance(light.diffuse) + luminance(light.ambient)) /
+                               (attenuation > 1e-6f ? attenuation : 1e-6f);
+    if (contribution >= c_min_contribution)
+      ranked[ranked_count++] = std::make_pair(-contribution, candidates[i]);
+  }
+
+  size_t const taken = std::min(ranked_count, max_count - count);
+  std::partial_sort(ranked, ranked + taken, ranked + ranked_count);
+  for (size_t i = 0; i < taken; ++i)
+    indices[count++] = ranked[i].second;
+  return count;
+}
+
+unsigned int light_manager_t::apply( IDirect3DDevice9 *device, vec_t const &center, float radius, bool dynamic_only )
+{
+  unsigned int indices[c_device_lights];
+  unsigned int const count = (unsigned int)select(center, radius, indices, c_device_lights, dynamic_only);
+
+  m_applied_center = center;
+  m_applied_radius = radius;
+  m_stats.selections_count++;
+  if (device == NULL)
+    return count;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    device_slot_t &slot = m_slots[i];
+    light_source_t const &source = m_sources[indices[i]];
+    D3DLIGHT9 const &light = m_device_lights[indices[i]];
+
+    /* Same unchanged light source or same parameters are already in the slot */
+    bool const same = slot.valid && (source.light != NULL ? slot.source.light == source.light && slot.source.version == source.version :
+                                                            memcmp(&slot.light, &light, sizeof(light)) == 0);
+    if (same)
+      m_stats.uploads_avoided++;
+    else
+    {
+      device->SetLight(i, &light);
+      slot.source = source;
+      slot.light = light;
+      slot.valid = true;
+      m_stats.uploads_count++;
+    }
+    if (!slot.enabled)
+    {
+      device->LightEnable(i, TRUE);
+      slot.enabled = true;
+      m_stats.enables_count++;
+    }
+  }
+  for (unsigned int i = count; i < c_device_lights; ++i)
+    if (m_slots[i].enabled)
+    {
+      device->LightEnable(i, FALSE);
+      m_slots[i].enabled = false;
+      m_stats.enables_count++;
+    }
+  return count;
+}
+
+unsigned int light_manager_t::reapply( IDirect3DDevice9 *device, bool dynamic_only )
+{
+  return apply(device, m_applied_center, m_applied_radius, dynamic_only);
+}
+
+void light_manager_t::reset_device( IDirect3DDevice9 *device )
+{
+  for (unsigned int i = 0; i < c_device_lights; ++i)
+    if (m_slots[i].enabled && device != NULL)
+      device->LightEnable(i, FALSE);
+  memset(m_slots, 0, sizeof(m_slots));
+}
+
+light_cluster_benchmark_t benchmark_light_clusters( unsigned int lights_count, unsigned int threads )
+{
+  light_cluster_benchmark_t result;
+  result.lights_count = lights_count;
+  result.threads_count = threads == 0 ? parallel_threads_count() : threads;
+
+  camera_t camera;
+  vec_t location(5, 5, 5.f), look_at(0.f), up(0.f, 1.f, 0.f);
+  camera.set_camera(location, look_at, up, true);
+  camera.set_near_far(0.5, 10000.f);
+
+  light_cluster_params_t params;
+  params.threads = threads;
+  light_manager_t manager;
+  frame_allocator_t memory;
+  manager.set_params(params);
+  manager.set_frame_memory(&memory);
+
+  /* Half point, half spot lights over the flowers field */
+  srand(1);
+  manager.begin_frame();
+  for (unsigned int i = 0; i < lights_count; ++i)
+  {
+    soft_light_t light;
+
+    light.type = i % 2 == 0 ? soft_light_t::POINT : soft_light_t::SPOT;
+    light.diffuse = color_t(random(0, 1), random(0, 1), random(0, 1));
+    light.ambient = color_t(0.f);
+    light.specular = color_t(0.f);
+    light.position = vec_t(random(-25, 25), random(0, 5), random(-25, 25));
+    light.direction = vec_t(random(-1, 1), -1, random(-1, 1));
+    light.range = random(1, 8);
+    light.falloff = 1;
+    light.attenuation0 = 1;
+    light.attenuation1 = 0.1f;
+    light.attenuation2 = 0;
+    light.theta = cglmath::Deg2Rad(random(10, 40));
+    light.phi = light.theta + cglmath::Deg2Rad(10.f);
+    manager.add(light);
+  }
+
+  int const builds = 10;
+  stopwatch_t timer;
+  for (int i = 0; i < builds; ++i)
+  {
+    memory.reset();
+    manager.build(camera.get_view_matrix(), camera.get_projection_matrix());
+  }
+  result.build_ms = timer.elapsed_ms() / builds;
+
+  int const draws = 1000;
+  unsigned int indices[light_manager_t::c_device_lights];
+  timer.restart();
+  for (int i = 0; i < draws; ++i)
+  {
+    memory.reset();
+    manager.select(vec_t(random(-20, 20), 0.5f, random(-20, 20)), 1.f, indices, light_manager_t::c_device_lights);
+  }
+  result.select_us = timer.elapsed_ms() * 1000 / draws;
+
+  size_t non_empty = 0, entries = 0;
+  unsigned int const clusters = params.tiles_x * params.tiles_y * params.slices;
+  for (unsigned int c = 0; c < clusters; ++c)
+  {
+    size_t count;
+    manager.cluster_lights(c, count);
+    non_empty += count > 0 ? 1 : 0;
+    entries += count;
+  }
+  result.mean_cluster_lights = non_empty > 0 ? (double)entries / non_empty : 0;
+  return result;
+}
@@ -0,0 +1,179 @@
+/**
+@file     light_clusters.h
+@brief    Clustered lights manager definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __LIGHT_CLUSTERS_INCLUDED__
+#define __LIGHT_CLUSTERS_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "allocators.h"
+#include "lighting.h"
+
+class light_t;
+
+/* View space cluster grid: screen tiles by exponential depth slices */
+struct light_cluster_params_t
+{
+  unsigned int tiles_x;
+  unsigned int tiles_y;
+  unsigned int slices;
+  unsigned int threads;         /* 0 means all hardware threads */
+
+  light_cluster_params_t() : tiles_x(16), tiles_y(9), slices(24), threads(0) {}
+};
+
+struct light_cluster_stats_t
+{
+  unsigned int lights_count;    /* submitted this frame */
+  unsigned int global_count;    /* directional lights, affect every cluster */
+  unsigned int visible_count;   /* local lights touching at least one cluster */
+  unsigned int entries_count;   /* cluster light list entries */
+  unsigned int max_cluster_lights;
+  unsigned int selections_count;
+  unsigned int uploads_count;   /* SetLight() calls */
+  unsigned int uploads_avoided; /* selected lights already in their device slot */
+  unsigned int enables_count;   /* LightEnable() calls */
+  double build_ms;
+};
+
+/* Collects lights of a frame and assigns them to clusters of the view frustum by their
+ * range spheres and spot cones. Draws then get their most affecting lights (fixed
+ * function pipeline slots, see apply()) and per pixel backends may read cluster light lists.
+ * Directional lights are not clustered, they are first in every selection.
+ * Device lights of the frame are prepared by build(), apply() only uploads slots whose
+ * light or its version differs from the one already bound.
+ * Static lights may be excluded from selection for draws with baked lighting (see light_bake.h).
+ * Usage per frame: begin_frame(), add() lights, build(), select()/apply() per draw.
+ * Transient lists of build() and select() live in frame memory, it is reset between frames */
+class light_manager_t
+{
+public:
+  /* Fixed function pipeline lights count */
+  static const unsigned int c_device_lights = 8;
+
+  light_manager_t();
+
+  void set_params( light_cluster_params_t const &params );
+  light_cluster_params_t const & params( void ) const { return m_params; }
+  /* frame_memory() by default */
+  void set_frame_memory( frame_allocator_t *memory ) { m_frame_memory = memory; }
+
+  void begin_frame( void );
+  /* Translation of lights added after it into render space, lights of units placed away
+   * from the frame origin are moved by it (see world_stack_t). Reset by begin_frame() */
+  void set_offset( vec_t const &offset ) { m_offset = offset; }
+  /* Returns light index in lights() */
+  unsigned int add( soft_light_t const &light, bool is_static = false );
+  /* Adds enabled lights only, the light is identified by address and version for device uploads,
+   * by parameters when it is added with an offset */
+  void add( light_t const &light, bool is_static = false );
+  /* Assign lights to clusters of the camera frustum, D3D style row vector matrices */
+  void build( matrix_t const &view, matrix_t const &projection );
+
+  std::vector<soft_light_t> const & lights( void ) const { return m_lights; }
+
+  /* Indices of up to max_count lights most affecting world space sphere, strongest first */
+  size_t select( vec_t const &center, float radius, unsigned int *indices, size_t max_count, bool dynamic_only = false ) const;
+  /* Bind selected lights to device slots 0.., other slots enabled by previous apply() are disabled.
+   * Returns bound lights count */
+  unsigned int apply( IDirect3DDevice9 *device, vec_t const &center, float radius, bool dynamic_only = false );
+  /* Select lights again for the sphere of the last apply() */
+  unsigned int reapply( IDirect3DDevice9 *device, bool dynamic_only );
+  /* Disable device lights enabled by apply() and forget device slots content */
+  void reset_device( IDirect3DDevice9 *device );
+
+  /* Cluster of view space point, -1 when it is out of the frustum */
+  int cluster_index( vec_t const &view_point ) const;
+  /* Local lights of the cluster, directional ones are in global_lights() */
+  unsigned int const * cluster_lights( unsigned int cluster, size_t &count ) const;
+  std::vector<unsigned int> const & global_lights( void ) const { return m_global; }
+
+  light_cluster_stats_t const & stats( void ) const { return m_stats; }
+private:
+  /* Light bounds in view space */
+  struct light_bounds_t
+  {
+    vec_t center;               /* range sphere */
+    float radius;
+    vec_t position;             /* cone apex and axis for spot lights */
+    vec_t axis;
+    float cos_cone;
+    float sin_cone;
+    bool is_spot;
+    unsigned int slice_min, slice_max;
+    unsigned int tile_min_x, tile_max_x, tile_min_y, tile_max_y;
+    bool visible;
+  };
+
+  /* Origin of a frame light */
+  struct light_source_t
+  {
+    light_t const *light;       /* NULL for lights added by parameters */
+    unsigned int version;
+    bool is_static;
+  };
+
+  /* Device light slot content */
+  struct device_slot_t
+  {
+    light_source_t source;
+    D3DLIGHT9 light;
+    bool valid;
+    bool enabled;
+  };
+
+  void update_clusters( matrix_t const &projection );
+  bool bound_light( soft_light_t const &light, light_bounds_t &bounds ) const;
+  unsigned int slice_of( float z ) const;
+  /* Lights of slice clusters sorted by cluster in frame memory, 'counts' are per cluster of slice */
+  unsigned int const * assign_slice( unsigned int slice, unsigned int *counts, size_t &indices_count ) const;
+
+  light_cluster_params_t m_params;
+  frame_allocator_t *m_frame_memory;
+
+  std::vector<soft_light_t> m_lights;
+  std::vector<light_source_t> m_sources;
+  vec_t m_offset;
+  std::vector<D3DLIGHT9> m_device_lights;
+  std::vector<unsigned int> m_global;
+  std::vector<light_bounds_t> m_bounds;
+
+  /* Frustum: projection scales, near and far planes; clusters view space boxes */
+  matrix_t m_view;
+  float m_scale_x, m_scale_y;
+  float m_near, m_far;
+  float m_log_far_near;
+  std::vector<vec_t> m_cluster_min, m_cluster_max;
+
+  /* Cluster light lists, cluster = (slice * tiles_y + y) * tiles_x + x */
+  std::vector<unsigned int> m_offsets;
+  std::vector<unsigned int> m_counts;
+  std::vector<unsigned int> m_indices;
+
+  device_slot_t m_slots[c_device_lights];
+  vec_t m_applied_center;
+  float m_applied_radius;
+  light_cluster_stats_t m_stats;
+};
+
+/* Cluster build time of random point and spot lights around the initial camera view */
+struct light_cluster_benchmark_t
+{
+  unsigned int lights_count;
+  unsigned int threads_count;
+  double build_ms;              /* mean of several builds */
+  double select_us;             /* mean select() time of 8 lights for a draw */
+  double mean_cluster_lights;   /* over non empty clusters */
+};
+
+light_cluster_benchmark_t benchmark_light_clusters( unsigned int lights_count, unsigned int threads );
+
+#endif /* __LIGHT_CLUSTERS_INCLUDED__ */
@@ -0,0 +1,501 @@
+/**
+@file     lighting.cpp
+@brief    CPU fixed function lighting evaluator implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "stopwatch.h"
+#include "lighting.h"
+
+namespace
+{
+  /* Lengths below are treated as zero */
+  const float c_min_length2 = 1e-20f;
+  /* 1 / (cos_half_theta - cos_half_phi) for equal cones: step function */
+  const float c_max_inv_cone = 1e20f;
+
+  float clamp01( float value )
+  {
+    return value < 0 ? 0 : value > 1 ? 1 : value;
+  }
+
+  /*** SSE helpers ***/
+
+  __m128 rsqrt_ps( __m128 x )
+  {
+    /* Estimate refined by one Newton-Raphson step */
+    __m128 const r = _mm_rsqrt_ps(x);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.f), _mm_mul_ps(_mm_mul_ps(x, r), r)));
+  }
+
+  __m128 clamp01_ps( __m128 x )
+  {
+    return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.f));
+  }
+
+  __m128 dot_ps( __m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz )
+  {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+  }
+
+  /* Natural logarithm of positive values, Cephes logf polynomial */
+  __m128 log_ps( __m128 x )
+  {
+    __m128i const bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+    /* Mantissa in [0.5, 1) */
+    __m128 m = _mm_or_ps(_mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(0.5f));
+
+    __m128 const is_small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    e = _mm_sub_ps(e, _mm_and_ps(is_small, _mm_set1_ps(1.f)));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(is_small, m)), _mm_set1_ps(1.f));
+
+    __m128 const z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+  }
+
+  /* Exponent, Cephes expf polynomial */
+  __m128 exp_ps( __m128 x )
+  {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.f)), _mm_set1_ps(88.f));
+
+    /* Round x / ln(2) to nearest integer */
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    fx = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, fx), _mm_set1_ps(1.f)));
+
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 const z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.f));
+
+    /* Scale by 2 ^ fx */
+    __m128i const pow2 = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(pow2));
+  }
+
+  /* x ^ p for x >= 0 as pow(): 0 ^ p is 0 for p > 0 and 1 for p == 0 */
+  __m128 pow_ps( __m128 x, float p )
+  {
+    if (p == 0)
+      return _mm_set1_ps(1.f);
+    if (p == 1)
+      return x;
+
+    /* Usual integer falloffs and specular powers by squaring */
+    int const n = (int)p;
+    if (n == p && n > 0 && n <= 256)
+    {
+      __m128 result = _mm_set1_ps(1.f), base = x;
+      for (int bits = n; ; bits >>= 1)
+      {
+        if (bits & 1)
+          result = _mm_mul_ps(result, base);
+        if (bits == 1)
+          return result;
+        base = _mm_mul_ps(base, base);
+      }
+    }
+
+    __m128 const is_positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+    __m128 const safe_x = _mm_max_ps(x, _mm_set1_ps(1e-30f));
+    return _mm_and_ps(is_positive, exp_ps(_mm_mul_ps(log_ps(safe_x), _mm_set1_ps(p))));
+  }
+
+  float pow_reference( float x, float p )
+  {
+    if (p == 0)
+      return 1;
+    return x > 0 ? (float)pow(x, p) : 0;
+  }
+}
+
+light_evaluator_t::light_evaluator_t()
+  : m_ambient(0.f)
+  , m_eye(0.f)
+{
+}
+
+void light_evaluator_t::set_lights( soft_light_t const *lights, size_t count )
+{
+  m_lights.resize(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    prepared_light_t &prepared = m_lights[i];
+
+    prepared.light = lights[i];
+    prepared.to_light = -lights[i].direction.normalizing();
+    prepared.cos_half_theta = cos(lights[i].theta / 2);
+    prepared.cos_half_phi = cos(lights[i].phi / 2);
+
+    float const cone = prepared.cos_half_theta - prepared.cos_half_phi;
+    prepared.inv_cone = cone > 1 / c_max_inv_cone ? 1 / cone : c_max_inv_cone;
+  }
+}
+
+void light_evaluator_t::evaluate4( float const *x, float const *y, float const *z, float const *nx, float const *ny, float const *nz,
+                                   float const *r, float const *g, float const *b, light_material_t const &material,
+                                   float *out[6] ) const
+{
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const px = _mm_loadu_ps(x), py = _mm_loadu_ps(y), pz = _mm_loadu_ps(z);
+  __m128 const vnx = _mm_loadu_ps(nx), vny = _mm_loadu_ps(ny), vnz = _mm_loadu_ps(nz);
+  bool const has_specular = out[3] != NULL;
+
+  __m128 ambient_r = zero, ambient_g = zero, ambient_b = zero;
+  __m128 diffuse_r = zero, diffuse_g = zero, diffuse_b = zero;
+  __m128 specular_r = zero, specular_g = zero, specular_b = zero;
+
+  /* Direction to viewer for half vectors */
+  __m128 vx = zero, vy = zero, vz = zero;
+  if (has_specular)
+  {
+    vx = _mm_sub_ps(_mm_set1_ps(m_eye.x), px);
+    vy = _mm_sub_ps(_mm_set1_ps(m_eye.y), py);
+    vz = _mm_sub_ps(_mm_set1_ps(m_eye.z), pz);
+    __m128 const inv_length = rsqrt_ps(_mm_max_ps(dot_ps(vx, vy, vz, vx, vy, vz), _mm_set1_ps(c_min_length2)));
+    vx = _mm_mul_ps(vx, inv_length);
+    vy = _mm_mul_ps(vy, inv_length);
+    vz = _mm_mul_ps(vz, inv_length);
+  }
+
+  for (size_t i = 0; i < m_lights.size(); ++i)
+  {
+    prepared_light_t const &prepared = m_lights[i];
+    soft_light_t const &light = prepared.light;
+    __m128 lx, ly, lz, attenuation;
+
+    if (light.type == soft_light_t::DIRECTIONAL)
+    {
+      lx = _mm_set1_ps(prepared.to_light.x);
+      ly = _mm_set1_ps(prepared.to_light.y);
+      lz = _mm_set1_ps(prepared.to_light.z);
+      attenuation = _mm_set1_ps(1.f);
+    }
+    else
+    {
+      lx = _mm_sub_ps(_mm_set1_ps(light.position.x), px);
+      ly = _mm_sub_ps(_mm_set1_ps(light.position.y), py);
+      lz = _mm_sub_ps(_mm_set1_ps(light.position.z), pz);
+
+      __m128 const distance2 = _mm_max_ps(dot_ps(lx, ly, lz, lx, ly, lz), _mm_set1_ps(c_min_length2));
+      __m128 const inv_distance = rsqrt_ps(distance2);
+      __m128 const distance = _mm_mul_ps(distance2, inv_distance);
+      __m128 const in_range = _mm_cmple_ps(distance, _mm_set1_ps(light.range));
+      if (_mm_movemask_ps(in_range) == 0)
+        continue;
+
+      lx = _mm_mul_ps(lx, inv_distance);
+      ly = _mm_mul_ps(ly, inv_distance);
+      lz = _mm_mul_ps(lz, inv_distance);
+
+      __m128 const denominator = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light.attenuation0), _mm_mul_ps(_mm_set1_ps(light.attenuation1), distance)),
+                                            _mm_mul_ps(_mm_set1_ps(light.attenuation2), distance2));
+      attenuation = _mm_and_ps(in_range, _mm_div_ps(_mm_set1_ps(1.f), denominator));
+
+      if (light.type == soft_light_t::SPOT)
+      {
+        /* Cosine between light direction and direction from light to vertex */
+        __m128 const rho = dot_ps(lx, ly, lz, _mm_set1_ps(prepared.to_light.x), _mm_set1_ps(prepared.to_light.y), _mm_set1_ps(prepared.to_light.z));
+        __m128 const t = clamp01_ps(_mm_mul_ps(_mm_sub_ps(rho, _mm_set1_ps(prepared.cos_half_phi)), _mm_set1_ps(prepared.inv_cone)));
+
+        attenuation = _mm_mul_ps(attenuation, pow_ps(t, light.falloff));
+        if (_mm_movemask_ps(_mm_cmpgt_ps(attenuation, zero)) == 0)
+          continue;
+      }
+    }
+
+    ambient_r = _mm_add_ps(ambient_r, _mm_mul_ps(attenuation, _mm_set1_ps(light.ambient.r)));
+    ambient_g = _mm_add_ps(ambient_g, _mm_mul_ps(attenuation, _mm_set1_ps(light.ambient.g)));
+    ambient_b = _mm_add_ps(ambient_b, _mm_mul_ps(attenuation, _mm_set1_ps(light.ambient.b)));
+
+    __m128 const n_dot_l = dot_ps(vnx, vny, vnz, lx, ly, lz);
+    __m128 const diffuse = _mm_mul_ps(_mm_max_ps(n_dot_l, zero), attenuation);
+    diffuse_r = _mm_add_ps(diffuse_r, _mm_mul_ps(diffuse, _mm_set1_ps(light.diffuse.r)));
+    diffuse_g = _mm_add_ps(diffuse_g, _mm_mul_ps(diffuse, _mm_set1_ps(light.diffuse.g)));
+    diffuse_b = _mm_add_ps(diffuse_b, _mm_mul_ps(diffuse, _mm_set1_ps(light.diffuse.b)));
+
+    if (has_specular)
+    {
+      __m128 hx = _mm_add_ps(lx, vx), hy = _mm_add_ps(ly, vy), hz = _mm_add_ps(lz, vz);
+      __m128 const inv_length = rsqrt_ps(_mm_max_ps(dot_ps(hx, hy, hz, hx, hy, hz), _mm_set1_ps(c_min_length2)));
+      __m128 const n_dot_h = _mm_max_ps(_mm_mul_ps(dot_ps(vnx, vny, vnz, hx, hy, hz), inv_length), zero);
+      __m128 const specular = _mm_and_ps(_mm_cmpgt_ps(n_dot_l, zero), _mm_mul_ps(pow_ps(n_dot_h, material.power), attenuation));
+
+      specular_r = _mm_add_ps(specular_r, _mm_mul_ps(specular, _mm_set1_ps(light.specular.r)));
+      specular_g = _mm_add_ps(specular_g, _mm_mul_ps(specular, _mm_set1_ps(light.specular.g)));
+      specular_b = _mm_add_ps(specular_b, _mm_mul_ps(specular, _mm_set1_ps(light.specular.b)));
+    }
+  }
+
+  /* Vertex colors are both diffuse and ambient material */
+  __m128 ca_r, ca_g, ca_b, cd_r, cd_g, cd_b;
+  if (r != NULL)
+  {
+    ca_r = cd_r = _mm_loadu_ps(r);
+    ca_g = cd_g = _mm_loadu_ps(g);
+    ca_b = cd_b = _mm_loadu_ps(b);
+  }
+  else
+  {
+    ca_r = _mm_set1_ps(material.ambient.r);
+    ca_g = _mm_set1_ps(material.ambient.g);
+    ca_b = _mm_set1_ps(material.ambient.b);
+    cd_r = _mm_set1_ps(material.diffuse.r);
+    cd_g = _mm_set1_ps(material.diffuse.g);
+    cd_b = _mm_set1_ps(material.diffuse.b);
+  }
+
+  ambient_r = _mm_add_ps(ambient_r, _mm_set1_ps(m_ambient.r));
+  ambient_g = _mm_add_ps(ambient_g, _mm_set1_ps(m_ambient.g));
+  ambient_b = _mm_add_ps(ambient_b, _mm_set1_ps(m_ambient.b));
+  _mm_storeu_ps(out[0], clamp01_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(material.emissive.r), _mm_mul_ps(ca_r, ambient_r)), _mm_mul_ps(cd_r, diffuse_r))));
+  _mm_storeu_ps(out[1], clamp01_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(material.emissive.g), _mm_mul_ps(ca_g, ambient_g)), _mm_mul_ps(cd_g, diffuse_g))));
+  _mm_storeu_ps(out[2], clamp01_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(material.emissive.b), _mm_mul_ps(ca_b, ambient_b)), _mm_mul_ps(cd_b, diffuse_b))));
+  if (has_specular)
+  {
+    _mm_storeu_ps(out[3], clamp01_ps(_mm_mul_ps(_mm_set1_ps(material.specular.r), specular_r)));
+    _mm_storeu_ps(out[4], clamp01_ps(_mm_mul_ps(_mm_set1_ps(material.specular.g), specular_g)));
+    _mm_storeu_ps(out[5], clamp01_ps(_mm_mul_ps(_mm_set1_ps(material.specular.b), specular_b)));
+  }
+}
+
+void light_evaluator_t::evaluate( light_batch_t const &batch, light_material_t const &material, light_output_t const &output ) const
+{
+  size_t const full_count = batch.count & ~(size_t)3;
+  float *out[6];
+
+  for (size_t i = 0; i < full_count; i += 4)
+  {
+    out[0] = output.diffuse_r + i;
+    out[1] = output.diffuse_g + i;
+    out[2] = output.diffuse_b + i;
+    out[3] = output.specular_r != NULL ? output.specular_r + i : NULL;
+    out[4] = output.specular_g != NULL ? output.specular_g + i : NULL;
+    out[5] = output.specular_b != NULL ? output.specular_b + i : NULL;
+    evaluate4(batch.x + i, batch.y + i, batch.z + i, batch.nx + i, batch.ny + i, batch.nz + i,
+              batch.r != NULL ? batch.r + i : NULL, batch.g != NULL ? batch.g + i : NULL, batch.b != NULL ? batch.b + i : NULL,
+              material, out);
+  }
+  if (full_count == batch.count)
+    return;
+
+  /* Tail is copied to zero padded groups */
+  float in[9][4], results[6][4];
+  size_t const tail = batch.count - full_count;
+  float const *sources[9] = {batch.x, batch.y, batch.z, batch.nx, batch.ny, batch.nz, batch.r, batch.g, batch.b};
+
+  memset(in, 0, sizeof(in));
+  for (int c = 0; c < 9; ++c)
+    if (sources[c] != NULL)
+      memcpy(in[c], sources[c] + full_count, tail * sizeof(float));
+  for (int c = 0; c < 6; ++c)
+    out[c] = results[c];
+  if (output.specular_r == NULL)
+    out[3] = out[4] = out[5] = NULL;
+  evaluate4(in[0], in[1], in[2], in[3], in[4], in[5],
+            batch.r != NULL ? in[6] : NULL, batch.g != NULL ? in[7] : NULL, batch.b != NULL ? in[8] : NULL, material, out);
+
+  float * const destinations[6] = {output.diffuse_r, output.diffuse_g, output.diffuse_b, output.specular_r, output.specular_g, output.specular_b};
+  for (int c = 0; c < 6; ++c)
+    if (destinations[c] != NULL)
+      memcpy(destinations[c] + full_count, results[c], tail * sizeof(float));
+}
+
+void light_evaluator_t::evaluate_reference( light_batch_t const &batch, light_material_t const &material, light_output_t const &output ) const
+{
+  bool const has_specular = output.specular_r != NULL;
+
+  for (size_t v = 0; v < batch.count; ++v)
+  {
+    vec_t const position(batch.x[v], batch.y[v], batch.z[v]);
+    vec_t const normal(batch.nx[v], batch.ny[v], batch.nz[v]);
+    color_t ambient(0.f), diffuse(0.f), specular(0.f);
+
+    vec_t to_eye = m_eye - position;
+    to_eye *= 1 / sqrt(to_eye.length2() > c_min_length2 ? to_eye.length2() : c_min_length2);
+
+    for (size_t i = 0; i < m_lights.size(); ++i)
+    {
+      prepared_light_t const &prepared = m_lights[i];
+      soft_light_t const &light = prepared.light;
+      vec_t to_light = prepared.to_light;
+      float attenuation = 1;
+
+      if (light.type != soft_light_t::DIRECTIONAL)
+      {
+        to_light = light.position - position;
+        float const distance2 = to_light.length2() > c_min_length2 ? to_light.length2() : c_min_length2;
+        float const distance = sqrt(distance2);
+        if (distance > light.range)
+          continue;
+        to_light *= 1 / distance;
+        attenuation = 1 / (light.attenuation0 + light.attenuation1 * distance + light.attenuation2 * distance2);
+
+        if (light.type == soft_light_t::SPOT)
+        {
+          float const rho = to_light.dot(prepared.to_light);
+          attenuation *= pow_reference(clamp01((rho - prepared.cos_half_phi) * prepared.inv_cone), light.falloff);
+        }
+      }
+
+      ambient.r += attenuation * light.ambient.r;
+      ambient.g += attenuation * light.ambient.g;
+      ambient.b += attenuation * light.ambient.b;
+
+      float const n_dot_l = normal.dot(to_light);
+      if (n_dot_l <= 0)
+        continue;
+      diffuse.r += n_dot_l * attenuation * light.diffuse.r;
+      diffuse.g += n_dot_l * attenuation * light.diffuse.g;
+      diffuse.b += n_dot_l * attenuation * light.diffuse.b;
+
+      if (has_specular)
+      {
+        vec_t half = to_light + to_eye;
+        half *= 1 / sqrt(half.length2() > c_min_length2 ? half.length2() : c_min_length2);
+        float const n_dot_h = normal.dot(half);
+        float const term = pow_reference(n_dot_h > 0 ? n_dot_h : 0, material.power) * attenuation;
+
+        specular.r += term * light.specular.r;
+        specular.g += term * light.specular.g;
+        specular.b += term * light.specular.b;
+      }
+    }
+
+    color_t const ca = batch.r != NULL ? color_t(batch.r[v], batch.g[v], batch.b[v]) : material.ambient;
+    color_t const cd = batch.r != NULL ? color_t(batch.r[v], batch.g[v], batch.b[v]) : material.diffuse;
+    output.diffuse_r[v] = clamp01(material.emissive.r + ca.r * (m_ambient.r + ambient.r) + cd.r * diffuse.r);
+    output.diffuse_g[v] = clamp01(material.emissive.g + ca.g * (m_ambient.g + ambient.g) + cd.g * diffuse.g);
+    output.diffuse_b[v] = clamp01(material.emissive.b + ca.b * (m_ambient.b + ambient.b) + cd.b * diffuse.b);
+    if (has_specular)
+    {
+      output.specular_r[v] = clamp01(material.specular.r * specular.r);
+      output.specular_g[v] = clamp01(material.specular.g * specular.g);
+      output.specular_b[v] = clamp01(material.specular.b * specular.b);
+    }
+  }
+}
+
+light_benchmark_t benchmark_lighting( unsigned int vertices_count, unsigned int lights_count )
+{
+  light_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.vertices_count = vertices_count;
+  result.lights_count = lights_count;
+  if (vertices_count == 0)
+    return result;
+
+  /* Deterministic pseudo random scene: vertices on 20 x 20 ground, lights above it */
+  unsigned int seed = 12345;
+  struct random_t
+  {
+    static float next( unsigned int &seed )
+    {
+      seed = seed * 1664525U + 1013904223U;
+      return (seed >> 8) / 16777216.f;
+    }
+  };
+
+  std::vector<float> data(15 * (size_t)vertices_count);
+  float *x = &data[0], *y = x + vertices_count, *z = y + vertices_count;
+  float *nx = z + vertices_count, *ny = nx + vertices_count, *nz = ny + vertices_count;
+  float *r = nz + vertices_count, *g = r + vertices_count, *b = g + vertices_count;
+  for (unsigned int i = 0; i < vertices_count; ++i)
+  {
+    vec_t const n = vec_t(random_t::next(seed) - 0.5f, 1.f, random_t::next(seed) - 0.5f).normalizing();
+
+    x[i] = random_t::next(seed) * 20 - 10;
+    y[i] = random_t::next(seed);
+    z[i] = random_t::next(seed) * 20 - 10;
+    nx[i] = n.x;
+    ny[i] = n.y;
+    nz[i] = n.z;
+    r[i] = random_t::next(seed);
+    g[i] = random_t::next(seed);
+    b[i] = random_t::next(seed);
+  }
+
+  std::vector<soft_light_t> lights(lights_count);
+  for (unsigned int i = 0; i < lights_count; ++i)
+  {
+    soft_light_t light = soft_light_t();
+
+    light.type = (soft_light_t::type_t)(soft_light_t::POINT + i % 3);
+    light.diffuse = color_t(random_t::next(seed), random_t::next(seed), random_t::next(seed));
+    light.ambient = color_t(0.05f);
+    light.specular = color_t(0.5f);
+    light.position = vec_t(random_t::next(seed) * 20 - 10, 2 + random_t::next(seed) * 3, random_t::next(seed) * 20 - 10);
+    light.direction = vec_t(random_t::next(seed) - 0.5f, -1.f, random_t::next(seed) - 0.5f);
+    light.range = 8;
+    light.falloff = 2;
+    light.attenuation0 = 1;
+    light.attenuation1 = 0.1f;
+    light.theta = 0.6f;
+    light.phi = 1.2f;
+    lights[i] = light;
+  }
+
+  light_evaluator_t evaluator;
+  light_material_t material;
+  material.specular = color_t(1.f);
+  material.power = 16;
+  evaluator.set_lights(lights.empty() ? NULL : &lights[0], lights.size());
+  evaluator.set_ambient(color_t(0.1f));
+  evaluator.set_eye(vec_t(0, 10, 10));
+
+  light_batch_t const batch = {x, y, z, nx, ny, nz, r, g, b, vertices_count};
+  float *out = &data[9 * (size_t)vertices_count];
+  float *reference_out = &data[12 * (size_t)vertices_count];
+  std::vector<float> specular(6 * (size_t)vertices_count);
+  light_output_t const output = {out, out + vertices_count, out + 2 * vertices_count,
+                                 &specular[0], &specular[vertices_count], &specular[2 * (size_t)vertices_count]};
+  light_output_t const reference_output = {reference_out, reference_out + vertices_count, reference_out + 2 * vertices_count,
+                                           &specular[3 * (size_t)vertices_count], &specular[4 * (size_t)vertices_count],
+                                           &specular[5 * (size_t)vertices_count]};
+
+  stopwatch_t timer;
+  evaluator.evaluate(batch, material, output);
+  result.simd_ms = timer.elapsed_ms();
+
+  timer.restart();
+  evaluator.evaluate_reference(batch, material, reference_output);
+  result.reference_ms = timer.elapsed_ms();
+
+  for (size_t i = 0; i < 3 * (size_t)vertices_count; ++i)
+  {
+    float const diffuse_error = fabs(out[i] - reference_out[i]);
+    float const specular_error = fabs(specular[i] - specular[i + 3 * (size_t)vertices_count]);
+
+    if (diffuse_error > result.max_error)
+      result.max_error = diffuse_error;
+    if (specular_error > result.max_error)
+      result.max_error = specular_error;
+  }
+  return result;
+}
@@ -0,0 +1,130 @@
+/**
+@file     lighting.h
+@brief    CPU fixed function lighting evaluator definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __LIGHTING_INCLUDED__
+#define __LIGHTING_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "Math/cglMath.h"
+
+/* Light source parameters, same meaning as fixed function pipeline ones */
+struct soft_light_t
+{
+  enum type_t
+  {
+    POINT = 1,
+    SPOT,
+    DIRECTIONAL
+  };
+
+  type_t type;
+  color_t diffuse;
+  color_t ambient;
+  color_t specular;
+  vec_t position;
+  vec_t direction;
+  float range;
+  float falloff;
+  float attenuation0;
+  float attenuation1;
+  float attenuation2;
+  float theta;                  /* inner cone angle in radians */
+  float phi;                    /* outer cone angle in radians */
+};
+
+/* Lit surface material, same meaning as D3DMATERIAL9 */
+struct light_material_t
+{
+  color_t diffuse;
+  color_t ambient;
+  color_t specular;
+  color_t emissive;
+  float power;
+
+  light_material_t() : diffuse(1.f), ambient(1.f), specular(0.f), emissive(0.f), power(0) {}
+};
+
+/* Vertices in structure of arrays layout: world space positions and unit length normals.
+ * Optional vertex colors replace material diffuse and ambient as with D3DMCS_COLOR1 */
+struct light_batch_t
+{
+  float const *x, *y, *z;
+  float const *nx, *ny, *nz;
+  float const *r, *g, *b;       /* NULL to use material colors */
+  size_t count;
+};
+
+/* Lit colors saturated to [0, 1], specular arrays may be NULL to skip specular term */
+struct light_output_t
+{
+  float *diffuse_r, *diffuse_g, *diffuse_b;
+  float *specular_r, *specular_g, *specular_b;
+};
+
+/* Evaluates fixed function vertex lighting for any number of lights:
+ *   diffuse  = emissive + ambient * (global ambient + sum(atten * spot * light ambient))
+ *              + diffuse * sum(atten * spot * light diffuse * N.L)
+ *   specular = specular * sum(atten * spot * light specular * N.H ^ power), only where N.L > 0
+ * with attenuation0/1/2, range, theta/phi cone and falloff of point and spot lights and
+ * local viewer half vector. Batches are evaluated 4 vertices at a time with SSE, lights state
+ * is read only during evaluation, so one evaluator may be used by several threads. */
+class light_evaluator_t
+{
+public:
+  light_evaluator_t();
+
+  void set_lights( soft_light_t const *lights, size_t count );
+  /* D3DRS_AMBIENT */
+  void set_ambient( color_t const &ambient ) { m_ambient = ambient; }
+  /* Camera position for specular half vectors */
+  void set_eye( vec_t const &eye ) { m_eye = eye; }
+
+  size_t lights_count( void ) const { return m_lights.size(); }
+
+  void evaluate( light_batch_t const &batch, light_material_t const &material, light_output_t const &output ) const;
+  /* Scalar implementation of the same model, used as evaluate() reference */
+  void evaluate_reference( light_batch_t const &batch, light_material_t const &material, light_output_t const &output ) const;
+private:
+  /* Light with values derived once per set_lights() */
+  struct prepared_light_t
+  {
+    soft_light_t light;
+    vec_t to_light;               /* normalized negative direction */
+    float cos_half_theta;
+    float cos_half_phi;
+    float inv_cone;               /* 1 / (cos_half_theta - cos_half_phi) */
+  };
+
+  void evaluate4( float const *x, float const *y, float const *z, float const *nx, float const *ny, float const *nz,
+                  float const *r, float const *g, float const *b, light_material_t const &material,
+                  float *out[6] ) const;
+
+  std::vector<prepared_light_t> m_lights;
+  color_t m_ambient;
+  vec_t m_eye;
+};
+
+/* Lighting throughput of random vertices lit by mixed direction, point and spot lights */
+struct light_benchmark_t
+{
+  unsigned int vertices_count;
+  unsigned int lights_count;
+  double simd_ms;
+  double reference_ms;
+  float max_error;              /* largest channel difference between SIMD and reference */
+
+  /* Millions of vertex-light evaluations per second */
+  double simd_rate( void ) const { return simd_ms > 0 ? (double)vertices_count * lights_count / simd_ms / 1000 : 0; }
+  double reference_rate( void ) const { return reference_ms > 0 ? (double)vertices_count * lights_count / reference_ms / 1000 : 0; }
+};
+
+light_benchmark_t benchmark_lighting( unsigned int vertices_count, unsigned int lights_count );
+
+#endif /* __LIGHTING_INCLUDED__ */
@@ -4,57 +4,95 @@
 #define __LIGHTS_INCLUDED__
 
 #include <cstring>
-#include <d3d9.h>
+#include "d3d_api.h"
 #include "Math/cglMath.h"
+#include "lighting.h"
+
+/* Device light of light parameters. Fields are copied one by one, math and device types share no layout guarantee */
+inline D3DLIGHT9 device_light( soft_light_t const &light )
+{
+  D3DLIGHT9 result;
+  D3DCOLORVALUE const diffuse = {light.diffuse.r, light.diffuse.g, light.diffuse.b, light.diffuse.a};
+  D3DCOLORVALUE const ambient = {light.ambient.r, light.ambient.g, light.ambient.b, light.ambient.a};
+  D3DCOLORVALUE const specular = {light.specular.r, light.specular.g, light.specular.b, light.specular.a};
+  D3DVECTOR const position = {light.position.x, light.position.y, light.position.z};
+  D3DVECTOR const direction = {light.direction.x, light.direction.y, light.direction.z};
+
+  result.Type = (D3DLIGHTTYPE)light.type;
+  result.Diffuse = diffuse;
+  result.Ambient = ambient;
+  result.Specular = specular;
+  result.Position = position;
+  result.Direction = direction;
+  result.Range = light.range;
+  result.Falloff = light.falloff;
+  result.Attenuation0 = light.attenuation0;
+  result.Attenuation1 = light.attenuation1;
+  result.Attenuation2 = light.attenuation2;
+  result.Theta = light.theta;
+  result.Phi = light.phi;
+  return result;
+}
 
 class light_t
 {
 public:
-  light_t() : m_enabled( -1 )
+  /* Index of lights bound by light_manager_t instead of a fixed device slot */
+  static const unsigned int c_managed_index = ~0u;
+
+  light_t() : m_light(), m_index( c_managed_index ), m_enabled( -1 ), m_version( 1 ), m_uploaded_version( 0 ), m_device_version( 0 ),
+              m_device_light()
   {
-    memset(&m_light, 0, sizeof(D3DLIGHT9));
   }
 
-  virtual ~light_t() = 0 {}
+  virtual ~light_t() = 0;
 
-  /* Add light source to device */
+  /* Add light source to device. Device may be NULL, then only state is tracked */
   virtual void set( LPDIRECT3DDEVICE9 device, unsigned int index )
   {
-    device->SetLight( m_index = index, &m_light );
+    m_index = index;
+    if (device != NULL)
+    {
+      device->SetLight( m_index, &device_light() );
+      m_uploaded_version = m_version;
+    }
     m_enabled = false;
   }
 
-  /* Update previously light source to device */
-  virtual void update( LPDIRECT3DDEVICE9 device )
+  /* Track state only, device slots are assigned per draw by light_manager_t */
+  void set_managed( void )
   {
-    if (m_enabled >= 0)
-      device->SetLight( m_index, &m_light );
+    set(NULL, c_managed_index);
   }
 
-  virtual void enable( LPDIRECT3DDEVICE9 device )
+  /* Upload light source to device when it was changed since last upload */
+  virtual void update( LPDIRECT3DDEVICE9 device )
   {
-    if (m_enabled >= 0)
+    if (m_enabled >= 0 && device != NULL && m_index != c_managed_index && m_uploaded_version != m_version)
     {
-      m_enabled = true;
-      bool k = true;
-      device->LightEnable( m_index, k );
+      device->SetLight( m_index, &device_light() );
+      m_uploaded_version = m_version;
     }
   }
 
+  virtual void enable( LPDIRECT3DDEVICE9 device )
+  {
+    set_state(device, true);
+  }
+
   virtual void disable( LPDIRECT3DDEVICE9 device )
   {
-    if (m_enabled >= 0)
-    {
-      m_enabled = false;
-      device->LightEnable( m_index, m_enabled );
-    }
+    set_state(device, false);
   }
 
   virtual void set_state( LPDIRECT3DDEVICE9 device, bool state )
   {
-    if (m_enabled >= 0)
+    if (m_enabled >= 0 && !!m_enabled != state)
     {
-      device->LightEnable( m_index, m_enabled = state );
+      m_enabled = state;
+      changed();
+      if (device != NULL && m_index != c_managed_index)
+        device->LightEnable( m_index, m_enabled );
     }
   }
 
@@ -65,12 +103,49 @@ public:
        return !!m_enabled;
     return false;
   }
+
+  /* Incremented on every parameter or state change */
+  unsigned int version( void ) const
+  {
+    return m_version;
+  }
+
+  /* Light parameters for software rasterizer and light manager */
+  soft_light_t const & soft_light( void ) const
+  {
+    return m_light;
+  }
+
+  /* Light parameters for device, converted once per change */
+  D3DLIGHT9 const & device_light( void ) const
+  {
+    if (m_device_version != m_version)
+    {
+      m_device_light = ::device_light(m_light);
+      m_device_version = m_version;
+    }
+    return m_device_light;
+  }
 protected:
-  D3DLIGHT9 m_light;
+  void changed( void )
+  {
+    m_version++;
+  }
+
+  soft_light_t m_light;
   unsigned int m_index;
   char m_enabled;
+private:
+  unsigned int m_version;
+  unsigned int m_uploaded_version;
+  mutable unsigned int m_device_version;
+  mutable D3DLIGHT9 m_device_light;
 };
 
+inline light_t::~light_t()
+{
+}
+
 class direction_light_t : public light_t
 {
 public:
@@ -79,31 +154,35 @@ public:
                      color_t const &diffuse = color_t( 1.f ),
                      color_t const &specular = color_t( 1.f ) )
   {
-    m_light.Type = D3DLIGHT_DIRECTIONAL;
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
+    m_light.type = soft_light_t::DIRECTIONAL;
+    m_light.direction = direction;
+    m_light.ambient = ambient;
+    m_light.diffuse = diffuse;
+    m_light.specular = specular;
   }
 
   void set_ambient( color_t const &ambient )
   {
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
+    m_light.ambient = ambient;
+    changed();
   }
 
   void set_diffuse( color_t const &diffuse )
   {
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
+    m_light.diffuse = diffuse;
+    changed();
   }
 
   void set_specular( color_t const &specular )
   {
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
+    m_light.specular = specular;
+    changed();
   }
 
   void set_direction( vec_t const & direction )
   {
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
+    m_light.direction = direction;
+    changed();
   }
 };
 
@@ -123,88 +202,98 @@ public:
                      color_t const &diffuse = color_t( 1.f ),
                      color_t const &specular = color_t( 1.f ) )
   {
-    m_light.Type = D3DLIGHT_SPOT;
-    m_light.Theta = theta;
-    m_light.Phi = phi;
-    m_light.Range = range;
-    m_light.Falloff = falloff;
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&pos);
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
-    m_light.Attenuation0 = attenuation0;
-    m_light.Attenuation1 = attenuation1;
-    m_light.Attenuation2 = attenuation2;
+    m_light.type = soft_light_t::SPOT;
+    m_light.theta = theta;
+    m_light.phi = phi;
+    m_light.range = range;
+    m_light.falloff = falloff;
+    m_light.position = pos;
+    m_light.direction = direction;
+    m_light.ambient = ambient;
+    m_light.diffuse = diffuse;
+    m_light.specular = specular;
+    m_light.attenuation0 = attenuation0;
+    m_light.attenuation1 = attenuation1;
+    m_light.attenuation2 = attenuation2;
   }
 
   void set_ambient( color_t const &ambient )
   {
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
+    m_light.ambient = ambient;
+    changed();
   }
 
   void set_diffuse( color_t const &diffuse )
   {
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
+    m_light.diffuse = diffuse;
+    changed();
   }
 
   void set_specular( color_t const &specular )
   {
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
+    m_light.specular = specular;
+    changed();
   }
 
   void set_direction( vec_t const & direction )
   {
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
+    m_light.direction = direction;
+    changed();
   }
 
   void set_position( vec_t const & position )
   {
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&position);
+    m_light.position = position;
+    changed();
   }
 
   void set_theta( float theta )
   {
-    m_light.Theta = theta;
+    m_light.theta = theta;
+    changed();
   }
 
   void set_phi( float phi )
   {
-    m_light.Phi = phi;
+    m_light.phi = phi;
+    changed();
   }
 
   void set_falloff( float falloff )
   {
-    m_light.Falloff = falloff;
+    m_light.falloff = falloff;
+    changed();
   }
 
   void set_range( float range )
   {
-    m_light.Range = range;
+    m_light.range = range;
+    changed();
   }
 
   void set_attenuation0( float attenuation0 )
   {
-    m_light.Attenuation0 = attenuation0;
+    m_light.attenuation0 = attenuation0;
+    changed();
   }
 
   void set_attenuation1( float attenuation1 )
   {
-    m_light.Attenuation1 = attenuation1;
+    m_light.attenuation1 = attenuation1;
+    changed();
   }
 
   void set_attenuation2( float attenuation2 )
   {
-    m_light.Attenuation2 = attenuation2;
+    m_light.attenuation2 = attenuation2;
+    changed();
   }
 
   void transform( transform_t &t )
   {
-    vec_t const pos = t.transform_point( *reinterpret_cast<vec_t const *>(&m_light.Position) );
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&pos);
-
-    vec_t const direction = t.transform_vector( *reinterpret_cast<vec_t const *>(&m_light.Direction) );
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
+    m_light.position = t.transform_point( m_light.position );
+    m_light.direction = t.transform_vector( m_light.direction );
+    changed();
   }
 };
 
@@ -221,70 +310,77 @@ public:
      color_t const &diffuse = color_t( 1.f ),
      color_t const &specular = color_t( 1.f ) )
   {
-    m_light.Type = D3DLIGHT_POINT;
-    m_light.Range = range;
-    m_light.Falloff = falloff;
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&pos);
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
-    m_light.Attenuation0 = attenuation0;
-    m_light.Attenuation1 = attenuation1;
-    m_light.Attenuation2 = attenuation2;
+    m_light.type = soft_light_t::POINT;
+    m_light.range = range;
+    m_light.falloff = falloff;
+    m_light.position = pos;
+    m_light.ambient = ambient;
+    m_light.diffuse = diffuse;
+    m_light.specular = specular;
+    m_light.attenuation0 = attenuation0;
+    m_light.attenuation1 = attenuation1;
+    m_light.attenuation2 = attenuation2;
   }
 
   void set_ambient( color_t const &ambient )
   {
-    m_light.Ambient = *reinterpret_cast<D3DCOLORVALUE const *>(&ambient);
+    m_light.ambient = ambient;
+    changed();
   }
 
   void set_diffuse( color_t const &diffuse )
   {
-    m_light.Diffuse = *reinterpret_cast<D3DCOLORVALUE const *>(&diffuse);
+    m_light.diffuse = diffuse;
+    changed();
   }
 
   void set_specular( color_t const &specular )
   {
-    m_light.Specular = *reinterpret_cast<D3DCOLORVALUE const *>(&specular);
+    m_light.specular = specular;
+    changed();
   }
 
   void set_position( vec_t const & position )
   {
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&position);
+    m_light.position = position;
+    changed();
   }
 
   void set_falloff( float falloff )
   {
-    m_light.Falloff = falloff;
+    m_light.falloff = falloff;
+    changed();
   }
 
   void set_range( float range )
   {
-    m_light.Range = range;
+    m_light.range = range;
+    changed();
   }
 
   void set_attenuation0( float attenuation0 )
   {
-    m_light.Attenuation0 = attenuation0;
+    m_light.attenuation0 = attenuation0;
+    changed();
   }
 
   void set_attenuation1( float attenuation1 )
   {
-    m_light.Attenuation1 = attenuation1;
+    m_light.attenuation1 = attenuation1;
+    changed();
   }
 
   void set_attenuation2( float attenuation2 )
   {
-    m_light.Attenuation2 = attenuation2;
+    m_light.attenuation2 = attenuation2;
+    changed();
   }
 
   void transform( transform_t &t )
   {
-    vec_t const pos = t.transform_point( *reinterpret_cast<vec_t const *>(&m_light.Position) );
-    m_light.Position = *reinterpret_cast<D3DVECTOR const *>(&pos);
-
-    vec_t const direction = t.transform_vector( *reinterpret_cast<vec_t const *>(&m_light.Direction) );
-    m_light.Direction = *reinterpret_cast<D3DVECTOR const *>(&direction);
+    m_light.position = t.transform_point( m_light.position );
+    m_light.direction = t.transform_vector( m_light.direction );
+    changed();
   }
 };
 
@@ -9,10 +9,17 @@
 // *******************************************************************
 // includes
 
+#ifdef _WIN32
 #include "windows.h"
 
 #include "myApp.h"
+#endif /* _WIN32 */
 
+#include <stdlib.h>
+
+#include "headless.h"
+
+#ifdef _WIN32
 /**
   @brief    This function is WinMain for D3DBase project
 
@@ -27,8 +34,26 @@
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInsatnce,
                    LPSTR lpszCommandLine, int nCmdShow)
 {
+  // '-headless' renders frames to files without window
+  headless_params_t params;
+  if (!parse_headless_args(__argc, __argv, params))
+    return 2;
+  if (params.enabled)
+    return run_headless(params);
+
   myApp app(1000, 700, (void*)hInstance, nCmdShow);
   if (!app.isFailed())
     app.theLoop();
+  return 0;
 } // end of WinMain
-
+#else /* _WIN32 */
+// Only headless mode is available without Windows
+int main(int argc, char **argv)
+{
+  headless_params_t params;
+  params.enabled = true;
+  if (!parse_headless_args(argc, argv, params))
+    return 2;
+  return run_headless(params);
+} // end of main
+#endif /* _WIN32 */
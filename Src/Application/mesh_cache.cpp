@@ -0,0 +1,232 @@
+/**
+@file     mesh_cache.cpp
+@brief    Cooked (binary, GPU ready) meshes cache implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstring>
+
+#include "stopwatch.h"
+#include "x_parser.h"
+#include "mesh_cache.h"
+
+namespace
+{
+  const size_t c_blob_alignment = 16;
+
+  /* Append blob to file data, returns its offset */
+  unsigned int append_blob( std::vector<unsigned char> &data, void const *blob, size_t size )
+  {
+    data.resize((data.size() + c_blob_alignment - 1) / c_blob_alignment * c_blob_alignment);
+
+    unsigned int const offset = (unsigned int)data.size();
+    if (size > 0)
+    {
+      data.resize(offset + size);
+      memcpy(&data[offset], blob, size);
+    }
+    return offset;
+  }
+
+  /* Check blob lies inside the file */
+  bool is_blob_valid( size_t offset, size_t count, size_t element_size, size_t file_size )
+  {
+    return offset <= file_size && count <= (file_size - offset) / element_size;
+  }
+
+  /* Check subset faces, vertices and material lie inside the mesh, so loaders may index by them */
+  bool is_subset_valid( mesh_subset_t const &subset, unsigned int faces_count, unsigned int vertex_count, unsigned int material_count )
+  {
+    return subset.face_start <= faces_count && subset.face_count <= faces_count - subset.face_start &&
+           subset.vertex_start <= vertex_count && subset.vertex_count <= vertex_count - subset.vertex_start &&
+           subset.material < material_count;
+  }
+
+  /* Check mapped blobs content: subsets ranges, NUL terminated texture names and indices range */
+  bool is_content_valid( cooked_mesh_header_t const &header, unsigned char const *data )
+  {
+    if (header.index_count == 0 || header.index_count % 3 != 0)
+      return false;
+
+    mesh_subset_t const *subsets = (mesh_subset_t const *)(data + header.subsets_offset);
+    for (unsigned int i = 0; i < header.subset_count; ++i)
+      if (!is_subset_valid(subsets[i], header.index_count / 3, header.vertex_count, header.material_count))
+        return false;
+
+    cooked_mesh_material_t const *materials = (cooked_mesh_material_t const *)(data + header.materials_offset);
+    for (unsigned int i = 0; i < header.material_count; ++i)
+      if (memchr(materials[i].texture_file, 0, c_cooked_mesh_texture_name_size) == NULL)
+        return false;
+
+    for (unsigned int i = 0; i < header.index_count; ++i)
+    {
+      unsigned int const index = header.index_size == 2 ? ((unsigned short const *)(data + header.indices_offset))[i]
+                                                        : ((unsigned int const *)(data + header.indices_offset))[i];
+      if (index >= header.vertex_count)
+        return false;
+    }
+    return true;
+  }
+}
+
+std::wstring cooked_mesh_file_name( wchar_t const *source_file_name )
+{
+  return std::wstring(source_file_name) + L".cglmesh";
+}
+
+bool write_cooked_mesh( wchar_t const *file_name, mesh_data_t const &mesh, file_stamp_t const &source_stamp )
+{
+  unsigned int const vertex_count = mesh.vertex_count();
+  if (vertex_count == 0 || mesh.indices.empty())
+    return false;
+  /* Files failing open() checks would be cooked again on every load */
+  for (size_t i = 0; i < mesh.subsets.size(); ++i)
+    if (!is_subset_valid(mesh.subsets[i], mesh.face_count(), vertex_count, (unsigned int)mesh.materials.size()))
+      return false;
+
+  cooked_mesh_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "CGLM", 4);
+  header.version = c_cooked_mesh_version;
+  header.fvf = mesh.fvf;
+  header.vertex_size = mesh.vertex_size;
+  header.vertex_count = vertex_count;
+  header.index_count = (unsigned int)mesh.indices.size();
+  header.index_size = vertex_count <= 0xFFFF ? 2 : 4;
+  header.subset_count = (unsigned int)mesh.subsets.size();
+  header.material_count = (unsigned int)mesh.materials.size();
+  header.source_size = source_stamp.size;
+  header.source_time = source_stamp.write_time;
+  for (int c = 0; c < 3; ++c)
+  {
+    header.bounds_min[c] = mesh.bounds_min[c];
+    header.bounds_max[c] = mesh.bounds_max[c];
+  }
+
+  std::vector<unsigned char> data(sizeof(header));
+
+  header.vertices_offset = append_blob(data, &mesh.vertices[0], mesh.vertices.size());
+
+  if (header.index_size == 2)
+  {
+    std::vector<unsigned short> indices(mesh.indices.begin(), mesh.indices.end());
+    header.indices_offset = append_blob(data, &indices[0], indices.size() * sizeof(unsigned short));
+  }
+  else
+    header.indices_offset = append_blob(data, &mesh.indices[0], mesh.indices.size() * sizeof(unsigned int));
+
+  header.subsets_offset = append_blob(data, mesh.subsets.empty() ? NULL : &mesh.subsets[0],
+                                      mesh.subsets.size() * sizeof(mesh_subset_t));
+
+  std::vector<cooked_mesh_material_t> materials(mesh.materials.size());
+  for (size_t i = 0; i < materials.size(); ++i)
+  {
+    mesh_material_t const &src = mesh.materials[i];
+    cooked_mesh_material_t &dst = materials[i];
+
+    memset(&dst, 0, sizeof(dst));
+    memcpy(dst.diffuse, src.diffuse, sizeof(dst.diffuse));
+    memcpy(dst.ambient, src.ambient, sizeof(dst.ambient));
+    memcpy(dst.specular, src.specular, sizeof(dst.specular));
+    memcpy(dst.emissive, src.emissive, sizeof(dst.emissive));
+    dst.power = src.power;
+    if (src.texture_file.size() >= c_cooked_mesh_texture_name_size)
+      return false;
+    memcpy(dst.texture_file, src.texture_file.c_str(), src.texture_file.size());
+  }
+  header.materials_offset = append_blob(data, materials.empty() ? NULL : &materials[0],
+                                        materials.size() * sizeof(cooked_mesh_material_t));
+
+  memcpy(&data[0], &header, sizeof(header));
+  return save_file(file_name, &data[0], data.size());
+}
+
+bool cooked_mesh_t::open( wchar_t const *file_name, file_stamp_t const &source_stamp )
+{
+  m_header = NULL;
+  if (!m_file.open(file_name) || m_file.size() < sizeof(cooked_mesh_header_t))
+    return false;
+
+  cooked_mesh_header_t const *header = (cooked_mesh_header_t const *)m_file.data();
+  size_t const size = m_file.size();
+  if (memcmp(header->magic, "CGLM", 4) != 0 || header->version != c_cooked_mesh_version ||
+      header->source_size != source_stamp.size || header->source_time != source_stamp.write_time ||
+      (header->index_size != 2 && header->index_size != 4) || header->vertex_size == 0 ||
+      !is_blob_valid(header->vertices_offset, header->vertex_count, header->vertex_size, size) ||
+      !is_blob_valid(header->indices_offset, header->index_count, header->index_size, size) ||
+      !is_blob_valid(header->subsets_offset, header->subset_count, sizeof(mesh_subset_t), size) ||
+      !is_blob_valid(header->materials_offset, header->material_count, sizeof(cooked_mesh_material_t), size) ||
+      !is_content_valid(*header, m_file.data()))
+  {
+    m_file.close();
+    return false;
+  }
+
+  m_header = header;
+  return true;
+}
+
+mesh_cache_benchmark_t benchmark_mesh_cache( wchar_t const *source_file_name, unsigned int repeats )
+{
+  mesh_cache_benchmark_t result;
+  file_stamp_t stamp;
+  std::wstring const cache_name = cooked_mesh_file_name(source_file_name);
+
+  result.is_loaded = false;
+  result.source_size = result.cooked_size = 0;
+  result.cold_ms = result.cook_ms = result.cooked_ms = 0;
+  if (repeats == 0 || !get_file_stamp(source_file_name, stamp))
+    return result;
+  result.source_size = (size_t)stamp.size;
+
+  /* Buffers stand for device vertex and index buffers being filled */
+  std::vector<unsigned char> vertices, indices;
+  x_scene_t scene;
+
+  stopwatch_t timer;
+  for (unsigned int i = 0; i < repeats; ++i)
+  {
+    scene = x_scene_t();
+    if (!parse_x_file(source_file_name, scene))
+      return result;
+    vertices.assign(scene.mesh.vertices.begin(), scene.mesh.vertices.end());
+    indices.resize(scene.mesh.indices.size() * sizeof(unsigned int));
+    if (!indices.empty())
+      memcpy(&indices[0], &scene.mesh.indices[0], indices.size());
+  }
+  result.cold_ms = timer.elapsed_ms() / repeats;
+
+  timer.restart();
+  if (!write_cooked_mesh(cache_name.c_str(), scene.mesh, stamp))
+    return result;
+  result.cook_ms = timer.elapsed_ms();
+
+  file_stamp_t cooked_stamp;
+  if (get_file_stamp(cache_name.c_str(), cooked_stamp))
+    result.cooked_size = (size_t)cooked_stamp.size;
+
+  timer.restart();
+  for (unsigned int i = 0; i < repeats; ++i)
+  {
+    cooked_mesh_t cooked;
+
+    if (!cooked.open(cache_name.c_str(), stamp))
+      return result;
+
+    cooked_mesh_header_t const &header = cooked.header();
+    size_t const vertices_size = (size_t)header.vertex_count * header.vertex_size;
+    size_t const indices_size = (size_t)header.index_count * header.index_size;
+
+    vertices.resize(vertices_size);
+    indices.resize(indices_size);
+    if (vertices_size > 0)
+      memcpy(&vertices[0], cooked.vertices(), vertices_size);
+    if (indices_size > 0)
+      memcpy(&indices[0], cooked.indices(), indices_size);
+  }
+  result.cooked_ms = timer.elapsed_ms() / repeats;
+  result.is_loaded = true;
+  return result;
+}
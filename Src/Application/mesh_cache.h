@@ -0,0 +1,106 @@
+/**
+@file     mesh_cache.h
+@brief    Cooked (binary, GPU ready) meshes cache definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __MESH_CACHE_INCLUDED__
+#define __MESH_CACHE_INCLUDED__
+
+#include <string>
+
+#include "files.h"
+#include "mesh_data.h"
+
+/* Cooked mesh file format version, increase on any layout or cooking change */
+const unsigned int c_cooked_mesh_version = 2;
+const unsigned int c_cooked_mesh_texture_name_size = 120;
+
+/* Cooked mesh file header. Blobs follow the header, every blob is 16 bytes aligned */
+struct cooked_mesh_header_t
+{
+  char magic[4];                /* 'CGLM' */
+  unsigned int version;
+  unsigned int fvf;
+  unsigned int vertex_size;
+  unsigned int vertex_count;
+  unsigned int index_count;
+  unsigned int index_size;      /* 2 or 4 bytes */
+  unsigned int subset_count;
+  unsigned int material_count;
+  unsigned int reserved;
+  unsigned long long source_size;
+  unsigned long long source_time;
+  float bounds_min[3];
+  float bounds_max[3];
+  unsigned int vertices_offset;
+  unsigned int indices_offset;
+  unsigned int subsets_offset;
+  unsigned int materials_offset;
+};
+
+/* Cooked material record */
+struct cooked_mesh_material_t
+{
+  float diffuse[4];
+  float ambient[4];
+  float specular[4];
+  float emissive[4];
+  float power;
+  char texture_file[c_cooked_mesh_texture_name_size];
+};
+
+/* Cache file name for the source mesh file */
+std::wstring cooked_mesh_file_name( wchar_t const *source_file_name );
+
+/* Write cooked mesh file. Indices are stored 16 bit when possible */
+bool write_cooked_mesh( wchar_t const *file_name, mesh_data_t const &mesh, file_stamp_t const &source_stamp );
+
+/* Memory mapped cooked mesh, blobs are used in place */
+class cooked_mesh_t
+{
+public:
+  cooked_mesh_t() : m_header(NULL) {}
+
+  /* Open and validate cache file against the source file stamp. Blobs out of the file, subsets out of
+   * faces, vertices or materials, indices out of vertices and unterminated texture names fail it, so the
+   * source is cooked again */
+  bool open( wchar_t const *file_name, file_stamp_t const &source_stamp );
+
+  cooked_mesh_header_t const & header( void ) const { return *m_header; }
+
+  void const * vertices( void ) const { return m_file.data() + m_header->vertices_offset; }
+  void const * indices( void ) const { return m_file.data() + m_header->indices_offset; }
+
+  mesh_subset_t const * subsets( void ) const
+  {
+    return (mesh_subset_t const *)(m_file.data() + m_header->subsets_offset);
+  }
+
+  cooked_mesh_material_t const * materials( void ) const
+  {
+    return (cooked_mesh_material_t const *)(m_file.data() + m_header->materials_offset);
+  }
+private:
+  mapped_file_t m_file;
+  cooked_mesh_header_t const *m_header;
+};
+
+/* Cold .x load against mapped cooked load of one file, CPU side up to buffers fill */
+struct mesh_cache_benchmark_t
+{
+  bool is_loaded;
+  size_t source_size;
+  size_t cooked_size;
+  double cold_ms;               /* parse and copy vertices and indices, mean of repeats */
+  double cook_ms;               /* write cache file once */
+  double cooked_ms;             /* map, validate and copy vertices and indices, mean of repeats */
+
+  double speedup( void ) const { return cooked_ms > 0 ? cold_ms / cooked_ms : 0; }
+};
+
+mesh_cache_benchmark_t benchmark_mesh_cache( wchar_t const *source_file_name, unsigned int repeats );
+
+#endif /* __MESH_CACHE_INCLUDED__ */
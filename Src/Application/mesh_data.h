@@ -0,0 +1,87 @@
+/**
+@file     mesh_data.h
+@brief    Engine mesh data (API independent) definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __MESH_DATA_INCLUDED__
+#define __MESH_DATA_INCLUDED__
+
+#include <string>
+#include <vector>
+
+/* Vertex components, values match D3DFVF_* codes */
+const unsigned int c_mesh_fvf_position = 0x002;
+const unsigned int c_mesh_fvf_normal = 0x010;
+const unsigned int c_mesh_fvf_diffuse = 0x040;
+const unsigned int c_mesh_fvf_tex1 = 0x100;
+
+/* Material in D3DMATERIAL9 components order */
+struct mesh_material_t
+{
+  float diffuse[4];
+  float ambient[4];
+  float specular[4];
+  float emissive[4];
+  float power;
+  std::string texture_file;
+
+  mesh_material_t() : power(0)
+  {
+    for (int i = 0; i < 4; ++i)
+      diffuse[i] = ambient[i] = specular[i] = emissive[i] = 0;
+  }
+};
+
+/* Range of triangles drawn with one material, D3DXATTRIBUTERANGE analogue */
+struct mesh_subset_t
+{
+  unsigned int material;
+  unsigned int face_start;
+  unsigned int face_count;
+  unsigned int vertex_start;
+  unsigned int vertex_count;
+};
+
+/* Indexed triangle list with interleaved vertices described by FVF code */
+struct mesh_data_t
+{
+  unsigned int fvf;
+  unsigned int vertex_size;
+  std::vector<unsigned char> vertices;
+  std::vector<unsigned int> indices;
+  std::vector<mesh_subset_t> subsets;
+  std::vector<mesh_material_t> materials;
+  float bounds_min[3];
+  float bounds_max[3];
+
+  mesh_data_t() : fvf(0), vertex_size(0)
+  {
+    for (int i = 0; i < 3; ++i)
+      bounds_min[i] = bounds_max[i] = 0;
+  }
+
+  unsigned int vertex_count( void ) const { return vertex_size == 0 ? 0 : (unsigned int)(vertices.size() / vertex_size); }
+  unsigned int face_count( void ) const { return (unsigned int)(indices.size() / 3); }
+
+  /* Compute axis aligned bounds, position is expected to be first three floats of vertex */
+  void update_bounds( void )
+  {
+    unsigned int const count = vertex_count();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      float const *pos = (float const *)&vertices[i * vertex_size];
+      for (int c = 0; c < 3; ++c)
+      {
+        if (i == 0 || pos[c] < bounds_min[c])
+          bounds_min[c] = pos[c];
+        if (i == 0 || pos[c] > bounds_max[c])
+          bounds_max[c] = pos[c];
+      }
+    }
+  }
+};
+
+#endif /* __MESH_DATA_INCLUDED__ */
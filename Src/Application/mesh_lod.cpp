@@ -0,0 +1,592 @@
+/**
+@file     mesh_lod.cpp
+@brief    Quadric error meshes simplification and LOD chains implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "parallel.h"
+#include "stopwatch.h"
+#include "mesh_lod.h"
+
+namespace
+{
+  /* Edge length term of collapse cost, flat regions are decimated evenly */
+  const double c_edge_weight = 1e-3;
+  /* Vertex lighting interpolation error per edge length, part of level error */
+  const float c_shading_error = 0.02f;
+  /* Collapses may not turn triangles normals by more than acos of it */
+  const float c_min_normal_cos = 0.2f;
+  /* Levels which remove less triangles than that end the chain */
+  const float c_min_progress = 0.9f;
+  const size_t c_edges_per_task = 16384;
+  const unsigned int c_no_group = ~0u;
+
+  std::mutex s_stats_mutex;
+  mesh_lod_stats_t s_stats;
+
+  /* Squared distances to planes, eval() is their mean */
+  struct quadric_t
+  {
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+
+    void clear( void )
+    {
+      memset(this, 0, sizeof(*this));
+    }
+
+    /* Plane n * p + d = 0, |n| = 1 */
+    void add_plane( double nx, double ny, double nz, double d )
+    {
+      a00 += nx * nx; a01 += nx * ny; a02 += nx * nz;
+      a11 += ny * ny; a12 += ny * nz; a22 += nz * nz;
+      b0 += nx * d; b1 += ny * d; b2 += nz * d;
+      c += d * d;
+      weight += 1;
+    }
+
+    void add( quadric_t const &q )
+    {
+      a00 += q.a00; a01 += q.a01; a02 += q.a02;
+      a11 += q.a11; a12 += q.a12; a22 += q.a22;
+      b0 += q.b0; b1 += q.b1; b2 += q.b2;
+      c += q.c;
+      weight += q.weight;
+    }
+
+    double eval( float const *p ) const
+    {
+      double const x = p[0], y = p[1], z = p[2];
+      double const error = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                           2 * (b0 * x + b1 * y + b2 * z) + c;
+      return error > 0 && weight > 0 ? error / weight : 0;
+    }
+  };
+
+  struct collapse_t
+  {
+    double cost;
+    double error;               /* quadric part of cost */
+    unsigned int from, to;
+
+    bool operator<( collapse_t const &other ) const
+    {
+      return cost < other.cost;
+    }
+  };
+
+  void triangle_normal( float const *p0, float const *p1, float const *p2, float *n )
+  {
+    float const e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    float const e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+  }
+
+  float distance2( float const *a, float const *b )
+  {
+    float const dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  /* Edge collapses simplifier keeping its state between levels of a chain */
+  class simplifier_t
+  {
+  public:
+    simplifier_t( void const *vertices, unsigned int vertex_size, unsigned int vertex_count, unsigned int const *indices,
+                  size_t index_count, unsigned int const *groups, unsigned int threads )
+      : m_vertex_count(vertex_count)
+      , m_positions((size_t)vertex_count * 3)
+      , m_indices(indices, indices + index_count)
+      , m_groups(groups, groups + index_count / 3)
+      , m_locked(vertex_count, 0)
+      , m_quadrics(vertex_count)
+      , m_error(0)
+      , m_threads(threads)
+    {
+      for (unsigned int i = 0; i < vertex_count; ++i)
+        memcpy(&m_positions[i * 3], (unsigned char const *)vertices + (size_t)i * vertex_size, 3 * sizeof(float));
+      lock_seams();
+      lock_borders();
+      compute_quadrics();
+    }
+
+    size_t triangles_count( void ) const { return m_indices.size() / 3; }
+    std::vector<unsigned int> const & indices( void ) const { return m_indices; }
+    std::vector<unsigned int> const & groups( void ) const { return m_groups; }
+
+    /* Object space error of the current triangles */
+    float error( void ) const
+    {
+      float max_edge2 = 0;
+      for (size_t i = 0; i < m_indices.size(); i += 3)
+        for (int k = 0; k < 3; ++k)
+          max_edge2 = cglmath::Max(max_edge2, distance2(position(m_indices[i + k]), position(m_indices[i + (k + 1) % 3])));
+      return cglmath::Max((float)sqrt(m_error), c_shading_error * (float)sqrt(max_edge2));
+    }
+
+    /* Collapse cheapest edges in passes until there are at most target_triangles */
+    void simplify( size_t target_triangles )
+    {
+      while (triangles_count() > target_triangles)
+        if (!pass(target_triangles))
+          break;
+    }
+  private:
+    float const * position( unsigned int vertex ) const { return &m_positions[(size_t)vertex * 3]; }
+
+    /* Vertices sharing position with other ones are on uv, normal or material seams */
+    void lock_seams( void )
+    {
+      std::vector<unsigned int> order(m_vertex_count);
+      for (unsigned int i = 0; i < m_vertex_count; ++i)
+        order[i] = i;
+      std::sort(order.begin(), order.end(), [this]( unsigned int a, unsigned int b )
+      {
+        return std::lexicographical_compare(position(a), position(a) + 3, position(b), position(b) + 3);
+      });
+      for (unsigned int i = 1; i < m_vertex_count; ++i)
+        if (memcmp(position(order[i - 1]), position(order[i]), 3 * sizeof(float)) == 0)
+          m_locked[order[i - 1]] = m_locked[order[i]] = 1;
+
+      /* Vertices of several subsets */
+      std::vector<unsigned int> vertex_group(m_vertex_count, c_no_group);
+      for (size_t i = 0; i < m_indices.size(); ++i)
+      {
+        unsigned int &group = vertex_group[m_indices[i]];
+        if (group == c_no_group)
+          group = m_groups[i / 3];
+        else if (group != m_groups[i / 3])
+          m_locked[m_indices[i]] = 1;
+      }
+    }
+
+    /* Edges of one triangle are on open borders */
+    void lock_borders( void )
+    {
+      std::vector<unsigned long long> edges;
+      edges.reserve(m_indices.size());
+      for (size_t i = 0; i < m_indices.size(); i += 3)
+        for (int k = 0; k < 3; ++k)
+        {
+          unsigned long long const a = m_indices[i + k], b = m_indices[i + (k + 1) % 3];
+          edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+        }
+      std::sort(edges.begin(), edges.end());
+      for (size_t i = 0; i < edges.size();)
+      {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i])
+          ++j;
+        if (j - i == 1)
+          m_locked[(unsigned int)(edges[i] >> 32)] = m_locked[(unsigned int)edges[i]] = 1;
+        i = j;
+      }
+    }
+
+    void compute_quadrics( void )
+    {
+      for (unsigned int i = 0; i < m_vertex_count; ++i)
+        m_quadrics[i].clear();
+      for (size_t i = 0; i < m_indices.size(); i += 3)
+      {
+        float n[3];
+        float const *p0 = position(m_indices[i]);
+        triangle_normal(p0, position(m_indices[i + 1]), position(m_indices[i + 2]), n);
+
+        double const length = sqrt((double)n[0] * n[0] + (double)n[1] * n[1] + (double)n[2] * n[2]);
+        if (length <= 0)
+          continue;
+        double const nx = n[0] / length, ny = n[1] / length, nz = n[2] / length;
+        quadric_t plane;
+        plane.clear();
+        plane.add_plane(nx, ny, nz, -(nx * p0[0] + ny * p0[1] + nz * p0[2]));
+        for (int k = 0; k < 3; ++k)
+          m_quadrics[m_indices[i + k]].add(plane);
+      }
+    }
+
+    /* Triangles of every vertex */
+    void build_adjacency( void )
+    {
+      m_offsets.assign(m_vertex_count + 1, 0);
+      for (size_t i = 0; i < m_indices.size(); ++i)
+        m_offsets[m_indices[i] + 1]++;
+      for (unsigned int i = 0; i < m_vertex_count; ++i)
+        m_offsets[i + 1] += m_offsets[i];
+
+      std::vector<unsigned int> fill(m_offsets.begin(), m_offsets.end() - 1);
+      m_adjacency.resize(m_indices.size());
+      for (size_t i = 0; i < m_indices.size(); ++i)
+        m_adjacency[fill[m_indices[i]]++] = (unsigned int)(i / 3);
+    }
+
+    /* Moving 'from' onto 'to' keeps orientation of triangles which stay */
+    bool is_valid( unsigned int from, unsigned int to ) const
+    {
+      for (unsigned int t = m_offsets[from]; t < m_offsets[from + 1]; ++t)
+      {
+        unsigned int const *tri = &m_indices[m_adjacency[t] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to)
+          continue;
+
+        float const *before[3], *after[3];
+        for (int k = 0; k < 3; ++k)
+        {
+          before[k] = position(tri[k]);
+          after[k] = tri[k] == from ? position(to) : before[k];
+        }
+        float n0[3], n1[3];
+        triangle_normal(before[0], before[1], before[2], n0);
+        triangle_normal(after[0], after[1], after[2], n1);
+        float const dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+        float const length2 = (n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]) * (n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+        if (dot <= 0 || dot * dot < c_min_normal_cos * c_min_normal_cos * length2)
+          return false;
+      }
+      return true;
+    }
+
+    /* One pass of independent collapses, every vertex takes part in at most one of them */
+    bool pass( size_t target_triangles )
+    {
+      build_adjacency();
+
+      std::vector<unsigned long long> edges;
+      edges.reserve(m_indices.size() / 2);
+      for (size_t i = 0; i < m_indices.size(); i += 3)
+        for (int k = 0; k < 3; ++k)
+        {
+          unsigned int const a = m_indices[i + k], b = m_indices[i + (k + 1) % 3];
+          if (a < b && !(m_locked[a] && m_locked[b]))
+            edges.push_back(((unsigned long long)a << 32) | b);
+        }
+
+      std::vector<collapse_t> collapses(edges.size());
+      parallel_for(0, edges.size(), c_edges_per_task, [&]( size_t begin, size_t end )
+      {
+        for (size_t i = begin; i < end; ++i)
+        {
+          unsigned int const a = (unsigned int)(edges[i] >> 32), b = (unsigned int)edges[i];
+          quadric_t q = m_quadrics[a];
+          q.add(m_quadrics[b]);
+
+          double const edge_cost = c_edge_weight * distance2(position(a), position(b));
+          double const error_ab = m_locked[a] ? HUGE_VAL : q.eval(position(b));
+          double const error_ba = m_locked[b] ? HUGE_VAL : q.eval(position(a));
+          collapse_t &collapse = collapses[i];
+          collapse.from = error_ab <= error_ba ? a : b;
+          collapse.to = error_ab <= error_ba ? b : a;
+          collapse.error = cglmath::Min(error_ab, error_ba);
+          collapse.cost = collapse.error + edge_cost;
+        }
+      }, m_threads);
+      std::sort(collapses.begin(), collapses.end());
+
+      std::vector<unsigned int> remap(m_vertex_count);
+      for (unsigned int i = 0; i < m_vertex_count; ++i)
+        remap[i] = i;
+      std::vector<unsigned char> touched(m_vertex_count, 0);
+      size_t triangles = triangles_count();
+      unsigned int collapsed = 0;
+
+      for (size_t i = 0; i < collapses.size() && triangles > target_triangles; ++i)
+      {
+        collapse_t const &collapse = collapses[i];
+        if (touched[collapse.from] || touched[collapse.to] || !is_valid(collapse.from, collapse.to))
+          continue;
+
+        for (unsigned int t = m_offsets[collapse.from]; t < m_offsets[collapse.from + 1]; ++t)
+        {
+          unsigned int const *tri = &m_indices[m_adjacency[t] * 3];
+          if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+            triangles--;
+          touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+        }
+        remap[collapse.from] = collapse.to;
+        m_quadrics[collapse.to].add(m_quadrics[collapse.from]);
+        m_error = cglmath::Max(m_error, collapse.error);
+        collapsed++;
+      }
+      if (collapsed == 0)
+        return false;
+
+      /* Remap in place and drop degenerate triangles */
+      parallel_for(0, m_indices.size(), c_edges_per_task * 3, [&]( size_t begin, size_t end )
+      {
+        for (size_t i = begin; i < end; ++i)
+          m_indices[i] = remap[m_indices[i]];
+      }, m_threads);
+      size_t kept = 0;
+      for (size_t i = 0; i < m_indices.size(); i += 3)
+      {
+        unsigned int const a = m_indices[i], b = m_indices[i + 1], c = m_indices[i + 2];
+        if (a == b || b == c || a == c)
+          continue;
+        m_indices[kept * 3] = a;
+        m_indices[kept * 3 + 1] = b;
+        m_indices[kept * 3 + 2] = c;
+        m_groups[kept] = m_groups[i / 3];
+        kept++;
+      }
+      m_indices.resize(kept * 3);
+      m_groups.resize(kept);
+      return true;
+    }
+
+    unsigned int m_vertex_count;
+    std::vector<float> m_positions;
+    std::vector<unsigned int> m_indices;
+    std::vector<unsigned int> m_groups;
+    std::vector<unsigned char> m_locked;
+    std::vector<quadric_t> m_quadrics;
+    std::vector<unsigned int> m_offsets;
+    std::vector<unsigned int> m_adjacency;
+    double m_error;
+    unsigned int m_threads;
+  };
+}
+
+mesh_lod_t::mesh_lod_t()
+{
+}
+
+mesh_lod_t::~mesh_lod_t()
+{
+  release();
+}
+
+void mesh_lod_t::release( void )
+{
+  for (size_t i = 0; i < m_levels.size(); ++i)
+    if (m_levels[i].buffer != NULL)
+      m_levels[i].buffer->Release();
+  m_levels.clear();
+}
+
+bool mesh_lod_t::build( IDirect3DDevice9 *device, void const *vertices, unsigned int vertex_size, unsigned int vertex_count,
+                        unsigned int const *indices, size_t index_count, mesh_subset_t const *subsets, size_t subsets_count,
+                        mesh_lod_params_t const &params )
+{
+  stopwatch_t timer;
+
+  release();
+  m_params = params;
+  if (vertex_count == 0 || index_count < 3)
+    return false;
+
+  /* Subset of every triangle, triangles out of subsets are dropped */
+  std::vector<mesh_subset_t> groups;
+  std::vector<unsigned int> triangle_groups(index_count / 3, c_no_group);
+  if (subsets == NULL)
+  {
+    mesh_subset_t const whole = {0, 0, (unsigned int)(index_count / 3), 0, vertex_count};
+    groups.push_back(whole);
+  }
+  else
+    groups.assign(subsets, subsets + subsets_count);
+  for (size_t g = 0; g < groups.size(); ++g)
+    for (unsigned int f = 0; f < groups[g].face_count && groups[g].face_start + f < triangle_groups.size(); ++f)
+      triangle_groups[groups[g].face_start + f] = (unsigned int)g;
+
+  std::vector<unsigned int> source_indices, source_groups;
+  for (size_t t = 0; t < triangle_groups.size(); ++t)
+    if (triangle_groups[t] != c_no_group)
+    {
+      source_indices.insert(source_indices.end(), indices + t * 3, indices + t * 3 + 3);
+      source_groups.push_back(triangle_groups[t]);
+    }
+
+  if (source_indices.empty())
+    return false;
+
+  mesh_lod_level_t full;
+  full.triangles_count = (unsigned int)(index_count / 3);
+  full.error = 0;
+  full.buffer = NULL;
+  full.subsets = groups;
+  m_levels.push_back(full);
+
+  simplifier_t simplifier(vertices, vertex_size, vertex_count, &source_indices[0], source_indices.size(), &source_groups[0],
+                          params.threads);
+  for (unsigned int l = 0; l < params.levels; ++l)
+  {
+    size_t const previous = simplifier.triangles_count();
+    size_t const target = (size_t)(previous * params.ratio);
+    if (target < params.min_triangles)
+      break;
+    simplifier.simplify(target);
+    if (simplifier.triangles_count() > previous * c_min_progress)
+      break;
+
+    /* Triangles sorted by subset, in subsets order */
+    std::vector<unsigned int> const &level_indices = simplifier.indices();
+    std::vector<unsigned int> const &level_groups = simplifier.groups();
+    std::vector<unsigned int> counts(groups.size() + 1, 0);
+    for (size_t t = 0; t < level_groups.size(); ++t)
+      counts[level_groups[t] + 1]++;
+    for (size_t g = 0; g < groups.size(); ++g)
+      counts[g + 1] += counts[g];
+
+    mesh_lod_level_t level;
+    level.triangles_count = (unsigned int)level_groups.size();
+    level.error = simplifier.error();
+    level.buffer = NULL;
+    level.indices.resize(level_indices.size());
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+      mesh_subset_t subset = groups[g];
+      subset.face_start = counts[g];
+      subset.face_count = counts[g + 1] - counts[g];
+      subset.vertex_start = 0;
+      subset.vertex_count = vertex_count;
+      level.subsets.push_back(subset);
+    }
+    for (size_t t = 0; t < level_groups.size(); ++t)
+      memcpy(&level.indices[counts[level_groups[t]]++ * 3], &level_indices[t * 3], 3 * sizeof(unsigned int));
+
+    if (device != NULL)
+    {
+      void *buf;
+      if (FAILED(device->CreateIndexBuffer((UINT)(level.indices.size() * sizeof(unsigned int)), D3DUSAGE_WRITEONLY, D3DFMT_INDEX32,
+                                           D3DPOOL_MANAGED, &level.buffer, NULL)))
+        break;
+      if (FAILED(level.buffer->Lock(0, 0, &buf, 0)))
+      {
+        level.buffer->Release();
+        break;
+      }
+      memcpy(buf, &level.indices[0], level.indices.size() * sizeof(unsigned int));
+      level.buffer->Unlock();
+    }
+    m_levels.push_back(level);
+  }
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.meshes_count++;
+  s_stats.levels_count += (unsigned int)m_levels.size() - 1;
+  s_stats.build_ms += timer.elapsed_ms();
+  return m_levels.size() > 1;
+}
+
+size_t mesh_lod_t::memory_size( void ) const
+{
+  size_t size = 0;
+  for (size_t i = 1; i < m_levels.size(); ++i)
+    size += m_levels[i].indices.size() * sizeof(unsigned int) * (m_levels[i].buffer != NULL ? 2 : 1);
+  return size;
+}
+
+size_t mesh_lod_t::select( frame_context_t const &frame, transform_t const &world, vec_t const &center, float radius ) const
+{
+  if (m_levels.size() < 2)
+    return 0;
+
+  float scale = 0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    float const length = vec_t(world.matrix.M[axis][0], world.matrix.M[axis][1], world.matrix.M[axis][2]).length();
+    scale = length > scale ? length : scale;
+  }
+
+  /* Nearest point of the sphere, view direction independent to avoid popping on camera turns */
+  float const distance = (world.transform_point(center) - frame.eye).length() - radius * scale;
+  if (distance <= frame.near_distance)
+    return 0;
+
+  float const pixels_per_unit = frame.projection.M[1][1] * frame.screen_height * 0.5f / distance;
+  for (size_t i = m_levels.size() - 1; i > 0; --i)
+    if (m_levels[i].error * scale * pixels_per_unit <= m_params.pixel_error)
+      return i;
+  return 0;
+}
+
+void mesh_lod_t::count_draw( size_t level ) const
+{
+  if (m_levels.size() < 2)
+    return;
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.draws_count++;
+  s_stats.lod_draws_count += level > 0 ? 1 : 0;
+  s_stats.full_triangles += m_levels[0].triangles_count;
+  s_stats.drawn_triangles += m_levels[level].triangles_count;
+}
+
+mesh_lod_stats_t mesh_lod_stats( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  return s_stats;
+}
+
+void mesh_lod_begin_frame( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.draws_count = 0;
+  s_stats.lod_draws_count = 0;
+  s_stats.full_triangles = 0;
+  s_stats.drawn_triangles = 0;
+}
+
+mesh_lod_benchmark_t benchmark_mesh_lod( unsigned int grid_size, unsigned int threads )
+{
+  mesh_lod_benchmark_t result;
+  std::vector<float> vertices((size_t)grid_size * grid_size * 3);
+  std::vector<unsigned int> indices;
+
+  /* Sphere grid with a seam at phi = pi and degenerate poles */
+  for (unsigned int i = 0; i < grid_size; ++i)
+    for (unsigned int j = 0; j < grid_size; ++j)
+    {
+      float const phi = ((float)i / (grid_size - 1) * 2 - 1) * cglmath::c_pif;
+      float const theta = ((float)j / (grid_size - 1) - 0.5f) * cglmath::c_pif;
+      float *p = &vertices[((size_t)i * grid_size + j) * 3];
+      p[0] = cos(theta) * cos(phi);
+      p[1] = sin(theta);
+      p[2] = cos(theta) * sin(phi);
+    }
+  for (unsigned int i = 0; i + 1 < grid_size; ++i)
+    for (unsigned int j = 0; j + 1 < grid_size; ++j)
+    {
+      unsigned int const quad[6] = {i * grid_size + j, i * grid_size + j + 1, (i + 1) * grid_size + j,
+                                    (i + 1) * grid_size + j, i * grid_size + j + 1, (i + 1) * grid_size + j + 1};
+      indices.insert(indices.end(), quad, quad + 6);
+    }
+
+  mesh_lod_params_t params;
+  params.levels = sizeof(result.levels_triangles) / sizeof(result.levels_triangles[0]) - 1;
+  params.threads = threads;
+
+  mesh_lod_t lod;
+  mesh_lod_stats_t const saved = mesh_lod_stats();
+  stopwatch_t timer;
+  lod.build(NULL, &vertices[0], 3 * sizeof(float), grid_size * grid_size, &indices[0], indices.size(), NULL, 0, params);
+  result.build_ms = timer.elapsed_ms();
+  {
+    /* Benchmark mesh is not a scene one */
+    std::lock_guard<std::mutex> lock(s_stats_mutex);
+    s_stats.meshes_count = saved.meshes_count;
+    s_stats.levels_count = saved.levels_count;
+    s_stats.build_ms = saved.build_ms;
+  }
+  result.triangles_count = (unsigned int)(indices.size() / 3);
+  result.threads_count = threads == 0 ? parallel_threads_count() : threads;
+  result.levels_count = (unsigned int)lod.levels_count();
+  for (size_t i = 0; i < lod.levels_count(); ++i)
+  {
+    result.levels_triangles[i] = lod.level(i).triangles_count;
+    result.levels_error[i] = lod.level(i).error;
+  }
+  return result;
+}
@@ -0,0 +1,104 @@
+/**
+@file     mesh_lod.h
+@brief    Quadric error meshes simplification and LOD chains definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __MESH_LOD_INCLUDED__
+#define __MESH_LOD_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "frame_context.h"
+#include "mesh_data.h"
+
+struct mesh_lod_params_t
+{
+  unsigned int levels;          /* besides the full detail one */
+  float ratio;                  /* triangles of a level to the previous level ones */
+  unsigned int min_triangles;   /* levels are not simplified below it */
+  float pixel_error;            /* allowed screen space error of selected level */
+  unsigned int threads;         /* 0 means all hardware threads */
+
+  mesh_lod_params_t() : levels(4), ratio(0.25f), min_triangles(64), pixel_error(1.f), threads(0) {}
+};
+
+/* Simplified triangles of a mesh, they index the same vertices as the full detail ones */
+struct mesh_lod_level_t
+{
+  std::vector<unsigned int> indices;
+  std::vector<mesh_subset_t> subsets;
+  unsigned int triangles_count;
+  float error;                  /* object space distance to the full detail surface */
+  IDirect3DIndexBuffer9 *buffer;
+};
+
+/* Chain of quadric error metric simplified levels. Collapses move a vertex onto its neighbour,
+ * so vertex buffers are shared by all levels and only index buffers differ.
+ * Vertices on uv, normal or material seams (several vertices of one position, several
+ * subsets) and on open borders are never removed. Level 0 is the mesh itself */
+class mesh_lod_t
+{
+public:
+  mesh_lod_t();
+  ~mesh_lod_t();
+
+  /* Vertices start with float3 position. 'subsets' may be NULL for a single subset mesh.
+   * Index buffers are created for non NULL device */
+  bool build( IDirect3DDevice9 *device, void const *vertices, unsigned int vertex_size, unsigned int vertex_count,
+              unsigned int const *indices, size_t index_count, mesh_subset_t const *subsets, size_t subsets_count,
+              mesh_lod_params_t const &params = mesh_lod_params_t() );
+  void release( void );
+
+  size_t levels_count( void ) const { return m_levels.size(); }
+  mesh_lod_level_t const & level( size_t index ) const { return m_levels[index]; }
+  /* Simplified levels indices and their device copies */
+  size_t memory_size( void ) const;
+
+  /* Coarsest level with projected error within params pixel error for the local bounding sphere */
+  size_t select( frame_context_t const &frame, transform_t const &world, vec_t const &center, float radius ) const;
+  /* Account a draw of the level in frame statistics, meshes without levels are not counted */
+  void count_draw( size_t level ) const;
+private:
+  mesh_lod_t( mesh_lod_t const & );
+  mesh_lod_t & operator=( mesh_lod_t const & );
+
+  std::vector<mesh_lod_level_t> m_levels;
+  mesh_lod_params_t m_params;
+};
+
+struct mesh_lod_stats_t
+{
+  unsigned int meshes_count;
+  unsigned int levels_count;
+  double build_ms;              /* all builds, on their threads */
+  /* Current frame */
+  unsigned int draws_count;
+  unsigned int lod_draws_count; /* drawn with simplified level */
+  size_t full_triangles;
+  size_t drawn_triangles;
+};
+
+mesh_lod_stats_t mesh_lod_stats( void );
+/* Reset frame statistics */
+void mesh_lod_begin_frame( void );
+
+/* LOD chain build of a sphere grid */
+struct mesh_lod_benchmark_t
+{
+  unsigned int triangles_count;
+  unsigned int threads_count;
+  double build_ms;
+  unsigned int levels_triangles[8];
+  float levels_error[8];
+  unsigned int levels_count;
+};
+
+mesh_lod_benchmark_t benchmark_mesh_lod( unsigned int grid_size, unsigned int threads );
+
+#endif /* __MESH_LOD_INCLUDED__ */
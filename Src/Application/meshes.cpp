@@ -6,10 +6,47 @@
 @author   Sergeev Artemiy
 */
 
+#include <cstring>
 #include <string>
 
+#include "soft_raster.h"
+#include "stopwatch.h"
 #include "meshes.h"
 
+mesh_load_stats_t x_mesh_t::s_load_stats = {0, 0, 0, 0, 0, 0, 0};
+std::mutex x_mesh_t::s_load_stats_mutex;
+
+namespace
+{
+  /* Draw mesh subsets by software rasterizer with material diffuse colors */
+  void render_soft_data( recursive_data_t & rd, mesh_data_t const &data, D3DMATERIAL9 const *materials, size_t materials_count )
+  {
+    if (data.vertices.empty() || data.indices.empty())
+      return;
+
+    /* Position is followed by optional normal and diffuse color */
+    soft_mesh_t mesh;
+    mesh.vertices = &data.vertices[0];
+    mesh.vertex_size = data.vertex_size;
+    mesh.vertices_count = data.vertex_count();
+    mesh.normal_offset = (data.fvf & c_mesh_fvf_normal) ? 12 : -1;
+    mesh.color_offset = (data.fvf & c_mesh_fvf_diffuse) ? ((data.fvf & c_mesh_fvf_normal) ? 24 : 12) : -1;
+    for (size_t i = 0; i < data.subsets.size(); ++i)
+    {
+      mesh_subset_t const &subset = data.subsets[i];
+
+      if (subset.material < materials_count)
+      {
+        D3DCOLORVALUE const &diffuse = materials[subset.material].Diffuse;
+        mesh.color = color_t(diffuse.r, diffuse.g, diffuse.b, diffuse.a);
+      }
+      mesh.indices = &data.indices[subset.face_start * 3];
+      mesh.triangles_count = subset.face_count;
+      rd.rasterizer->draw(mesh, rd.world().matrix);
+    }
+  }
+}
+
 void A2W( std::wstring &ws, const std::string &s )
 {
   std::wstring wsTmp(s.begin(), s.end());
@@ -18,37 +55,322 @@ void A2W( std::wstring &ws, const std::string &s )
 }
 
 void x_mesh_t::load( LPCWSTR file_name, LPDIRECT3DDEVICE9 device )
+{
+  mesh_load_stats_t stats = {0, 0, 0, 0, 0, 0, 0};
+  stopwatch_t timer;
+  file_stamp_t stamp;
+  bool const has_stamp = get_file_stamp(file_name, stamp);
+  std::wstring const cache_name = cooked_mesh_file_name(file_name);
+
+  cooked_mesh_t cooked;
+  if (has_stamp && cooked.open(cache_name.c_str(), stamp) && load_cooked(cooked, device))
+  {
+    stats.cooked_count = 1;
+    stats.cooked_ms = timer.elapsed_ms();
+    add_load_stats(stats);
+    return;
+  }
+
+  /* Cache miss: portable parser output is cooked and loaded the same way as cache hits */
+  x_scene_t scene;
+  stopwatch_t parse_timer;
+  if (has_stamp && parse_x_file(file_name, scene))
+  {
+    stats.parse_ms = parse_timer.elapsed_ms();
+    stats.parsed_bytes = stamp.size;
+
+    stopwatch_t cooking_timer;
+    bool const is_cooked = write_cooked_mesh(cache_name.c_str(), scene.mesh, stamp) && cooked.open(cache_name.c_str(), stamp);
+
+    stats.cooking_ms = cooking_timer.elapsed_ms();
+    if (is_cooked && load_cooked(cooked, device))
+    {
+      stats.parsed_count = 1;
+      stats.parsed_ms = timer.elapsed_ms() - stats.cooking_ms;
+      add_load_stats(stats);
+      return;
+    }
+  }
+
+  /* D3DX fallback for files the parser does not support (compressed ones), needs device */
+  std::vector<mesh_material_t> materials;
+  if (device == NULL || !load_x(file_name, device, materials))
+  {
+    add_load_stats(stats);
+    return;
+  }
+  stats.parsed_count = 1;
+  stats.parsed_ms = timer.elapsed_ms() - stats.cooking_ms;
+
+  stopwatch_t cooking_timer;
+  m_data.materials = materials;
+  if (extract(m_data))
+  {
+    if (has_stamp)
+      write_cooked_mesh(cache_name.c_str(), m_data, stamp);
+    build_lod(device);
+  }
+  stats.cooking_ms += cooking_timer.elapsed_ms();
+  add_load_stats(stats);
+}
+
+mesh_load_stats_t x_mesh_t::load_stats( void )
+{
+  std::lock_guard<std::mutex> lock(s_load_stats_mutex);
+  return s_load_stats;
+}
+
+void x_mesh_t::add_load_stats( mesh_load_stats_t const &stats )
+{
+  std::lock_guard<std::mutex> lock(s_load_stats_mutex);
+  s_load_stats.cooked_count += stats.cooked_count;
+  s_load_stats.parsed_count += stats.parsed_count;
+  s_load_stats.cooked_ms += stats.cooked_ms;
+  s_load_stats.parsed_ms += stats.parsed_ms;
+  s_load_stats.cooking_ms += stats.cooking_ms;
+  s_load_stats.parse_ms += stats.parse_ms;
+  s_load_stats.parsed_bytes += stats.parsed_bytes;
+}
+
+bool x_mesh_t::load_x( LPCWSTR file_name, LPDIRECT3DDEVICE9 device, std::vector<mesh_material_t> &materials )
 {
   ID3DXBuffer *materials_buf = NULL;
 
   HRESULT hr = D3DXLoadMeshFromX(file_name, 0, device, NULL, &materials_buf, NULL, &m_materials_count, &m_mesh);
   if (hr != ERROR_SUCCESS)
-     return;
+     return false;
 
   D3DXMATERIAL *materials_array = (D3DXMATERIAL *)materials_buf->GetBufferPointer();
-  m_materials = new D3DMATERIAL9[m_materials_count];
-
-  m_textures = new texture_t[m_materials_count];
-
-  bool result;
+  materials.resize(m_materials_count);
   for (DWORD i = 0; i < m_materials_count; ++i)
   {
-    m_materials[i] = materials_array[i].MatD3D;
-    m_materials[i].Ambient = m_materials[i].Diffuse;
-
-    std::wstring str;
-    A2W(str, std::string(materials_array[i].pTextureFilename));
-
-    result = m_textures[i].load(device, str.c_str());
+    memcpy(materials[i].diffuse, &materials_array[i].MatD3D, sizeof(D3DMATERIAL9));
+    if (materials_array[i].pTextureFilename != NULL)
+      materials[i].texture_file = materials_array[i].pTextureFilename;
   }
   if (materials_buf)
     materials_buf->Release();
-  
+
+  load_materials(device, materials);
   m_mesh->OptimizeInplace(D3DXMESHOPT_COMPACT | D3DXMESHOPT_ATTRSORT, NULL, NULL, NULL, NULL);
+  return true;
+}
+
+bool x_mesh_t::load_cooked( cooked_mesh_t const &cooked, LPDIRECT3DDEVICE9 device )
+{
+  cooked_mesh_header_t const &header = cooked.header();
+
+  std::vector<mesh_material_t> materials(header.material_count);
+  cooked_mesh_material_t const *cooked_materials = cooked.materials();
+  for (unsigned int i = 0; i < header.material_count; ++i)
+  {
+    memcpy(materials[i].diffuse, cooked_materials[i].diffuse, sizeof(materials[i].diffuse));
+    memcpy(materials[i].ambient, cooked_materials[i].ambient, sizeof(materials[i].ambient));
+    memcpy(materials[i].specular, cooked_materials[i].specular, sizeof(materials[i].specular));
+    memcpy(materials[i].emissive, cooked_materials[i].emissive, sizeof(materials[i].emissive));
+    materials[i].power = cooked_materials[i].power;
+    materials[i].texture_file.assign(cooked_materials[i].texture_file,
+                                     strnlen(cooked_materials[i].texture_file, c_cooked_mesh_texture_name_size));
+  }
+
+  m_data.fvf = header.fvf;
+  m_data.vertex_size = header.vertex_size;
+  m_data.vertices.assign((unsigned char const *)cooked.vertices(), (unsigned char const *)cooked.vertices() + header.vertex_count * header.vertex_size);
+  m_data.indices.resize(header.index_count);
+  if (header.index_size == 4)
+    memcpy(&m_data.indices[0], cooked.indices(), header.index_count * sizeof(unsigned int));
+  else
+    for (unsigned int i = 0; i < header.index_count; ++i)
+      m_data.indices[i] = ((unsigned short const *)cooked.indices())[i];
+  m_data.subsets.assign(cooked.subsets(), cooked.subsets() + header.subset_count);
+  for (int c = 0; c < 3; ++c)
+  {
+    m_data.bounds_min[c] = header.bounds_min[c];
+    m_data.bounds_max[c] = header.bounds_max[c];
+  }
+
+  /* Headless mode: system memory copy only */
+  if (device == NULL)
+  {
+    m_materials_count = header.material_count;
+    load_materials(device, materials);
+    return true;
+  }
+
+  DWORD const options = D3DXMESH_MANAGED | (header.index_size == 4 ? D3DXMESH_32BIT : 0);
+  ID3DXMesh *mesh;
+
+  if (D3DXCreateMeshFVF(header.index_count / 3, header.vertex_count, options, header.fvf, device, &mesh) != ERROR_SUCCESS)
+    return false;
+
+  /* Blobs are already in device layout, so buffers are filled by plain copies */
+  void *vertices, *indices;
+  DWORD *attributes;
+  if (mesh->LockVertexBuffer(0, &vertices) != ERROR_SUCCESS)
+  {
+    mesh->Release();
+    return false;
+  }
+  memcpy(vertices, cooked.vertices(), header.vertex_count * header.vertex_size);
+  mesh->UnlockVertexBuffer();
+
+  if (mesh->LockIndexBuffer(0, &indices) != ERROR_SUCCESS)
+  {
+    mesh->Release();
+    return false;
+  }
+  memcpy(indices, cooked.indices(), header.index_count * header.index_size);
+  mesh->UnlockIndexBuffer();
+
+  std::vector<D3DXATTRIBUTERANGE> table(header.subset_count);
+  mesh_subset_t const *subsets = cooked.subsets();
+  if (mesh->LockAttributeBuffer(0, &attributes) != ERROR_SUCCESS)
+  {
+    mesh->Release();
+    return false;
+  }
+  for (unsigned int i = 0; i < header.subset_count; ++i)
+  {
+    table[i].AttribId = subsets[i].material;
+    table[i].FaceStart = subsets[i].face_start;
+    table[i].FaceCount = subsets[i].face_count;
+    table[i].VertexStart = subsets[i].vertex_start;
+    table[i].VertexCount = subsets[i].vertex_count;
+    for (unsigned int f = 0; f < subsets[i].face_count; ++f)
+      attributes[subsets[i].face_start + f] = subsets[i].material;
+  }
+  mesh->UnlockAttributeBuffer();
+  if (!table.empty())
+    mesh->SetAttributeTable(&table[0], header.subset_count);
+
+  m_mesh = mesh;
+  m_materials_count = header.material_count;
+  load_materials(device, materials);
+  build_lod(device);
+  return true;
+}
+
+bool x_mesh_t::extract( mesh_data_t &data ) const
+{
+  DWORD subsets_count = 0;
+  void *vertices, *indices;
+
+  data.fvf = m_mesh->GetFVF();
+  data.vertex_size = m_mesh->GetNumBytesPerVertex();
+  data.vertices.resize(m_mesh->GetNumVertices() * data.vertex_size);
+  data.indices.resize(m_mesh->GetNumFaces() * 3);
+
+  if (m_mesh->LockVertexBuffer(D3DLOCK_READONLY, &vertices) != ERROR_SUCCESS)
+    return false;
+  memcpy(&data.vertices[0], vertices, data.vertices.size());
+  m_mesh->UnlockVertexBuffer();
+
+  if (m_mesh->LockIndexBuffer(D3DLOCK_READONLY, &indices) != ERROR_SUCCESS)
+    return false;
+  if (m_mesh->GetOptions() & D3DXMESH_32BIT)
+    memcpy(&data.indices[0], indices, data.indices.size() * sizeof(unsigned int));
+  else
+    for (size_t i = 0; i < data.indices.size(); ++i)
+      data.indices[i] = ((unsigned short const *)indices)[i];
+  m_mesh->UnlockIndexBuffer();
+
+  m_mesh->GetAttributeTable(NULL, &subsets_count);
+  std::vector<D3DXATTRIBUTERANGE> table(subsets_count);
+  if (subsets_count > 0)
+    m_mesh->GetAttributeTable(&table[0], &subsets_count);
+  data.subsets.resize(subsets_count);
+  for (DWORD i = 0; i < subsets_count; ++i)
+  {
+    data.subsets[i].material = table[i].AttribId;
+    data.subsets[i].face_start = table[i].FaceStart;
+    data.subsets[i].face_count = table[i].FaceCount;
+    data.subsets[i].vertex_start = table[i].VertexStart;
+    data.subsets[i].vertex_count = table[i].VertexCount;
+  }
+
+  data.update_bounds();
+  return true;
+}
+
+void x_mesh_t::load_materials( LPDIRECT3DDEVICE9 device, std::vector<mesh_material_t> const &materials )
+{
+  m_materials = new D3DMATERIAL9[materials.size()];
+  m_textures = new texture_t[materials.size()];
+
+  for (size_t i = 0; i < materials.size(); ++i)
+  {
+    memcpy(&m_materials[i], materials[i].diffuse, sizeof(D3DMATERIAL9));
+    m_materials[i].Ambient = m_materials[i].Diffuse;
+
+    if (device != NULL && !materials[i].texture_file.empty())
+    {
+      std::wstring str;
+      A2W(str, materials[i].texture_file);
+      m_textures[i].load(device, str.c_str());
+    }
+  }
+}
+
+void x_mesh_t::build_lod( LPDIRECT3DDEVICE9 device )
+{
+  if (m_data.vertices.empty() || m_data.indices.empty())
+    return;
+
+  m_lod.build(device, &m_data.vertices[0], m_data.vertex_size, m_data.vertex_count(), &m_data.indices[0], m_data.indices.size(),
+              m_data.subsets.empty() ? NULL : &m_data.subsets[0], m_data.subsets.size());
+}
+
+bool x_mesh_t::get_bounds( vec_t & center, float & radius ) const
+{
+  if (m_data.vertices.empty())
+    return false;
+
+  vec_t const box_min(m_data.bounds_min[0], m_data.bounds_min[1], m_data.bounds_min[2]);
+  vec_t const box_max(m_data.bounds_max[0], m_data.bounds_max[1], m_data.bounds_max[2]);
+  center = (box_min + box_max) * 0.5f;
+  radius = (box_max - box_min).length() * 0.5f;
+  return true;
+}
+
+bool x_mesh_t::get_subtree_bounds( vec_t & box_min, vec_t & box_max ) const
+{
+  if (m_data.vertices.empty())
+    return false;
+
+  box_min = vec_t(m_data.bounds_min[0], m_data.bounds_min[1], m_data.bounds_min[2]);
+  box_max = vec_t(m_data.bounds_max[0], m_data.bounds_max[1], m_data.bounds_max[2]);
+  return true;
+}
+
+void x_mesh_t::add_occluders( occlusion_culler_t & culler, transform_t const & world )
+{
+  vec_t center;
+  float radius;
+
+  if (!get_bounds(center, radius) || m_data.indices.empty() || !culler.is_occluder(world.matrix, center, radius))
+    return;
+  culler.add_occluder(&m_data.vertices[0], m_data.vertex_size, m_data.vertex_count(), &m_data.indices[0],
+                      m_data.face_count(), world.matrix);
 }
 
 void x_mesh_t::render( recursive_data_t & rd )
 {
+  if (rd.rasterizer != NULL)
+  {
+    render_soft(rd);
+    return;
+  }
+
+  vec_t center;
+  float radius;
+  size_t const level = get_bounds(center, radius) ? m_lod.select(rd.frame, rd.world(), center, radius) : 0;
+  m_lod.count_draw(level);
+  if (level > 0)
+  {
+    render_lod(rd, level);
+    return;
+  }
+
   auto_texture_saver_t(rd.device, 0);
   for (DWORD i = 0; i < m_materials_count; ++i)
   {
@@ -58,6 +380,37 @@ void x_mesh_t::render( recursive_data_t & rd )
   }
 }
 
+void x_mesh_t::render_lod( recursive_data_t & rd, size_t level )
+{
+  mesh_lod_level_t const &lod = m_lod.level(level);
+  IDirect3DVertexBuffer9 *vertices = NULL;
+
+  if (m_mesh->GetVertexBuffer(&vertices) != ERROR_SUCCESS)
+    return;
+  rd.device->SetFVF(m_mesh->GetFVF());
+  rd.device->SetStreamSource(0, vertices, 0, m_mesh->GetNumBytesPerVertex());
+  rd.device->SetIndices(lod.buffer);
+
+  /* Same subsets order and states as DrawSubset() calls */
+  auto_texture_saver_t(rd.device, 0);
+  for (size_t i = 0; i < lod.subsets.size(); ++i)
+  {
+    mesh_subset_t const &subset = lod.subsets[i];
+    if (subset.face_count == 0 || subset.material >= m_materials_count)
+      continue;
+
+    rd.device->SetMaterial(&(m_materials[subset.material]));
+    m_textures->bind(rd.device, 0);
+    rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_mesh->GetNumVertices(), subset.face_start * 3, subset.face_count);
+  }
+  vertices->Release();
+}
+
+void x_mesh_t::render_soft( recursive_data_t & rd )
+{
+  render_soft_data(rd, m_data, m_materials, m_materials_count);
+}
+
 x_mesh_t::~x_mesh_t()
 {
   if (m_materials)
@@ -67,3 +420,139 @@ x_mesh_t::~x_mesh_t()
   if (m_textures)
     delete[] m_textures;
 }
+
+skinned_mesh_t::skinned_mesh_t()
+  : m_posed_time(0)
+  , m_is_posed(false)
+  , m_vertices_buf(NULL)
+  , m_index_buf(NULL)
+  , m_textures(NULL)
+{
+}
+
+bool skinned_mesh_t::load( LPCWSTR file_name, LPDIRECT3DDEVICE9 device )
+{
+  /* Skinned meshes bypass the cooked cache, it keeps no bones */
+  if (!parse_x_file(file_name, m_scene) || m_scene.influences.empty() || !m_skin.create(m_scene.mesh, &m_scene.influences[0]))
+    return false;
+
+  mesh_data_t const &data = m_scene.mesh;
+  m_materials.resize(data.materials.size());
+  m_textures = new texture_t[data.materials.size()];
+  for (size_t i = 0; i < data.materials.size(); ++i)
+  {
+    memcpy(&m_materials[i], data.materials[i].diffuse, sizeof(D3DMATERIAL9));
+    m_materials[i].Ambient = m_materials[i].Diffuse;
+
+    if (device != NULL && !data.materials[i].texture_file.empty())
+    {
+      std::wstring str;
+      A2W(str, data.materials[i].texture_file);
+      m_textures[i].load(device, str.c_str());
+    }
+  }
+
+  if (device == NULL)
+    return true;
+
+  /* Vertices are rewritten every frame, indices once */
+  void *indices;
+  if (FAILED(device->CreateVertexBuffer((UINT)data.vertices.size(), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, data.fvf,
+                                        D3DPOOL_DEFAULT, &m_vertices_buf, NULL)) ||
+      FAILED(device->CreateIndexBuffer((UINT)(data.indices.size() * sizeof(unsigned int)), D3DUSAGE_WRITEONLY, D3DFMT_INDEX32,
+                                       D3DPOOL_MANAGED, &m_index_buf, NULL)) ||
+      FAILED(m_index_buf->Lock(0, 0, &indices, 0)))
+    return false;
+  memcpy(indices, &data.indices[0], data.indices.size() * sizeof(unsigned int));
+  m_index_buf->Unlock();
+  return true;
+}
+
+void skinned_mesh_t::pose( float time )
+{
+  if (m_is_posed && time == m_posed_time)
+    return;
+  m_is_posed = true;
+  m_posed_time = time;
+
+  if (m_clip)
+    m_clip->evaluate(time, m_pose);
+
+  /* Parents precede children in the frames list */
+  m_worlds.resize(m_scene.frames.size());
+  for (size_t i = 0; i < m_scene.frames.size(); ++i)
+  {
+    x_frame_t const &frame = m_scene.frames[i];
+    matrix_t local;
+
+    memcpy(local.M, frame.transform, sizeof(local.M));
+    if (i < m_pose.size())
+      local = m_pose.transform((unsigned int)i).matrix * local;
+    m_worlds[i] = frame.parent >= 0 ? local * m_worlds[frame.parent] : local;
+  }
+
+  skin_t::build_palette(m_scene.bones, m_worlds.empty() ? NULL : &m_worlds[0], m_palette);
+  m_skin.deform(&m_palette[0], &m_scene.mesh.vertices[0]);
+}
+
+bool skinned_mesh_t::get_bounds( vec_t & center, float & radius ) const
+{
+  mesh_data_t const &data = m_scene.mesh;
+  if (data.vertices.empty())
+    return false;
+
+  vec_t const box_min(data.bounds_min[0], data.bounds_min[1], data.bounds_min[2]);
+  vec_t const box_max(data.bounds_max[0], data.bounds_max[1], data.bounds_max[2]);
+  center = (box_min + box_max) * 0.5f;
+  radius = (box_max - box_min).length() * 0.5f;
+  return true;
+}
+
+void skinned_mesh_t::render( recursive_data_t & rd )
+{
+  mesh_data_t const &data = m_scene.mesh;
+  if (m_skin.vertices_count() == 0)
+    return;
+
+  pose(rd.frame.time);
+  if (rd.rasterizer != NULL)
+  {
+    render_soft_data(rd, data, m_materials.empty() ? NULL : &m_materials[0], m_materials.size());
+    return;
+  }
+  if (m_vertices_buf == NULL || m_index_buf == NULL)
+    return;
+
+  void *vertices;
+  if (FAILED(m_vertices_buf->Lock(0, 0, &vertices, D3DLOCK_DISCARD)))
+    return;
+  memcpy(vertices, &data.vertices[0], data.vertices.size());
+  m_vertices_buf->Unlock();
+
+  rd.device->SetFVF(data.fvf);
+  rd.device->SetStreamSource(0, m_vertices_buf, 0, data.vertex_size);
+  rd.device->SetIndices(m_index_buf);
+
+  auto_texture_saver_t(rd.device, 0);
+  for (size_t i = 0; i < data.subsets.size(); ++i)
+  {
+    mesh_subset_t const &subset = data.subsets[i];
+    if (subset.material >= m_materials.size())
+      continue;
+
+    rd.device->SetMaterial(&m_materials[subset.material]);
+    m_textures[subset.material].bind(rd.device, 0);
+    rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, subset.vertex_start, subset.vertex_count, subset.face_start * 3,
+                                    subset.face_count);
+  }
+}
+
+skinned_mesh_t::~skinned_mesh_t()
+{
+  if (m_vertices_buf)
+    m_vertices_buf->Release();
+  if (m_index_buf)
+    m_index_buf->Release();
+  if (m_textures)
+    delete[] m_textures;
+}
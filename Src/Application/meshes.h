@@ -9,23 +9,101 @@
 #ifndef __MESHES_INCLUDED__
 #define __MESHES_INCLUDED__
 
-#include <d3dx9mesh.h>
+#include <mutex>
+
+#include "animation.h"
+#include "d3d_api.h"
 #include "geometry.h"
+#include "mesh_cache.h"
+#include "mesh_lod.h"
+#include "skinning.h"
 #include "texture.h"
 #include "unit.h"
+#include "x_parser.h"
+
+/* Meshes loading statistics */
+struct mesh_load_stats_t
+{
+  unsigned int cooked_count;    /* loaded from cooked cache */
+  unsigned int parsed_count;    /* loaded from .x file */
+  double cooked_ms;
+  double parsed_ms;
+  double cooking_ms;            /* spent on writing cache */
+  double parse_ms;              /* spent in .x parser only */
+  unsigned long long parsed_bytes;
+};
 
 class x_mesh_t : public IAnimationUnit
 {
 public:
-  x_mesh_t() : m_mesh(0), m_materials(0), m_materials_count(0), m_textures(0) {}
+  x_mesh_t() : m_mesh(0), m_materials(0), m_textures(0), m_materials_count(0) {}
+  /* Load mesh from cooked cache, cook it from .x file on cache miss */
   void load( LPCWSTR file_name, LPDIRECT3DDEVICE9 device );
   void render( recursive_data_t & rd );
+  bool get_bounds( vec_t & center, float & radius ) const;
+  bool get_subtree_bounds( vec_t & box_min, vec_t & box_max ) const;
+  /* Full detail mesh occludes when large enough on screen */
+  void add_occluders( occlusion_culler_t & culler, transform_t const & world );
   ~x_mesh_t();
+
+  /* Loading may run on several threads, statistics are returned by copy */
+  static mesh_load_stats_t load_stats( void );
 private:
+  bool load_x( LPCWSTR file_name, LPDIRECT3DDEVICE9 device, std::vector<mesh_material_t> &materials );
+  bool load_cooked( cooked_mesh_t const &cooked, LPDIRECT3DDEVICE9 device );
+  /* Copy loaded mesh buffers for cooking */
+  bool extract( mesh_data_t &data ) const;
+  void load_materials( LPDIRECT3DDEVICE9 device, std::vector<mesh_material_t> const &materials );
+  void build_lod( LPDIRECT3DDEVICE9 device );
+  void render_soft( recursive_data_t & rd );
+  void render_lod( recursive_data_t & rd, size_t level );
+
+  static void add_load_stats( mesh_load_stats_t const &stats );
+
+  static mesh_load_stats_t s_load_stats;
+  static std::mutex s_load_stats_mutex;
+
   ID3DXMesh *m_mesh;
+  /* System memory copy for software rasterizer */
+  mesh_data_t m_data;
+  /* Simplified levels drawn with the mesh vertex buffer */
+  mesh_lod_t m_lod;
   D3DMATERIAL9 *m_materials;
   texture_t *m_textures;
   DWORD m_materials_count;
 };
 
+/* .x mesh with skin weights deformed on CPU before drawing. Frames follow an optional clip
+ * of frame nodes applied on top of their bind transforms, vertices follow the frames */
+class skinned_mesh_t : public IAnimationUnit
+{
+public:
+  skinned_mesh_t();
+  /* Parse .x file, false for files without skin weights */
+  bool load( LPCWSTR file_name, LPDIRECT3DDEVICE9 device );
+  void set_clip( std::shared_ptr<animation_clip_t const> const &clip ) { m_clip = clip; }
+  void render( recursive_data_t & rd );
+  /* Bind pose bounds */
+  bool get_bounds( vec_t & center, float & radius ) const;
+  ~skinned_mesh_t();
+private:
+  /* Frame worlds of clip pose at 'time' and skinned vertices of them */
+  void pose( float time );
+
+  /* Mesh vertices are replaced by skinned ones */
+  x_scene_t m_scene;
+  skin_t m_skin;
+  std::shared_ptr<animation_clip_t const> m_clip;
+  animation_pose_t m_pose;
+  std::vector<matrix_t> m_worlds;
+  std::vector<matrix_t> m_palette;
+  float m_posed_time;
+  bool m_is_posed;
+
+  IDirect3DVertexBuffer9 *m_vertices_buf;
+  IDirect3DIndexBuffer9 *m_index_buf;
+  std::vector<D3DMATERIAL9> m_materials;
+  texture_t *m_textures;
+};
+
 #endif /* __MESHES_INCLUDED__ */
@@ -0,0 +1,413 @@
+/**
+@file     mipmap.cpp
+@brief    CPU mipmap chain generator implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "parallel.h"
+#include "stopwatch.h"
+#include "mipmap.h"
+
+namespace
+{
+  /* Destination rows processed by one task */
+  const size_t c_rows_per_task = 32;
+
+  /* Kaiser filter taps count and window shape */
+  const int c_kaiser_taps = 8;
+  const float c_kaiser_alpha = 4.f;
+  const float c_kaiser_radius = 2.f;
+  const float c_pi = 3.1415927f;
+
+  /* Conversion tables between 8 bit and linear float values */
+  struct conversion_tables_t
+  {
+    float srgb_to_linear[256];
+    float unorm_to_float[256];
+    unsigned char linear_to_srgb[4096];
+
+    conversion_tables_t()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        float const c = i / 255.f;
+        unorm_to_float[i] = c;
+        srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+      }
+      for (int i = 0; i < 4096; ++i)
+      {
+        float const l = i / 4095.f;
+        float const c = l <= 0.0031308f ? l * 12.92f : 1.055f * pow(l, 1 / 2.4f) - 0.055f;
+        linear_to_srgb[i] = (unsigned char)(c * 255 + 0.5f);
+      }
+    }
+  };
+
+  /* Built at startup, so worker threads only read it */
+  conversion_tables_t const s_tables;
+
+  /* Zero order modified Bessel function of the first kind */
+  float bessel_i0( float x )
+  {
+    float sum = 1, term = 1;
+    float const half_x2 = x * x / 4;
+
+    for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+    {
+      term *= half_x2 / (float)(k * k);
+      sum += term;
+    }
+    return sum;
+  }
+
+  /* Normalized 2:1 downsampling Kaiser windowed sinc weights.
+   * Tap k samples source pixel 2 * x - 3 + k for destination pixel x.
+   */
+  void kaiser_weights( float weights[c_kaiser_taps] )
+  {
+    float sum = 0;
+
+    for (int k = 0; k < c_kaiser_taps; ++k)
+    {
+      /* Distance from destination pixel center in destination pixels */
+      float const t = (k - 3.5f) / 2;
+      float const pt = c_pi * t;
+      float const sinc = fabs(t) < 1e-6f ? 1 : sin(pt) / pt;
+      float const r = t / c_kaiser_radius;
+      float const window = r * r < 1 ? bessel_i0(c_kaiser_alpha * sqrt(1 - r * r)) / bessel_i0(c_kaiser_alpha) : 0;
+
+      weights[k] = sinc * window;
+      sum += weights[k];
+    }
+    for (int k = 0; k < c_kaiser_taps; ++k)
+      weights[k] /= sum;
+  }
+
+  /* Read image row as linear RGBA floats */
+  void decode_row( image_t const &img, unsigned int y, float *dst, bool srgb )
+  {
+    if (img.format == PIXEL_FORMAT_RGBA32F)
+    {
+      memcpy(dst, img.row(y), img.pitch());
+      return;
+    }
+
+    unsigned char const *src = img.row(y);
+    float const *color_table = srgb ? s_tables.srgb_to_linear : s_tables.unorm_to_float;
+    for (unsigned int x = 0; x < img.width; ++x, src += 4, dst += 4)
+    {
+      dst[0] = color_table[src[0]];
+      dst[1] = color_table[src[1]];
+      dst[2] = color_table[src[2]];
+      dst[3] = s_tables.unorm_to_float[src[3]];
+    }
+  }
+
+  /* Write linear RGBA floats to image row */
+  void encode_row( float const *src, image_t &img, unsigned int y, bool srgb )
+  {
+    if (img.format == PIXEL_FORMAT_RGBA32F)
+    {
+      memcpy(img.row(y), src, img.pitch());
+      return;
+    }
+
+    float const color_scale = srgb ? 4095.f : 255.f;
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1);
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const scale = _mm_set_ps(255.f, color_scale, color_scale, color_scale);
+    unsigned char *dst = img.row(y);
+    int quantized[4];
+
+    for (unsigned int x = 0; x < img.width; ++x, src += 4, dst += 4)
+    {
+      __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), zero), one);
+      v = _mm_add_ps(_mm_mul_ps(v, scale), half);
+      _mm_storeu_si128((__m128i *)quantized, _mm_cvttps_epi32(v));
+
+      if (srgb)
+      {
+        dst[0] = s_tables.linear_to_srgb[quantized[0]];
+        dst[1] = s_tables.linear_to_srgb[quantized[1]];
+        dst[2] = s_tables.linear_to_srgb[quantized[2]];
+      }
+      else
+      {
+        dst[0] = (unsigned char)quantized[0];
+        dst[1] = (unsigned char)quantized[1];
+        dst[2] = (unsigned char)quantized[2];
+      }
+      dst[3] = (unsigned char)quantized[3];
+    }
+  }
+
+  /* Source texels of one destination texel along an axis with their weights */
+  struct box_taps_t
+  {
+    unsigned int count;
+    unsigned int index[3];
+    float weight[3];
+  };
+
+  /* Even sizes average 2 texels. Odd ones take 3 texels with weights of the source texels parts
+   * covered by the destination one, so the last source column or row is not dropped */
+  box_taps_t box_taps( unsigned int x, unsigned int src_size, unsigned int dst_size )
+  {
+    box_taps_t taps;
+
+    if (src_size == 1)
+    {
+      taps.count = 1;
+      taps.index[0] = 0;
+      taps.weight[0] = 1;
+    }
+    else if (src_size % 2 == 0)
+    {
+      taps.count = 2;
+      taps.index[0] = x * 2;
+      taps.index[1] = x * 2 + 1;
+      taps.weight[0] = taps.weight[1] = 0.5f;
+    }
+    else
+    {
+      float const size = (float)src_size;
+
+      taps.count = 3;
+      for (unsigned int i = 0; i < 3; ++i)
+        taps.index[i] = x * 2 + i;
+      taps.weight[0] = (dst_size - x) / size;
+      taps.weight[1] = dst_size / size;
+      taps.weight[2] = (x + 1) / size;
+    }
+    return taps;
+  }
+
+  /* Box filter rows [first, last) of destination level */
+  void box_rows( image_t const &src, image_t &dst, size_t first, size_t last, bool srgb )
+  {
+    size_t const row_size = src.width * 4;
+    std::vector<float> rows(row_size * 3), column(row_size), out(dst.width * 4);
+    std::vector<box_taps_t> x_taps(dst.width);
+
+    for (unsigned int x = 0; x < dst.width; ++x)
+      x_taps[x] = box_taps(x, src.width, dst.width);
+
+    for (size_t y = first; y < last; ++y)
+    {
+      box_taps_t const y_taps = box_taps((unsigned int)y, src.height, dst.height);
+
+      /* Source rows are weighted to one row first, then its texels are */
+      for (unsigned int t = 0; t < y_taps.count; ++t)
+        decode_row(src, y_taps.index[t], &rows[t * row_size], srgb);
+      for (size_t i = 0; i < row_size; i += 4)
+      {
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(&rows[i]), _mm_set1_ps(y_taps.weight[0]));
+
+        for (unsigned int t = 1; t < y_taps.count; ++t)
+          sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&rows[t * row_size + i]), _mm_set1_ps(y_taps.weight[t])));
+        _mm_storeu_ps(&column[i], sum);
+      }
+
+      for (unsigned int x = 0; x < dst.width; ++x)
+      {
+        box_taps_t const &taps = x_taps[x];
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(&column[taps.index[0] * 4]), _mm_set1_ps(taps.weight[0]));
+
+        for (unsigned int t = 1; t < taps.count; ++t)
+          sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&column[taps.index[t] * 4]), _mm_set1_ps(taps.weight[t])));
+        _mm_storeu_ps(&out[x * 4], sum);
+      }
+      encode_row(&out[0], dst, (unsigned int)y, srgb);
+    }
+  }
+
+  /* Horizontally filtered source rows cache for the Kaiser filter */
+  class kaiser_rows_cache_t
+  {
+  public:
+    kaiser_rows_cache_t( image_t const &src, unsigned int dst_width, float const *weights, bool srgb )
+      : m_src(src)
+      , m_dst_width(dst_width)
+      , m_weights(weights)
+      , m_srgb(srgb)
+      , m_decoded(src.width * 4)
+    {
+      for (int i = 0; i < c_kaiser_taps; ++i)
+      {
+        m_rows[i] = -1;
+        m_data[i].resize(dst_width * 4);
+      }
+    }
+
+    /* Get horizontally filtered source row (row index must be valid) */
+    float const * get( int y )
+    {
+      int const slot = y & (c_kaiser_taps - 1);
+
+      if (m_rows[slot] != y)
+      {
+        decode_row(m_src, y, &m_decoded[0], m_srgb);
+        filter(&m_data[slot][0]);
+        m_rows[slot] = y;
+      }
+      return &m_data[slot][0];
+    }
+  private:
+    void filter( float *out )
+    {
+      int const width = (int)m_src.width;
+      float const *in = &m_decoded[0];
+
+      for (int x = 0; x < (int)m_dst_width; ++x, out += 4)
+      {
+        int const first = 2 * x - 3;
+        __m128 sum = _mm_setzero_ps();
+
+        if (first >= 0 && first + c_kaiser_taps <= width)
+        {
+          for (int k = 0; k < c_kaiser_taps; ++k)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + (first + k) * 4), _mm_set1_ps(m_weights[k])));
+        }
+        else
+        {
+          for (int k = 0; k < c_kaiser_taps; ++k)
+          {
+            int const sx = first + k < 0 ? 0 : first + k >= width ? width - 1 : first + k;
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + sx * 4), _mm_set1_ps(m_weights[k])));
+          }
+        }
+        _mm_storeu_ps(out, sum);
+      }
+    }
+
+    image_t const &m_src;
+    unsigned int m_dst_width;
+    float const *m_weights;
+    bool m_srgb;
+    std::vector<float> m_decoded;
+    int m_rows[c_kaiser_taps];
+    std::vector<float> m_data[c_kaiser_taps];
+  };
+
+  /* Separable Kaiser filter rows [first, last) of destination level */
+  void kaiser_rows( image_t const &src, image_t &dst, size_t first, size_t last, float const *weights, bool srgb )
+  {
+    kaiser_rows_cache_t cache(src, dst.width, weights, srgb);
+    std::vector<float> out(dst.width * 4);
+    int const height = (int)src.height;
+
+    for (size_t y = first; y < last; ++y)
+    {
+      float const *rows[c_kaiser_taps];
+      int const first_row = 2 * (int)y - 3;
+
+      for (int k = 0; k < c_kaiser_taps; ++k)
+      {
+        int const sy = first_row + k < 0 ? 0 : first_row + k >= height ? height - 1 : first_row + k;
+        rows[k] = cache.get(sy);
+      }
+
+      for (unsigned int x = 0; x < dst.width * 4; x += 4)
+      {
+        __m128 sum = _mm_setzero_ps();
+
+        for (int k = 0; k < c_kaiser_taps; ++k)
+          sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + x), _mm_set1_ps(weights[k])));
+        _mm_storeu_ps(&out[x], sum);
+      }
+      encode_row(&out[0], dst, (unsigned int)y, srgb);
+    }
+  }
+}
+
+unsigned int mip_levels_count( unsigned int width, unsigned int height )
+{
+  unsigned int levels = 1;
+
+  while (width > 1 || height > 1)
+  {
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+    ++levels;
+  }
+  return levels;
+}
+
+unsigned int build_mip_chain( image_t const &base, std::vector<image_t> &chain, mip_params_t const &params )
+{
+  if (base.width == 0 || base.height == 0 || base.data.size() < base.pitch() * base.height)
+    return 0;
+
+  unsigned int levels = mip_levels_count(base.width, base.height);
+  if (params.max_levels != 0 && params.max_levels < levels)
+    levels = params.max_levels;
+
+  bool const srgb = params.srgb && base.format == PIXEL_FORMAT_RGBA8;
+  float weights[c_kaiser_taps];
+  kaiser_weights(weights);
+
+  chain.resize(levels);
+  chain[0] = base;
+  for (unsigned int level = 1; level < levels; ++level)
+  {
+    image_t const &src = chain[level - 1];
+    image_t &dst = chain[level];
+
+    dst = image_t(src.width > 1 ? src.width / 2 : 1, src.height > 1 ? src.height / 2 : 1, base.format);
+    /* Levels of one task are filtered on this thread without waking the pool */
+    unsigned int const threads = dst.height <= c_rows_per_task ? 1 : params.threads;
+    /* Kaiser weights are for the even 2:1 phase, odd sides are box filtered */
+    bool const is_odd = (src.width > 1 && src.width % 2 != 0) || (src.height > 1 && src.height % 2 != 0);
+    if (params.filter == MIP_FILTER_BOX || is_odd)
+      parallel_for(0, dst.height, c_rows_per_task, [&]( size_t first, size_t last )
+      {
+        box_rows(src, dst, first, last, srgb);
+      }, threads);
+    else
+      parallel_for(0, dst.height, c_rows_per_task, [&]( size_t first, size_t last )
+      {
+        kaiser_rows(src, dst, first, last, weights, srgb);
+      }, threads);
+  }
+  return levels;
+}
+
+mip_benchmark_t benchmark_mip_chain( unsigned int size, mip_filter_t filter, unsigned int threads )
+{
+  mip_benchmark_t result;
+  image_t base(size, size, PIXEL_FORMAT_RGBA8);
+
+  /* Gradients with a checker of 4 texel cells, so every filter tap sees varying texels */
+  for (unsigned int y = 0; y < size; ++y)
+  {
+    unsigned char *texel = base.row(y);
+    for (unsigned int x = 0; x < size; ++x, texel += 4)
+    {
+      unsigned char const checker = ((x / 4 + y / 4) & 1) != 0 ? 64 : 0;
+      texel[0] = (unsigned char)(x * 255 / size) ^ checker;
+      texel[1] = (unsigned char)(y * 255 / size) ^ checker;
+      texel[2] = (unsigned char)((x + y) * 127 / size);
+      texel[3] = 255;
+    }
+  }
+
+  mip_params_t params;
+  params.filter = filter;
+  params.threads = threads;
+
+  std::vector<image_t> chain;
+  stopwatch_t timer;
+  result.levels_count = build_mip_chain(base, chain, params);
+  result.build_ms = timer.elapsed_ms();
+  result.size = size;
+  result.filter = filter;
+  result.threads_count = threads != 0 ? threads : parallel_threads_count();
+  return result;
+}
@@ -0,0 +1,108 @@
+/**
+@file     mipmap.h
+@brief    CPU mipmap chain generator definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __MIPMAP_INCLUDED__
+#define __MIPMAP_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+/* Pixel formats of CPU side images */
+enum pixel_format_t
+{
+  PIXEL_FORMAT_RGBA8,   /* 4 x 8 bit unsigned normalized, alpha in the last byte */
+  PIXEL_FORMAT_RGBA32F  /* 4 x 32 bit float, alpha in the last component */
+};
+
+/* CPU side image (one mipmap level) */
+struct image_t
+{
+  unsigned int width;
+  unsigned int height;
+  pixel_format_t format;
+  std::vector<unsigned char> data;
+
+  image_t() : width(0), height(0), format(PIXEL_FORMAT_RGBA8) {}
+  image_t( unsigned int w, unsigned int h, pixel_format_t fmt )
+    : width(w)
+    , height(h)
+    , format(fmt)
+    , data(w * h * pixel_size(fmt))
+  {
+  }
+
+  static size_t pixel_size( pixel_format_t fmt )
+  {
+    return fmt == PIXEL_FORMAT_RGBA8 ? 4 : 16;
+  }
+
+  size_t pitch( void ) const
+  {
+    return width * pixel_size(format);
+  }
+
+  unsigned char * row( unsigned int y )
+  {
+    return &data[0] + y * pitch();
+  }
+
+  unsigned char const * row( unsigned int y ) const
+  {
+    return &data[0] + y * pitch();
+  }
+};
+
+/* Downsampling filters */
+enum mip_filter_t
+{
+  MIP_FILTER_BOX,   /* 2x2 average, 3 taps along odd sizes */
+  MIP_FILTER_KAISER /* 8 tap Kaiser windowed sinc, separable, box for levels with odd sides */
+};
+
+/* Mipmap chain generation parameters */
+struct mip_params_t
+{
+  mip_filter_t filter;
+  bool srgb;               /* Color channels of RGBA8 images are sRGB encoded: filter in linear space */
+  unsigned int max_levels; /* Maximum levels count including the base one, 0 - full chain */
+  unsigned int threads;    /* Worker threads count, 0 - all hardware threads */
+
+  mip_params_t()
+    : filter(MIP_FILTER_KAISER)
+    , srgb(true)
+    , max_levels(0)
+    , threads(0)
+  {
+  }
+};
+
+/* Full chain levels count for the image size */
+unsigned int mip_levels_count( unsigned int width, unsigned int height );
+
+/* Build mipmap chain for the base image. Chain level 0 is a copy of the base image,
+ * all levels have the base image pixel format. Returns levels count (0 on failure).
+ */
+unsigned int build_mip_chain( image_t const &base, std::vector<image_t> &chain,
+                              mip_params_t const &params = mip_params_t() );
+
+/* Full chain build of a square RGBA8 sRGB image */
+struct mip_benchmark_t
+{
+  unsigned int size;
+  mip_filter_t filter;
+  unsigned int threads_count;
+  unsigned int levels_count;
+  double build_ms;
+
+  /* Base level megapixels per second */
+  double rate( void ) const { return build_ms > 0 ? (double)size * size / build_ms / 1000 : 0; }
+};
+
+mip_benchmark_t benchmark_mip_chain( unsigned int size, mip_filter_t filter, unsigned int threads );
+
+#endif /* __MIPMAP_INCLUDED__ */
@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <cstdlib>
+#include <string>
 #include <windows.h>
 #include <windowsx.h>
 #include <zmouse.h>
@@ -23,8 +24,13 @@
 
 #include <d3dx9math.h>
 
-#include "airplane.h"
-#include "flower.h"
+#include "allocators.h"
+#include "frame_context.h"
+#include "impostor.h"
+#include "mesh_lod.h"
+#include "terrain.h"
+#include "meshes.h"
+#include "vertex_format.h"
 
 // *******************************************************************
 // defines
@@ -47,22 +53,27 @@ static int s_minmag[2] = {D3DTEXF_POINT, D3DTEXF_LINEAR};
 // Methods
 
 myApp::myApp( int nW, int nH, void* hInst, int nCmdShow )
-  : cglApp(nW, nH, hInst, nCmdShow)
+  : cglApp(nW, nH, hInst, nCmdShow, true)
   , m_nPrevMouseX(-100)
   , m_nPrevMouseY(-100)
   , m_is_wireframe(false)
   , m_is_fixed_camera(false)
+  , m_is_occlusion(false)
   , m_mipmap_index(0)
   , m_min_index(0)
   , m_mag_index(0)
   , m_bias(0)
+  , m_hud_page(HUD_PAGE_LOADING)
   , m_font(0)
+  , m_scene(m_pD3D->getDevice())
 {
   for (int i = 0; i < MAX_KEYS; i++)
     m_keysPressed[i] = false;
-  m_nClearColor = 0xFF222222;
-  m_camera.set_camera(vec_t(5, 5, 5.f), vec_t(0.f), vec_t(0.f, 1.f, 0.f), true);
-  m_camera.set_near_far(0.5, 10000.f);
+  m_nClearColor = scene_t::c_clear_color;
+  scene_t::reset_camera(m_camera);
+  /* Reversed depth only pays off with float depth buffer */
+  set_depth_mode(m_pD3D->isFloatDepth(), m_pD3D->isFloatDepth());
+  m_soft_rasterizer.resize(nW, nH);
 
   IDirect3DDevice9 *device  = m_pD3D->getDevice();
   device->SetRenderState(D3DRS_SPECULARENABLE, true);
@@ -70,52 +81,6 @@ myApp::myApp( int nW, int nH, void* hInst, int nCmdShow )
   device->SetRenderState(D3DRS_NORMALIZENORMALS, true);
 
   device->SetSamplerState( 0, D3DSAMP_MIPFILTER, s_mipmap[m_mipmap_index] );
-
-  direction_light.set_ambient(color_t(0.1f));
-  direction_light.set_diffuse(color_t(0.6f));
-  direction_light.set_specular(color_t(0.1f));
-  direction_light.set_direction(vec_t(-1, -1, 0.01f));
-  direction_light.set(device, 0);
-  direction_light.enable(device);
-
-  /*** Add units to render ***/
-  m_units.push_back((IAnimationUnit *)new base_plane_t(device));
-
-  m_units.push_back((IAnimationUnit *)new airplane_t(device));
-
-  flower_params_t params;
-  params.petal2_height = 0.1f;
-  params.petal2_width = 0.03f;
-  params.petal2_color = color_t(1, 0, 0);
-  params.petal2_angle_min = 5.f;
-  params.petal2_angle_max = 20.f;
-
-  params.petal1_height = 0.1f;
-  params.petal1_width = 0.1f;
-  params.petal1_color = color_t(0x00CC00UL);
-  params.petal1_angle_min = 5.f;
-  params.petal1_angle_max = 60.f;
-
-  params.receptacle_radius = 0.12f;
-  params.receptacle_color = color_t(0xFFCC33UL);
-
-  params.petals_count = 12;
-  params.velocity = 1.f;
-
-  params.stem_thickness = 0.03f;
-  params.stem_length = 0.7f;
-  params.stem_color = color_t(0x003300UL);
-  
-  for (size_t i = 0; i < 10; ++i)
-    for (size_t j = 0; j < 10; ++j)
-    {
-      params.velocity =  (rand() / (float)RAND_MAX + 0.1f) * 2;
-      flower_t *flower = new flower_t(device, params);
-      float const x = rand() / (float)RAND_MAX * 40 - 20;
-      float const z = rand() / (float)RAND_MAX * 40 - 20;
-      flower->transform().translate(x, 0, z);
-      m_units.push_back((IAnimationUnit *)flower);
-    }
 }
 
 bool myApp::processInput(unsigned int nMsg, int wParam, long lParam)
@@ -158,7 +123,7 @@ bool myApp::processInput(unsigned int nMsg, int wParam, long lParam)
       {
       case VK_SPACE:
         m_is_fixed_camera = !m_is_fixed_camera;
-        m_camera.look_at = vec_t(0, 0, 0);
+        m_camera.look_at = relative_position(dvec_t(0, 0, 0), m_origin.position());
         m_camera.up = vec_t(0, 1, 0);
         m_camera.update_look_at_loc_up();
         break;
@@ -188,6 +153,18 @@ bool myApp::processInput(unsigned int nMsg, int wParam, long lParam)
         m_min_index = (m_min_index + 1) % 2;
         m_pD3D->getDevice()->SetSamplerState( 0, D3DSAMP_MINFILTER , s_minmag[m_min_index] );
         break;
+      case 'Z':
+        /* Conventional, reversed, reversed with infinite far plane */
+        if (!m_camera.is_reversed_depth)
+          set_depth_mode(true, false);
+        else if (!m_camera.is_infinite_far)
+          set_depth_mode(true, true);
+        else
+          set_depth_mode(false, false);
+        break;
+      case 'O':
+        m_is_occlusion = !m_is_occlusion;
+        break;
       case 'G':
         m_mag_index = (m_mag_index + 1) % 2;
         m_pD3D->getDevice()->SetSamplerState( 0, D3DSAMP_MAGFILTER, s_minmag[m_mag_index] );
@@ -196,6 +173,12 @@ bool myApp::processInput(unsigned int nMsg, int wParam, long lParam)
         m_is_wireframe = !m_is_wireframe;
         m_pD3D->getDevice()->SetRenderState(D3DRS_FILLMODE, m_is_wireframe ? D3DFILL_WIREFRAME : D3DFILL_SOLID);
         break;
+      case VK_F2:
+        render_soft();
+        break;
+      case VK_TAB:
+        m_hud_page = (m_hud_page + 1) % HUD_PAGES_COUNT;
+        break;
       case VK_ADD:
       case VK_OEM_PLUS:
         if (m_keysPressed[VK_SHIFT])
@@ -254,20 +237,122 @@ void myApp::renderInternal()
 {
   D3DXMATRIX proj, view;
   IDirect3DDevice9 *device = m_pD3D->getDevice();
-  device->SetTransform(D3DTS_PROJECTION, (D3DMATRIX *)m_camera.get_projection_matrix().M);
-  device->SetTransform(D3DTS_VIEW, (D3DMATRIX *)m_camera.get_view_matrix().M);
+  frame_context_t const frame(m_camera, m_timer.getTime(), m_timer.getDelta(), m_origin.position());
+  device->SetTransform(D3DTS_PROJECTION, (D3DMATRIX *)frame.projection.M);
+  device->SetTransform(D3DTS_VIEW, (D3DMATRIX *)frame.view.M);
+  device->SetRenderState(D3DRS_ZFUNC, frame.is_reversed_depth ? D3DCMP_GREATEREQUAL : D3DCMP_LESSEQUAL);
+
+  recursive_data_t rd(device, frame);
+  rd.occlusion = m_is_occlusion ? &m_occlusion : NULL;
+  m_scene.render(rd);
 
-  recursive_data_t rd(device, m_camera, m_timer, transform_t());
-  for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
-    (*it)->treat_as_unit(rd);
+  char occlusion_report[200] = "off";
+  if (m_is_occlusion)
+  {
+    occlusion_stats_t const &stats = m_occlusion.stats();
+    sprintf_s(occlusion_report, "%u occluders, %u of %u culled (%.1f%%), %.2f ms on %u threads",
+              stats.occluders_count, stats.culled_count, stats.tests_count, stats.culled_percent(),
+              stats.build_ms + stats.test_ms, stats.threads_count);
+  }
+
+  static char const * const hud_pages[HUD_PAGES_COUNT] = {"off", "loading", "lighting", "geometry", "frame"};
 
   char buf[1000] = {0};
-  sprintf_s(buf, "MipMap: %s\nMin filter: %s\nMagFilter: %s\nMipMap bias: %f",
+  sprintf_s(buf, "MipMap: %s; world origin %.0f, %.0f, %.0f (%u rebases)\nMin filter: %s\nMagFilter: %s\nMipMap bias: %f; occlusion (O): %s\nDepth (Z): %s%s, %s buffer\nStatistics (Tab): %s",
              m_mipmap_index == 0 ? "D3DTEXF_POINT" : m_mipmap_index == 1 ? "D3DTEXF_LINEAR" : "D3DTEXF_NONE",
+             m_origin.position().x, m_origin.position().y, m_origin.position().z, m_origin.rebases_count(),
              m_min_index == 0 ? "D3DTEXF_POINT" : "D3DTEXF_LINEAR",
              m_mag_index == 0 ? "D3DTEXF_POINT" : "D3DTEXF_LINEAR",
-             m_bias);
-  print_text(buf, 0, 0, 1000, 100, color_t(.5f, 0.5f, 0.5f));
+             m_bias, occlusion_report, m_camera.is_reversed_depth ? "reversed" : "conventional", m_camera.is_infinite_far ? ", infinite far" : "",
+             m_pD3D->isFloatDepth() ? "D24FS8" : "D24S8", hud_pages[m_hud_page]);
+  print_text(buf, 0, 0, 1000, 120, color_t(.5f, 0.5f, 0.5f));
+
+  /* One statistics page at a time below the settings. Subsystem benchmarks are run by headless mode ('-bench NAME') */
+  std::string page;
+  switch (m_hud_page)
+  {
+  case HUD_PAGE_LOADING:
+  {
+    texture_load_stats_t const tex_stats = texture_t::load_stats();
+    sprintf_s(buf, "Textures cooked: %u (%.1f ms)\nTextures decoded: %u (%.1f ms, cooking %.1f ms)\n",
+              tex_stats.cooked_count, tex_stats.cooked_ms, tex_stats.decoded_count, tex_stats.decoded_ms, tex_stats.cooking_ms);
+    page += buf;
+
+    mesh_load_stats_t const mesh_stats = x_mesh_t::load_stats();
+    sprintf_s(buf, "Meshes cooked: %u (%.1f ms)\nMeshes parsed: %u (%.1f ms, parser %.1f MB/s, cooking %.1f ms)\n",
+              mesh_stats.cooked_count, mesh_stats.cooked_ms, mesh_stats.parsed_count, mesh_stats.parsed_ms,
+              mesh_stats.parse_ms > 0 ? mesh_stats.parsed_bytes / mesh_stats.parse_ms / 1000 : 0., mesh_stats.cooking_ms);
+    page += buf;
+
+    job_graph_stats_t const jobs_stats = m_scene.startup_stats();
+    sprintf_s(buf, "Startup: %u/%u jobs on %u threads, wall %.1f ms, work %.1f ms\nCritical path: %.1f ms (%s)\n",
+              jobs_stats.done_count, jobs_stats.jobs_count, jobs_stats.threads_count, jobs_stats.wall_ms, jobs_stats.work_ms,
+              jobs_stats.critical_path_ms, jobs_stats.critical_path.c_str());
+    page += buf;
+
+    geometry_cache_stats_t const cache_stats = geometry_cache().stats();
+    sprintf_s(buf, "Geometry cache: %u requests, %.1f%% hits (%u waited in flight), %u entries, %.1f KB",
+              cache_stats.requests, cache_stats.requests > 0 ? 100.f * cache_stats.hits / cache_stats.requests : 0.f,
+              cache_stats.in_flight_waits, cache_stats.entries, cache_stats.memory / 1024.f);
+    page += buf;
+    break;
+  }
+  case HUD_PAGE_LIGHTING:
+  {
+    light_cluster_stats_t const light_stats = m_scene.light_stats();
+    light_bake_stats_t const bake_stats = light_bake_cache().stats();
+    sprintf_s(buf, "Lights: %u (%u directional, %u visible), %u cluster entries, up to %u per cluster, %u draws lit, build %.2f ms\n"
+                   "Light uploads: %u, avoided %u, enable changes %u\nBaked lighting: %u bakes of %u vertices (%.1f ms), %.1f KB\n",
+              light_stats.lights_count, light_stats.global_count, light_stats.visible_count, light_stats.entries_count,
+              light_stats.max_cluster_lights, light_stats.selections_count, light_stats.build_ms,
+              light_stats.uploads_count, light_stats.uploads_avoided, light_stats.enables_count,
+              bake_stats.bakes, bake_stats.baked_vertices, bake_stats.bake_ms, bake_stats.memory / 1024.f);
+    page += buf;
+
+    vertex_compression_stats_t const vertex_stats = vertex_compression_stats();
+    sprintf_s(buf, "Vertex buffers: %u (%u compressed, %s), %.1f KB of %.1f KB; max error: position %.1e, normal %.2f deg, uv %.1e",
+              vertex_stats.buffers_count, vertex_stats.compressed_count, device_vertex_format().name().c_str(),
+              vertex_stats.memory / 1024.f, vertex_stats.full_memory / 1024.f, vertex_stats.error.max_position,
+              vertex_stats.error.max_normal, vertex_stats.error.max_uv);
+    page += buf;
+    break;
+  }
+  case HUD_PAGE_GEOMETRY:
+  {
+    mesh_lod_stats_t const lod_stats = mesh_lod_stats();
+    sprintf_s(buf, "LOD: %u meshes, %u levels (%.1f ms); %u of %u draws simplified, %u of %u triangles drawn (%u saved)\n",
+              lod_stats.meshes_count, lod_stats.levels_count, lod_stats.build_ms, lod_stats.lod_draws_count, lod_stats.draws_count,
+              (unsigned int)lod_stats.drawn_triangles, (unsigned int)lod_stats.full_triangles,
+              (unsigned int)(lod_stats.full_triangles - lod_stats.drawn_triangles));
+    page += buf;
+
+    terrain_stats_t const terrain = terrain_stats();
+    sprintf_s(buf, "Terrain: %u chunks drawn (%u culled), %u of %.0f full detail triangles\n"
+                   "Terrain chunks: %u resident (%.1f MB), %u built (%.1f ms), %u requested\n",
+              terrain.visible_count, terrain.culled_count, (unsigned int)terrain.drawn_triangles, terrain.full_triangles,
+              terrain.resident_count, terrain.memory / 1048576.0, terrain.built_count, terrain.build_ms, terrain.requests_count);
+    page += buf;
+
+    impostor_stats_t const impostors = impostor_stats();
+    sprintf_s(buf, "Impostors: %u quads (%u cross-fading) in %u draws, saved %u draws and %u vertices; %u views baked in %.1f ms",
+              impostors.quads_count, impostors.faded_count, impostors.draws_count, impostors.draws_saved, impostors.vertices_saved,
+              impostors.views_count, impostors.bake_ms);
+    page += buf;
+    break;
+  }
+  case HUD_PAGE_FRAME:
+  {
+    memory_stats_t const memory = memory_stats();
+    sprintf_s(buf, "Memory: %u heap allocations (%.1f KB) this frame, frame memory %.1f/%.1f KB, %u units in pools of %.1f KB\n",
+              memory.frame_heap_count, memory.frame_heap_bytes / 1024.0, memory.frame_memory_used / 1024.0,
+              memory.frame_memory_capacity / 1024.0, (unsigned int)memory.units_count, memory.units_pool_bytes / 1024.0);
+    page += buf;
+    page += m_soft_report.empty() ? "Software rasterizer (F2): not rendered" : m_soft_report;
+    break;
+  }
+  }
+  if (!page.empty())
+    print_text(const_cast<char *>(page.c_str()), 0, 120, 1000, 260, color_t(.5f, 0.5f, 0.5f));
 
   float const axis_len = 1000;
   struct axis_vertex
@@ -295,6 +380,8 @@ void myApp::update()
   // Call predecessor update
   cglApp::update();
 
+  m_scene.update();
+
   // Process keyboard
   float dx = 0.0f;
   float dy = 0.0f;
@@ -312,6 +399,39 @@ void myApp::update()
   if (m_keysPressed[VK_ADD])
     dr += s_rKbd2Zoom * m_timer.getDelta();
 
+  /* Render space stays around the moved camera */
+  m_origin.rebase(m_camera);
+}
+
+void myApp::render_soft( void )
+{
+  IDirect3DDevice9 *device = m_pD3D->getDevice();
+
+  m_soft_rasterizer.begin_frame(m_camera.get_view_matrix(), m_camera.get_projection_matrix(), m_nClearColor);
+
+  frame_context_t const frame(m_camera, m_timer.getTime(), m_timer.getDelta(), m_origin.position());
+  recursive_data_t rd(device, frame);
+  rd.rasterizer = &m_soft_rasterizer;
+  rd.occlusion = m_is_occlusion ? &m_occlusion : NULL;
+  m_scene.render(rd);
+
+  m_soft_rasterizer.end_frame();
+  m_soft_rasterizer.save_ppm(L"soft_frame.ppm");
+
+  /* Threads scaling is measured by headless mode ('-bench raster') */
+  soft_raster_stats_t const &stats = m_soft_rasterizer.stats();
+  char buf[300];
+  sprintf_s(buf, "Software (F2, soft_frame.ppm): %u draws, %u/%u triangles visible, %u bin entries, %.1f ms (vertex %.1f, setup %.1f, raster %.1f), %.1f Mtris/s on %u threads",
+            stats.draws_count, stats.visible_count, stats.triangles_count, stats.bin_entries, stats.frame_ms,
+            stats.vertex_ms, stats.setup_ms, stats.raster_ms, stats.mtris_per_second(), stats.threads_count);
+  m_soft_report = buf;
+}
+
+void myApp::set_depth_mode( bool reversed, bool infinite_far )
+{
+  m_camera.set_depth_mode(reversed, infinite_far);
+  m_rClearDepth = m_camera.get_clear_depth();
+  m_soft_rasterizer.set_reversed_depth(reversed);
 }
 
 void myApp::print_text( char *text, long x1, long y1, long x2, long y2, D3DCOLOR color )
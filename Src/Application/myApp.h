@@ -17,10 +17,14 @@
 #include "../Library/cglApp.h"
 #include "Math/cglMath.h"
 #include "geometry.h"
-#include "lights.h"
 #include "texture.h"
+#include "geometry_cache.h"
+#include "occlusion.h"
+#include "soft_raster.h"
+#include "scene.h"
 
 #include "unit.h"
+#include "world_origin.h"
 
 // *******************************************************************
 // defines & constants
@@ -38,8 +42,6 @@ public:
   virtual ~myApp() 
   {
     m_font->Release();
-    for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
-        delete (*it);
   }
   // This function performs input processing. Returns true if input is handled
   virtual bool processInput(unsigned int nMsg, int wParam, long lParam);
@@ -61,11 +63,15 @@ private:
   void zoom(float dr);
 
   camera_t m_camera;
+  /* Render space origin, the camera location is relative to it */
+  world_origin_t m_origin;
 
-  direction_light_t direction_light;
+  /* Camera depth mapping with matching device and software rasterizer depth test and clear */
+  void set_depth_mode( bool reversed, bool infinite_far );
 
-  typedef std::list<IAnimationUnit *>::iterator unit_iterator_t;
-  std::list<IAnimationUnit *> m_units;
+  scene_t m_scene;
+  /* Units hidden behind large meshes and terrain are skipped when enabled */
+  occlusion_culler_t m_occlusion;
 
   int m_mipmap_index;
   int m_min_index;
@@ -73,11 +79,31 @@ private:
 
   bool m_is_wireframe;
   bool m_is_fixed_camera;
+  bool m_is_occlusion;
 
   float m_bias;
 
+  /* Statistics page shown below the settings, cycled by Tab */
+  enum hud_page_t
+  {
+    HUD_PAGE_NONE,
+    HUD_PAGE_LOADING,     /* textures, meshes, startup jobs and geometry cache */
+    HUD_PAGE_LIGHTING,    /* lights, baked lighting and vertex buffers */
+    HUD_PAGE_GEOMETRY,    /* LOD, terrain and impostors */
+    HUD_PAGE_FRAME,       /* frame memory and software rasterizer report */
+    HUD_PAGES_COUNT
+  };
+
+  int m_hud_page;
+
   ID3DXFont * m_font;
 
+  /* Software rasterizer frame, rendered on request and benchmarked on growing threads count */
+  soft_rasterizer_t m_soft_rasterizer;
+  std::string m_soft_report;
+
+  void render_soft( void );
+
   void print_text( char *text, long x1, long y1, long x2, long y2, D3DCOLOR color );
 };
 
@@ -0,0 +1,384 @@
+/**
+@file     occlusion.cpp
+@brief    Software occlusion culling by low resolution depth buffer implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "parallel.h"
+#include "stopwatch.h"
+#include "terrain.h"
+#include "occlusion.h"
+
+occlusion_culler_t::occlusion_culler_t()
+  : m_width(0)
+  , m_height(0)
+  , m_stride(0)
+  , m_bands_count(0)
+  , m_is_reversed_depth(false)
+  , m_projection_scale(1)
+{
+  memset(m_view_projection, 0, sizeof(m_view_projection));
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void occlusion_culler_t::begin_frame( frame_context_t const &frame )
+{
+  memcpy(m_view_projection, frame.view_projection.M, sizeof(m_view_projection));
+  m_projection_scale = frame.projection.M[1][1];
+  m_is_reversed_depth = frame.is_reversed_depth;
+
+  /* Rows are padded, so 4-pixel groups never cross row end */
+  unsigned int const width = cglmath::Max(m_params.width, 4U);
+  unsigned int const height = frame.screen_width > 0 && frame.screen_height > 0 ?
+                              cglmath::Max((width * frame.screen_height + frame.screen_width / 2) / frame.screen_width, 1U) :
+                              width * 3 / 4;
+  if (width != m_width || height != m_height)
+  {
+    m_width = width;
+    m_height = height;
+    m_stride = (width + 3) & ~3U;
+    m_bands_count = (height + c_band_height - 1) / c_band_height;
+    m_depth.resize((size_t)m_stride * m_height);
+  }
+
+  m_occluders.clear();
+  m_pipeline.clear();
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void occlusion_culler_t::add_occluder( void const *vertices, unsigned int vertex_size, unsigned int vertices_count,
+                                       unsigned int const *indices, unsigned int triangles_count, matrix_t const &world )
+{
+  if (vertices_count == 0 || triangles_count == 0)
+    return;
+
+  occluder_t occluder;
+  occluder.vertices = vertices;
+  occluder.vertex_size = vertex_size;
+  matrix_t::multiply(world.M, m_view_projection, occluder.clip);
+  m_occluders.push_back(occluder);
+  m_pipeline.add_draw(vertices_count, indices, triangles_count);
+
+  m_stats.occluders_count++;
+  m_stats.triangles_count += triangles_count;
+}
+
+bool occlusion_culler_t::is_occluder( matrix_t const &world, vec_t const &center, float radius ) const
+{
+  float scale = 0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    /* Largest axis scale keeps the sphere conservative */
+    float const length = vec_t(world.M[axis][0], world.M[axis][1], world.M[axis][2]).length();
+    scale = length > scale ? length : scale;
+  }
+
+  vec_t const p = center * world;
+  float const w = p.x * m_view_projection[0][3] + p.y * m_view_projection[1][3] + p.z * m_view_projection[2][3] + m_view_projection[3][3];
+  float const world_radius = radius * scale;
+  if (w <= world_radius)
+    return true;
+  /* Sphere diameter to NDC height of 2 */
+  return world_radius * m_projection_scale / w >= m_params.min_occluder_size;
+}
+
+void occlusion_culler_t::build( void )
+{
+  stopwatch_t timer;
+
+  m_pipeline.process([this]( pipeline_t::work_item_t const &item, clip_vertex_t *vertices )
+  {
+    occluder_t const &occluder = m_occluders[item.draw];
+    float const (*clip)[4] = occluder.clip;
+    unsigned char const *src = (unsigned char const *)occluder.vertices + (size_t)item.begin * occluder.vertex_size;
+
+    for (unsigned int i = item.begin; i < item.end; ++i, src += occluder.vertex_size, ++vertices)
+    {
+      float const *p = (float const *)src;
+
+      vertices->x = p[0] * clip[0][0] + p[1] * clip[1][0] + p[2] * clip[2][0] + clip[3][0];
+      vertices->y = p[0] * clip[0][1] + p[1] * clip[1][1] + p[2] * clip[2][1] + clip[3][1];
+      vertices->z = p[0] * clip[0][2] + p[1] * clip[1][2] + p[2] * clip[2][2] + clip[3][2];
+      vertices->w = p[0] * clip[0][3] + p[1] * clip[1][3] + p[2] * clip[2][3] + clip[3][3];
+    }
+  }, m_params.threads);
+  m_pipeline.setup(m_bands_count, m_is_reversed_depth, [this]( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2,
+                                                               pipeline_t::chunk_t &chunk )
+  {
+    setup_triangle(v0, v1, v2, chunk);
+  }, m_params.threads);
+
+  /* Bands do not overlap, so every band is cleared and rasterized by one task */
+  parallel_for(0, m_bands_count, 1, [this]( size_t begin, size_t end )
+  {
+    for (size_t band = begin; band < end; ++band)
+      rasterize_band((unsigned int)band);
+  }, m_params.threads);
+
+  for (size_t i = 0; i < m_pipeline.chunks_count(); ++i)
+    m_stats.rasterized_count += (unsigned int)m_pipeline.chunk(i).triangles.size();
+  m_stats.threads_count = m_params.threads > 0 ? m_params.threads : parallel_threads_count();
+  m_stats.build_ms = timer.elapsed_ms();
+}
+
+void occlusion_culler_t::setup_triangle( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2,
+                                         pipeline_t::chunk_t &chunk ) const
+{
+  occluder_triangle_t tri;
+  screen_vertices_t screen;
+  if (!setup_screen_triangle(&v0->x, &v1->x, &v2->x, m_width, m_height, tri, screen))
+    return;
+  screen.plane(tri, screen.z, tri.z);
+
+  /* Depth at the pixel corner farthest along the plane gradient, capped by the farthest vertex */
+  float const half_span = 0.5f * (fabsf(tri.z[0]) + fabsf(tri.z[1]));
+  if (m_is_reversed_depth)
+  {
+    tri.z[2] -= half_span;
+    tri.z_limit = cglmath::Min3(screen.z[0], screen.z[1], screen.z[2]);
+  }
+  else
+  {
+    tri.z[2] += half_span;
+    tri.z_limit = cglmath::Max3(screen.z[0], screen.z[1], screen.z[2]);
+  }
+
+  unsigned int const index = (unsigned int)chunk.triangles.size();
+  chunk.triangles.push_back(tri);
+  for (int band = tri.min_y / (int)c_band_height; band <= tri.max_y / (int)c_band_height; ++band)
+    chunk.bins[band].push_back(index);
+}
+
+void occlusion_culler_t::rasterize_band( unsigned int band )
+{
+  int const band_y0 = band * c_band_height;
+  int const band_y1 = cglmath::Min(band_y0 + (int)c_band_height, (int)m_height);
+  float const clear_depth = m_is_reversed_depth ? 0.f : 1.f;
+
+  for (int y = band_y0; y < band_y1; ++y)
+  {
+    float *row = &m_depth[(size_t)y * m_stride];
+    for (unsigned int x = 0; x < m_stride; ++x)
+      row[x] = clear_depth;
+  }
+
+  __m128 const pixel_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+  __m128 const zero = _mm_setzero_ps();
+
+  for (size_t c = 0; c < m_pipeline.chunks_count(); ++c)
+  {
+    pipeline_t::chunk_t const &chunk = m_pipeline.chunk(c);
+    std::vector<unsigned int> const &bin = chunk.bins[band];
+
+    for (size_t t = 0; t < bin.size(); ++t)
+    {
+      occluder_triangle_t const &tri = chunk.triangles[bin[t]];
+      /* Rows are padded to multiples of 4, aligned groups stay inside them */
+      int const x0 = tri.min_x & ~3;
+      int const x1 = tri.max_x;
+      int const y0 = cglmath::Max(tri.min_y, band_y0);
+      int const y1 = cglmath::Min(tri.max_y, band_y1 - 1);
+
+      __m128 edge_a[3], edge_b[3], edge_c[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        edge_a[i] = _mm_set1_ps(tri.edge_a[i]);
+        edge_b[i] = _mm_set1_ps(tri.edge_b[i]);
+        edge_c[i] = _mm_set1_ps(tri.edge_c[i]);
+      }
+      __m128 const z_a = _mm_set1_ps(tri.z[0]);
+      __m128 const z_limit = _mm_set1_ps(tri.z_limit);
+
+      for (int y = y0; y <= y1; ++y)
+      {
+        float const fy = y - tri.min_y + 0.5f;
+        __m128 const py = _mm_set1_ps(fy);
+        __m128 e_row[3];
+        for (int i = 0; i < 3; ++i)
+          e_row[i] = _mm_add_ps(_mm_mul_ps(edge_b[i], py), edge_c[i]);
+        __m128 const z_row = _mm_set1_ps(tri.z[1] * fy + tri.z[2]);
+        float *depth_row = &m_depth[(size_t)y * m_stride];
+
+        for (int x = x0; x <= x1; x += 4)
+        {
+          __m128 const px = _mm_add_ps(_mm_set1_ps((float)(x - tri.min_x)), pixel_offsets);
+          __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+          for (int i = 0; i < 3; ++i)
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[i], px), e_row[i]), zero));
+          if (_mm_movemask_ps(mask) == 0)
+            continue;
+
+          /* Nearer of stored and triangle depth */
+          __m128 const plane_z = _mm_add_ps(_mm_mul_ps(z_a, px), z_row);
+          __m128 const depth = _mm_loadu_ps(depth_row + x);
+          __m128 const z = m_is_reversed_depth ? _mm_max_ps(_mm_max_ps(plane_z, z_limit), depth) :
+                                                 _mm_min_ps(_mm_min_ps(plane_z, z_limit), depth);
+          _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, depth)));
+        }
+      }
+    }
+  }
+}
+
+bool occlusion_culler_t::is_visible( matrix_t const &world, vec_t const &box_min, vec_t const &box_max )
+{
+  stopwatch_t timer;
+  bool const visible = is_box_visible(world, box_min, box_max);
+
+  m_stats.tests_count++;
+  if (!visible)
+    m_stats.culled_count++;
+  m_stats.test_ms += timer.elapsed_ms();
+  return visible;
+}
+
+bool occlusion_culler_t::is_box_visible( matrix_t const &world, vec_t const &box_min, vec_t const &box_max ) const
+{
+  if (m_stats.rasterized_count == 0)
+    return true;
+
+  float clip[4][4];
+  matrix_t::multiply(world.M, m_view_projection, clip);
+
+  /* Screen rectangle and nearest depth of the corners */
+  float min_x = 0, max_x = 0, min_y = 0, max_y = 0, nearest = 0;
+  for (int i = 0; i < 8; ++i)
+  {
+    float const x = i & 1 ? box_max.x : box_min.x, y = i & 2 ? box_max.y : box_min.y, z = i & 4 ? box_max.z : box_min.z;
+    float const cx = x * clip[0][0] + y * clip[1][0] + z * clip[2][0] + clip[3][0];
+    float const cy = x * clip[0][1] + y * clip[1][1] + z * clip[2][1] + clip[3][1];
+    float const cz = x * clip[0][2] + y * clip[1][2] + z * clip[2][2] + clip[3][2];
+    float const cw = x * clip[0][3] + y * clip[1][3] + z * clip[2][3] + clip[3][3];
+    if (cw <= 0 || near_plane_distance(cz, cw, m_is_reversed_depth) < 0)
+      return true;
+
+    float const inv_w = 1 / cw;
+    float const sx = (cx * inv_w * 0.5f + 0.5f) * m_width, sy = (0.5f - cy * inv_w * 0.5f) * m_height, sz = cz * inv_w;
+    if (i == 0)
+    {
+      min_x = max_x = sx;
+      min_y = max_y = sy;
+      nearest = sz;
+      continue;
+    }
+    min_x = cglmath::Min(min_x, sx);
+    max_x = cglmath::Max(max_x, sx);
+    min_y = cglmath::Min(min_y, sy);
+    max_y = cglmath::Max(max_y, sy);
+    nearest = m_is_reversed_depth ? cglmath::Max(nearest, sz) : cglmath::Min(nearest, sz);
+  }
+
+  /* Pixels touched by the rectangle, off screen boxes are left to frustum culling */
+  int const x0 = cglmath::Max(0, (int)floor(min_x)), x1 = cglmath::Min((int)m_width - 1, (int)ceil(max_x) - 1);
+  int const y0 = cglmath::Max(0, (int)floor(min_y)), y1 = cglmath::Min((int)m_height - 1, (int)ceil(max_y) - 1);
+  if (x0 > x1 || y0 > y1)
+    return true;
+
+  __m128 const lanes = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+  __m128 const first = _mm_set1_ps((float)x0), last = _mm_set1_ps((float)x1);
+  __m128 const box_depth = _mm_set1_ps(nearest);
+  for (int y = y0; y <= y1; ++y)
+  {
+    float const *depth_row = &m_depth[(size_t)y * m_stride];
+
+    for (int x = x0 & ~3; x <= x1; x += 4)
+    {
+      __m128 const px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+      __m128 const inside = _mm_and_ps(_mm_cmpge_ps(px, first), _mm_cmple_ps(px, last));
+      __m128 const depth = _mm_loadu_ps(depth_row + x);
+      __m128 const nearer = m_is_reversed_depth ? _mm_cmpge_ps(box_depth, depth) : _mm_cmple_ps(box_depth, depth);
+      if (_mm_movemask_ps(_mm_and_ps(inside, nearer)) != 0)
+        return true;
+    }
+  }
+  return false;
+}
+
+occlusion_benchmark_t benchmark_occlusion( unsigned int boxes_count, unsigned int frames_count, unsigned int threads )
+{
+  occlusion_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.threads_count = threads > 0 ? threads : parallel_threads_count();
+  result.frames_count = frames_count;
+  result.boxes_count = boxes_count;
+  if (frames_count == 0)
+    return result;
+
+  float const size = 2000;
+  terrain_params_t params;
+  params.size = size;
+  params.levels = 6;
+  params.height = benchmark_hills_height;
+  params.streaming = false;
+  params.max_resident = 1024;
+  terrain_t terrain(NULL, params);
+  transform_t const world;
+
+  /* Houses sized boxes standing on the ground ahead of the flight, fixed seed */
+  std::vector<vec_t> box_min(boxes_count), box_max(boxes_count);
+  srand(1);
+  for (unsigned int i = 0; i < boxes_count; ++i)
+  {
+    float const x = (rand() / (float)RAND_MAX - 0.5f) * size * 0.9f;
+    float const z = (rand() / (float)RAND_MAX - 0.5f) * size * 0.9f;
+    float const ground = benchmark_hills_height(x, z);
+    box_min[i] = vec_t(x - 4, ground, z - 4);
+    box_max[i] = vec_t(x + 4, ground + 8, z + 4);
+  }
+
+  occlusion_params_t occlusion_params;
+  occlusion_params.threads = threads;
+  occlusion_culler_t culler;
+  culler.set_params(occlusion_params);
+
+  camera_t camera;
+  camera.screen_width = 1000;
+  camera.screen_height = 700;
+  camera.set_near_far(0.5f, 10000.f);
+  camera.update_proj_data();
+  unsigned int tested_count = 0, culled_count = 0;
+  double test_ms = 0;
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+  {
+    /* Low flight along the diagonal looking ahead */
+    float const t = (frame + 0.5f) / frames_count - 0.5f;
+    float const x = t * size * 0.8f, z = t * size * 0.6f;
+    vec_t location(x, benchmark_hills_height(x, z) + 5.f, z), at(x + 100.f, benchmark_hills_height(x, z) + 5.f, z + 75.f), up(0, 1, 0);
+
+    camera.set_camera(location, at, up, true);
+    frame_context_t const context(camera, 0, 0);
+    terrain.update(NULL, context, world);
+
+    culler.begin_frame(context);
+    terrain.add_occluders(culler, world);
+    culler.build();
+    result.build_ms += culler.stats().build_ms;
+    result.triangles += culler.stats().triangles_count;
+
+    /* Occlusion is measured on boxes inside the frustum */
+    for (unsigned int i = 0; i < boxes_count; ++i)
+    {
+      vec_t const center = (box_min[i] + box_max[i]) * 0.5f;
+      if (!camera.get_frustum().is_visible(center, (box_max[i] - box_min[i]).length() * 0.5f))
+        continue;
+      culler.is_visible(world.matrix, box_min[i], box_max[i]);
+    }
+    tested_count += culler.stats().tests_count;
+    culled_count += culler.stats().culled_count;
+    test_ms += culler.stats().test_ms;
+  }
+
+  result.triangles /= frames_count;
+  result.build_ms /= frames_count;
+  result.culled_percent = tested_count > 0 ? 100.0 * culled_count / tested_count : 0;
+  result.test_us = tested_count > 0 ? test_ms * 1000 / tested_count : 0;
+  return result;
+}
@@ -0,0 +1,136 @@
+/**
+@file     occlusion.h
+@brief    Software occlusion culling by low resolution depth buffer definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __OCCLUSION_INCLUDED__
+#define __OCCLUSION_INCLUDED__
+
+#include <vector>
+
+#include "Math/cglMath.h"
+#include "frame_context.h"
+#include "soft_raster.h"
+
+struct occlusion_params_t
+{
+  unsigned int width;           /* depth buffer width, height follows the screen aspect */
+  unsigned int threads;         /* 0 means all hardware threads */
+  float min_occluder_size;      /* meshes below this fraction of screen height are not occluders */
+
+  occlusion_params_t() : width(256), threads(0), min_occluder_size(0.1f) {}
+};
+
+/* Frame statistics */
+struct occlusion_stats_t
+{
+  unsigned int occluders_count;
+  unsigned int triangles_count;   /* of occluders */
+  unsigned int rasterized_count;  /* survived near clipping and covering pixel centers */
+  unsigned int tests_count;
+  unsigned int culled_count;
+  unsigned int threads_count;
+  double build_ms;                /* occluders setup and rasterization */
+  double test_ms;
+
+  float culled_percent( void ) const { return tests_count > 0 ? 100.f * culled_count / tests_count : 0; }
+};
+
+/* Depth buffer of selected occluders at low resolution, boxes of the frame are tested against it.
+ * Usage per frame: begin_frame(), add_occluder() meshes, build(), is_visible() boxes.
+ * Triangles are set up and binned into bands of rows by tasks, bands are rasterized in parallel
+ * with 4-wide SSE edge functions. Pixels are covered by their centers, stored depth is the
+ * farthest depth of the triangle plane within the pixel, so boxes are only culled behind it.
+ * Boxes crossing the near plane are always visible */
+class occlusion_culler_t
+{
+public:
+  /* Rows of one rasterization task */
+  static const unsigned int c_band_height = 8;
+
+  occlusion_culler_t();
+
+  void set_params( occlusion_params_t const &params ) { m_params = params; }
+  occlusion_params_t const & params( void ) const { return m_params; }
+
+  void begin_frame( frame_context_t const &frame );
+  /* Occluder vertices start with 3 floats position, mesh data is referenced until build() */
+  void add_occluder( void const *vertices, unsigned int vertex_size, unsigned int vertices_count,
+                     unsigned int const *indices, unsigned int triangles_count, matrix_t const &world );
+  /* Meshes of local space bounding sphere smaller than min_occluder_size are not worth it */
+  bool is_occluder( matrix_t const &world, vec_t const &center, float radius ) const;
+  void build( void );
+
+  /* Local space box is not hidden by occluders */
+  bool is_visible( matrix_t const &world, vec_t const &box_min, vec_t const &box_max );
+
+  unsigned int width( void ) const { return m_width; }
+  unsigned int height( void ) const { return m_height; }
+  /* Rows are 'stride' depths apart */
+  unsigned int stride( void ) const { return m_stride; }
+  float const * depth_buffer( void ) const { return m_depth.empty() ? 0 : &m_depth[0]; }
+
+  occlusion_stats_t const & stats( void ) const { return m_stats; }
+private:
+  occlusion_culler_t( occlusion_culler_t const & );
+  occlusion_culler_t & operator=( occlusion_culler_t const & );
+
+  struct occluder_t
+  {
+    void const *vertices;
+    unsigned int vertex_size;
+    float clip[4][4];               /* world followed by view projection */
+  };
+
+  /* Depth plane is the farthest depth within pixel, not beyond z_limit */
+  struct occluder_triangle_t : screen_edges_t
+  {
+    float z[3];
+    float z_limit;                  /* farthest vertex depth */
+  };
+
+  struct clip_vertex_t
+  {
+    float x, y, z, w;
+  };
+
+  /* Chunk bins are bands of rows */
+  typedef clip_pipeline_t<clip_vertex_t, occluder_triangle_t> pipeline_t;
+
+  void setup_triangle( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2, pipeline_t::chunk_t &chunk ) const;
+  void rasterize_band( unsigned int band );
+  bool is_box_visible( matrix_t const &world, vec_t const &box_min, vec_t const &box_max ) const;
+
+  occlusion_params_t m_params;
+  unsigned int m_width, m_height, m_stride;
+  unsigned int m_bands_count;
+  bool m_is_reversed_depth;
+  float m_view_projection[4][4];
+  float m_projection_scale;       /* NDC height of unit size at unit distance */
+  std::vector<float> m_depth;
+
+  std::vector<occluder_t> m_occluders;
+  pipeline_t m_pipeline;
+
+  occlusion_stats_t m_stats;
+};
+
+/* Camera flight low over a hilly terrain with boxes standing on it, the terrain chunks drawn
+ * are the occluders */
+struct occlusion_benchmark_t
+{
+  unsigned int threads_count;
+  unsigned int frames_count;
+  unsigned int boxes_count;
+  double triangles;             /* mean occluder triangles per frame */
+  double culled_percent;
+  double build_ms;              /* mean per frame */
+  double test_us;               /* mean per box */
+};
+
+occlusion_benchmark_t benchmark_occlusion( unsigned int boxes_count, unsigned int frames_count, unsigned int threads );
+
+#endif /* __OCCLUSION_INCLUDED__ */
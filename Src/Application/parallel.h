@@ -0,0 +1,83 @@
+/**
+@file     parallel.h
+@brief    Simple data parallel loops helpers
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __PARALLEL_INCLUDED__
+#define __PARALLEL_INCLUDED__
+
+#include <atomic>
+#include <thread>
+
+#include "job_graph.h"
+
+/* Number of worker threads used by default (at least 1) */
+inline unsigned int parallel_threads_count( void )
+{
+  unsigned int const count = std::thread::hardware_concurrency();
+  return count == 0 ? 1 : count;
+}
+
+/* Split [begin, end) into 'grain'-sized chunks and call func(chunk_begin, chunk_end)
+ * for every chunk on job pool threads. Calling thread takes part in the work, so loops
+ * nested in pool tasks finish even when all pool threads are busy.
+ * threads == 0 means "use all hardware threads".
+ */
+template<class FUNC>
+void parallel_for( size_t begin, size_t end, size_t grain, FUNC const & func, unsigned int threads = 0 )
+{
+  if (begin >= end)
+    return;
+  if (grain == 0)
+    grain = 1;
+
+  size_t const chunks = (end - begin + grain - 1) / grain;
+  if (threads == 0)
+    threads = parallel_threads_count();
+  if (threads > chunks)
+    threads = (unsigned int)chunks;
+
+  if (threads <= 1)
+  {
+    func(begin, end);
+    return;
+  }
+
+  /* Loop state lives on this stack frame until all joined threads return */
+  struct loop_t
+  {
+    size_t begin, end, grain, chunks;
+    FUNC const *func;
+    std::atomic<size_t> next_chunk;
+
+    static void run( void *context )
+    {
+      loop_t &loop = *static_cast<loop_t *>(context);
+
+      for (size_t chunk = loop.next_chunk++; chunk < loop.chunks; chunk = loop.next_chunk++)
+      {
+        size_t const first = loop.begin + chunk * loop.grain;
+        size_t const last = first + loop.grain < loop.end ? first + loop.grain : loop.end;
+        (*loop.func)(first, last);
+      }
+    }
+  };
+
+  loop_t loop;
+  loop.begin = begin;
+  loop.end = end;
+  loop.grain = grain;
+  loop.chunks = chunks;
+  loop.func = &func;
+  loop.next_chunk = 0;
+
+  job_pool_t::task_t task;
+  job_pool().start(task, &loop_t::run, &loop, threads - 1);
+  loop_t::run(&loop);
+  job_pool().finish(task);
+}
+
+#endif /* __PARALLEL_INCLUDED__ */
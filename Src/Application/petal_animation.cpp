@@ -0,0 +1,166 @@
+/**
+@file     petal_animation.cpp
+@brief    Batched procedural petal animation kernel implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "simd_math.h"
+#include "stopwatch.h"
+#include "petal_animation.h"
+
+namespace
+{
+  /* Four values starting at 'first', lanes past the end are zero */
+  __m128 load_ps( std::vector<float> const &values, size_t first, size_t count )
+  {
+    if (count == 4)
+      return _mm_loadu_ps(&values[first]);
+
+    float lanes[4] = {0, 0, 0, 0};
+    memcpy(lanes, &values[first], count * sizeof(float));
+    return _mm_loadu_ps(lanes);
+  }
+
+  /* rotate_x() followed by translate(0, 0, offset) of identity transform */
+  void set_pose( transform_t &pose, float sine, float cosine, float offset )
+  {
+    _mm_storeu_ps(pose.matrix.M[0], _mm_setr_ps(1, 0, 0, 0));
+    _mm_storeu_ps(pose.matrix.M[1], _mm_setr_ps(0, cosine, sine, 0));
+    _mm_storeu_ps(pose.matrix.M[2], _mm_setr_ps(0, -sine, cosine, 0));
+    _mm_storeu_ps(pose.matrix.M[3], _mm_setr_ps(0, 0, offset, 1));
+
+    /* Inverse rotation is transposed, translation is undone before it */
+    _mm_storeu_ps(pose.inv_matrix.M[0], _mm_setr_ps(1, 0, 0, 0));
+    _mm_storeu_ps(pose.inv_matrix.M[1], _mm_setr_ps(0, cosine, -sine, 0));
+    _mm_storeu_ps(pose.inv_matrix.M[2], _mm_setr_ps(0, sine, cosine, 0));
+    _mm_storeu_ps(pose.inv_matrix.M[3], _mm_setr_ps(0, -offset * sine, -offset * cosine, 1));
+  }
+}
+
+void petal_batch_t::add( float phase, float velocity, float angle1_min, float angle1_max, float angle2_min, float angle2_max,
+                         float offset )
+{
+  phases.push_back(phase);
+  velocities.push_back(velocity);
+  this->angle1_min.push_back(angle1_min);
+  angle1_range.push_back(angle1_max - angle1_min);
+  this->angle2_min.push_back(angle2_min);
+  angle2_range.push_back(angle2_max - angle2_min);
+  offsets.push_back(offset);
+}
+
+void petal_batch_t::clear( void )
+{
+  phases.clear();
+  velocities.clear();
+  angle1_min.clear();
+  angle1_range.clear();
+  angle2_min.clear();
+  angle2_range.clear();
+  offsets.clear();
+}
+
+void animate_petals( petal_batch_t const &batch, float time, transform_t * const *petals1, transform_t * const *petals2 )
+{
+  size_t const petals_count = batch.size();
+  __m128 const time4 = _mm_set1_ps(time);
+  __m128 const half = _mm_set1_ps(0.5f);
+  /* Swing angles are negated degrees */
+  __m128 const to_radians = _mm_set1_ps(-cglmath::c_pif / 180);
+
+  for (size_t first = 0; first < petals_count; first += 4)
+  {
+    size_t const count = petals_count - first < 4 ? petals_count - first : 4;
+    __m128 swing, unused;
+
+    sincos_ps(_mm_add_ps(_mm_mul_ps(time4, load_ps(batch.velocities, first, count)), load_ps(batch.phases, first, count)),
+              swing, unused);
+    __m128 const t = _mm_add_ps(_mm_mul_ps(swing, half), half);
+
+    __m128 sine1, cosine1, sine2, cosine2;
+    sincos_ps(_mm_mul_ps(_mm_add_ps(load_ps(batch.angle1_min, first, count), _mm_mul_ps(t, load_ps(batch.angle1_range, first, count))),
+                         to_radians), sine1, cosine1);
+    sincos_ps(_mm_mul_ps(_mm_add_ps(load_ps(batch.angle2_min, first, count), _mm_mul_ps(t, load_ps(batch.angle2_range, first, count))),
+                         to_radians), sine2, cosine2);
+
+    float lanes[4][4];
+    _mm_storeu_ps(lanes[0], sine1);
+    _mm_storeu_ps(lanes[1], cosine1);
+    _mm_storeu_ps(lanes[2], sine2);
+    _mm_storeu_ps(lanes[3], cosine2);
+    for (size_t i = 0; i < count; ++i)
+    {
+      set_pose(*petals1[first + i], lanes[0][i], lanes[1][i], 0);
+      set_pose(*petals2[first + i], lanes[2][i], lanes[3][i], batch.offsets[first + i]);
+    }
+  }
+}
+
+void animate_petals_reference( petal_batch_t const &batch, float time, transform_t * const *petals1, transform_t * const *petals2 )
+{
+  for (size_t i = 0; i < batch.size(); ++i)
+  {
+    float const t = sin(time * batch.velocities[i] + batch.phases[i]) * 0.5f + 0.5f;
+
+    *petals1[i] = transform_t().rotate_x(-(batch.angle1_min[i] + t * batch.angle1_range[i]));
+    *petals2[i] = transform_t().rotate_x(-(batch.angle2_min[i] + t * batch.angle2_range[i])).translate(0, 0, batch.offsets[i]);
+  }
+}
+
+petal_benchmark_t benchmark_petals( unsigned int petals_count, unsigned int frames_count )
+{
+  petal_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.petals_count = petals_count;
+  result.frames_count = frames_count;
+  if (petals_count == 0 || frames_count == 0)
+    return result;
+
+  /* Flowers of the demo scene: 12 petals each with random velocity */
+  unsigned int seed = 12345;
+  petal_batch_t batch;
+  float velocity = 1;
+  for (unsigned int i = 0; i < petals_count; ++i)
+  {
+    if (i % 12 == 0)
+    {
+      seed = seed * 1664525U + 1013904223U;
+      velocity = ((seed >> 8) / 16777216.f + 0.1f) * 2;
+    }
+    batch.add(sin((i % 12) * cglmath::c_pif / 12), velocity, 5, 60, 5, 20, 0.1f);
+  }
+
+  std::vector<transform_t> simd(2 * (size_t)petals_count), reference(2 * (size_t)petals_count);
+  std::vector<transform_t *> simd_ptrs(simd.size()), reference_ptrs(reference.size());
+  for (size_t i = 0; i < simd.size(); ++i)
+  {
+    simd_ptrs[i] = &simd[i];
+    reference_ptrs[i] = &reference[i];
+  }
+
+  stopwatch_t timer;
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    animate_petals(batch, frame / 60.f, &simd_ptrs[0], &simd_ptrs[petals_count]);
+  result.simd_ms = timer.elapsed_ms();
+
+  timer.restart();
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    animate_petals_reference(batch, frame / 60.f, &reference_ptrs[0], &reference_ptrs[petals_count]);
+  result.reference_ms = timer.elapsed_ms();
+
+  for (size_t i = 0; i < simd.size(); ++i)
+    for (int row = 0; row < 4; ++row)
+      for (int column = 0; column < 4; ++column)
+      {
+        float const error = cglmath::Max(fabs(simd[i].matrix.M[row][column] - reference[i].matrix.M[row][column]),
+                                         fabs(simd[i].inv_matrix.M[row][column] - reference[i].inv_matrix.M[row][column]));
+        result.max_error = cglmath::Max(result.max_error, error);
+      }
+  return result;
+}
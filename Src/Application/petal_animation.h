@@ -0,0 +1,61 @@
+/**
+@file     petal_animation.h
+@brief    Batched procedural petal animation kernel definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __PETAL_ANIMATION_INCLUDED__
+#define __PETAL_ANIMATION_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "Math/cglMath.h"
+
+/* Swing parameters of petals in structure of arrays layout, one entry per petal.
+ * First petal swings around its base x axis between angle1 bounds, second petal is
+ * attached at 'offset' along the first one and swings between angle2 bounds, both
+ * with sin(time * velocity + phase) */
+struct petal_batch_t
+{
+  std::vector<float> phases;
+  std::vector<float> velocities;
+  std::vector<float> angle1_min;  /* degrees */
+  std::vector<float> angle1_range;
+  std::vector<float> angle2_min;
+  std::vector<float> angle2_range;
+  std::vector<float> offsets;
+
+  size_t size( void ) const { return phases.size(); }
+
+  void add( float phase, float velocity, float angle1_min, float angle1_max, float angle2_min, float angle2_max, float offset );
+  void clear( void );
+};
+
+/* Poses of all batch petals at 'time': first petals relative to their parents and second
+ * petals relative to first ones. Matrices and inverses are written in place through
+ * the pointer arrays of batch size, four petals at a time */
+void animate_petals( petal_batch_t const &batch, float time, transform_t * const *petals1, transform_t * const *petals2 );
+
+/* Same poses by rotate_x()/translate() transform construction */
+void animate_petals_reference( petal_batch_t const &batch, float time, transform_t * const *petals1, transform_t * const *petals2 );
+
+/* Kernel throughput against the reference on one thread */
+struct petal_benchmark_t
+{
+  unsigned int petals_count;
+  unsigned int frames_count;
+  double simd_ms;
+  double reference_ms;
+  float max_error;              /* largest matrix element difference */
+
+  /* Millions of petals per second */
+  double simd_rate( void ) const { return simd_ms > 0 ? (double)petals_count * frames_count / simd_ms / 1000 : 0; }
+  double reference_rate( void ) const { return reference_ms > 0 ? (double)petals_count * frames_count / reference_ms / 1000 : 0; }
+};
+
+petal_benchmark_t benchmark_petals( unsigned int petals_count, unsigned int frames_count );
+
+#endif /* __PETAL_ANIMATION_INCLUDED__ */
@@ -0,0 +1,214 @@
+/**
+@file     scene.cpp
+@brief    Demo scene units and their startup loading implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstdlib>
+#include <memory>
+
+#include "airplane.h"
+#include "flower.h"
+#include "geometry_cache.h"
+#include "mesh_lod.h"
+#include "soft_raster.h"
+#include "terrain.h"
+#include "texture.h"
+#include "scene.h"
+
+const unsigned long scene_t::c_clear_color = 0xFF222222UL;
+
+scene_t::scene_t( IDirect3DDevice9 *device, dvec_t const &world_offset ) : m_world_offset(world_offset)
+{
+  m_direction_light.set_ambient(color_t(0.1f));
+  m_direction_light.set_diffuse(color_t(0.6f));
+  m_direction_light.set_specular(color_t(0.1f));
+  m_direction_light.set_direction(vec_t(-1, -1, 0.01f));
+  m_direction_light.set_managed();
+  m_direction_light.enable(device);
+
+  /*** Declare startup jobs, units are added to render as they are loaded ***/
+  std::shared_ptr<texture_t> ground_texture(new texture_t());
+  job_graph_t::job_id_t const ground_texture_job = m_startup_jobs.add("ground texture", [=]()
+  {
+    /* Software rasterizer does not sample textures */
+    if (device != NULL)
+      ground_texture->load(device, L"Res/ground00.bmp");
+  });
+  m_startup_jobs.add("base plane", [=]()
+  {
+    add_loaded_unit(new base_plane_t(device, ground_texture));
+  }, std::vector<job_graph_t::job_id_t>(1, ground_texture_job));
+
+  std::shared_ptr<IAnimationUnitPtr> airplane_mesh(new IAnimationUnitPtr());
+  job_graph_t::job_id_t const airplane_mesh_job = m_startup_jobs.add("airplane mesh", [=]()
+  {
+    x_mesh_t *mesh = new x_mesh_t();
+
+    mesh->load(L"Res/airplane00.x", device);
+    airplane_mesh->reset(mesh);
+  });
+  m_startup_jobs.add("airplane", [=]()
+  {
+    std::shared_ptr<animation_clip_t> flight(new animation_clip_t());
+
+    /* Authored flight clip replaces the built-in one */
+    if (!flight->load(L"Res/airplane00.anim"))
+      flight = airplane_t::default_flight();
+    add_loaded_unit(new airplane_t(device, std::move(*airplane_mesh), flight));
+  }, std::vector<job_graph_t::job_id_t>(1, airplane_mesh_job));
+
+  flower_params_t params;
+  params.petal2_height = 0.1f;
+  params.petal2_width = 0.03f;
+  params.petal2_color = color_t(1, 0, 0);
+  params.petal2_angle_min = 5.f;
+  params.petal2_angle_max = 20.f;
+
+  params.petal1_height = 0.1f;
+  params.petal1_width = 0.1f;
+  params.petal1_color = color_t(0x00CC00UL);
+  params.petal1_angle_min = 5.f;
+  params.petal1_angle_max = 60.f;
+
+  params.receptacle_radius = 0.12f;
+  params.receptacle_color = color_t(0xFFCC33UL);
+
+  params.petals_count = 12;
+  params.velocity = 1.f;
+
+  params.stem_thickness = 0.03f;
+  params.stem_length = 0.7f;
+  params.stem_color = color_t(0x003300UL);
+
+  /* All flowers share params besides velocity, one atlas of a model flower serves them.
+   * Impostors are drawn on device only */
+  std::vector<job_graph_t::job_id_t> impostor_jobs;
+  if (device != NULL)
+  {
+    std::shared_ptr<impostor_atlas_t> impostor(new impostor_atlas_t());
+    std::vector<soft_light_t> const lights(1, m_direction_light.soft_light());
+
+    impostor_jobs.push_back(m_startup_jobs.add("flower impostor", [=]()
+    {
+      flower_t model(device, params);
+      impostor->bake(device, model, lights, 0);
+    }));
+    m_flower_impostor = impostor;
+  }
+
+  /* One job per flowers row, random placement is generated here to keep rand() on one thread */
+  for (size_t i = 0; i < 10; ++i)
+  {
+    std::vector<vec_t> placement;
+    for (size_t j = 0; j < 10; ++j)
+    {
+      float const velocity = (rand() / (float)RAND_MAX + 0.1f) * 2;
+      float const x = rand() / (float)RAND_MAX * 40 - 20;
+      float const z = rand() / (float)RAND_MAX * 40 - 20;
+      placement.push_back(vec_t(x, velocity, z));
+    }
+
+    std::shared_ptr<impostor_atlas_t> const impostor = m_flower_impostor;
+    m_startup_jobs.add("flowers", [=]()
+    {
+      flower_params_t flower_params = params;
+      for (size_t j = 0; j < placement.size(); ++j)
+      {
+        flower_params.velocity = placement[j].y;
+        flower_t *flower = new flower_t(device, flower_params);
+        flower->set_position(dvec_t(placement[j].x, 0, placement[j].z));
+        if (impostor != NULL && impostor->is_baked())
+          flower->set_impostor(impostor);
+        add_loaded_unit(flower);
+      }
+    }, impostor_jobs);
+  }
+
+  m_startup_jobs.run();
+}
+
+scene_t::~scene_t()
+{
+  m_startup_jobs.wait();
+  update();
+  for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
+    delete (*it);
+  m_flower_impostor.reset();
+  geometry_cache().clear();
+  light_bake_cache().clear();
+}
+
+void scene_t::add_loaded_unit( IAnimationUnit *unit )
+{
+  unit->set_position(unit->get_position() + m_world_offset);
+
+  std::lock_guard<std::mutex> lock(m_loaded_units_mutex);
+  m_loaded_units.push_back(unit);
+}
+
+void scene_t::update( void )
+{
+  std::lock_guard<std::mutex> lock(m_loaded_units_mutex);
+  m_units.insert(m_units.end(), m_loaded_units.begin(), m_loaded_units.end());
+  m_loaded_units.clear();
+}
+
+void scene_t::wait_loaded( void )
+{
+  m_startup_jobs.wait();
+}
+
+void scene_t::render( recursive_data_t &rd )
+{
+  m_static_lighting.lights.clear();
+  if (m_direction_light.get_state())
+    m_static_lighting.lights.push_back(m_direction_light.soft_light());
+
+  memory_begin_frame();
+  mesh_lod_begin_frame();
+  terrain_begin_frame();
+  impostor_begin_frame();
+  m_lights.begin_frame();
+  m_lights.add(m_direction_light, true);
+  for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
+  {
+    m_lights.set_offset(relative_position((*it)->get_position(), rd.frame.origin));
+    (*it)->collect_lights(m_lights);
+  }
+  m_lights.set_offset(vec_t(0, 0, 0));
+  m_lights.build(rd.frame.view, rd.frame.projection);
+  rd.lights = &m_lights;
+  rd.static_lighting = &m_static_lighting;
+
+  if (rd.rasterizer != NULL)
+    for (size_t i = 0; i < m_lights.lights().size(); ++i)
+      rd.rasterizer->add_light(m_lights.lights()[i]);
+
+  if (rd.occlusion != NULL)
+  {
+    world_stack_t world_stack(rd.world(), rd.frame.origin);
+
+    rd.occlusion->begin_frame(rd.frame);
+    for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
+      (*it)->collect_occluders(*rd.occlusion, world_stack);
+    rd.occlusion->build();
+  }
+
+  for (unit_iterator_t it = m_units.begin(); it != m_units.end(); ++it)
+    (*it)->treat_as_unit(rd);
+  if (m_flower_impostor != NULL)
+    m_flower_impostor->flush(rd);
+  rd.lights = NULL;
+  rd.static_lighting = NULL;
+}
+
+void scene_t::reset_camera( camera_t &camera )
+{
+  vec_t location(5, 5, 5.f), look_at(0.f), up(0.f, 1.f, 0.f);
+
+  camera.set_camera(location, look_at, up, true);
+  camera.set_near_far(0.5, 10000.f);
+}
@@ -0,0 +1,78 @@
+/**
+@file     scene.h
+@brief    Demo scene units and their startup loading definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __SCENE_INCLUDED__
+#define __SCENE_INCLUDED__
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "impostor.h"
+#include "job_graph.h"
+#include "light_bake.h"
+#include "light_clusters.h"
+#include "lights.h"
+#include "unit.h"
+
+/* Ground, airplane and flowers with the global light. Units are loaded by startup jobs
+ * and become visible on update() as they are loaded.
+ * Device may be NULL: units then keep system memory geometry only and the scene
+ * can be rendered by software rasterizer (headless mode) */
+class scene_t
+{
+public:
+  static const unsigned long c_clear_color;
+
+  /* Starts loading jobs, units are placed 'world_offset' away from the world origin */
+  scene_t( IDirect3DDevice9 *device, dvec_t const &world_offset = dvec_t(0, 0, 0) );
+  /* Waits for loading, releases units and cached geometry */
+  ~scene_t();
+
+  /* Move units loaded by startup jobs to rendered ones */
+  void update( void );
+  /* Block until all startup jobs are done, loaded units are published on next update() */
+  void wait_loaded( void );
+
+  /* Render and animate units. Lights of the frame are clustered for rd.frame, units get
+   * their device lights selected; all lights are added to rd.rasterizer when it is set.
+   * The global light is static: it is baked into ground and stems colors on device */
+  void render( recursive_data_t &rd );
+
+  job_graph_stats_t startup_stats( void ) const { return m_startup_jobs.stats(); }
+  light_cluster_stats_t light_stats( void ) const { return m_lights.stats(); }
+
+  /* Initial view of the scene, the camera is in render space of the world offset origin */
+  static void reset_camera( camera_t &camera );
+private:
+  scene_t( scene_t const & );
+  scene_t & operator=( scene_t const & );
+
+  void add_loaded_unit( IAnimationUnit *unit );
+
+  dvec_t const m_world_offset;
+
+  direction_light_t m_direction_light;
+  light_manager_t m_lights;
+  static_lighting_t m_static_lighting;
+
+  /* Views of the flowers, distant ones are drawn by it after other units */
+  std::shared_ptr<impostor_atlas_t> m_flower_impostor;
+
+  typedef std::vector<IAnimationUnit *>::iterator unit_iterator_t;
+  std::vector<IAnimationUnit *> m_units;
+
+  /* Assets are loaded by startup jobs, finished units are moved to m_units on update */
+  job_graph_t m_startup_jobs;
+  std::mutex m_loaded_units_mutex;
+  std::vector<IAnimationUnit *> m_loaded_units;
+};
+
+#endif /* __SCENE_INCLUDED__ */
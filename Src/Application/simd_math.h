@@ -0,0 +1,55 @@
+/**
+@file     simd_math.h
+@brief    SSE transcendental functions shared by batched kernels
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __SIMD_MATH_INCLUDED__
+#define __SIMD_MATH_INCLUDED__
+
+#include <emmintrin.h>
+
+/* Sine and cosine of radians, Cephes sinf/cosf polynomials on [-pi/4, pi/4].
+ * Accurate to a few ulps for arguments up to thousands */
+inline void sincos_ps( __m128 x, __m128 &sine, __m128 &cosine )
+{
+  /* Quadrant and remainder by two part pi/2 */
+  __m128i const quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772367581343f)));
+  __m128 const q = _mm_cvtepi32_ps(quadrant);
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5707963705062866f)));
+  r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(-4.3711388286737929e-8f)));
+
+  __m128 const r2 = _mm_mul_ps(r, r);
+  __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+  s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+  s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+  __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+  c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+  c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, r2), r2), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_set1_ps(1.f));
+
+  /* Odd quadrants swap sine and cosine, quadrants 2, 3 negate sine and 1, 2 negate cosine */
+  __m128 const swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+  __m128 const sine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+  __m128 const cosine_sign = _mm_castsi128_ps(_mm_slli_epi32(
+    _mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+  sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sine_sign);
+  cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosine_sign);
+}
+
+/* Arc cosine of [0, 1] values, Abramowitz and Stegun 4.4.46, absolute error below 2e-8 */
+inline __m128 acos_positive_ps( __m128 x )
+{
+  __m128 p = _mm_set1_ps(-0.0012624911f);
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0066700901f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0170881256f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0308918810f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0501743046f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0889789874f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.2145988016f));
+  p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(1.5707963050f));
+  return _mm_mul_ps(p, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.f), x), _mm_setzero_ps())));
+}
+
+#endif /* __SIMD_MATH_INCLUDED__ */
@@ -0,0 +1,283 @@
+/**
+@file     skinning.cpp
+@brief    Linear blend skinning kernel implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "parallel.h"
+#include "stopwatch.h"
+#include "skinning.h"
+
+namespace
+{
+  /* Row of four bone matrices blended by broadcast weights */
+  inline __m128 blend_row( matrix_t const &b0, matrix_t const &b1, matrix_t const &b2, matrix_t const &b3,
+                           __m128 w0, __m128 w1, __m128 w2, __m128 w3, int row )
+  {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, _mm_loadu_ps(b0.M[row])), _mm_mul_ps(w1, _mm_loadu_ps(b1.M[row]))),
+                      _mm_add_ps(_mm_mul_ps(w2, _mm_loadu_ps(b2.M[row])), _mm_mul_ps(w3, _mm_loadu_ps(b3.M[row]))));
+  }
+
+  inline __m128 splat( __m128 v, int lane )
+  {
+    switch (lane)
+    {
+    case 0:
+      return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+    case 1:
+      return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+    case 2:
+      return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+    }
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  /* Three lanes only, the next vertex component is not touched */
+  inline void store3( float *dst, __m128 v )
+  {
+    _mm_storel_pi((__m64 *)dst, v);
+    _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+  }
+}
+
+skin_t::skin_t() : m_vertex_size(0)
+{
+}
+
+bool skin_t::create( mesh_data_t const &mesh, x_influence_t const *influences )
+{
+  unsigned int const count = mesh.vertex_count();
+  bool const has_normals = (mesh.fvf & c_mesh_fvf_normal) != 0;
+
+  m_positions.clear();
+  m_normals.clear();
+  m_influences.clear();
+  m_vertex_size = mesh.vertex_size;
+  if (count == 0 || influences == NULL || (mesh.fvf & c_mesh_fvf_position) == 0)
+    return false;
+
+  m_positions.resize(count * 4);
+  m_normals.resize(has_normals ? count * 4 : 0);
+  m_influences.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    float const *src = (float const *)&mesh.vertices[i * mesh.vertex_size];
+
+    memcpy(&m_positions[i * 4], src, 3 * sizeof(float));
+    m_positions[i * 4 + 3] = 1;
+    if (has_normals)
+    {
+      memcpy(&m_normals[i * 4], src + 3, 3 * sizeof(float));
+      m_normals[i * 4 + 3] = 0;
+    }
+
+    /* The largest weight goes first, so single bone vertices are recognized by the second one */
+    x_influence_t const &in = influences[i];
+    influence_t &out = m_influences[i];
+    int first = 0;
+    for (int j = 1; j < 4; ++j)
+      if (in.weights[j] > in.weights[first])
+        first = j;
+    for (int j = 0; j < 4; ++j)
+    {
+      int const k = j == 0 ? first : (j <= first ? j - 1 : j);
+      out.weights[j] = in.weights[k];
+      out.bones[j] = in.bones[k];
+    }
+  }
+  return true;
+}
+
+void skin_t::build_palette( std::vector<x_bone_t> const &bones, matrix_t const *worlds, std::vector<matrix_t> &palette )
+{
+  matrix_t const identity = transform_t().matrix;
+
+  palette.resize(bones.size());
+  for (size_t i = 0; i < bones.size(); ++i)
+    matrix_t::multiply((float const (*)[4])bones[i].offset, (bones[i].frame >= 0 ? worlds[bones[i].frame] : identity).M, palette[i].M);
+}
+
+void skin_t::deform_range( matrix_t const *palette, size_t first, size_t last, void *vertices ) const
+{
+  bool const has_normals = !m_normals.empty();
+  __m128 const half = _mm_set1_ps(0.5f);
+  __m128 const three_halves = _mm_set1_ps(1.5f);
+  __m128 const tiny = _mm_set1_ps(1e-30f);
+
+  for (size_t i = first; i < last; ++i)
+  {
+    influence_t const &influence = m_influences[i];
+    matrix_t const &b0 = palette[influence.bones[0]];
+    __m128 row0, row1, row2, row3;
+
+    if (influence.weights[1] == 0)
+    {
+      row0 = _mm_loadu_ps(b0.M[0]);
+      row1 = _mm_loadu_ps(b0.M[1]);
+      row2 = _mm_loadu_ps(b0.M[2]);
+      row3 = _mm_loadu_ps(b0.M[3]);
+    }
+    else
+    {
+      matrix_t const &b1 = palette[influence.bones[1]], &b2 = palette[influence.bones[2]], &b3 = palette[influence.bones[3]];
+      __m128 const weights = _mm_loadu_ps(influence.weights);
+      __m128 const w0 = splat(weights, 0), w1 = splat(weights, 1), w2 = splat(weights, 2), w3 = splat(weights, 3);
+
+      row0 = blend_row(b0, b1, b2, b3, w0, w1, w2, w3, 0);
+      row1 = blend_row(b0, b1, b2, b3, w0, w1, w2, w3, 1);
+      row2 = blend_row(b0, b1, b2, b3, w0, w1, w2, w3, 2);
+      row3 = blend_row(b0, b1, b2, b3, w0, w1, w2, w3, 3);
+    }
+
+    float *dst = (float *)((unsigned char *)vertices + i * m_vertex_size);
+    __m128 const position = _mm_loadu_ps(&m_positions[i * 4]);
+    store3(dst, _mm_add_ps(_mm_add_ps(_mm_mul_ps(splat(position, 0), row0), _mm_mul_ps(splat(position, 1), row1)),
+                           _mm_add_ps(_mm_mul_ps(splat(position, 2), row2), row3)));
+    if (!has_normals)
+      continue;
+
+    /* Blended matrix is used for normals as is, renormalized by one Newton step of rsqrt */
+    __m128 const normal = _mm_loadu_ps(&m_normals[i * 4]);
+    __m128 const n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(splat(normal, 0), row0), _mm_mul_ps(splat(normal, 1), row1)),
+                                _mm_mul_ps(splat(normal, 2), row2));
+    __m128 const squares = _mm_mul_ps(n, n);
+    __m128 const length2 = _mm_max_ps(_mm_add_ps(_mm_add_ps(splat(squares, 0), splat(squares, 1)), splat(squares, 2)), tiny);
+    __m128 r = _mm_rsqrt_ps(length2);
+    r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, length2), _mm_mul_ps(r, r))));
+    store3(dst + 3, _mm_mul_ps(n, r));
+  }
+}
+
+void skin_t::deform( matrix_t const *palette, void *vertices, unsigned int threads ) const
+{
+  parallel_for(0, m_influences.size(), c_skin_block_size, [&]( size_t first, size_t last )
+  {
+    deform_range(palette, first, last, vertices);
+  }, threads);
+}
+
+void skin_t::deform_reference( matrix_t const *palette, void *vertices ) const
+{
+  bool const has_normals = !m_normals.empty();
+
+  for (size_t i = 0; i < m_influences.size(); ++i)
+  {
+    influence_t const &influence = m_influences[i];
+    matrix_t m;
+    for (int row = 0; row < 4; ++row)
+      for (int column = 0; column < 4; ++column)
+      {
+        m.M[row][column] = 0;
+        for (int j = 0; j < 4; ++j)
+          m.M[row][column] += influence.weights[j] * palette[influence.bones[j]].M[row][column];
+      }
+
+    float *dst = (float *)((unsigned char *)vertices + i * m_vertex_size);
+    float const *position = &m_positions[i * 4];
+    for (int c = 0; c < 3; ++c)
+      dst[c] = position[0] * m.M[0][c] + position[1] * m.M[1][c] + position[2] * m.M[2][c] + m.M[3][c];
+    if (!has_normals)
+      continue;
+
+    float const *normal = &m_normals[i * 4];
+    float n[3], length = 0;
+    for (int c = 0; c < 3; ++c)
+    {
+      n[c] = normal[0] * m.M[0][c] + normal[1] * m.M[1][c] + normal[2] * m.M[2][c];
+      length += n[c] * n[c];
+    }
+    length = sqrt(length);
+    for (int c = 0; c < 3; ++c)
+      dst[3 + c] = length > 0 ? n[c] / length : 0;
+  }
+}
+
+skinning_benchmark_t benchmark_skinning( unsigned int vertices_count, unsigned int bones_count, unsigned int frames_count )
+{
+  skinning_benchmark_t result;
+  memset(&result, 0, sizeof(result));
+  result.vertices_count = vertices_count;
+  result.bones_count = bones_count;
+  result.frames_count = frames_count;
+  if (vertices_count == 0 || bones_count < 4 || frames_count == 0)
+    return result;
+
+  /* Unit radius tube of 16 vertices rings, bone j spans heights [j, j + 1] */
+  unsigned int const ring_size = 16;
+  unsigned int const rings_count = (vertices_count + ring_size - 1) / ring_size;
+  mesh_data_t mesh;
+  std::vector<x_influence_t> influences(vertices_count);
+
+  mesh.fvf = c_mesh_fvf_position | c_mesh_fvf_normal | c_mesh_fvf_tex1;
+  mesh.vertex_size = 8 * sizeof(float);
+  mesh.vertices.resize(vertices_count * mesh.vertex_size);
+  for (unsigned int i = 0; i < vertices_count; ++i)
+  {
+    float const angle = (i % ring_size) * 2 * cglmath::c_pif / ring_size;
+    float const height = rings_count > 1 ? (float)(i / ring_size) * bones_count / (rings_count - 1) : 0;
+    float const vertex[8] = {cos(angle), height, sin(angle), cos(angle), 0, sin(angle), (float)(i % ring_size) / ring_size, height};
+    memcpy(&mesh.vertices[i * mesh.vertex_size], vertex, sizeof(vertex));
+
+    /* Tent weights of the four nearest bone centers */
+    int const first_bone = cglmath::Clamp((int)floor(height - 0.5f) - 1, 0, (int)bones_count - 4);
+    float sum = 0;
+    for (int j = 0; j < 4; ++j)
+    {
+      influences[i].bones[j] = (unsigned short)(first_bone + j);
+      influences[i].weights[j] = cglmath::Max(2.f - (float)fabs(height - (first_bone + j + 0.5f)), 0.05f);
+      sum += influences[i].weights[j];
+    }
+    for (int j = 0; j < 4; ++j)
+      influences[i].weights[j] /= sum;
+  }
+
+  skin_t skin;
+  skin.create(mesh, &influences[0]);
+
+  /* Bones bend around z at their bases, bind pose is identity */
+  std::vector<std::vector<matrix_t> > palettes(frames_count, std::vector<matrix_t>(bones_count));
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+  {
+    transform_t world;
+    for (unsigned int j = 0; j < bones_count; ++j)
+    {
+      float const angle = 10 * sin(frame / 30.f + j * 0.5f);
+      world = transform_t().translate(0, -(float)j, 0).rotate_z(angle).translate(0, (float)j, 0) * world;
+      palettes[frame][j] = world.matrix;
+    }
+  }
+
+  std::vector<unsigned char> simd(mesh.vertices), parallel(mesh.vertices), reference(mesh.vertices);
+  stopwatch_t timer;
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    skin.deform(&palettes[frame][0], &simd[0], 1);
+  result.simd_ms = timer.elapsed_ms();
+
+  result.threads_count = cglmath::Min(parallel_threads_count(), (vertices_count + (unsigned int)c_skin_block_size - 1) /
+                                                                  (unsigned int)c_skin_block_size);
+  timer.restart();
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    skin.deform(&palettes[frame][0], &parallel[0], result.threads_count);
+  result.parallel_ms = timer.elapsed_ms();
+
+  timer.restart();
+  for (unsigned int frame = 0; frame < frames_count; ++frame)
+    skin.deform_reference(&palettes[frame][0], &reference[0]);
+  result.reference_ms = timer.elapsed_ms();
+
+  for (unsigned int i = 0; i < vertices_count; ++i)
+    for (int c = 0; c < 6; ++c)
+    {
+      float const r = ((float const *)&reference[i * mesh.vertex_size])[c];
+      float const error = cglmath::Max(fabs(((float const *)&simd[i * mesh.vertex_size])[c] - r),
+                                       fabs(((float const *)&parallel[i * mesh.vertex_size])[c] - r));
+      result.max_error = cglmath::Max(result.max_error, error);
+    }
+  return result;
+}
@@ -0,0 +1,77 @@
+/**
+@file     skinning.h
+@brief    Linear blend skinning kernel definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __SKINNING_INCLUDED__
+#define __SKINNING_INCLUDED__
+
+#include <cstddef>
+#include <vector>
+
+#include "Math/cglMath.h"
+#include "x_parser.h"
+
+/* Vertices blended by one thread at a time */
+const size_t c_skin_block_size = 2048;
+
+/* Bind pose positions, normals and four bone influences of mesh vertices. deform() writes
+ * blended positions and normals into vertices of the mesh layout, other attributes stay */
+class skin_t
+{
+public:
+  skin_t();
+
+  /* Mesh with position and optional normal first, one influence per vertex */
+  bool create( mesh_data_t const &mesh, x_influence_t const *influences );
+
+  size_t vertices_count( void ) const { return m_influences.size(); }
+
+  /* Bone matrices: offset followed by the frame world, 'worlds' are per frame */
+  static void build_palette( std::vector<x_bone_t> const &bones, matrix_t const *worlds, std::vector<matrix_t> &palette );
+
+  /* Vertices [first, last) with SSE, vertices of one bone skip the blend */
+  void deform_range( matrix_t const *palette, size_t first, size_t last, void *vertices ) const;
+  /* All vertices by c_skin_block_size blocks on 'threads' threads, 0 means all hardware ones */
+  void deform( matrix_t const *palette, void *vertices, unsigned int threads = 0 ) const;
+  /* Same vertices by blended matrix_t, one thread */
+  void deform_reference( matrix_t const *palette, void *vertices ) const;
+private:
+  struct influence_t
+  {
+    float weights[4];
+    unsigned int bones[4];
+  };
+
+  std::vector<float> m_positions; /* x, y, z, 1 per vertex */
+  std::vector<float> m_normals;   /* x, y, z, 0 per vertex, empty without normals */
+  std::vector<influence_t> m_influences;
+  unsigned int m_vertex_size;
+};
+
+/* Bending tube of 'vertices_count' vertices along a chain of 'bones_count' bones, four
+ * influences per vertex, skinned for 'frames_count' frames on one and all threads */
+struct skinning_benchmark_t
+{
+  unsigned int vertices_count;
+  unsigned int bones_count;
+  unsigned int frames_count;
+  unsigned int threads_count;
+  double simd_ms;               /* one thread */
+  double parallel_ms;           /* threads_count threads */
+  double reference_ms;
+  float max_error;              /* largest position or normal component difference */
+
+  /* Millions of vertices per second */
+  double simd_rate( void ) const { return simd_ms > 0 ? (double)vertices_count * frames_count / simd_ms / 1000 : 0; }
+  double parallel_rate( void ) const { return parallel_ms > 0 ? (double)vertices_count * frames_count / parallel_ms / 1000 : 0; }
+  double per_core_rate( void ) const { return threads_count > 0 ? parallel_rate() / threads_count : 0; }
+  double reference_rate( void ) const { return reference_ms > 0 ? (double)vertices_count * frames_count / reference_ms / 1000 : 0; }
+};
+
+skinning_benchmark_t benchmark_skinning( unsigned int vertices_count, unsigned int bones_count, unsigned int frames_count );
+
+#endif /* __SKINNING_INCLUDED__ */
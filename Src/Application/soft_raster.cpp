@@ -0,0 +1,426 @@
+/**
+@file     soft_raster.cpp
+@brief    Tile based multithreaded software rasterizer implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "image_io.h"
+#include "parallel.h"
+#include "stopwatch.h"
+#include "soft_raster.h"
+
+namespace
+{
+  /* Vertices lit by one light_evaluator_t call */
+  const unsigned int c_lighting_batch = 64;
+}
+
+bool setup_screen_triangle( float const *v0, float const *v1, float const *v2, unsigned int width, unsigned int height,
+                            screen_edges_t &edges, screen_vertices_t &vertices )
+{
+  float const *v[3] = {v0, v1, v2};
+  float sx[3], sy[3];
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (v[i][3] <= 0)
+      return false;
+    vertices.inv_w[i] = 1 / v[i][3];
+    sx[i] = (v[i][0] * vertices.inv_w[i] * 0.5f + 0.5f) * width;
+    sy[i] = (0.5f - v[i][1] * vertices.inv_w[i] * 0.5f) * height;
+    vertices.z[i] = v[i][2] * vertices.inv_w[i];
+  }
+
+  /* Pixels with centers inside bounding box, triangles without any are rejected */
+  float const min_x = cglmath::Min3(sx[0], sx[1], sx[2]), max_x = cglmath::Max3(sx[0], sx[1], sx[2]);
+  float const min_y = cglmath::Min3(sy[0], sy[1], sy[2]), max_y = cglmath::Max3(sy[0], sy[1], sy[2]);
+
+  edges.min_x = cglmath::Max(0, (int)ceil(min_x - 0.5f));
+  edges.min_y = cglmath::Max(0, (int)ceil(min_y - 0.5f));
+  edges.max_x = cglmath::Min((int)width - 1, (int)floor(max_x - 0.5f));
+  edges.max_y = cglmath::Min((int)height - 1, (int)floor(max_y - 0.5f));
+  if (edges.min_x > edges.max_x || edges.min_y > edges.max_y)
+    return false;
+
+  float const area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+  if (area == 0)
+    return false;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    sx[i] -= edges.min_x;
+    sy[i] -= edges.min_y;
+  }
+
+  /* Edge i equals area at vertex i, signs are flipped to be positive inside */
+  float const sign = area > 0 ? 1.f : -1.f;
+  vertices.inv_area = 1 / (area * sign);
+  edges.top_left = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    int const j = (i + 1) % 3, k = (i + 2) % 3;
+
+    edges.edge_a[i] = (sy[j] - sy[k]) * sign;
+    edges.edge_b[i] = (sx[k] - sx[j]) * sign;
+    edges.edge_c[i] = (sx[j] * sy[k] - sx[k] * sy[j]) * sign;
+    if (edges.edge_a[i] > 0 || (edges.edge_a[i] == 0 && edges.edge_b[i] > 0))
+      edges.top_left |= 1 << i;
+  }
+  return true;
+}
+
+soft_rasterizer_t::soft_rasterizer_t()
+  : m_width(0)
+  , m_height(0)
+  , m_stride(0)
+  , m_tiles_x(0)
+  , m_tiles_y(0)
+  , m_threads(0)
+  , m_is_reversed_depth(false)
+  , m_clear_color(0xFF000000U)
+{
+  memset(m_view_projection, 0, sizeof(m_view_projection));
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void soft_rasterizer_t::resize( unsigned int width, unsigned int height )
+{
+  m_width = width;
+  m_height = height;
+  /* Rows are padded, so 4-pixel groups never cross row end */
+  m_stride = (width + 3) & ~3U;
+  m_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  m_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+  m_color.assign((size_t)m_stride * height, m_clear_color);
+  m_depth.assign((size_t)m_stride * height, m_is_reversed_depth ? 0.f : 1.f);
+}
+
+void soft_rasterizer_t::begin_frame( matrix_t const &view, matrix_t const &projection, unsigned long clear_color )
+{
+  matrix_t::multiply(view.M, projection.M, m_view_projection);
+  m_clear_color = (unsigned int)clear_color;
+  m_lights.clear();
+  m_draws.clear();
+  m_pipeline.clear();
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void soft_rasterizer_t::add_light( soft_light_t const &light )
+{
+  m_lights.push_back(light);
+}
+
+void soft_rasterizer_t::draw( soft_mesh_t const &mesh, matrix_t const &world )
+{
+  if (mesh.triangles_count == 0 || mesh.vertices_count == 0)
+    return;
+
+  draw_t draw;
+  draw.mesh = mesh;
+  memcpy(draw.world, world.M, sizeof(draw.world));
+  m_draws.push_back(draw);
+  m_pipeline.add_draw(mesh.vertices_count, mesh.indices, mesh.triangles_count);
+
+  m_stats.draws_count++;
+  m_stats.triangles_count += mesh.triangles_count;
+}
+
+void soft_rasterizer_t::end_frame( void )
+{
+  stopwatch_t frame_timer;
+  unsigned int const tiles_count = m_tiles_x * m_tiles_y;
+
+  m_stats.visible_count = m_stats.bin_entries = 0;
+  m_lighting.set_lights(m_lights.empty() ? NULL : &m_lights[0], m_lights.size());
+
+  stopwatch_t timer;
+  m_pipeline.process([this]( pipeline_t::work_item_t const &item, clip_vertex_t *vertices )
+  {
+    process_vertices(item, vertices);
+  }, m_threads);
+  m_stats.vertex_ms = timer.elapsed_ms();
+
+  timer.restart();
+  m_pipeline.setup(tiles_count, m_is_reversed_depth, [this]( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2,
+                                                             pipeline_t::chunk_t &chunk )
+  {
+    setup_triangle(v0, v1, v2, chunk);
+  }, m_threads);
+  m_stats.setup_ms = timer.elapsed_ms();
+
+  /* Tiles do not overlap, so every tile is cleared and rasterized by one task */
+  timer.restart();
+  parallel_for(0, tiles_count, 1, [this]( size_t begin, size_t end )
+  {
+    for (size_t tile = begin; tile < end; ++tile)
+      rasterize_tile((unsigned int)tile);
+  }, m_threads);
+  m_stats.raster_ms = timer.elapsed_ms();
+
+  for (size_t i = 0; i < m_pipeline.chunks_count(); ++i)
+  {
+    pipeline_t::chunk_t const &chunk = m_pipeline.chunk(i);
+
+    m_stats.visible_count += (unsigned int)chunk.triangles.size();
+    for (unsigned int tile = 0; tile < tiles_count; ++tile)
+      m_stats.bin_entries += (unsigned int)chunk.bins[tile].size();
+  }
+  m_stats.threads_count = m_threads > 0 ? m_threads : parallel_threads_count();
+  m_stats.frame_ms = frame_timer.elapsed_ms();
+}
+
+void soft_rasterizer_t::process_vertices( pipeline_t::work_item_t const &item, clip_vertex_t *vertices ) const
+{
+  draw_t const &draw = m_draws[item.draw];
+  soft_mesh_t const &mesh = draw.mesh;
+  float const (*world)[4] = draw.world;
+  float const (*vp)[4] = m_view_projection;
+  bool const is_lit = mesh.normal_offset >= 0 && !m_lights.empty();
+
+  /* Mesh color is the material of vertices without color */
+  light_material_t material;
+  material.diffuse = material.ambient = mesh.color;
+
+  /* World space vertices are gathered into structure of arrays batches for lighting */
+  float x[c_lighting_batch], y[c_lighting_batch], z[c_lighting_batch];
+  float nx[c_lighting_batch], ny[c_lighting_batch], nz[c_lighting_batch];
+  float r[c_lighting_batch], g[c_lighting_batch], b[c_lighting_batch];
+  float lit_r[c_lighting_batch], lit_g[c_lighting_batch], lit_b[c_lighting_batch];
+  bool const has_colors = mesh.color_offset >= 0;
+  light_batch_t const batch = {x, y, z, nx, ny, nz, has_colors ? r : NULL, has_colors ? g : NULL, has_colors ? b : NULL, 0};
+  light_output_t const output = {lit_r, lit_g, lit_b, NULL, NULL, NULL};
+
+  for (unsigned int first = item.begin; first < item.end; first += c_lighting_batch)
+  {
+    unsigned int const count = item.end - first < c_lighting_batch ? item.end - first : c_lighting_batch;
+    unsigned char const *src = (unsigned char const *)mesh.vertices + (size_t)first * mesh.vertex_size;
+    clip_vertex_t *dst = vertices + (first - item.begin);
+
+    for (unsigned int i = 0; i < count; ++i, src += mesh.vertex_size)
+    {
+      float const *p = (float const *)src;
+      x[i] = p[0] * world[0][0] + p[1] * world[1][0] + p[2] * world[2][0] + world[3][0];
+      y[i] = p[0] * world[0][1] + p[1] * world[1][1] + p[2] * world[2][1] + world[3][1];
+      z[i] = p[0] * world[0][2] + p[1] * world[1][2] + p[2] * world[2][2] + world[3][2];
+
+      dst[i].x = x[i] * vp[0][0] + y[i] * vp[1][0] + z[i] * vp[2][0] + vp[3][0];
+      dst[i].y = x[i] * vp[0][1] + y[i] * vp[1][1] + z[i] * vp[2][1] + vp[3][1];
+      dst[i].z = x[i] * vp[0][2] + y[i] * vp[1][2] + z[i] * vp[2][2] + vp[3][2];
+      dst[i].w = x[i] * vp[0][3] + y[i] * vp[1][3] + z[i] * vp[2][3] + vp[3][3];
+
+      r[i] = mesh.color.r;
+      g[i] = mesh.color.g;
+      b[i] = mesh.color.b;
+      if (has_colors)
+      {
+        unsigned int const argb = *(unsigned int const *)(src + mesh.color_offset);
+
+        r[i] = ((argb >> 16) & 0xFF) / 255.f;
+        g[i] = ((argb >> 8) & 0xFF) / 255.f;
+        b[i] = (argb & 0xFF) / 255.f;
+      }
+
+      if (!is_lit)
+        continue;
+
+      /* Normals are transformed by world rotation part and renormalized as with D3DRS_NORMALIZENORMALS */
+      float const *n = (float const *)(src + mesh.normal_offset);
+      vec_t normal(n[0] * world[0][0] + n[1] * world[1][0] + n[2] * world[2][0],
+                   n[0] * world[0][1] + n[1] * world[1][1] + n[2] * world[2][1],
+                   n[0] * world[0][2] + n[1] * world[1][2] + n[2] * world[2][2]);
+      float const length2 = normal.length2();
+      if (length2 > 0)
+        normal *= 1 / sqrt(length2);
+      nx[i] = normal.x;
+      ny[i] = normal.y;
+      nz[i] = normal.z;
+    }
+
+    if (!is_lit)
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        dst[i].r = r[i];
+        dst[i].g = g[i];
+        dst[i].b = b[i];
+      }
+      continue;
+    }
+
+    light_batch_t counted_batch = batch;
+    counted_batch.count = count;
+    m_lighting.evaluate(counted_batch, material, output);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      dst[i].r = lit_r[i];
+      dst[i].g = lit_g[i];
+      dst[i].b = lit_b[i];
+    }
+  }
+}
+
+void soft_rasterizer_t::setup_triangle( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2,
+                                        pipeline_t::chunk_t &chunk ) const
+{
+  raster_triangle_t tri;
+  screen_vertices_t screen;
+  if (!setup_screen_triangle(&v0->x, &v1->x, &v2->x, m_width, m_height, tri, screen))
+    return;
+
+  float const r[3] = {v0->r * screen.inv_w[0], v1->r * screen.inv_w[1], v2->r * screen.inv_w[2]};
+  float const g[3] = {v0->g * screen.inv_w[0], v1->g * screen.inv_w[1], v2->g * screen.inv_w[2]};
+  float const b[3] = {v0->b * screen.inv_w[0], v1->b * screen.inv_w[1], v2->b * screen.inv_w[2]};
+  screen.plane(tri, screen.z, tri.z);
+  screen.plane(tri, screen.inv_w, tri.inv_w);
+  screen.plane(tri, r, tri.r);
+  screen.plane(tri, g, tri.g);
+  screen.plane(tri, b, tri.b);
+
+  unsigned int const index = (unsigned int)chunk.triangles.size();
+  int const tile_x0 = tri.min_x / TILE_SIZE, tile_x1 = tri.max_x / TILE_SIZE;
+  int const tile_y0 = tri.min_y / TILE_SIZE, tile_y1 = tri.max_y / TILE_SIZE;
+  bool const is_single_tile = tile_x0 == tile_x1 && tile_y0 == tile_y1;
+  bool is_binned = false;
+
+  for (int ty = tile_y0; ty <= tile_y1; ++ty)
+    for (int tx = tile_x0; tx <= tile_x1; ++tx)
+    {
+      /* Skip tiles entirely outside of any edge: test the tile corner pixel where the edge is largest */
+      if (!is_single_tile)
+      {
+        float const x0 = tx * TILE_SIZE - tri.min_x + 0.5f, x1 = x0 + TILE_SIZE - 1;
+        float const y0 = ty * TILE_SIZE - tri.min_y + 0.5f, y1 = y0 + TILE_SIZE - 1;
+        bool is_outside = false;
+
+        for (int i = 0; i < 3 && !is_outside; ++i)
+          is_outside = tri.edge_a[i] * (tri.edge_a[i] > 0 ? x1 : x0) + tri.edge_b[i] * (tri.edge_b[i] > 0 ? y1 : y0) + tri.edge_c[i] < 0;
+        if (is_outside)
+          continue;
+      }
+      chunk.bins[ty * m_tiles_x + tx].push_back(index);
+      is_binned = true;
+    }
+  if (is_binned)
+    chunk.triangles.push_back(tri);
+}
+
+void soft_rasterizer_t::rasterize_tile( unsigned int tile )
+{
+  int const tile_x0 = (tile % m_tiles_x) * TILE_SIZE, tile_y0 = (tile / m_tiles_x) * TILE_SIZE;
+  int const tile_x1 = cglmath::Min(tile_x0 + (int)TILE_SIZE, (int)m_width);
+  int const tile_y1 = cglmath::Min(tile_y0 + (int)TILE_SIZE, (int)m_height);
+  float const clear_depth = m_is_reversed_depth ? 0.f : 1.f;
+
+  for (int y = tile_y0; y < tile_y1; ++y)
+  {
+    size_t const row = (size_t)y * m_stride;
+
+    for (int x = tile_x0; x < tile_x1; ++x)
+    {
+      m_color[row + x] = m_clear_color;
+      m_depth[row + x] = clear_depth;
+    }
+  }
+
+  __m128 const pixel_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const two = _mm_set1_ps(2.f);
+  __m128 const scale = _mm_set1_ps(255.f);
+  __m128i const alpha = _mm_set1_epi32((int)0xFF000000U);
+
+  for (size_t c = 0; c < m_pipeline.chunks_count(); ++c)
+  {
+    pipeline_t::chunk_t const &chunk = m_pipeline.chunk(c);
+    std::vector<unsigned int> const &bin = chunk.bins[tile];
+
+    for (size_t t = 0; t < bin.size(); ++t)
+    {
+      raster_triangle_t const &tri = chunk.triangles[bin[t]];
+      /* Tiles and rows start at multiples of 4, so aligned groups stay inside the tile */
+      int const x0 = cglmath::Max(tri.min_x, tile_x0) & ~3;
+      int const x1 = cglmath::Min(tri.max_x, tile_x1 - 1);
+      int const y0 = cglmath::Max(tri.min_y, tile_y0);
+      int const y1 = cglmath::Min(tri.max_y, tile_y1 - 1);
+
+      __m128 edge_a[3], edge_b[3], edge_c[3], top_left[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        edge_a[i] = _mm_set1_ps(tri.edge_a[i]);
+        edge_b[i] = _mm_set1_ps(tri.edge_b[i]);
+        edge_c[i] = _mm_set1_ps(tri.edge_c[i]);
+        top_left[i] = _mm_castsi128_ps(_mm_set1_epi32((tri.top_left >> i) & 1 ? -1 : 0));
+      }
+
+      for (int y = y0; y <= y1; ++y)
+      {
+        float const fy = y - tri.min_y + 0.5f;
+        __m128 const py = _mm_set1_ps(fy);
+        __m128 e_row[3];
+        for (int i = 0; i < 3; ++i)
+          e_row[i] = _mm_add_ps(_mm_mul_ps(edge_b[i], py), edge_c[i]);
+        __m128 const z_row = _mm_set1_ps(tri.z[1] * fy + tri.z[2]);
+        __m128 const inv_w_row = _mm_set1_ps(tri.inv_w[1] * fy + tri.inv_w[2]);
+        __m128 const r_row = _mm_set1_ps(tri.r[1] * fy + tri.r[2]);
+        __m128 const g_row = _mm_set1_ps(tri.g[1] * fy + tri.g[2]);
+        __m128 const b_row = _mm_set1_ps(tri.b[1] * fy + tri.b[2]);
+        float *depth_row = &m_depth[(size_t)y * m_stride];
+        unsigned int *color_row = &m_color[(size_t)y * m_stride];
+
+        for (int x = x0; x <= x1; x += 4)
+        {
+          __m128 const px = _mm_add_ps(_mm_set1_ps((float)(x - tri.min_x)), pixel_offsets);
+          __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+          for (int i = 0; i < 3; ++i)
+          {
+            __m128 const e = _mm_add_ps(_mm_mul_ps(edge_a[i], px), e_row[i]);
+            mask = _mm_and_ps(mask, _mm_or_ps(_mm_cmpgt_ps(e, zero), _mm_and_ps(_mm_cmpeq_ps(e, zero), top_left[i])));
+          }
+          if (_mm_movemask_ps(mask) == 0)
+            continue;
+
+          __m128 const z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.z[0]), px), z_row);
+          __m128 const depth = _mm_loadu_ps(depth_row + x);
+          mask = _mm_and_ps(mask, m_is_reversed_depth ? _mm_cmpge_ps(z, depth) : _mm_cmple_ps(z, depth));
+          if (_mm_movemask_ps(mask) == 0)
+            continue;
+          _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, depth)));
+
+          /* w = 1 / (1 / w) by reciprocal estimate and one Newton-Raphson step */
+          __m128 const inv_w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.inv_w[0]), px), inv_w_row);
+          __m128 w = _mm_rcp_ps(inv_w);
+          w = _mm_mul_ps(w, _mm_sub_ps(two, _mm_mul_ps(inv_w, w)));
+
+          __m128 const r = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.r[0]), px), r_row), w);
+          __m128 const g = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.g[0]), px), g_row), w);
+          __m128 const b = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.b[0]), px), b_row), w);
+          __m128i const channels[3] =
+          {
+            _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(r, scale), zero), scale)),
+            _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(g, scale), zero), scale)),
+            _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(b, scale), zero), scale))
+          };
+          __m128i const argb = _mm_or_si128(_mm_or_si128(alpha, _mm_slli_epi32(channels[0], 16)),
+                                            _mm_or_si128(_mm_slli_epi32(channels[1], 8), channels[2]));
+
+          __m128i const mask_i = _mm_castps_si128(mask);
+          __m128i const old = _mm_loadu_si128((__m128i const *)(color_row + x));
+          _mm_storeu_si128((__m128i *)(color_row + x), _mm_or_si128(_mm_and_si128(mask_i, argb), _mm_andnot_si128(mask_i, old)));
+        }
+      }
+    }
+  }
+}
+
+bool soft_rasterizer_t::save_ppm( wchar_t const *file_name ) const
+{
+  image_t image;
+  image_from_argb(color_buffer(), m_width, m_height, m_stride, image);
+  return ::save_ppm(file_name, image);
+}
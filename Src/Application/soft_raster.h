@@ -0,0 +1,392 @@
+/**
+@file     soft_raster.h
+@brief    Tile based multithreaded software rasterizer definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __SOFT_RASTER_INCLUDED__
+#define __SOFT_RASTER_INCLUDED__
+
+#include <vector>
+
+#include "Math/cglMath.h"
+#include "lighting.h"
+#include "parallel.h"
+
+/* Indexed triangle list. Vertices start with 3 floats position, normal is 3 floats,
+ * color is packed ARGB as in base_geometry_t::vertex_t and flower_vertex_t */
+struct soft_mesh_t
+{
+  void const *vertices;
+  unsigned int vertex_size;
+  unsigned int vertices_count;
+  int normal_offset;            /* -1 for unlit vertices */
+  int color_offset;             /* -1 to use 'color' for all vertices */
+  color_t color;
+
+  unsigned int const *indices;
+  unsigned int triangles_count;
+
+  soft_mesh_t()
+    : vertices(0), vertex_size(0), vertices_count(0), normal_offset(12), color_offset(24)
+    , color(1.f), indices(0), triangles_count(0)
+  {
+  }
+};
+
+/* Frame statistics */
+struct soft_raster_stats_t
+{
+  unsigned int draws_count;
+  unsigned int triangles_count;   /* submitted */
+  unsigned int visible_count;     /* survived clipping, culling and small triangles rejection */
+  unsigned int bin_entries;       /* triangle references in tiles */
+  unsigned int threads_count;
+  double vertex_ms;
+  double setup_ms;                /* clipping, setup and binning */
+  double raster_ms;
+  double frame_ms;
+
+  /* Submitted triangles throughput in millions per second */
+  double mtris_per_second( void ) const
+  {
+    return frame_ms > 0 ? triangles_count / frame_ms / 1000 : 0;
+  }
+};
+
+/* Clip space outcode bits: point is outside of the plane */
+enum
+{
+  CLIP_OUT_LEFT = 1,
+  CLIP_OUT_RIGHT = 2,
+  CLIP_OUT_BOTTOM = 4,
+  CLIP_OUT_TOP = 8,
+  CLIP_OUT_NEAR = 16,
+  CLIP_OUT_FAR = 32
+};
+
+/* Distance to the near plane z = 0, or z = w with reversed depth, negative behind it */
+inline float near_plane_distance( float z, float w, bool is_reversed_depth )
+{
+  return is_reversed_depth ? w - z : z;
+}
+
+inline int clip_outcode( float x, float y, float z, float w, bool is_reversed_depth )
+{
+  int const out_low = is_reversed_depth ? CLIP_OUT_FAR : CLIP_OUT_NEAR, out_high = is_reversed_depth ? CLIP_OUT_NEAR : CLIP_OUT_FAR;
+  return (x < -w ? CLIP_OUT_LEFT : 0) | (x > w ? CLIP_OUT_RIGHT : 0) |
+         (y < -w ? CLIP_OUT_BOTTOM : 0) | (y > w ? CLIP_OUT_TOP : 0) |
+         (z < 0 ? out_low : 0) | (z > w ? out_high : 0);
+}
+
+/* Screen triangle covering pixel centers inside [min_x, max_x] x [min_y, max_y]. Edge i is opposite
+ * to vertex i and positive inside. Edges and attribute planes are a * x + b * y + c of pixel
+ * coordinates relative to (min_x, min_y), otherwise their constant terms are large and
+ * interpolated depth loses precision in cancellation */
+struct screen_edges_t
+{
+  float edge_a[3], edge_b[3], edge_c[3];
+  int min_x, min_y, max_x, max_y;
+  int top_left;                   /* bit per edge including pixels exactly on the edge */
+};
+
+/* Projected vertices of the triangle being set up */
+struct screen_vertices_t
+{
+  float z[3];
+  float inv_w[3];
+  float inv_area;
+
+  /* Plane of vertex values is barycentric weighted sum of edge functions */
+  void plane( screen_edges_t const &edges, float const values[3], float plane[3] ) const
+  {
+    plane[0] = (values[0] * edges.edge_a[0] + values[1] * edges.edge_a[1] + values[2] * edges.edge_a[2]) * inv_area;
+    plane[1] = (values[0] * edges.edge_b[0] + values[1] * edges.edge_b[1] + values[2] * edges.edge_b[2]) * inv_area;
+    plane[2] = (values[0] * edges.edge_c[0] + values[1] * edges.edge_c[1] + values[2] * edges.edge_c[2]) * inv_area;
+  }
+};
+
+/* Project clip space vertices (x, y, z, w) to width x height viewport and set up edges,
+ * false for triangles covering no pixel centers */
+bool setup_screen_triangle( float const *v0, float const *v1, float const *v2, unsigned int width, unsigned int height,
+                            screen_edges_t &edges, screen_vertices_t &vertices );
+
+/* Vertex and clipping stages shared by the rasterizer and the occlusion culler. Draws of indexed
+ * triangles are split into tasks of limited size. The owner transforms vertices into VERTEX
+ * starting with clip space x, y, z, w, all its floats are interpolated on clipping. Triangles
+ * outside of the frustum are rejected, ones crossing the near plane are clipped, and the owner
+ * sets up and bins the result into per task chunks of TRIANGLE */
+template<class VERTEX, class TRIANGLE>
+class clip_pipeline_t
+{
+public:
+  /* Range of one draw vertices or triangles processed by one task */
+  struct work_item_t
+  {
+    size_t draw;
+    unsigned int begin, end;
+  };
+
+  /* Triangles set up by one task and their bins */
+  struct chunk_t
+  {
+    std::vector<TRIANGLE> triangles;
+    std::vector<std::vector<unsigned int> > bins;
+  };
+
+  clip_pipeline_t() : m_vertices_count(0) {}
+
+  void clear( void );
+  /* Indices are referenced until setup() */
+  void add_draw( unsigned int vertices_count, unsigned int const *indices, unsigned int triangles_count );
+
+  /* process(item, vertices) fills clip space vertices of the item, 'vertices' is the one of item.begin */
+  template<class PROCESS>
+  void process( PROCESS const &process, unsigned int threads );
+  /* setup(v0, v1, v2, chunk) sets up triangle and adds it to some of 'bins_count' chunk bins */
+  template<class SETUP>
+  void setup( unsigned int bins_count, bool is_reversed_depth, SETUP const &setup, unsigned int threads );
+
+  size_t chunks_count( void ) const { return m_triangle_items.size(); }
+  chunk_t const & chunk( size_t index ) const { return m_chunks[index]; }
+private:
+  /* Vertices and triangles processed by one task */
+  static const unsigned int c_vertices_per_task = 4096;
+  static const unsigned int c_triangles_per_task = 4096;
+
+  struct draw_t
+  {
+    unsigned int vertices_count;
+    unsigned int const *indices;
+    unsigned int triangles_count;
+    size_t first_vertex;            /* in m_vertices */
+  };
+
+  template<class SETUP>
+  void setup_triangles( work_item_t const &item, bool is_reversed_depth, SETUP const &setup, chunk_t &chunk ) const;
+
+  std::vector<draw_t> m_draws;
+  size_t m_vertices_count;
+  std::vector<VERTEX> m_vertices;
+  std::vector<work_item_t> m_vertex_items;
+  std::vector<work_item_t> m_triangle_items;
+  std::vector<chunk_t> m_chunks;
+};
+
+/* Renders indexed triangle lists with Gouraud shading into ARGB color and float depth buffers.
+ * Draws are collected between begin_frame() and end_frame(), vertices are lit and transformed,
+ * triangles are clipped, set up and binned into screen tiles, and tiles are rasterized in
+ * parallel with 4-wide SSE edge functions and depth test (D3DCMP_LESSEQUAL, D3DCMP_GREATEREQUAL
+ * with reversed depth).
+ * Vertices are lit by light_evaluator_t with vertex color as diffuse and ambient material,
+ * textures and specular are not supported. No face culling as with D3DCULL_NONE. */
+class soft_rasterizer_t
+{
+public:
+  enum
+  {
+    TILE_SIZE = 64
+  };
+
+  soft_rasterizer_t();
+
+  void resize( unsigned int width, unsigned int height );
+  /* Threads count used by end_frame(), 0 means hardware concurrency */
+  void set_threads( unsigned int threads ) { m_threads = threads; }
+  /* Depth of projections mapping near plane to 1 and far one to 0: near plane clipping is at
+   * z = w, depth is cleared to 0 and nearer pixels have greater depth */
+  void set_reversed_depth( bool is_reversed ) { m_is_reversed_depth = is_reversed; }
+
+  void begin_frame( matrix_t const &view, matrix_t const &projection, unsigned long clear_color = 0xFF000000UL );
+  /* Lights and draws may be added in any order, all lights affect all draws of the frame */
+  void add_light( soft_light_t const &light );
+  /* Mesh data is referenced, it must stay alive until end_frame() */
+  void draw( soft_mesh_t const &mesh, matrix_t const &world );
+  /* Render collected draws, may be called again to render the same frame with other threads count */
+  void end_frame( void );
+
+  unsigned int width( void ) const { return m_width; }
+  unsigned int height( void ) const { return m_height; }
+  /* Color buffer rows are 'stride' pixels apart, pixels are 0xAARRGGBB */
+  unsigned int stride( void ) const { return m_stride; }
+  unsigned int const * color_buffer( void ) const { return m_color.empty() ? 0 : &m_color[0]; }
+  float const * depth_buffer( void ) const { return m_depth.empty() ? 0 : &m_depth[0]; }
+
+  /* Save color buffer as binary PPM image */
+  bool save_ppm( wchar_t const *file_name ) const;
+
+  soft_raster_stats_t const & stats( void ) const { return m_stats; }
+private:
+  soft_rasterizer_t( soft_rasterizer_t const & );
+  soft_rasterizer_t & operator=( soft_rasterizer_t const & );
+
+  /* Transformed and lit vertex */
+  struct clip_vertex_t
+  {
+    float x, y, z, w;
+    float r, g, b;
+  };
+
+  /* Attributes are planes of screen_edges_t coordinates */
+  struct raster_triangle_t : screen_edges_t
+  {
+    float z[3];
+    float inv_w[3];
+    float r[3], g[3], b[3];         /* divided by w for perspective correct interpolation */
+  };
+
+  struct draw_t
+  {
+    soft_mesh_t mesh;
+    float world[4][4];
+  };
+
+  /* Chunk bins are screen tiles */
+  typedef clip_pipeline_t<clip_vertex_t, raster_triangle_t> pipeline_t;
+
+  void process_vertices( pipeline_t::work_item_t const &item, clip_vertex_t *vertices ) const;
+  void setup_triangle( clip_vertex_t const *v0, clip_vertex_t const *v1, clip_vertex_t const *v2, pipeline_t::chunk_t &chunk ) const;
+  void rasterize_tile( unsigned int tile );
+
+  unsigned int m_width, m_height, m_stride;
+  unsigned int m_tiles_x, m_tiles_y;
+  unsigned int m_threads;
+  bool m_is_reversed_depth;
+  std::vector<unsigned int> m_color;
+  std::vector<float> m_depth;
+
+  float m_view_projection[4][4];
+  std::vector<soft_light_t> m_lights;
+  light_evaluator_t m_lighting;
+  unsigned int m_clear_color;
+
+  std::vector<draw_t> m_draws;
+  pipeline_t m_pipeline;
+
+  soft_raster_stats_t m_stats;
+};
+
+template<class VERTEX, class TRIANGLE>
+void clip_pipeline_t<VERTEX, TRIANGLE>::clear( void )
+{
+  m_draws.clear();
+  m_vertex_items.clear();
+  m_triangle_items.clear();
+  m_vertices_count = 0;
+}
+
+template<class VERTEX, class TRIANGLE>
+void clip_pipeline_t<VERTEX, TRIANGLE>::add_draw( unsigned int vertices_count, unsigned int const *indices, unsigned int triangles_count )
+{
+  draw_t draw = {vertices_count, indices, triangles_count, m_vertices_count};
+  size_t const index = m_draws.size();
+
+  m_draws.push_back(draw);
+  m_vertices_count += vertices_count;
+  for (unsigned int begin = 0; begin < vertices_count; begin += c_vertices_per_task)
+  {
+    work_item_t item = {index, begin, begin + c_vertices_per_task < vertices_count ? begin + c_vertices_per_task : vertices_count};
+    m_vertex_items.push_back(item);
+  }
+  for (unsigned int begin = 0; begin < triangles_count; begin += c_triangles_per_task)
+  {
+    work_item_t item = {index, begin, begin + c_triangles_per_task < triangles_count ? begin + c_triangles_per_task : triangles_count};
+    m_triangle_items.push_back(item);
+  }
+}
+
+template<class VERTEX, class TRIANGLE>
+template<class PROCESS>
+void clip_pipeline_t<VERTEX, TRIANGLE>::process( PROCESS const &process, unsigned int threads )
+{
+  m_vertices.resize(m_vertices_count);
+  parallel_for(0, m_vertex_items.size(), 4, [this, &process]( size_t begin, size_t end )
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      work_item_t const &item = m_vertex_items[i];
+      process(item, &m_vertices[m_draws[item.draw].first_vertex + item.begin]);
+    }
+  }, threads);
+}
+
+template<class VERTEX, class TRIANGLE>
+template<class SETUP>
+void clip_pipeline_t<VERTEX, TRIANGLE>::setup( unsigned int bins_count, bool is_reversed_depth, SETUP const &setup, unsigned int threads )
+{
+  if (m_chunks.size() < m_triangle_items.size())
+    m_chunks.resize(m_triangle_items.size());
+  for (size_t i = 0; i < m_triangle_items.size(); ++i)
+  {
+    m_chunks[i].triangles.clear();
+    m_chunks[i].bins.resize(bins_count);
+    for (unsigned int bin = 0; bin < bins_count; ++bin)
+      m_chunks[i].bins[bin].clear();
+  }
+
+  parallel_for(0, m_triangle_items.size(), 1, [this, is_reversed_depth, &setup]( size_t begin, size_t end )
+  {
+    for (size_t i = begin; i < end; ++i)
+      setup_triangles(m_triangle_items[i], is_reversed_depth, setup, m_chunks[i]);
+  }, threads);
+}
+
+template<class VERTEX, class TRIANGLE>
+template<class SETUP>
+void clip_pipeline_t<VERTEX, TRIANGLE>::setup_triangles( work_item_t const &item, bool is_reversed_depth, SETUP const &setup,
+                                                         chunk_t &chunk ) const
+{
+  draw_t const &draw = m_draws[item.draw];
+  VERTEX const *vertices = &m_vertices[draw.first_vertex];
+
+  for (unsigned int t = item.begin; t < item.end; ++t)
+  {
+    unsigned int const i0 = draw.indices[3 * t], i1 = draw.indices[3 * t + 1], i2 = draw.indices[3 * t + 2];
+    if (i0 >= draw.vertices_count || i1 >= draw.vertices_count || i2 >= draw.vertices_count)
+      continue;
+
+    VERTEX const *v[3] = {&vertices[i0], &vertices[i1], &vertices[i2]};
+    int const code0 = clip_outcode(v[0]->x, v[0]->y, v[0]->z, v[0]->w, is_reversed_depth);
+    int const code1 = clip_outcode(v[1]->x, v[1]->y, v[1]->z, v[1]->w, is_reversed_depth);
+    int const code2 = clip_outcode(v[2]->x, v[2]->y, v[2]->z, v[2]->w, is_reversed_depth);
+
+    if ((code0 & code1 & code2) != 0)
+      continue;
+    if (((code0 | code1 | code2) & CLIP_OUT_NEAR) == 0)
+    {
+      /* Other planes are handled by screen bounds, far pixels fail depth test */
+      setup(v[0], v[1], v[2], chunk);
+      continue;
+    }
+
+    /* Clip by near plane, result is a triangle or a quad */
+    VERTEX polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      VERTEX const &a = *v[i], &b = *v[(i + 1) % 3];
+      float const distance_a = near_plane_distance(a.z, a.w, is_reversed_depth);
+      float const distance_b = near_plane_distance(b.z, b.w, is_reversed_depth);
+
+      if (distance_a >= 0)
+        polygon[count++] = a;
+      if ((distance_a >= 0) != (distance_b >= 0))
+      {
+        float const s = distance_a / (distance_a - distance_b);
+        float const *fa = &a.x, *fb = &b.x;
+        VERTEX &c = polygon[count++];
+        float *fc = &c.x;
+
+        for (size_t k = 0; k < sizeof(VERTEX) / sizeof(float); ++k)
+          fc[k] = fa[k] + (fb[k] - fa[k]) * s;
+        c.z = is_reversed_depth ? c.w : 0;
+      }
+    }
+    for (int i = 1; i + 1 < count; ++i)
+      setup(&polygon[0], &polygon[i], &polygon[i + 1], chunk);
+  }
+}
+
+#endif /* __SOFT_RASTER_INCLUDED__ */
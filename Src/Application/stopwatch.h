@@ -0,0 +1,38 @@
+/**
+@file     stopwatch.h
+@brief    Wall clock interval measurement helper
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __STOPWATCH_INCLUDED__
+#define __STOPWATCH_INCLUDED__
+
+#include <chrono>
+
+class stopwatch_t
+{
+public:
+  stopwatch_t()
+  {
+    restart();
+  }
+
+  void restart( void )
+  {
+    m_start = clock_t::now();
+  }
+
+  /* Milliseconds since construction or last restart */
+  double elapsed_ms( void ) const
+  {
+    return std::chrono::duration<double, std::milli>(clock_t::now() - m_start).count();
+  }
+private:
+  typedef std::chrono::high_resolution_clock clock_t;
+
+  clock_t::time_point m_start;
+};
+
+#endif /* __STOPWATCH_INCLUDED__ */
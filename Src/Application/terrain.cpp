@@ -0,0 +1,580 @@
+/**
+@file     terrain.cpp
+@brief    Chunked quadtree LOD terrain implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "light_bake.h"
+#include "soft_raster.h"
+#include "stopwatch.h"
+#include "terrain.h"
+
+namespace
+{
+  /* Skirts depth besides the cracks estimate, hides T-junction gaps on flat ground */
+  const float c_skirt_cells = 0.05f;
+  const unsigned int c_key_bits = 28;
+  const unsigned long long c_key_mask = (1ULL << c_key_bits) - 1;
+
+  std::mutex s_stats_mutex;
+  terrain_stats_t s_stats;
+
+  /* Distance from point to axis aligned box, 0 inside */
+  float box_distance( vec_t const &point, vec_t const &box_min, vec_t const &box_max )
+  {
+    float const dx = cglmath::Max(cglmath::Max(box_min.x - point.x, point.x - box_max.x), 0.f);
+    float const dy = cglmath::Max(cglmath::Max(box_min.y - point.y, point.y - box_max.y), 0.f);
+    float const dz = cglmath::Max(cglmath::Max(box_min.z - point.z, point.z - box_max.z), 0.f);
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+terrain_t::terrain_t( IDirect3DDevice9 *device, terrain_params_t const &params )
+  : m_params(params)
+  , m_index_buf(NULL)
+  , m_is_static(false)
+  , m_root(NULL)
+  , m_frame(0)
+  , m_culled_count(0)
+  , m_is_stopping(false)
+{
+  unsigned int const n = m_params.chunk_quads, row = n + 1;
+
+  /* Grid rows go along x, columns against z: the winding of base_geometry_t grid on the ground */
+  m_chunk_vertices = row * row + 4 * row;
+  m_chunk_triangles = 2 * n * n + 4 * 2 * n;
+  m_indices.reserve(m_chunk_triangles * 3);
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < n; ++j)
+    {
+      unsigned int const quad[6] = {i * row + j, i * row + j + 1, (i + 1) * row + j,
+                                    (i + 1) * row + j, i * row + j + 1, (i + 1) * row + j + 1};
+      m_indices.insert(m_indices.end(), quad, quad + 6);
+    }
+
+  /* Skirts: borders at x min, x max, z max, z min copied below, faces look outside */
+  for (unsigned int edge = 0; edge < 4; ++edge)
+  {
+    bool const is_flipped = edge == 0 || edge == 3;
+    for (unsigned int k = 0; k < n; ++k)
+    {
+      unsigned int border[2], skirt[2];
+      for (unsigned int t = 0; t < 2; ++t)
+      {
+        unsigned int const along = k + t;
+        border[t] = edge == 0 ? along : edge == 1 ? n * row + along : edge == 2 ? along * row : along * row + n;
+        skirt[t] = row * row + edge * row + along;
+      }
+      unsigned int const quad[6] = {border[0], border[1], skirt[0], skirt[0], border[1], skirt[1]};
+      unsigned int const flipped[6] = {border[0], skirt[0], border[1], skirt[0], skirt[1], border[1]};
+      m_indices.insert(m_indices.end(), is_flipped ? flipped : quad, (is_flipped ? flipped : quad) + 6);
+    }
+  }
+
+  if (device != NULL)
+  {
+    /* Chunks have less than 64K vertices */
+    void *buf;
+    if (SUCCEEDED(device->CreateIndexBuffer((UINT)m_indices.size() * sizeof(WORD), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16,
+                                            D3DPOOL_DEFAULT, &m_index_buf, NULL)))
+    {
+      m_index_buf->Lock(0, 0, &buf, 0);
+      WORD *indices = (WORD *)buf;
+      for (size_t i = 0; i < m_indices.size(); ++i)
+        indices[i] = (WORD)m_indices[i];
+      m_index_buf->Unlock();
+    }
+  }
+
+  m_root = build_chunk(chunk_key(0, 0, 0));
+  add_chunk(device, m_root);
+
+  {
+    std::lock_guard<std::mutex> lock(s_stats_mutex);
+    s_stats.terrains_count++;
+  }
+  if (m_params.streaming)
+    m_stream_thread = std::thread(&terrain_t::stream_worker, this);
+}
+
+terrain_t::~terrain_t()
+{
+  if (m_stream_thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_stream_mutex);
+      m_is_stopping = true;
+    }
+    m_stream_cond.notify_all();
+    m_stream_thread.join();
+  }
+  for (size_t i = 0; i < m_built.size(); ++i)
+    delete m_built[i];
+  for (std::map<unsigned long long, chunk_t *>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    release_chunk(it->second);
+  if (m_index_buf != NULL)
+    m_index_buf->Release();
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.terrains_count--;
+}
+
+unsigned long long terrain_t::chunk_key( unsigned int level, unsigned int x, unsigned int z )
+{
+  return ((unsigned long long)level << (2 * c_key_bits)) | ((unsigned long long)x << c_key_bits) | z;
+}
+
+terrain_t::chunk_t * terrain_t::build_chunk( unsigned long long key ) const
+{
+  stopwatch_t timer;
+  chunk_t *chunk = new chunk_t();
+
+  chunk->key = key;
+  chunk->level = (unsigned int)(key >> (2 * c_key_bits));
+  chunk->x = (unsigned int)((key >> c_key_bits) & c_key_mask);
+  chunk->z = (unsigned int)(key & c_key_mask);
+  chunk->last_frame = 0;
+
+  /* Positions are computed from grid indices of the level: shared borders of neighbours
+   * and parent vertices in children are bit exact (cell sizes are powers of 2 fractions) */
+  unsigned int const n = m_params.chunk_quads, row = n + 1;
+  float const half = m_params.size * 0.5f;
+  float const cell = m_params.size / (float)(n << chunk->level);
+  unsigned int const first_x = chunk->x * n, first_z = chunk->z * n;
+  bool const is_flat = !m_params.height;
+  DWORD const color = m_params.color;
+
+  chunk->vertices.resize(m_chunk_vertices);
+  base_geometry_t::vertex_t *vertices = &chunk->vertices[0];
+  for (unsigned int i = 0; i <= n; ++i)
+    for (unsigned int j = 0; j <= n; ++j)
+    {
+      base_geometry_t::vertex_t &vertex = vertices[i * row + j];
+      float const x = -half + (first_x + i) * cell;
+      float const z = -half + (first_z + n - j) * cell;
+
+      vertex.V = vec_t(x, is_flat ? 0 : m_params.height(x, z), z);
+      if (is_flat)
+        vertex.N = vec_t(0, 1, 0);
+      else
+        vertex.N = vec_t(m_params.height(x - cell, z) - m_params.height(x + cell, z), 2 * cell,
+                         m_params.height(x, z - cell) - m_params.height(x, z + cell)).normalizing();
+      vertex.Color = color;
+      vertex.u = (x + half) / m_params.texture_size;
+      vertex.v = (z + half) / m_params.texture_size;
+    }
+
+  /* Children and finer neighbours differ from the grid by its midpoints error at most */
+  float error = 0;
+  if (!is_flat)
+    for (unsigned int i = 0; i <= n; ++i)
+      for (unsigned int j = 0; j <= n; ++j)
+      {
+        vec_t const &p = vertices[i * row + j].V;
+        if (i < n)
+        {
+          vec_t const &q = vertices[(i + 1) * row + j].V;
+          error = cglmath::Max(error, fabsf(m_params.height((p.x + q.x) * 0.5f, p.z) - (p.y + q.y) * 0.5f));
+        }
+        if (j < n)
+        {
+          vec_t const &q = vertices[i * row + j + 1].V;
+          error = cglmath::Max(error, fabsf(m_params.height(p.x, (p.z + q.z) * 0.5f) - (p.y + q.y) * 0.5f));
+        }
+      }
+
+  /* Neighbours may be a couple of levels apart */
+  float const skirt_depth = 2 * error + c_skirt_cells * cell;
+  for (unsigned int edge = 0; edge < 4; ++edge)
+    for (unsigned int k = 0; k <= n; ++k)
+    {
+      unsigned int const border = edge == 0 ? k : edge == 1 ? n * row + k : edge == 2 ? k * row : k * row + n;
+      base_geometry_t::vertex_t &vertex = vertices[row * row + edge * row + k];
+
+      vertex = vertices[border];
+      vertex.V.y -= skirt_depth;
+    }
+
+  chunk->box_min = chunk->box_max = vertices[0].V;
+  for (unsigned int i = 1; i < m_chunk_vertices; ++i)
+  {
+    vec_t const &v = vertices[i].V;
+    chunk->box_min = vec_t(cglmath::Min(chunk->box_min.x, v.x), cglmath::Min(chunk->box_min.y, v.y), cglmath::Min(chunk->box_min.z, v.z));
+    chunk->box_max = vec_t(cglmath::Max(chunk->box_max.x, v.x), cglmath::Max(chunk->box_max.y, v.y), cglmath::Max(chunk->box_max.z, v.z));
+  }
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.built_count++;
+  s_stats.build_ms += timer.elapsed_ms();
+  return chunk;
+}
+
+void terrain_t::add_chunk( IDirect3DDevice9 *device, chunk_t *chunk )
+{
+  if (device != NULL)
+    chunk->device_vertices.create(device, &chunk->vertices[0], sizeof(base_geometry_t::vertex_t), m_chunk_vertices,
+                                  base_geometry_t::c_FVF);
+  m_chunks[chunk->key] = chunk;
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.resident_count++;
+  s_stats.memory += chunk->memory_size();
+}
+
+terrain_t::chunk_t::~chunk_t()
+{
+  light_bake_cache().forget(this);
+}
+
+void terrain_t::release_chunk( chunk_t *chunk )
+{
+  {
+    std::lock_guard<std::mutex> lock(s_stats_mutex);
+    s_stats.resident_count--;
+    s_stats.memory -= chunk->memory_size();
+  }
+  delete chunk;
+}
+
+terrain_t::chunk_t * terrain_t::find_chunk( unsigned long long key ) const
+{
+  std::map<unsigned long long, chunk_t *>::const_iterator it = m_chunks.find(key);
+  return it == m_chunks.end() ? NULL : it->second;
+}
+
+double terrain_t::full_triangles( void ) const
+{
+  double const quads = (double)(m_params.chunk_quads << (m_params.levels - 1));
+  return 2 * quads * quads;
+}
+
+bool terrain_t::get_bounds( vec_t &center, float &radius ) const
+{
+  center = (m_root->box_min + m_root->box_max) * 0.5f;
+  radius = (m_root->box_max - m_root->box_min).length() * 0.5f;
+  return true;
+}
+
+bool terrain_t::frustum_t::is_visible( vec_t const &box_min, vec_t const &box_max ) const
+{
+  for (int i = 0; i < 6; ++i)
+  {
+    float const *plane = planes[i];
+    /* Box corner farthest along the plane normal */
+    float const x = plane[0] > 0 ? box_max.x : box_min.x;
+    float const y = plane[1] > 0 ? box_max.y : box_min.y;
+    float const z = plane[2] > 0 ? box_max.z : box_min.z;
+    if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0)
+      return false;
+  }
+  return true;
+}
+
+void terrain_t::update( IDirect3DDevice9 *device, frame_context_t const &frame, transform_t const &world )
+{
+  m_frame++;
+  if (m_params.streaming)
+    receive_chunks(device);
+
+  /* Local space planes of clip volume -w < x, y < w, 0 < z < w of row vectors p * M */
+  matrix_t clip;
+  matrix_t::multiply(world.matrix, frame.view_projection, clip);
+  int const rows[6][2] = {{0, 1}, {0, -1}, {1, 1}, {1, -1}, {2, 0}, {2, -1}};
+  frustum_t frustum;
+  for (int i = 0; i < 6; ++i)
+    for (int j = 0; j < 4; ++j)
+    {
+      float const axis = clip.M[j][rows[i][0]];
+      float const w = clip.M[j][3];
+      frustum.planes[i][j] = rows[i][1] == 0 ? axis : w + rows[i][1] * axis;
+    }
+
+  m_visible.clear();
+  m_wanted.clear();
+  m_culled_count = 0;
+  select(device, m_root, frustum, world.inv_transform_point(frame.eye));
+
+  if (m_params.streaming)
+    request_chunks();
+  evict();
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.visible_count += (unsigned int)m_visible.size();
+  s_stats.culled_count += m_culled_count;
+  s_stats.requests_count += (unsigned int)m_wanted.size();
+  s_stats.drawn_triangles += visible_triangles();
+  s_stats.full_triangles += full_triangles();
+}
+
+void terrain_t::select( IDirect3DDevice9 *device, chunk_t *chunk, frustum_t const &frustum, vec_t const &eye )
+{
+  /* Culled chunks are kept: they are back as soon as the camera turns */
+  chunk->last_frame = m_frame;
+  if (!frustum.is_visible(chunk->box_min, chunk->box_max))
+  {
+    m_culled_count++;
+    return;
+  }
+
+  float const size = m_params.size / (float)(1u << chunk->level);
+  if (chunk->level + 1 < m_params.levels && box_distance(eye, chunk->box_min, chunk->box_max) < m_params.lod_distance * size)
+  {
+    chunk_t *children[4];
+    bool is_ready = true;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      unsigned long long const key = chunk_key(chunk->level + 1, 2 * chunk->x + (i & 1), 2 * chunk->z + (i >> 1));
+
+      children[i] = find_chunk(key);
+      if (children[i] == NULL && !m_params.streaming)
+      {
+        children[i] = build_chunk(key);
+        add_chunk(device, children[i]);
+      }
+      if (children[i] == NULL)
+      {
+        m_wanted.push_back(key);
+        is_ready = false;
+      }
+    }
+
+    /* Chunk is drawn whole until all its children are streamed in */
+    if (is_ready)
+    {
+      for (unsigned int i = 0; i < 4; ++i)
+        select(device, children[i], frustum, eye);
+      return;
+    }
+  }
+  m_visible.push_back(chunk);
+}
+
+void terrain_t::render( recursive_data_t &rd )
+{
+  update(rd.device, rd.frame, rd.world());
+  draw(rd);
+}
+
+void terrain_t::add_occluders( occlusion_culler_t &culler, transform_t const &world )
+{
+  /* Flat ground hides nothing */
+  if (!m_params.height)
+    return;
+
+  for (size_t i = 0; i < m_visible.size(); ++i)
+    culler.add_occluder(&m_visible[i]->vertices[0], sizeof(base_geometry_t::vertex_t), m_chunk_vertices,
+                        &m_indices[0], m_chunk_triangles, world.matrix);
+}
+
+void terrain_t::draw( recursive_data_t &rd )
+{
+  if (rd.rasterizer != NULL)
+  {
+    for (size_t i = 0; i < m_visible.size(); ++i)
+    {
+      soft_mesh_t mesh;
+
+      mesh.vertices = &m_visible[i]->vertices[0];
+      mesh.vertex_size = sizeof(base_geometry_t::vertex_t);
+      mesh.vertices_count = m_chunk_vertices;
+      mesh.indices = &m_indices[0];
+      mesh.triangles_count = m_chunk_triangles;
+      rd.rasterizer->draw(mesh, rd.world().matrix);
+    }
+    return;
+  }
+  if (rd.device == NULL || m_index_buf == NULL)
+    return;
+
+  rd.device->SetIndices(m_index_buf);
+  std::vector<chunk_t *> unbaked;
+  if (m_is_static && rd.static_lighting != NULL && rd.lights != NULL)
+  {
+    baked_lighting_binder_t binder(rd, m_params.color);
+
+    rd.device->SetTransform(D3DTS_WORLD, (D3DMATRIX *)rd.world().matrix.M);
+    rd.device->SetFVF(base_geometry_t::c_FVF);
+    for (size_t i = 0; i < m_visible.size(); ++i)
+    {
+      chunk_t const *chunk = m_visible[i];
+      IDirect3DVertexBuffer9 *baked = light_bake_cache().get(rd.device, chunk, &chunk->vertices[0], sizeof(base_geometry_t::vertex_t),
+                                                             m_chunk_vertices, base_geometry_t::c_FVF, rd.world(),
+                                                             *rd.static_lighting);
+      if (baked == NULL)
+      {
+        unbaked.push_back(m_visible[i]);
+        continue;
+      }
+      rd.device->SetStreamSource(0, baked, 0, sizeof(base_geometry_t::vertex_t));
+      rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_chunk_vertices, 0, m_chunk_triangles);
+    }
+  }
+  else
+    unbaked = m_visible;
+
+  for (size_t i = 0; i < unbaked.size(); ++i)
+  {
+    unbaked[i]->device_vertices.bind(rd.device, rd.world());
+    rd.device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, m_chunk_vertices, 0, m_chunk_triangles);
+  }
+}
+
+void terrain_t::stream_worker( void )
+{
+  std::unique_lock<std::mutex> lock(m_stream_mutex);
+  for (;;)
+  {
+    while (!m_is_stopping && m_requests.empty())
+      m_stream_cond.wait(lock);
+    if (m_is_stopping)
+      return;
+
+    unsigned long long const key = m_requests.front();
+    m_requests.erase(m_requests.begin());
+    m_streaming.insert(key);
+    lock.unlock();
+    chunk_t *chunk = build_chunk(key);
+    lock.lock();
+    m_built.push_back(chunk);
+  }
+}
+
+void terrain_t::receive_chunks( IDirect3DDevice9 *device )
+{
+  std::vector<chunk_t *> received;
+  {
+    std::lock_guard<std::mutex> lock(m_stream_mutex);
+    size_t const count = cglmath::Min((size_t)m_params.uploads_per_frame, m_built.size());
+
+    received.assign(m_built.begin(), m_built.begin() + count);
+    m_built.erase(m_built.begin(), m_built.begin() + count);
+    for (size_t i = 0; i < received.size(); ++i)
+      m_streaming.erase(received[i]->key);
+  }
+  for (size_t i = 0; i < received.size(); ++i)
+  {
+    received[i]->last_frame = m_frame;
+    add_chunk(device, received[i]);
+  }
+}
+
+void terrain_t::request_chunks( void )
+{
+  /* Keys start with the level: coarse chunks are streamed first */
+  std::sort(m_wanted.begin(), m_wanted.end());
+  {
+    std::lock_guard<std::mutex> lock(m_stream_mutex);
+
+    m_requests.clear();
+    for (size_t i = 0; i < m_wanted.size(); ++i)
+      if (m_streaming.find(m_wanted[i]) == m_streaming.end())
+        m_requests.push_back(m_wanted[i]);
+    if (m_requests.empty())
+      return;
+  }
+  m_stream_cond.notify_one();
+}
+
+void terrain_t::evict( void )
+{
+  if (m_chunks.size() <= m_params.max_resident)
+    return;
+
+  /* Chunks of this frame are drawn or lead to drawn ones */
+  std::vector<std::pair<unsigned int, chunk_t *> > unused;
+  for (std::map<unsigned long long, chunk_t *>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    if (it->second->last_frame != m_frame)
+      unused.push_back(std::make_pair(it->second->last_frame, it->second));
+  std::sort(unused.begin(), unused.end());
+
+  size_t const count = cglmath::Min(unused.size(), m_chunks.size() - m_params.max_resident);
+  for (size_t i = 0; i < count; ++i)
+  {
+    m_chunks.erase(unused[i].second->key);
+    release_chunk(unused[i].second);
+  }
+}
+
+terrain_stats_t terrain_stats( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  return s_stats;
+}
+
+void terrain_begin_frame( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.visible_count = 0;
+  s_stats.culled_count = 0;
+  s_stats.requests_count = 0;
+  s_stats.drawn_triangles = 0;
+  s_stats.full_triangles = 0;
+}
+
+terrain_benchmark_t benchmark_terrain( float size, unsigned int levels, unsigned int frames_count )
+{
+  terrain_benchmark_t result;
+  terrain_params_t params;
+
+  memset(&result, 0, sizeof(result));
+  result.size = size;
+  result.levels = levels;
+  result.frames_count = frames_count;
+
+  params.size = size;
+  params.levels = levels;
+  params.texture_size = 50;
+  params.height = benchmark_hills_height;
+  params.streaming = false;
+  params.max_resident = 1024;
+
+  terrain_stats_t const before = terrain_stats();
+  stopwatch_t timer;
+  double total_ms = 0;
+  {
+    terrain_t terrain(NULL, params);
+    transform_t const world;
+    camera_t camera;
+
+    camera.screen_width = 1000;
+    camera.screen_height = 700;
+    camera.set_near_far(0.5f, 10000.f);
+    camera.update_proj_data();
+    result.full_triangles = terrain.full_triangles();
+
+    /* Low flight along the diagonal, looking ahead and down */
+    for (unsigned int frame = 0; frame < frames_count; ++frame)
+    {
+      float const t = (frame + 0.5f) / frames_count - 0.5f;
+      float const x = t * size * 0.8f, z = t * size * 0.6f;
+      vec_t location(x, benchmark_hills_height(x, z) + 30.f, z), at(x + 100.f, benchmark_hills_height(x, z), z + 75.f), up(0, 1, 0);
+
+      camera.set_camera(location, at, up, true);
+      timer.restart();
+      terrain.update(NULL, frame_context_t(camera, 0, 0), world);
+      total_ms += timer.elapsed_ms();
+      result.visible_chunks += terrain.visible_count();
+      result.visible_triangles += terrain.visible_triangles();
+    }
+  }
+  terrain_stats_t const after = terrain_stats();
+
+  result.built_count = after.built_count - before.built_count;
+  result.build_ms = after.build_ms - before.build_ms;
+  result.select_ms = cglmath::Max(total_ms - result.build_ms, 0.0) / frames_count;
+  result.visible_chunks /= frames_count;
+  result.visible_triangles /= frames_count;
+  return result;
+}
+
+float benchmark_hills_height( float x, float z )
+{
+  return 40.f * sinf(x * 0.004f) * cosf(z * 0.0035f) + 6.f * sinf(x * 0.031f + z * 0.027f) + 1.5f * cosf(x * 0.13f - z * 0.11f);
+}
@@ -0,0 +1,189 @@
+/**
+@file     terrain.h
+@brief    Chunked quadtree LOD terrain definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __TERRAIN_INCLUDED__
+#define __TERRAIN_INCLUDED__
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+#include "geometry.h"
+#include "unit.h"
+#include "vertex_format.h"
+
+/* Ground height at local space point, called on the streaming thread */
+typedef std::function<float ( float x, float z )> terrain_height_t;
+
+struct terrain_params_t
+{
+  float size;                   /* side of the square centered at local origin, y is up */
+  unsigned int levels;          /* quadtree depth, leaf chunks have the finest resolution */
+  unsigned int chunk_quads;     /* grid quads along chunk side, power of 2 up to 128 */
+  float lod_distance;           /* chunks closer than this many their sizes are split */
+  float texture_size;           /* texture repeat distance */
+  color_t color;
+  terrain_height_t height;      /* empty for flat ground */
+  bool streaming;               /* build chunks on a worker thread, parents are drawn until children are ready */
+  unsigned int max_resident;    /* resident chunks above it are evicted, least recently used first */
+  unsigned int uploads_per_frame; /* device buffers created per frame for streamed chunks */
+
+  terrain_params_t()
+    : size(50), levels(5), chunk_quads(32), lod_distance(2), texture_size(50), color(1.f), streaming(true)
+    , max_resident(256), uploads_per_frame(8)
+  {
+  }
+};
+
+/* Square ground of quadtree chunks. Every chunk is a grid of the same quads count, so
+ * finer levels cover less ground with more detail and all chunks share one index buffer.
+ * Chunks are culled by the view frustum and split by camera distance. Neighbours of
+ * different levels meet with T-junctions, skirts hanging down the chunk borders cover
+ * the cracks. Only the root chunk is always resident: others are built on request, on
+ * the streaming thread if enabled, and evicted when not drawn for a while */
+class terrain_t : public IAnimationUnit
+{
+public:
+  terrain_t( IDirect3DDevice9 *device, terrain_params_t const &params = terrain_params_t() );
+  virtual ~terrain_t();
+
+  /* Select chunks of the frame and draw them */
+  virtual void render( recursive_data_t &rd );
+  /* Select chunks for the camera without drawing, resident chunks are updated */
+  void update( IDirect3DDevice9 *device, frame_context_t const &frame, transform_t const &world );
+  /* Chunks selected by the last update() occlude, a frame late when called before render() */
+  virtual void add_occluders( occlusion_culler_t &culler, transform_t const &world );
+
+  /* Static terrain is drawn on device with static lights baked into vertex colors */
+  void set_static( bool is_static ) { m_is_static = is_static; }
+
+  bool get_bounds( vec_t &center, float &radius ) const;
+
+  terrain_params_t const & params( void ) const { return m_params; }
+  /* Chunks selected by the last update() */
+  size_t visible_count( void ) const { return m_visible.size(); }
+  unsigned int visible_triangles( void ) const { return (unsigned int)m_visible.size() * m_chunk_triangles; }
+  /* Triangles of the whole terrain at the finest level */
+  double full_triangles( void ) const;
+private:
+  terrain_t( terrain_t const & );
+  terrain_t & operator=( terrain_t const & );
+
+  struct chunk_t
+  {
+    unsigned long long key;
+    unsigned int level, x, z;
+    vec_t box_min, box_max;     /* with skirts */
+    std::vector<base_geometry_t::vertex_t> vertices;
+    device_vertices_t device_vertices;
+    unsigned int last_frame;
+
+    /* Releases baked lighting of the chunk */
+    ~chunk_t();
+
+    size_t memory_size( void ) const
+    {
+      return vertices.size() * sizeof(base_geometry_t::vertex_t) + device_vertices.memory_size();
+    }
+  };
+
+  struct frustum_t
+  {
+    float planes[6][4];
+
+    bool is_visible( vec_t const &box_min, vec_t const &box_max ) const;
+  };
+
+  static unsigned long long chunk_key( unsigned int level, unsigned int x, unsigned int z );
+  /* Grid vertices and skirts of the chunk, thread safe */
+  chunk_t * build_chunk( unsigned long long key ) const;
+  void add_chunk( IDirect3DDevice9 *device, chunk_t *chunk );
+  void release_chunk( chunk_t *chunk );
+  chunk_t * find_chunk( unsigned long long key ) const;
+
+  void select( IDirect3DDevice9 *device, chunk_t *chunk, frustum_t const &frustum, vec_t const &eye );
+  void draw( recursive_data_t &rd );
+
+  /* Streaming thread side */
+  void stream_worker( void );
+  /* Take built chunks within uploads budget */
+  void receive_chunks( IDirect3DDevice9 *device );
+  /* Replace requests by missing chunks of the frame */
+  void request_chunks( void );
+  void evict( void );
+
+  terrain_params_t m_params;
+  unsigned int m_chunk_vertices;
+  unsigned int m_chunk_triangles;
+  IDirect3DIndexBuffer9 *m_index_buf;
+  /* Copy for software rasterizer */
+  std::vector<unsigned int> m_indices;
+  bool m_is_static;
+
+  std::map<unsigned long long, chunk_t *> m_chunks;
+  chunk_t *m_root;
+  unsigned int m_frame;
+  std::vector<chunk_t *> m_visible;
+  unsigned int m_culled_count;
+  std::vector<unsigned long long> m_wanted;   /* missing children of chunks to split */
+
+  std::thread m_stream_thread;
+  std::mutex m_stream_mutex;
+  std::condition_variable m_stream_cond;
+  std::vector<unsigned long long> m_requests; /* coarse levels first */
+  std::set<unsigned long long> m_streaming;   /* being built or built, not yet taken */
+  std::vector<chunk_t *> m_built;
+  bool m_is_stopping;
+};
+
+/* All terrains */
+struct terrain_stats_t
+{
+  unsigned int terrains_count;
+  unsigned int resident_count;
+  size_t memory;
+  unsigned int built_count;     /* chunks built since start */
+  double build_ms;              /* on their threads */
+  /* Current frame */
+  unsigned int visible_count;
+  unsigned int culled_count;    /* frustum culled quadtree nodes */
+  unsigned int requests_count;  /* chunks waiting for the streaming thread */
+  size_t drawn_triangles;
+  double full_triangles;        /* of drawn terrains at the finest level */
+};
+
+terrain_stats_t terrain_stats( void );
+/* Reset frame statistics */
+void terrain_begin_frame( void );
+
+/* Camera flight over a hilly terrain in headless mode, chunks are built synchronously */
+struct terrain_benchmark_t
+{
+  float size;
+  unsigned int levels;
+  unsigned int frames_count;
+  unsigned int built_count;
+  double build_ms;
+  double select_ms;             /* mean per frame, without builds */
+  double visible_chunks;        /* mean per frame */
+  double visible_triangles;
+  double full_triangles;
+};
+
+terrain_benchmark_t benchmark_terrain( float size, unsigned int levels, unsigned int frames_count );
+
+/* Rolling hills height function of the benchmarks, meters */
+float benchmark_hills_height( float x, float z );
+
+#endif /* __TERRAIN_INCLUDED__ */
@@ -6,9 +6,31 @@
 @author   Sergeev Artemiy
 */
 
-#include <D3DX9.h>
+#include <cstring>
+
+#include "d3d_api.h"
+#include "stopwatch.h"
+#include "texture_cache.h"
 #include "texture.h"
 
+texture_load_stats_t texture_t::s_load_stats = {0, 0, 0, 0, 0};
+std::mutex texture_t::s_load_stats_mutex;
+
+namespace
+{
+  /* D3DFMT_A8R8G8B8 stores pixels as BGRA, image_t RGBA8 as RGBA */
+  void copy_swap_red_blue( unsigned char *dst, unsigned char const *src, unsigned int width )
+  {
+    for (unsigned int x = 0; x < width; ++x, dst += 4, src += 4)
+    {
+      dst[0] = src[2];
+      dst[1] = src[1];
+      dst[2] = src[0];
+      dst[3] = src[3];
+    }
+  }
+}
+
 
 texture_t::texture_t() : m_texture(0)
 {
@@ -28,7 +50,17 @@ texture_t::~texture_t()
 
 bool texture_t::load( IDirect3DDevice9 * device, LPCWSTR file_name )
 {
-  return D3DXCreateTextureFromFile(device, file_name, &m_texture) == ERROR_SUCCESS;
+  if (load_cooked(device, file_name))
+    return true;
+
+  stopwatch_t timer;
+  if (D3DXCreateTextureFromFile(device, file_name, &m_texture) != ERROR_SUCCESS)
+    return false;
+
+  std::lock_guard<std::mutex> lock(s_load_stats_mutex);
+  s_load_stats.decoded_count++;
+  s_load_stats.decoded_ms += timer.elapsed_ms();
+  return true;
 }
 
 bool texture_t::load_mipmaped( IDirect3DDevice9 * device, std::vector<LPCWSTR> file_names )
@@ -38,9 +70,9 @@ bool texture_t::load_mipmaped( IDirect3DDevice9 * device, std::vector<LPCWSTR> f
   IDirect3DTexture9 *temp_tex;
 
   size_t mipmap_count = file_names.size();
-  if (D3DXCreateTexture(device, info.Width, info.Height, mipmap_count, 0, D3DFMT_R8G8B8, D3DPOOL_DEFAULT, &m_texture) != ERROR_SUCCESS)
+  if (D3DXCreateTexture(device, info.Width, info.Height, mipmap_count, 0, D3DFMT_DXT1, D3DPOOL_DEFAULT, &m_texture) != ERROR_SUCCESS)
     return false;
-  if (D3DXCreateTexture(device, info.Width, info.Height, mipmap_count, 0, D3DFMT_R8G8B8, D3DPOOL_SYSTEMMEM, &temp_tex) != ERROR_SUCCESS)
+  if (D3DXCreateTexture(device, info.Width, info.Height, mipmap_count, 0, D3DFMT_DXT1, D3DPOOL_SYSTEMMEM, &temp_tex) != ERROR_SUCCESS)
   {
     m_texture->Release();
     return false;
@@ -60,6 +92,142 @@ bool texture_t::load_mipmaped( IDirect3DDevice9 * device, std::vector<LPCWSTR> f
   return true;
 }
 
+bool texture_t::decode( IDirect3DDevice9 * device, LPCWSTR file_name, image_t &img )
+{
+  IDirect3DTexture9 *src_tex;
+
+  /* Decode base level only */
+  if (D3DXCreateTextureFromFileEx(device, file_name, D3DX_DEFAULT_NONPOW2, D3DX_DEFAULT_NONPOW2, 1, 0, D3DFMT_A8R8G8B8,
+                                  D3DPOOL_SYSTEMMEM, D3DX_FILTER_NONE, D3DX_DEFAULT, 0, NULL, NULL, &src_tex) != ERROR_SUCCESS)
+    return false;
+
+  D3DSURFACE_DESC desc;
+  D3DLOCKED_RECT locked;
+  src_tex->GetLevelDesc(0, &desc);
+  if (src_tex->LockRect(0, &locked, NULL, D3DLOCK_READONLY) != ERROR_SUCCESS)
+  {
+    src_tex->Release();
+    return false;
+  }
+  img = image_t(desc.Width, desc.Height, PIXEL_FORMAT_RGBA8);
+  for (unsigned int y = 0; y < img.height; ++y)
+    copy_swap_red_blue(img.row(y), (unsigned char *)locked.pBits + y * locked.Pitch, img.width);
+  src_tex->UnlockRect(0);
+  src_tex->Release();
+  return true;
+}
+
+bool texture_t::load_filtered( IDirect3DDevice9 * device, LPCWSTR file_name, mip_params_t const & params )
+{
+  image_t base;
+  if (!decode(device, file_name, base))
+    return false;
+  return create(device, base, params);
+}
+
+bool texture_t::create( IDirect3DDevice9 * device, image_t const & base, mip_params_t const & params )
+{
+  std::vector<image_t> chain;
+  unsigned int const levels = build_mip_chain(base, chain, params);
+  if (levels == 0)
+    return false;
+
+  IDirect3DTexture9 *texture;
+  if (device->CreateTexture(base.width, base.height, levels, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &texture, NULL) != ERROR_SUCCESS)
+    return false;
+
+  for (unsigned int i = 0; i < levels; ++i)
+  {
+    D3DLOCKED_RECT locked;
+    if (texture->LockRect(i, &locked, NULL, 0) != ERROR_SUCCESS)
+    {
+      texture->Release();
+      return false;
+    }
+    for (unsigned int y = 0; y < chain[i].height; ++y)
+      copy_swap_red_blue((unsigned char *)locked.pBits + y * locked.Pitch, chain[i].row(y), chain[i].width);
+    texture->UnlockRect(i);
+  }
+
+  if (m_texture)
+    m_texture->Release();
+  m_texture = texture;
+  return true;
+}
+
+bool texture_t::load_cooked( IDirect3DDevice9 * device, LPCWSTR file_name, mip_params_t const & params )
+{
+  stopwatch_t timer;
+  file_stamp_t stamp;
+  if (!get_file_stamp(file_name, stamp))
+    return false;
+
+  std::wstring const cache_name = cooked_texture_file_name(file_name);
+  cooked_texture_t cooked;
+  double decoding_ms = 0, cooking_ms = 0;
+  bool const is_cached = cooked.open(cache_name.c_str(), stamp);
+
+  if (!is_cached)
+  {
+    D3DXIMAGE_INFO info;
+    image_t base;
+    std::vector<image_t> chain;
+
+    /* Block compressed level 0 must consist of whole blocks: check the file header before decoding,
+     * so other sizes are decoded once by the caller's fallback */
+    if (D3DXGetImageInfoFromFile(file_name, &info) != ERROR_SUCCESS || info.Width % 4 != 0 || info.Height % 4 != 0 ||
+        !decode(device, file_name, base) || build_mip_chain(base, chain, params) == 0)
+      return false;
+    decoding_ms = timer.elapsed_ms();
+    stopwatch_t cooking_timer;
+
+    block_format_t const format = image_has_alpha(base) ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_BC1;
+    if (!write_cooked_texture(cache_name.c_str(), chain, format, stamp) || !cooked.open(cache_name.c_str(), stamp))
+      return false;
+    cooking_ms = cooking_timer.elapsed_ms();
+  }
+
+  stopwatch_t upload_timer;
+  IDirect3DTexture9 *texture;
+  D3DFORMAT const format = cooked.format() == BLOCK_FORMAT_BC3 ? D3DFMT_DXT5 : D3DFMT_DXT1;
+  if (device->CreateTexture(cooked.width(), cooked.height(), cooked.levels(), 0, format, D3DPOOL_MANAGED, &texture, NULL) != ERROR_SUCCESS)
+    return false;
+
+  for (unsigned int i = 0; i < cooked.levels(); ++i)
+  {
+    D3DLOCKED_RECT locked;
+    if (texture->LockRect(i, &locked, NULL, 0) != ERROR_SUCCESS)
+    {
+      texture->Release();
+      return false;
+    }
+    unsigned char const *src = cooked.level_data(i);
+    unsigned int const pitch = cooked.level_pitch(i);
+    for (unsigned int y = 0; y < cooked.level_rows(i); ++y, src += pitch)
+      memcpy((unsigned char *)locked.pBits + y * locked.Pitch, src, pitch);
+    texture->UnlockRect(i);
+  }
+
+  if (m_texture)
+    m_texture->Release();
+  m_texture = texture;
+
+  /* Cache miss is accounted as decoding plus upload, cooking is timed on its own */
+  std::lock_guard<std::mutex> lock(s_load_stats_mutex);
+  if (is_cached)
+  {
+    s_load_stats.cooked_count++;
+    s_load_stats.cooked_ms += timer.elapsed_ms();
+  }
+  else
+  {
+    s_load_stats.decoded_count++;
+    s_load_stats.decoded_ms += decoding_ms + upload_timer.elapsed_ms();
+    s_load_stats.cooking_ms += cooking_ms;
+  }
+  return true;
+}
+
 void texture_t::bind( IDirect3DDevice9 * device, DWORD unit )
 {
   device->SetTexture(unit, m_texture);
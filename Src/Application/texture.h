@@ -9,10 +9,22 @@
 #ifndef __TEXTURE_INCLUDED__
 #define __TEXTURE_INCLUDED__
 
-#include <D3D9.h>
-
+#include <mutex>
 #include <vector>
 
+#include "d3d_api.h"
+#include "mipmap.h"
+
+/* Textures loading statistics */
+struct texture_load_stats_t
+{
+  unsigned int cooked_count;    /* loaded from cooked cache */
+  unsigned int decoded_count;   /* decoded from source file */
+  double cooked_ms;
+  double decoded_ms;            /* decoding, mipmaps and upload, without cooking */
+  double cooking_ms;            /* spent on compressing and writing cache */
+};
+
 class texture_t
 {
 public:
@@ -23,14 +35,29 @@ public:
   bool is_loaded() { return m_texture != NULL; }
   bool load( IDirect3DDevice9 * device, LPCWSTR file_name );
   bool load_mipmaped( IDirect3DDevice9 * device, std::vector<LPCWSTR> file_names );
+  /* Load base level from file and build mipmap chain on CPU */
+  bool load_filtered( IDirect3DDevice9 * device, LPCWSTR file_name, mip_params_t const & params = mip_params_t() );
+  /* Build mipmap chain of RGBA8 image on CPU */
+  bool create( IDirect3DDevice9 * device, image_t const & base, mip_params_t const & params = mip_params_t() );
+  /* Load block compressed texture from cooked cache, cook it from source file on cache miss */
+  bool load_cooked( IDirect3DDevice9 * device, LPCWSTR file_name, mip_params_t const & params = mip_params_t() );
   void bind( IDirect3DDevice9 * device, DWORD unit );
 
   static void unbind( IDirect3DDevice9 *device, DWORD unit = 0 )
   {
     device->SetTexture(unit, NULL);
   }
+
+  /* Loading may run on several threads, statistics are returned by copy */
+  static texture_load_stats_t load_stats( void );
 private:
+  /* Decode base level of source file to RGBA8 image */
+  static bool decode( IDirect3DDevice9 * device, LPCWSTR file_name, image_t &img );
+
   IDirect3DTexture9 *m_texture;
+
+  static texture_load_stats_t s_load_stats;
+  static std::mutex s_load_stats_mutex;
 };
 
 class texture_binder_t
@@ -0,0 +1,156 @@
+/**
+@file     texture_cache.cpp
+@brief    Cooked (block compressed, mipmapped) textures cache implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cstring>
+
+#include "image_io.h"
+#include "stopwatch.h"
+#include "texture_cache.h"
+
+std::wstring cooked_texture_file_name( wchar_t const *source_file_name )
+{
+  return std::wstring(source_file_name) + L".cgltex";
+}
+
+bool write_cooked_texture( wchar_t const *file_name, std::vector<image_t> const &chain, block_format_t format,
+                           file_stamp_t const &source_stamp )
+{
+  if (chain.empty() || chain.size() > c_cooked_texture_max_levels)
+    return false;
+
+  cooked_texture_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "CGLT", 4);
+  header.version = c_cooked_texture_version;
+  header.format = format;
+  header.width = chain[0].width;
+  header.height = chain[0].height;
+  header.levels = (unsigned int)chain.size();
+  header.source_size = source_stamp.size;
+  header.source_time = source_stamp.write_time;
+
+  std::vector<unsigned char> level;
+  std::vector<unsigned char> data(sizeof(header));
+  for (size_t i = 0; i < chain.size(); ++i)
+  {
+    if (!compress_image(chain[i], format, level))
+      return false;
+    header.level_offset[i] = (unsigned int)data.size();
+    header.level_size[i] = (unsigned int)level.size();
+    data.insert(data.end(), level.begin(), level.end());
+  }
+  memcpy(&data[0], &header, sizeof(header));
+
+  return save_file(file_name, &data[0], data.size());
+}
+
+bool cooked_texture_t::open( wchar_t const *file_name, file_stamp_t const &source_stamp )
+{
+  m_header = NULL;
+  if (!m_file.open(file_name) || m_file.size() < sizeof(cooked_texture_header_t))
+    return false;
+
+  cooked_texture_header_t const *header = (cooked_texture_header_t const *)m_file.data();
+  if (memcmp(header->magic, "CGLT", 4) != 0 || header->version != c_cooked_texture_version ||
+      header->source_size != source_stamp.size || header->source_time != source_stamp.write_time ||
+      (header->format != BLOCK_FORMAT_BC1 && header->format != BLOCK_FORMAT_BC3) ||
+      header->levels == 0 || header->levels > c_cooked_texture_max_levels)
+  {
+    m_file.close();
+    return false;
+  }
+
+  unsigned int width = header->width, height = header->height;
+  for (unsigned int i = 0; i < header->levels; ++i)
+  {
+    if (header->level_size[i] != block_image_size((block_format_t)header->format, width, height) ||
+        (size_t)header->level_offset[i] + header->level_size[i] > m_file.size())
+    {
+      m_file.close();
+      return false;
+    }
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+
+  m_header = header;
+  return true;
+}
+
+unsigned int cooked_texture_t::level_pitch( unsigned int level ) const
+{
+  unsigned int const width = m_header->width >> level;
+  return ((width > 0 ? width : 1) + 3) / 4 * block_size(format());
+}
+
+unsigned int cooked_texture_t::level_rows( unsigned int level ) const
+{
+  unsigned int const height = m_header->height >> level;
+  return ((height > 0 ? height : 1) + 3) / 4;
+}
+
+texture_cache_benchmark_t benchmark_texture_cache( wchar_t const *source_file_name, unsigned int repeats )
+{
+  texture_cache_benchmark_t result;
+  file_stamp_t stamp;
+  std::wstring const cache_name = cooked_texture_file_name(source_file_name);
+
+  memset(&result, 0, sizeof(result));
+  if (repeats == 0 || !get_file_stamp(source_file_name, stamp))
+    return result;
+  result.source_size = (size_t)stamp.size;
+
+  image_t base;
+  std::vector<image_t> chain;
+
+  stopwatch_t timer;
+  for (unsigned int i = 0; i < repeats; ++i)
+    if (!load_image(source_file_name, base) || build_mip_chain(base, chain, mip_params_t()) == 0)
+      return result;
+  result.decoded_ms = timer.elapsed_ms() / repeats;
+  result.width = base.width;
+  result.height = base.height;
+  result.levels = (unsigned int)chain.size();
+
+  /* Same rule as texture_t::load_cooked() */
+  if (base.width % 4 != 0 || base.height % 4 != 0)
+    return result;
+  result.format = image_has_alpha(base) ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_BC1;
+  timer.restart();
+  if (!write_cooked_texture(cache_name.c_str(), chain, result.format, stamp))
+    return result;
+  result.cook_ms = timer.elapsed_ms();
+
+  file_stamp_t cooked_stamp;
+  if (get_file_stamp(cache_name.c_str(), cooked_stamp))
+    result.cooked_size = (size_t)cooked_stamp.size;
+
+  /* Buffer stands for locked texture levels being filled */
+  std::vector<unsigned char> levels(result.cooked_size);
+  timer.restart();
+  for (unsigned int i = 0; i < repeats; ++i)
+  {
+    cooked_texture_t cooked;
+    size_t offset = 0;
+
+    if (!cooked.open(cache_name.c_str(), stamp))
+      return result;
+    for (unsigned int level = 0; level < cooked.levels(); ++level)
+    {
+      size_t const size = (size_t)cooked.level_pitch(level) * cooked.level_rows(level);
+
+      if (offset + size > levels.size())
+        levels.resize(offset + size);
+      memcpy(&levels[offset], cooked.level_data(level), size);
+      offset += size;
+    }
+  }
+  result.cooked_ms = timer.elapsed_ms() / repeats;
+  result.is_loaded = true;
+  return result;
+}
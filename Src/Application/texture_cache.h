@@ -0,0 +1,91 @@
+/**
+@file     texture_cache.h
+@brief    Cooked (block compressed, mipmapped) textures cache definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __TEXTURE_CACHE_INCLUDED__
+#define __TEXTURE_CACHE_INCLUDED__
+
+#include <string>
+
+#include "files.h"
+#include "mipmap.h"
+#include "texture_compress.h"
+
+/* Cooked texture file format version, increase on any layout or encoder change */
+const unsigned int c_cooked_texture_version = 1;
+const unsigned int c_cooked_texture_max_levels = 16;
+
+/* Cooked texture file header. Level data follows the header. */
+struct cooked_texture_header_t
+{
+  char magic[4];                /* 'CGLT' */
+  unsigned int version;
+  unsigned int format;          /* block_format_t */
+  unsigned int width;
+  unsigned int height;
+  unsigned int levels;
+  unsigned long long source_size;
+  unsigned long long source_time;
+  unsigned int level_offset[c_cooked_texture_max_levels];
+  unsigned int level_size[c_cooked_texture_max_levels];
+};
+
+/* Cache file name for the source texture file */
+std::wstring cooked_texture_file_name( wchar_t const *source_file_name );
+
+/* Compress mipmap chain and write cooked texture file */
+bool write_cooked_texture( wchar_t const *file_name, std::vector<image_t> const &chain, block_format_t format,
+                           file_stamp_t const &source_stamp );
+
+/* Memory mapped cooked texture */
+class cooked_texture_t
+{
+public:
+  cooked_texture_t() : m_header(NULL) {}
+
+  /* Open and validate cache file against the source file stamp */
+  bool open( wchar_t const *file_name, file_stamp_t const &source_stamp );
+
+  block_format_t format( void ) const { return (block_format_t)m_header->format; }
+  unsigned int width( void ) const { return m_header->width; }
+  unsigned int height( void ) const { return m_header->height; }
+  unsigned int levels( void ) const { return m_header->levels; }
+
+  unsigned char const * level_data( unsigned int level ) const
+  {
+    return m_file.data() + m_header->level_offset[level];
+  }
+
+  /* Bytes in one row of 4x4 blocks */
+  unsigned int level_pitch( unsigned int level ) const;
+  /* Rows of 4x4 blocks */
+  unsigned int level_rows( unsigned int level ) const;
+private:
+  mapped_file_t m_file;
+  cooked_texture_header_t const *m_header;
+};
+
+/* Decoding against mapped cooked load of one PNG or PPM file, CPU side up to texture levels fill */
+struct texture_cache_benchmark_t
+{
+  bool is_loaded;
+  unsigned int width;
+  unsigned int height;
+  unsigned int levels;
+  block_format_t format;
+  size_t source_size;
+  size_t cooked_size;
+  double decoded_ms;            /* decode and build mipmap chain, mean of repeats */
+  double cook_ms;               /* compress and write cache file once */
+  double cooked_ms;             /* map, validate and copy levels, mean of repeats */
+
+  double speedup( void ) const { return cooked_ms > 0 ? decoded_ms / cooked_ms : 0; }
+};
+
+texture_cache_benchmark_t benchmark_texture_cache( wchar_t const *source_file_name, unsigned int repeats );
+
+#endif /* __TEXTURE_CACHE_INCLUDED__ */
@@ -0,0 +1,321 @@
+/**
+@file     texture_compress.cpp
+@brief    BC1/BC3 (DXT1/DXT5) block compression implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+
+#include "parallel.h"
+#include "texture_compress.h"
+
+namespace
+{
+  /* Block rows compressed by one task */
+  const size_t c_block_rows_per_task = 4;
+
+  /* Palette interpolation weights of the first endpoint for BC1 color codes 0..3 */
+  const float c_color_weights[4] = {1.f, 0.f, 2.f / 3, 1.f / 3};
+
+  /* 4x4 pixels of RGBA8 image */
+  struct pixel_block_t
+  {
+    unsigned char px[16][4];
+  };
+
+  /* Get block pixels, pixels outside the image repeat the edge ones */
+  void fetch_block( image_t const &img, unsigned int bx, unsigned int by, pixel_block_t &block )
+  {
+    for (unsigned int y = 0; y < 4; ++y)
+    {
+      unsigned int const sy = by * 4 + y < img.height ? by * 4 + y : img.height - 1;
+      unsigned char const *row = img.row(sy);
+
+      for (unsigned int x = 0; x < 4; ++x)
+      {
+        unsigned int const sx = bx * 4 + x < img.width ? bx * 4 + x : img.width - 1;
+        for (int c = 0; c < 4; ++c)
+          block.px[y * 4 + x][c] = row[sx * 4 + c];
+      }
+    }
+  }
+
+  unsigned short pack_565( float const rgb[3] )
+  {
+    int const r = (int)(rgb[0] < 0 ? 0 : rgb[0] > 255 ? 31 : rgb[0] * 31 / 255 + 0.5f);
+    int const g = (int)(rgb[1] < 0 ? 0 : rgb[1] > 255 ? 63 : rgb[1] * 63 / 255 + 0.5f);
+    int const b = (int)(rgb[2] < 0 ? 0 : rgb[2] > 255 ? 31 : rgb[2] * 31 / 255 + 0.5f);
+
+    return (unsigned short)((r << 11) | (g << 5) | b);
+  }
+
+  void unpack_565( unsigned short color, int rgb[3] )
+  {
+    int const r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+  }
+
+  /* Choose nearest palette entry for every pixel, returns total squared error */
+  int select_color_indices( pixel_block_t const &block, unsigned short c0, unsigned short c1, unsigned char indices[16] )
+  {
+    int palette[4][3];
+    int error = 0;
+
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+      int best = 0, best_error = 0x7FFFFFFF;
+
+      for (int p = 0; p < 4; ++p)
+      {
+        int const dr = block.px[i][0] - palette[p][0];
+        int const dg = block.px[i][1] - palette[p][1];
+        int const db = block.px[i][2] - palette[p][2];
+        int const e = dr * dr + dg * dg + db * db;
+
+        if (e < best_error)
+        {
+          best_error = e;
+          best = p;
+        }
+      }
+      indices[i] = (unsigned char)best;
+      error += best_error;
+    }
+    return error;
+  }
+
+  /* Least squares endpoints for the fixed indices. Returns false for degenerate system */
+  bool refine_endpoints( pixel_block_t const &block, unsigned char const indices[16], float e0[3], float e1[3] )
+  {
+    float aa = 0, ab = 0, bb = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+
+    for (int i = 0; i < 16; ++i)
+    {
+      float const a = c_color_weights[indices[i]], b = 1 - a;
+
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+      for (int c = 0; c < 3; ++c)
+      {
+        ax[c] += a * block.px[i][c];
+        bx[c] += b * block.px[i][c];
+      }
+    }
+
+    float const det = aa * bb - ab * ab;
+    if (fabs(det) < 1e-6f)
+      return false;
+    for (int c = 0; c < 3; ++c)
+    {
+      e0[c] = (bb * ax[c] - ab * bx[c]) / det;
+      e1[c] = (aa * bx[c] - ab * ax[c]) / det;
+    }
+    return true;
+  }
+
+  void write_color_block( unsigned short c0, unsigned short c1, unsigned char const indices[16], unsigned char *out )
+  {
+    unsigned int bits = 0;
+
+    /* Keep four colors mode: first endpoint must be greater */
+    if (c0 < c1)
+    {
+      static const unsigned char swapped[4] = {1, 0, 3, 2};
+      unsigned short const tmp = c0;
+
+      c0 = c1;
+      c1 = tmp;
+      for (int i = 0; i < 16; ++i)
+        bits |= swapped[indices[i]] << (2 * i);
+    }
+    else if (c0 != c1)
+      for (int i = 0; i < 16; ++i)
+        bits |= indices[i] << (2 * i);
+
+    out[0] = (unsigned char)c0;
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)c1;
+    out[3] = (unsigned char)(c1 >> 8);
+    out[4] = (unsigned char)bits;
+    out[5] = (unsigned char)(bits >> 8);
+    out[6] = (unsigned char)(bits >> 16);
+    out[7] = (unsigned char)(bits >> 24);
+  }
+
+  /* Principal axis range fit with one least squares refinement */
+  void compress_color_block( pixel_block_t const &block, unsigned char *out )
+  {
+    float mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+      for (int c = 0; c < 3; ++c)
+        mean[c] += block.px[i][c] / 16.f;
+
+    /* Covariance matrix: xx, xy, xz, yy, yz, zz */
+    float cov[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+      float const r = block.px[i][0] - mean[0], g = block.px[i][1] - mean[1], b = block.px[i][2] - mean[2];
+
+      cov[0] += r * r;
+      cov[1] += r * g;
+      cov[2] += r * b;
+      cov[3] += g * g;
+      cov[4] += g * b;
+      cov[5] += b * b;
+    }
+
+    /* Power iteration for the principal axis */
+    float axis[3] = {cov[0], cov[3], cov[5]};
+    for (int iteration = 0; iteration < 4; ++iteration)
+    {
+      float const x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+      float const y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+      float const z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+      float const length = sqrt(x * x + y * y + z * z);
+
+      if (length < 1e-6f)
+        break;
+      axis[0] = x / length;
+      axis[1] = y / length;
+      axis[2] = z / length;
+    }
+
+    float min_t = 0, max_t = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+      float const t = (block.px[i][0] - mean[0]) * axis[0] + (block.px[i][1] - mean[1]) * axis[1] +
+                      (block.px[i][2] - mean[2]) * axis[2];
+
+      min_t = t < min_t ? t : min_t;
+      max_t = t > max_t ? t : max_t;
+    }
+
+    /* Inset bounding range to reduce quantization error at the ends */
+    float const inset = (max_t - min_t) / 16;
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; ++c)
+    {
+      e0[c] = mean[c] + axis[c] * (max_t - inset);
+      e1[c] = mean[c] + axis[c] * (min_t + inset);
+    }
+
+    unsigned short c0 = pack_565(e0), c1 = pack_565(e1);
+    unsigned char indices[16];
+    int error = select_color_indices(block, c0, c1, indices);
+
+    if (c0 != c1 && refine_endpoints(block, indices, e0, e1))
+    {
+      unsigned short const r0 = pack_565(e0), r1 = pack_565(e1);
+      unsigned char refined[16];
+      int const refined_error = select_color_indices(block, r0, r1, refined);
+
+      if (refined_error < error)
+      {
+        c0 = r0;
+        c1 = r1;
+        error = refined_error;
+        for (int i = 0; i < 16; ++i)
+          indices[i] = refined[i];
+      }
+    }
+    write_color_block(c0, c1, indices, out);
+  }
+
+  /* Eight values interpolated alpha block */
+  void compress_alpha_block( pixel_block_t const &block, unsigned char *out )
+  {
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i)
+    {
+      a0 = block.px[i][3] > a0 ? block.px[i][3] : a0;
+      a1 = block.px[i][3] < a1 ? block.px[i][3] : a1;
+    }
+
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 2; i < 8; ++i)
+      out[i] = 0;
+    if (a0 == a1)
+      return;
+
+    int palette[8] = {a0, a1};
+    for (int i = 1; i < 7; ++i)
+      palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+
+    unsigned long long bits = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+      int best = 0, best_error = 256;
+
+      for (int p = 0; p < 8; ++p)
+      {
+        int const e = block.px[i][3] > palette[p] ? block.px[i][3] - palette[p] : palette[p] - block.px[i][3];
+        if (e < best_error)
+        {
+          best_error = e;
+          best = p;
+        }
+      }
+      bits |= (unsigned long long)best << (3 * i);
+    }
+    for (int i = 0; i < 6; ++i)
+      out[2 + i] = (unsigned char)(bits >> (8 * i));
+  }
+}
+
+bool image_has_alpha( image_t const &img )
+{
+  if (img.format != PIXEL_FORMAT_RGBA8)
+    return false;
+  for (size_t i = 3; i < img.data.size(); i += 4)
+    if (img.data[i] != 255)
+      return true;
+  return false;
+}
+
+bool compress_image( image_t const &img, block_format_t format, std::vector<unsigned char> &blocks, unsigned int threads )
+{
+  if (img.format != PIXEL_FORMAT_RGBA8 || img.width == 0 || img.height == 0)
+    return false;
+
+  unsigned int const blocks_x = (img.width + 3) / 4, blocks_y = (img.height + 3) / 4;
+  unsigned int const size = block_size(format);
+
+  blocks.resize(block_image_size(format, img.width, img.height));
+  parallel_for(0, blocks_y, c_block_rows_per_task, [&]( size_t first, size_t last )
+  {
+    pixel_block_t block;
+
+    for (size_t by = first; by < last; ++by)
+    {
+      unsigned char *out = &blocks[by * blocks_x * size];
+
+      for (unsigned int bx = 0; bx < blocks_x; ++bx, out += size)
+      {
+        fetch_block(img, bx, (unsigned int)by, block);
+        if (format == BLOCK_FORMAT_BC3)
+        {
+          compress_alpha_block(block, out);
+          compress_color_block(block, out + 8);
+        }
+        else
+          compress_color_block(block, out);
+      }
+    }
+  }, threads);
+  return true;
+}
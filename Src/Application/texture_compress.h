@@ -0,0 +1,44 @@
+/**
+@file     texture_compress.h
+@brief    BC1/BC3 (DXT1/DXT5) block compression definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __TEXTURE_COMPRESS_INCLUDED__
+#define __TEXTURE_COMPRESS_INCLUDED__
+
+#include <vector>
+
+#include "mipmap.h"
+
+/* Block compressed formats */
+enum block_format_t
+{
+  BLOCK_FORMAT_BC1 = 1, /* DXT1: 8 bytes per 4x4 block, opaque */
+  BLOCK_FORMAT_BC3 = 3  /* DXT5: 16 bytes per 4x4 block, interpolated alpha */
+};
+
+/* Bytes per 4x4 block */
+inline unsigned int block_size( block_format_t format )
+{
+  return format == BLOCK_FORMAT_BC1 ? 8 : 16;
+}
+
+/* Compressed image size for the dimensions */
+inline size_t block_image_size( block_format_t format, unsigned int width, unsigned int height )
+{
+  return (size_t)((width + 3) / 4) * ((height + 3) / 4) * block_size(format);
+}
+
+/* Check if RGBA8 image has any non opaque pixel */
+bool image_has_alpha( image_t const &img );
+
+/* Compress RGBA8 image (R, G, B, A bytes order) to blocks in rows order.
+ * threads == 0 means "use all hardware threads".
+ */
+bool compress_image( image_t const &img, block_format_t format, std::vector<unsigned char> &blocks,
+                     unsigned int threads = 0 );
+
+#endif /* __TEXTURE_COMPRESS_INCLUDED__ */
@@ -0,0 +1,87 @@
+/**
+@file     unit.cpp
+@brief    Animation units traversal implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <atomic>
+#include <cstdio>
+
+#include "d3d_api.h"
+#include "light_clusters.h"
+#include "unit.h"
+
+namespace
+{
+  /* Reported once, the scene depth does not change between frames */
+  std::atomic<bool> s_is_depth_overflow_reported(false);
+
+  void report_depth_overflow( void )
+  {
+    if (!s_is_depth_overflow_reported.exchange(true))
+      fprintf(stderr, "Units deeper than %u levels are skipped\n", (unsigned int)world_stack_t::c_max_depth);
+  }
+
+  void apply_lights( recursive_data_t &rd, vec_t const &center, float radius )
+  {
+    transform_t const &world = rd.world();
+    float scale = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      /* Largest axis scale keeps the sphere conservative */
+      float const length = vec_t(world.matrix.M[axis][0], world.matrix.M[axis][1], world.matrix.M[axis][2]).length();
+      scale = length > scale ? length : scale;
+    }
+    rd.lights->apply(rd.device, world.transform_point(center), radius * scale);
+  }
+}
+
+void IAnimationUnit::treat_as_unit( recursive_data_t &rd )
+{
+  if (!rd.world_stack.push(m_transform, m_position))
+  {
+    report_depth_overflow();
+    return;
+  }
+
+  vec_t box_min, box_max;
+  if (rd.occlusion != NULL && get_subtree_bounds(box_min, box_max) && !rd.occlusion->is_visible(rd.world().matrix, box_min, box_max))
+  {
+    respond_subtree( rd );
+    rd.world_stack.pop();
+    return;
+  }
+  if (rd.device != NULL)
+  {
+    rd.device->SetTransform( D3DTS_WORLD, (D3DMATRIX *)rd.world().matrix.M );
+    vec_t center;
+    float radius;
+    if (rd.lights != NULL && get_bounds(center, radius))
+      apply_lights(rd, center, radius);
+  }
+  render( rd );
+  response( rd );
+  if (is_expanded( rd ))
+    for (IAnimationUnit *child = m_first_child; child != NULL; child = child->m_next_sibling)
+      child->treat_as_unit( rd );
+  rd.world_stack.pop();
+}
+
+void IAnimationUnit::respond_subtree( recursive_data_t &rd )
+{
+  response( rd );
+  if (is_expanded( rd ))
+    for (IAnimationUnit *child = m_first_child; child != NULL; child = child->m_next_sibling)
+    {
+      if (rd.world_stack.push(child->m_transform, child->m_position))
+      {
+        child->respond_subtree( rd );
+        rd.world_stack.pop();
+      }
+      else
+        report_depth_overflow();
+    }
+}
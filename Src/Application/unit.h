@@ -9,45 +9,87 @@
 #ifndef __UNIT_INCLUDED__
 #define __UNIT_INCLUDED__
 
-#include <d3d9.h>
-#include <list>
 #include <memory>
 
 #include "Math/cglMath.h"
-#include "../Library/cglTimer.h"
-#include "Math/cglMath.h"
+#include "allocators.h"
+#include "frame_context.h"
+#include "occlusion.h"
+
+/* Scene graph is device independent, device calls of the traversal are in unit.cpp */
+struct IDirect3DDevice9;
 
-class myApp;
+class scene_t;
+class impostor_atlas_t;
+class light_manager_t;
+class soft_rasterizer_t;
+struct static_lighting_t;
 
+/* Traversal state of one frame: shared frame context and the world transforms of the units
+ * being visited, units are rendered in rd.world() */
 struct recursive_data_t
 {
-  transform_t world_transform;
-  camera_t    camera;
-  cglTimer    timer;
+  frame_context_t const &frame;
+  world_stack_t world_stack;
 
+  /* NULL in headless mode, rasterizer is set then */
   IDirect3DDevice9 *device;
-
-  recursive_data_t() {};
-  recursive_data_t( IDirect3DDevice9 *_device, camera_t &_camera, cglTimer &_timer, transform_t &_world_transform )
-     : device(_device)
-     , camera(_camera)
-     , timer(_timer)
-     , world_transform(_world_transform)
+  /* Geometry is drawn by software rasterizer instead of device when set */
+  soft_rasterizer_t *rasterizer;
+  /* Frame lights, device lights are selected by it for every unit with bounds */
+  light_manager_t *lights;
+  /* Static lights baked into static geometry colors on device, NULL to light it as usual */
+  static_lighting_t const *static_lighting;
+  /* Built occluders of the frame, subtrees with bounds hidden behind them are skipped */
+  occlusion_culler_t *occlusion;
+
+  recursive_data_t( IDirect3DDevice9 *_device, frame_context_t const &_frame, transform_t const &root = transform_t() )
+     : frame(_frame)
+     , world_stack(root, _frame.origin)
+     , device(_device)
+     , rasterizer(0)
+     , lights(0)
+     , static_lighting(0)
+     , occlusion(0)
   {
+  }
 
+  transform_t const & world( void ) const
+  {
+    return world_stack.top();
   }
+private:
+  recursive_data_t & operator=( recursive_data_t const & );
 };
 
+/* Units are allocated from size class pools, children are linked into a list through the units */
 class IAnimationUnit
 {
 public:
-  virtual ~IAnimationUnit() = 0 {}
-  virtual void render( recursive_data_t & rd ) {};
-  virtual void response( recursive_data_t & rd ) {};
+  IAnimationUnit() : m_position(0, 0, 0), m_first_child(NULL), m_last_child(NULL), m_next_sibling(NULL) {}
+  virtual ~IAnimationUnit() = 0;
+
+  static void * operator new( size_t size ) { return unit_allocate(size); }
+  static void operator delete( void *unit, size_t size ) { unit_free(unit, size); }
+
+  virtual void render( recursive_data_t & ) {};
+  virtual void response( recursive_data_t & ) {};
+  /* Add unit light sources of the frame, they are in world space */
+  virtual void add_lights( light_manager_t & ) {};
+  /* Local space bounding sphere, units without bounds are lit by lights selected for their parent */
+  virtual bool get_bounds( vec_t &, float & ) const { return false; }
+  /* Children are neither rendered nor animated this frame when false, called after render() */
+  virtual bool is_expanded( recursive_data_t & ) { return true; }
+  /* Add occluder meshes of the frame in 'world' space, called before rendering */
+  virtual void add_occluders( occlusion_culler_t &, transform_t const & ) {};
+  /* Local space box of the unit and its children, subtrees without it are never occluded */
+  virtual bool get_subtree_bounds( vec_t &, vec_t & ) const { return false; }
 
   IAnimationUnit & operator << ( std::unique_ptr<IAnimationUnit> unit )
   {
-    m_units.push_back(std::move(unit));
+    IAnimationUnit *child = unit.release();
+    (m_last_child != NULL ? m_last_child->m_next_sibling : m_first_child) = child;
+    m_last_child = child;
     return *this;
   }
 
@@ -65,27 +107,70 @@ public:
   {
      m_transform = transform;
   }
+
+  /* Placement in parent space applied after the transform, double precision keeps units of
+   * large worlds steady: root units are rendered relative to the frame origin */
+  dvec_t const & get_position() const
+  {
+    return m_position;
+  }
+
+  void set_position( dvec_t const & position )
+  {
+    m_position = position;
+  }
 protected:
   transform_t m_transform;
+  dvec_t m_position;
 private:
-  void treat_as_unit( recursive_data_t &rd )
+  /* Units deeper than world_stack_t::c_max_depth are skipped and reported once */
+  void treat_as_unit( recursive_data_t &rd );
+  /* Occluded subtree of the unit pushed on the world stack: nothing is drawn, animation still
+   * advances by response() */
+  void respond_subtree( recursive_data_t &rd );
+
+  void collect_lights( light_manager_t &lights )
+  {
+    add_lights( lights );
+    for (IAnimationUnit *child = m_first_child; child != NULL; child = child->m_next_sibling)
+      child->collect_lights( lights );
+  }
+
+  /* Units deeper than world_stack_t::c_max_depth are skipped as by treat_as_unit() */
+  void collect_occluders( occlusion_culler_t &culler, world_stack_t &world_stack )
   {
-    transform_t const saved_transform = rd.world_transform;
-
-    rd.world_transform = m_transform * rd.world_transform;
-    rd.device->SetTransform( D3DTS_WORLD, (D3DMATRIX *)rd.world_transform.matrix.M );
-    render( rd );
-    response( rd );
-    for (auto it = m_units.begin(); it != m_units.end(); ++it)
-      (*it)->treat_as_unit( rd );
-    rd.world_transform = saved_transform;
+    if (!world_stack.push(m_transform, m_position))
+      return;
+
+    add_occluders( culler, world_stack.top() );
+    for (IAnimationUnit *child = m_first_child; child != NULL; child = child->m_next_sibling)
+      child->collect_occluders( culler, world_stack );
+    world_stack.pop();
   }
 private:
-  std::list<std::unique_ptr<IAnimationUnit>> m_units;
+  IAnimationUnit( IAnimationUnit const & );
+  IAnimationUnit & operator=( IAnimationUnit const & );
 
-  friend myApp;
+  /* Owned children */
+  IAnimationUnit *m_first_child;
+  IAnimationUnit *m_last_child;
+  IAnimationUnit *m_next_sibling;
+
+  friend scene_t;
+  friend impostor_atlas_t;
+  friend traversal_benchmark_t benchmark_traversal( unsigned int nodes_count, unsigned int fanout, unsigned int frames_count );
 };
 
+inline IAnimationUnit::~IAnimationUnit()
+{
+  while (m_first_child != NULL)
+  {
+    IAnimationUnit *child = m_first_child;
+    m_first_child = child->m_next_sibling;
+    delete child;
+  }
+}
+
 typedef std::unique_ptr<IAnimationUnit> IAnimationUnitPtr;
 
 #endif /* __UNIT_INCLUDED__ */ 
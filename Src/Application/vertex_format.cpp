@@ -0,0 +1,621 @@
+/**
+@file     vertex_format.cpp
+@brief    Compressed vertex formats implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <emmintrin.h>
+
+#include "parallel.h"
+#include "stopwatch.h"
+#include "vertex_format.h"
+
+namespace
+{
+  /* Vertices packed by one task */
+  const unsigned int c_vertices_per_task = 4096;
+
+  /* base_geometry_t::vertex_t layout */
+  const unsigned int c_normal_offset = 12;
+  const unsigned int c_color_offset = 24;
+  const unsigned int c_uv_offset = 28;
+
+  const float c_short_max = 32767.f;
+  const float c_dec3_max = 511.f;
+
+  vertex_format_t s_device_format = vertex_format_t::device_compact();
+
+  std::mutex s_stats_mutex;
+  vertex_compression_stats_t s_stats;
+
+  __m128 abs_mask( void )
+  {
+    return _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  }
+
+  __m128 sign_mask( void )
+  {
+    return _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+  }
+
+  /* x, y, z lanes of 3 floats followed by any 4 bytes, w = 0 */
+  __m128 load_vec3( unsigned char const *src )
+  {
+    return _mm_and_ps(_mm_loadu_ps((float const *)src), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+  }
+
+  void store_vec3( unsigned char *dst, __m128 v )
+  {
+    float lanes[4];
+    _mm_storeu_ps(lanes, v);
+    memcpy(dst, lanes, 3 * sizeof(float));
+  }
+
+  /* Dot product of x, y, z lanes in all lanes */
+  __m128 dot3( __m128 a, __m128 b )
+  {
+    __m128 const m = _mm_mul_ps(a, b);
+    return _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1))),
+                      _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+  }
+
+  /* Zero length vectors stay zero */
+  __m128 normalize3( __m128 v )
+  {
+    __m128 const length2 = dot3(v, v);
+    if (_mm_cvtss_f32(length2) <= 0)
+      return v;
+    return _mm_div_ps(v, _mm_sqrt_ps(length2));
+  }
+
+  /* Half floats in low 16 bits of lanes, round to nearest even.
+   * Values out of half range are clamped, ones below normal range become zero, NaN is not kept */
+  __m128i float_to_half( __m128 v )
+  {
+    __m128i const sign = _mm_srli_epi32(_mm_castps_si128(_mm_and_ps(v, sign_mask())), 16);
+    __m128 const abs = _mm_min_ps(_mm_and_ps(v, abs_mask()), _mm_set1_ps(65504.f));
+    __m128i bits = _mm_castps_si128(abs);
+    __m128i const odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+
+    bits = _mm_add_epi32(bits, _mm_add_epi32(_mm_set1_epi32(0x0FFF), odd));
+    /* Exponent bias 127 -> 15 */
+    __m128i const half = _mm_srli_epi32(_mm_sub_epi32(bits, _mm_set1_epi32(0x38000000)), 13);
+    __m128i const is_normal = _mm_castps_si128(_mm_cmpge_ps(abs, _mm_set1_ps(6.103515625e-05f)));
+    return _mm_or_si128(_mm_and_si128(half, is_normal), sign);
+  }
+
+  /* Inverse of float_to_half(), denormals become zero */
+  __m128 half_to_float( __m128i h )
+  {
+    __m128i const sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    __m128i const magnitude = _mm_and_si128(h, _mm_set1_epi32(0x7FFF));
+    __m128i bits = _mm_add_epi32(_mm_slli_epi32(magnitude, 13), _mm_set1_epi32(0x38000000));
+    __m128i const is_zero = _mm_cmplt_epi32(magnitude, _mm_set1_epi32(0x0400));
+    __m128i const is_special = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7BFF));
+
+    /* Infinity and NaN keep maximum exponent */
+    bits = _mm_add_epi32(bits, _mm_and_si128(is_special, _mm_set1_epi32(0x38000000)));
+    bits = _mm_andnot_si128(is_zero, bits);
+    return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+  }
+
+  /* Lanes rounded and saturated to 16 bit signed integers in low 64 bits */
+  __m128i to_shorts( __m128 v )
+  {
+    v = _mm_max_ps(_mm_min_ps(v, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+    __m128i const q = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(c_short_max)));
+    return _mm_packs_epi32(q, q);
+  }
+
+  /* 4 signed 16 bit integers from low 64 bits to [-1, 1] */
+  __m128 from_shorts( __m128i q )
+  {
+    __m128i const wide = _mm_srai_epi32(_mm_unpacklo_epi16(q, q), 16);
+    return _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(1 / c_short_max));
+  }
+
+  /* Octahedral map of unit vector in x, y lanes */
+  __m128 octahedral_encode( __m128 n )
+  {
+    __m128 const abs = _mm_and_ps(n, abs_mask());
+    __m128 const sum = dot3(abs, _mm_set1_ps(1.f));
+    if (_mm_cvtss_f32(sum) <= 0)
+      return n;
+
+    __m128 o = _mm_div_ps(n, sum);
+
+    if (_mm_cvtss_f32(_mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 2, 2, 2))) < 0)
+    {
+      /* Fold lower hemisphere over the diagonals */
+      __m128 const swapped = _mm_shuffle_ps(o, o, _MM_SHUFFLE(3, 2, 0, 1));
+      __m128 const folded = _mm_sub_ps(_mm_set1_ps(1.f), _mm_and_ps(swapped, abs_mask()));
+      o = _mm_or_ps(folded, _mm_and_ps(o, sign_mask()));
+    }
+    return o;
+  }
+
+  __m128 octahedral_decode( __m128 o )
+  {
+    __m128 const abs = _mm_and_ps(o, abs_mask());
+    float const z = 1 - _mm_cvtss_f32(abs) - _mm_cvtss_f32(_mm_shuffle_ps(abs, abs, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128 const fold = _mm_set1_ps(z < 0 ? -z : 0);
+    __m128 const xy = _mm_sub_ps(o, _mm_or_ps(fold, _mm_and_ps(o, sign_mask())));
+    __m128 const n = _mm_setr_ps(_mm_cvtss_f32(xy), _mm_cvtss_f32(_mm_shuffle_ps(xy, xy, _MM_SHUFFLE(1, 1, 1, 1))), z, 0);
+    return normalize3(n);
+  }
+
+  unsigned int pack_dec3n( __m128 n )
+  {
+    n = _mm_max_ps(_mm_min_ps(n, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+    int q[4];
+    _mm_storeu_si128((__m128i *)q, _mm_cvtps_epi32(_mm_mul_ps(n, _mm_set1_ps(c_dec3_max))));
+    return (q[0] & 0x3FF) | ((q[1] & 0x3FF) << 10) | ((q[2] & 0x3FF) << 20);
+  }
+
+  __m128 unpack_dec3n( unsigned int packed )
+  {
+    /* Sign extension of 10 bit fields */
+    __m128i const q = _mm_setr_epi32((int)(packed << 22) >> 22, (int)(packed << 12) >> 22, (int)(packed << 2) >> 22, 0);
+    return _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(1 / c_dec3_max));
+  }
+
+  void pack_range( vertex_format_t const &format, vertex_quantization_t const &quantization, unsigned char const *src,
+                   unsigned int vertex_size, size_t begin, size_t end, unsigned char *dst )
+  {
+    unsigned int const stride = format.stride();
+    unsigned int const normal_offset = format.normal_offset();
+    unsigned int const color_offset = format.color_offset();
+    unsigned int const uv_offset = format.uv_offset();
+    bool const is_quantized = format.is_quantized();
+    __m128 const center = _mm_setr_ps(quantization.center.x, quantization.center.y, quantization.center.z, 0);
+    __m128 const scale = _mm_setr_ps(quantization.scale.x, quantization.scale.y, quantization.scale.z, 0);
+    __m128 const inv_scale = _mm_setr_ps(1 / quantization.scale.x, 1 / quantization.scale.y, 1 / quantization.scale.z, 0);
+    __m128 const w_one = _mm_setr_ps(0, 0, 0, 1);
+
+    src += begin * vertex_size;
+    dst += begin * stride;
+    for (size_t i = begin; i < end; ++i, src += vertex_size, dst += stride)
+    {
+      __m128 const position = load_vec3(src);
+      if (!is_quantized)
+        store_vec3(dst, position);
+      else
+      {
+        __m128i const q = to_shorts(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(position, center), inv_scale), w_one));
+        if (format.position == vertex_format_t::POSITION_SHORT4N)
+          _mm_storel_epi64((__m128i *)dst, q);
+        else
+        {
+          short lanes[8];
+          _mm_storeu_si128((__m128i *)lanes, q);
+          memcpy(dst, lanes, 3 * sizeof(short));
+        }
+      }
+
+      __m128 normal = load_vec3(src + c_normal_offset);
+      if (is_quantized)
+        normal = _mm_mul_ps(normal, scale);
+      normal = normalize3(normal);
+      switch (format.normal)
+      {
+      case vertex_format_t::NORMAL_FLOAT3:
+        store_vec3(dst + normal_offset, normal);
+        break;
+      case vertex_format_t::NORMAL_DEC3N:
+      {
+        unsigned int const packed = pack_dec3n(normal);
+        memcpy(dst + normal_offset, &packed, sizeof(packed));
+        break;
+      }
+      case vertex_format_t::NORMAL_OCTAHEDRAL:
+      {
+        int const packed = _mm_cvtsi128_si32(to_shorts(octahedral_encode(normal)));
+        memcpy(dst + normal_offset, &packed, sizeof(packed));
+        break;
+      }
+      }
+
+      memcpy(dst + color_offset, src + c_color_offset, sizeof(DWORD));
+
+      if (format.uv == vertex_format_t::UV_FLOAT2)
+        memcpy(dst + uv_offset, src + c_uv_offset, 2 * sizeof(float));
+      else
+      {
+        __m128i const h = float_to_half(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const *)(src + c_uv_offset))));
+        int const packed = _mm_cvtsi128_si32(_mm_packs_epi32(_mm_sub_epi32(h, _mm_set1_epi32(0x8000)), _mm_setzero_si128())) ^ 0x80008000;
+        memcpy(dst + uv_offset, &packed, sizeof(packed));
+      }
+    }
+  }
+
+  void unpack_range( vertex_format_t const &format, vertex_quantization_t const &quantization, unsigned char const *src,
+                     size_t begin, size_t end, unsigned char *dst, unsigned int vertex_size )
+  {
+    unsigned int const stride = format.stride();
+    unsigned int const normal_offset = format.normal_offset();
+    unsigned int const color_offset = format.color_offset();
+    unsigned int const uv_offset = format.uv_offset();
+    bool const is_quantized = format.is_quantized();
+    __m128 const center = _mm_setr_ps(quantization.center.x, quantization.center.y, quantization.center.z, 0);
+    __m128 const scale = _mm_setr_ps(quantization.scale.x, quantization.scale.y, quantization.scale.z, 0);
+    __m128 const inv_scale = _mm_setr_ps(1 / quantization.scale.x, 1 / quantization.scale.y, 1 / quantization.scale.z, 0);
+
+    src += begin * stride;
+    dst += begin * vertex_size;
+    for (size_t i = begin; i < end; ++i, src += stride, dst += vertex_size)
+    {
+      if (!is_quantized)
+        memcpy(dst, src, 3 * sizeof(float));
+      else
+      {
+        short lanes[4] = {0, 0, 0, 0};
+        memcpy(lanes, src, 3 * sizeof(short));
+        __m128 const q = from_shorts(_mm_loadl_epi64((__m128i const *)lanes));
+        store_vec3(dst, _mm_add_ps(_mm_mul_ps(q, scale), center));
+      }
+
+      __m128 normal;
+      switch (format.normal)
+      {
+      case vertex_format_t::NORMAL_FLOAT3:
+        normal = load_vec3(src + normal_offset);
+        break;
+      case vertex_format_t::NORMAL_DEC3N:
+      {
+        unsigned int packed;
+        memcpy(&packed, src + normal_offset, sizeof(packed));
+        normal = unpack_dec3n(packed);
+        break;
+      }
+      default:
+      {
+        int packed;
+        memcpy(&packed, src + normal_offset, sizeof(packed));
+        normal = octahedral_decode(from_shorts(_mm_cvtsi32_si128(packed)));
+        break;
+      }
+      }
+      if (is_quantized)
+        normal = _mm_mul_ps(normal, inv_scale);
+      store_vec3(dst + c_normal_offset, normalize3(normal));
+
+      memcpy(dst + c_color_offset, src + color_offset, sizeof(DWORD));
+
+      if (format.uv == vertex_format_t::UV_FLOAT2)
+        memcpy(dst + c_uv_offset, src + uv_offset, 2 * sizeof(float));
+      else
+      {
+        int packed;
+        memcpy(&packed, src + uv_offset, sizeof(packed));
+        __m128 const uv = half_to_float(_mm_unpacklo_epi16(_mm_cvtsi32_si128(packed), _mm_setzero_si128()));
+        _mm_storel_epi64((__m128i *)(dst + c_uv_offset), _mm_castps_si128(uv));
+      }
+    }
+  }
+
+  /* Tessellated unit sphere in base_geometry_t::vertex_t layout */
+  void sphere_vertices( unsigned int count, std::vector<unsigned char> &vertices )
+  {
+    unsigned int const columns = (unsigned int)sqrt((double)count) + 1;
+    unsigned int const rows = (count + columns - 1) / columns;
+
+    vertices.resize((size_t)count * 36);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      float const u = (float)(i % columns) / columns, v = (float)(i / columns) / (rows > 1 ? rows - 1 : 1);
+      float const phi = (u * 2 - 1) * cglmath::c_pif, theta = (v - 0.5f) * cglmath::c_pif;
+      float const vertex[8] = {cos(theta) * cos(phi) * 3, sin(theta) * 3, cos(theta) * sin(phi) * 3,
+                               cos(theta) * cos(phi), sin(theta), cos(theta) * sin(phi), 0, 0};
+      float const uv[2] = {u, 1 - v};
+      DWORD const color = 0xFF808080;
+
+      memcpy(&vertices[(size_t)i * 36], vertex, 6 * sizeof(float));
+      memcpy(&vertices[(size_t)i * 36 + c_color_offset], &color, sizeof(color));
+      memcpy(&vertices[(size_t)i * 36 + c_uv_offset], uv, sizeof(uv));
+    }
+  }
+}
+
+vertex_format_t vertex_format_t::supported( D3DCAPS9 const &caps ) const
+{
+  vertex_format_t result = *this;
+
+  if (result.position == POSITION_SHORT3)
+    result.position = POSITION_SHORT4N;
+  if (result.normal == NORMAL_OCTAHEDRAL)
+    result.normal = NORMAL_DEC3N;
+
+  if (result.position == POSITION_SHORT4N && !(caps.DeclTypes & D3DDTCAPS_SHORT4N))
+    result.position = POSITION_FLOAT3;
+  if (result.normal == NORMAL_DEC3N && !(caps.DeclTypes & D3DDTCAPS_DEC3N))
+    result.normal = NORMAL_FLOAT3;
+  if (result.uv == UV_HALF2 && !(caps.DeclTypes & D3DDTCAPS_FLOAT16_2))
+    result.uv = UV_FLOAT2;
+  return result;
+}
+
+void vertex_format_t::declaration( D3DVERTEXELEMENT9 *elements ) const
+{
+  D3DVERTEXELEMENT9 const layout[5] =
+  {
+    {0, 0, (BYTE)(position == POSITION_FLOAT3 ? D3DDECLTYPE_FLOAT3 : D3DDECLTYPE_SHORT4N), D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0},
+    {0, (WORD)normal_offset(), (BYTE)(normal == NORMAL_FLOAT3 ? D3DDECLTYPE_FLOAT3 : D3DDECLTYPE_DEC3N), D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL, 0},
+    {0, (WORD)color_offset(), D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 0},
+    {0, (WORD)uv_offset(), (BYTE)(uv == UV_FLOAT2 ? D3DDECLTYPE_FLOAT2 : D3DDECLTYPE_FLOAT16_2), D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 0},
+    D3DDECL_END()
+  };
+  memcpy(elements, layout, sizeof(layout));
+}
+
+std::string vertex_format_t::name( void ) const
+{
+  static char const * const positions[] = {"float3", "short3", "short4n"};
+  static char const * const normals[] = {"float3", "dec3n", "oct16"};
+  static char const * const uvs[] = {"float2", "half2"};
+
+  return std::string(positions[position]) + "/" + normals[normal] + "/" + uvs[uv];
+}
+
+void vertex_quantization_t::fit( void const *vertices, unsigned int vertex_size, unsigned int count )
+{
+  center = vec_t(0.f);
+  scale = vec_t(1.f);
+  if (count == 0)
+    return;
+
+  unsigned char const *src = (unsigned char const *)vertices;
+  __m128 min = load_vec3(src), max = min;
+  for (unsigned int i = 1; i < count; ++i)
+  {
+    src += vertex_size;
+    __m128 const position = load_vec3(src);
+    min = _mm_min_ps(min, position);
+    max = _mm_max_ps(max, position);
+  }
+
+  float lanes_center[4], lanes_scale[4];
+  _mm_storeu_ps(lanes_center, _mm_mul_ps(_mm_add_ps(min, max), _mm_set1_ps(0.5f)));
+  _mm_storeu_ps(lanes_scale, _mm_mul_ps(_mm_sub_ps(max, min), _mm_set1_ps(0.5f)));
+  center = vec_t(lanes_center[0], lanes_center[1], lanes_center[2]);
+  /* Flat axes keep unit scale, all their quantized coordinates are zero */
+  scale = vec_t(lanes_scale[0] > 0 ? lanes_scale[0] : 1, lanes_scale[1] > 0 ? lanes_scale[1] : 1,
+                lanes_scale[2] > 0 ? lanes_scale[2] : 1);
+}
+
+matrix_t vertex_quantization_t::matrix( void ) const
+{
+  return matrix_t(scale.x, 0, 0,
+                  0, scale.y, 0,
+                  0, 0, scale.z,
+                  center.x, center.y, center.z);
+}
+
+void pack_vertices( vertex_format_t const &format, vertex_quantization_t const &quantization, void const *vertices,
+                    unsigned int vertex_size, unsigned int count, void *packed, unsigned int threads )
+{
+  parallel_for(0, count, c_vertices_per_task, [&]( size_t begin, size_t end )
+  {
+    pack_range(format, quantization, (unsigned char const *)vertices, vertex_size, begin, end, (unsigned char *)packed);
+  }, threads);
+}
+
+void unpack_vertices( vertex_format_t const &format, vertex_quantization_t const &quantization, void const *packed,
+                      unsigned int count, void *vertices, unsigned int vertex_size, unsigned int threads )
+{
+  parallel_for(0, count, c_vertices_per_task, [&]( size_t begin, size_t end )
+  {
+    unpack_range(format, quantization, (unsigned char const *)packed, begin, end, (unsigned char *)vertices, vertex_size);
+  }, threads);
+}
+
+void vertex_error_t::merge( vertex_error_t const &other )
+{
+  unsigned int const count = vertices_count + other.vertices_count;
+  if (count == 0)
+    return;
+
+  mean_position = (mean_position * vertices_count + other.mean_position * other.vertices_count) / count;
+  mean_normal = (mean_normal * vertices_count + other.mean_normal * other.vertices_count) / count;
+  mean_uv = (mean_uv * vertices_count + other.mean_uv * other.vertices_count) / count;
+  max_position = other.max_position > max_position ? other.max_position : max_position;
+  max_normal = other.max_normal > max_normal ? other.max_normal : max_normal;
+  max_uv = other.max_uv > max_uv ? other.max_uv : max_uv;
+  vertices_count = count;
+}
+
+vertex_error_t measure_vertex_error( void const *original, void const *unpacked, unsigned int vertex_size, unsigned int count )
+{
+  vertex_error_t error;
+  unsigned char const *a = (unsigned char const *)original;
+  unsigned char const *b = (unsigned char const *)unpacked;
+
+  for (unsigned int i = 0; i < count; ++i, a += vertex_size, b += vertex_size)
+  {
+    __m128 const delta = _mm_sub_ps(load_vec3(a), load_vec3(b));
+    float const position = _mm_cvtss_f32(_mm_sqrt_ss(dot3(delta, delta)));
+
+    float const cosine = _mm_cvtss_f32(dot3(normalize3(load_vec3(a + c_normal_offset)), normalize3(load_vec3(b + c_normal_offset))));
+    float const normal = acos(cosine > 1 ? 1 : cosine < -1 ? -1 : cosine) * 180 / cglmath::c_pif;
+
+    float const *uv_a = (float const *)(a + c_uv_offset), *uv_b = (float const *)(b + c_uv_offset);
+    float const du = fabs(uv_a[0] - uv_b[0]), dv = fabs(uv_a[1] - uv_b[1]);
+    float const uv = du > dv ? du : dv;
+
+    error.max_position = position > error.max_position ? position : error.max_position;
+    error.max_normal = normal > error.max_normal ? normal : error.max_normal;
+    error.max_uv = uv > error.max_uv ? uv : error.max_uv;
+    error.mean_position += position;
+    error.mean_normal += normal;
+    error.mean_uv += uv;
+  }
+  if (count > 0)
+  {
+    error.mean_position /= count;
+    error.mean_normal /= count;
+    error.mean_uv /= count;
+  }
+  error.vertices_count = count;
+  return error;
+}
+
+device_vertices_t::device_vertices_t()
+  : m_buffer(NULL), m_declaration(NULL), m_fvf(0), m_count(0), m_counted_memory(0), m_counted_full_memory(0), m_is_counted(false)
+{
+}
+
+device_vertices_t::~device_vertices_t()
+{
+  release();
+}
+
+void device_vertices_t::release( void )
+{
+  if (m_is_counted)
+  {
+    std::lock_guard<std::mutex> lock(s_stats_mutex);
+    s_stats.buffers_count--;
+    s_stats.compressed_count -= m_declaration != NULL ? 1 : 0;
+    s_stats.full_memory -= m_counted_full_memory;
+    s_stats.memory -= m_counted_memory;
+    m_is_counted = false;
+  }
+  if (m_buffer != NULL)
+    m_buffer->Release();
+  if (m_declaration != NULL)
+    m_declaration->Release();
+  m_buffer = NULL;
+  m_declaration = NULL;
+  m_count = 0;
+}
+
+bool device_vertices_t::create( IDirect3DDevice9 *device, void const *vertices, unsigned int vertex_size, unsigned int count, DWORD fvf )
+{
+  release();
+  m_fvf = fvf;
+  m_format = vertex_format_t();
+  m_quantization = vertex_quantization_t();
+  if (device == NULL || count == 0)
+    return false;
+
+  D3DCAPS9 caps;
+  vertex_format_t const requested = device_vertex_format();
+  if (!(requested == vertex_format_t()) && SUCCEEDED(device->GetDeviceCaps(&caps)))
+  {
+    vertex_format_t const format = requested.supported(caps);
+    D3DVERTEXELEMENT9 elements[5];
+
+    format.declaration(elements);
+    if (!(format == vertex_format_t()) && SUCCEEDED(device->CreateVertexDeclaration(elements, &m_declaration)))
+      m_format = format;
+  }
+
+  unsigned int const stride = m_format.stride();
+  if (FAILED(device->CreateVertexBuffer(stride * count, D3DUSAGE_WRITEONLY, m_declaration != NULL ? 0 : fvf, D3DPOOL_DEFAULT,
+                                        &m_buffer, NULL)))
+  {
+    release();
+    return false;
+  }
+  m_count = count;
+
+  vertex_error_t error;
+  std::vector<unsigned char> packed;
+  if (m_declaration != NULL)
+  {
+    /* Device buffer is write only, error is measured on a system memory copy */
+    std::vector<unsigned char> unpacked((size_t)vertex_size * count);
+
+    if (m_format.is_quantized())
+      m_quantization.fit(vertices, vertex_size, count);
+    packed.resize((size_t)stride * count);
+    pack_vertices(m_format, m_quantization, vertices, vertex_size, count, &packed[0]);
+    unpack_vertices(m_format, m_quantization, &packed[0], count, &unpacked[0], vertex_size);
+    error = measure_vertex_error(vertices, &unpacked[0], vertex_size, count);
+  }
+
+  void *buf;
+  if (FAILED(m_buffer->Lock(0, 0, &buf, 0)))
+  {
+    release();
+    return false;
+  }
+  memcpy(buf, packed.empty() ? vertices : &packed[0], (size_t)stride * count);
+  m_buffer->Unlock();
+
+  m_counted_full_memory = (size_t)vertex_format_t().stride() * count;
+  m_counted_memory = memory_size();
+  m_is_counted = true;
+
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  s_stats.buffers_count++;
+  s_stats.compressed_count += m_declaration != NULL ? 1 : 0;
+  s_stats.full_memory += m_counted_full_memory;
+  s_stats.memory += m_counted_memory;
+  s_stats.error.merge(error);
+  return true;
+}
+
+void device_vertices_t::bind( IDirect3DDevice9 *device, transform_t const &world ) const
+{
+  device->SetStreamSource(0, m_buffer, 0, m_format.stride());
+  if (m_declaration == NULL)
+  {
+    device->SetFVF(m_fvf);
+    return;
+  }
+
+  device->SetVertexDeclaration(m_declaration);
+  if (m_format.is_quantized())
+  {
+    matrix_t const matrix = m_quantization.matrix() * world.matrix;
+    device->SetTransform(D3DTS_WORLD, (D3DMATRIX *)matrix.M);
+  }
+}
+
+void set_device_vertex_format( vertex_format_t const &format )
+{
+  s_device_format = format;
+}
+
+vertex_format_t device_vertex_format( void )
+{
+  return s_device_format;
+}
+
+vertex_compression_stats_t vertex_compression_stats( void )
+{
+  std::lock_guard<std::mutex> lock(s_stats_mutex);
+  return s_stats;
+}
+
+vertex_format_benchmark_t benchmark_vertex_format( vertex_format_t const &format, unsigned int vertices_count, unsigned int threads )
+{
+  vertex_format_benchmark_t result;
+  std::vector<unsigned char> vertices, packed((size_t)format.stride() * vertices_count), unpacked((size_t)vertices_count * 36);
+  vertex_quantization_t quantization;
+
+  sphere_vertices(vertices_count, vertices);
+  if (format.is_quantized())
+    quantization.fit(&vertices[0], 36, vertices_count);
+
+  result.format = format;
+  result.vertices_count = vertices_count;
+
+  stopwatch_t timer;
+  pack_vertices(format, quantization, &vertices[0], 36, vertices_count, &packed[0], threads);
+  result.pack_ms = timer.elapsed_ms();
+
+  timer.restart();
+  unpack_vertices(format, quantization, &packed[0], vertices_count, &unpacked[0], 36, threads);
+  result.unpack_ms = timer.elapsed_ms();
+
+  result.error = measure_vertex_error(&vertices[0], &unpacked[0], 36, vertices_count);
+  return result;
+}
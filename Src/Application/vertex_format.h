@@ -0,0 +1,197 @@
+/**
+@file     vertex_format.h
+@brief    Compressed vertex formats definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __VERTEX_FORMAT_INCLUDED__
+#define __VERTEX_FORMAT_INCLUDED__
+
+#include <cstddef>
+#include <string>
+
+#include "d3d_api.h"
+#include "Math/cglMath.h"
+
+/* Layout of packed vertices made of base_geometry_t::vertex_t / flower_vertex_t ones:
+ * position, normal, ARGB color, texture coordinates, in this order without gaps.
+ * Quantized positions are relative to mesh bounds (see vertex_quantization_t) */
+struct vertex_format_t
+{
+  enum position_t
+  {
+    POSITION_FLOAT3,            /* 12 bytes */
+    POSITION_SHORT3,            /* 6 bytes, 16 bit normalized, software only */
+    POSITION_SHORT4N            /* 8 bytes, 16 bit normalized, w = 1 */
+  };
+
+  enum normal_t
+  {
+    NORMAL_FLOAT3,              /* 12 bytes */
+    NORMAL_DEC3N,               /* 4 bytes, 10:10:10:2 signed normalized */
+    NORMAL_OCTAHEDRAL           /* 4 bytes, 2 x 16 bit octahedral map, software only */
+  };
+
+  enum uv_t
+  {
+    UV_FLOAT2,                  /* 8 bytes */
+    UV_HALF2                    /* 4 bytes */
+  };
+
+  position_t position;
+  normal_t normal;
+  uv_t uv;
+
+  /* Uncompressed 36 bytes format */
+  vertex_format_t() : position(POSITION_FLOAT3), normal(NORMAL_FLOAT3), uv(UV_FLOAT2) {}
+  vertex_format_t( position_t position, normal_t normal, uv_t uv ) : position(position), normal(normal), uv(uv) {}
+
+  /* Smallest format fixed function pipeline can read: 20 bytes */
+  static vertex_format_t device_compact( void )
+  {
+    return vertex_format_t(POSITION_SHORT4N, NORMAL_DEC3N, UV_HALF2);
+  }
+
+  /* Smallest format: 18 bytes, for system memory copies */
+  static vertex_format_t compact( void )
+  {
+    return vertex_format_t(POSITION_SHORT3, NORMAL_OCTAHEDRAL, UV_HALF2);
+  }
+
+  bool operator==( vertex_format_t const &other ) const
+  {
+    return position == other.position && normal == other.normal && uv == other.uv;
+  }
+
+  bool is_quantized( void ) const { return position != POSITION_FLOAT3; }
+
+  unsigned int normal_offset( void ) const
+  {
+    return position == POSITION_FLOAT3 ? 12 : position == POSITION_SHORT3 ? 6 : 8;
+  }
+  unsigned int color_offset( void ) const { return normal_offset() + (normal == NORMAL_FLOAT3 ? 12 : 4); }
+  unsigned int uv_offset( void ) const { return color_offset() + 4; }
+  unsigned int stride( void ) const { return uv_offset() + (uv == UV_FLOAT2 ? 8 : 4); }
+
+  /* Format has vertex declaration types, i.e. can be drawn without shaders */
+  bool is_declarable( void ) const
+  {
+    return position != POSITION_SHORT3 && normal != NORMAL_OCTAHEDRAL;
+  }
+  /* Nearest format the device can read: unsupported elements become float ones */
+  vertex_format_t supported( D3DCAPS9 const &caps ) const;
+  /* Fill 5 elements for is_declarable() format, last one is D3DDECL_END() */
+  void declaration( D3DVERTEXELEMENT9 *elements ) const;
+
+  /* Short description, e.g. "short4n/dec3n/half2" */
+  std::string name( void ) const;
+};
+
+/* Quantized positions mapping: position = center + q * scale, q in [-1, 1].
+ * Normals of quantized vertices are stored multiplied by scale, then the dequantizing
+ * matrix in front of world transform gives original normal directions after fixed
+ * function normals transformation (inverse transposed world view) and normalization */
+struct vertex_quantization_t
+{
+  vec_t center;
+  vec_t scale;
+
+  vertex_quantization_t() : center(0.f), scale(1.f) {}
+
+  /* Mapping of the bounding box of vertices positions */
+  void fit( void const *vertices, unsigned int vertex_size, unsigned int count );
+  /* Dequantization matrix, world transform is applied after it */
+  matrix_t matrix( void ) const;
+};
+
+/* Pack vertices of base_geometry_t::vertex_t layout (with any 'vertex_size' stride) to the format */
+void pack_vertices( vertex_format_t const &format, vertex_quantization_t const &quantization, void const *vertices,
+                    unsigned int vertex_size, unsigned int count, void *packed, unsigned int threads = 0 );
+/* Inverse of pack_vertices(), normals are of unit length */
+void unpack_vertices( vertex_format_t const &format, vertex_quantization_t const &quantization, void const *packed,
+                      unsigned int count, void *vertices, unsigned int vertex_size, unsigned int threads = 0 );
+
+/* Precision loss of packed vertices */
+struct vertex_error_t
+{
+  unsigned int vertices_count;
+  float max_position;           /* object space distance */
+  double mean_position;
+  float max_normal;             /* degrees */
+  double mean_normal;
+  float max_uv;                 /* texture coordinate component */
+  double mean_uv;
+
+  vertex_error_t() : vertices_count(0), max_position(0), mean_position(0), max_normal(0), mean_normal(0), max_uv(0), mean_uv(0) {}
+
+  /* Accumulate error of other vertices */
+  void merge( vertex_error_t const &other );
+};
+
+/* Compare unpacked vertices with the original ones, both of base_geometry_t::vertex_t layout */
+vertex_error_t measure_vertex_error( void const *original, void const *unpacked, unsigned int vertex_size, unsigned int count );
+
+/* Device vertex buffer in the configured format (see set_device_vertex_format()), in the nearest
+ * supported one when the device can not read it. Quantized buffers override world transform */
+class device_vertices_t
+{
+public:
+  device_vertices_t();
+  ~device_vertices_t();
+
+  /* Vertices of base_geometry_t::vertex_t layout with the same meaning FVF */
+  bool create( IDirect3DDevice9 *device, void const *vertices, unsigned int vertex_size, unsigned int count, DWORD fvf );
+  void release( void );
+
+  /* Set stream 0, vertex layout and world transform (dequantization one with 'world') */
+  void bind( IDirect3DDevice9 *device, transform_t const &world ) const;
+
+  vertex_format_t const & format( void ) const { return m_format; }
+  size_t memory_size( void ) const { return (size_t)m_format.stride() * m_count; }
+private:
+  device_vertices_t( device_vertices_t const & );
+  device_vertices_t & operator=( device_vertices_t const & );
+
+  IDirect3DVertexBuffer9 *m_buffer;
+  IDirect3DVertexDeclaration9 *m_declaration;
+  DWORD m_fvf;
+  vertex_format_t m_format;
+  vertex_quantization_t m_quantization;
+  unsigned int m_count;
+  /* Bytes added to compression statistics by create(), release() subtracts them */
+  size_t m_counted_memory;
+  size_t m_counted_full_memory;
+  bool m_is_counted;
+};
+
+/* Format of device vertex buffers created afterwards, vertex_format_t::device_compact() by default */
+void set_device_vertex_format( vertex_format_t const &format );
+vertex_format_t device_vertex_format( void );
+
+/* Device vertex buffers created by device_vertices_t */
+struct vertex_compression_stats_t
+{
+  unsigned int buffers_count;
+  unsigned int compressed_count; /* buffers in other than full format */
+  size_t full_memory;           /* bytes the buffers take in full format */
+  size_t memory;
+  vertex_error_t error;         /* of all buffers created so far, released ones too */
+};
+
+vertex_compression_stats_t vertex_compression_stats( void );
+
+/* Pack and unpack speed and precision loss of vertex formats on a sphere mesh */
+struct vertex_format_benchmark_t
+{
+  vertex_format_t format;
+  unsigned int vertices_count;
+  double pack_ms;
+  double unpack_ms;
+  vertex_error_t error;
+};
+
+vertex_format_benchmark_t benchmark_vertex_format( vertex_format_t const &format, unsigned int vertices_count, unsigned int threads );
+
+#endif /* __VERTEX_FORMAT_INCLUDED__ */
@@ -0,0 +1,116 @@
+/**
+@file     world_origin.cpp
+@brief    Render space origin of large worlds and positional precision measurement implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <cmath>
+
+#include "world_origin.h"
+
+const float world_origin_t::c_rebase_distance = 1024;
+const float world_origin_t::c_rebase_step = 1;
+
+namespace
+{
+  /* Camera distance from units of the measurement, meters */
+  const double c_units_distance = 100;
+
+  /* Deterministic [-1, 1] values, rand() sequence of the scene stays untouched */
+  double random_signed( unsigned int &seed )
+  {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) / (double)(1 << 24) * 2 - 1;
+  }
+
+  dvec_t random_vector( unsigned int &seed )
+  {
+    double const x = random_signed(seed), y = random_signed(seed);
+    return dvec_t(x, y, random_signed(seed));
+  }
+
+  /* Origin moved by whole steps, nearest to 'position' */
+  dvec_t snap( dvec_t const &position, double step )
+  {
+    return dvec_t(floor(position.x / step + 0.5) * step, floor(position.y / step + 0.5) * step,
+                  floor(position.z / step + 0.5) * step);
+  }
+
+  /* View space position of 'vertex' of a unit at 'unit' seen by camera at 'eye' in doubles.
+   * Rotation is taken from the float view matrix, so only translations are compared */
+  dvec_t reference_view_point( matrix_t const &view, dvec_t const &eye, dvec_t const &unit, vec_t const &vertex )
+  {
+    dvec_t const d(unit.x + vertex.x - eye.x, unit.y + vertex.y - eye.y, unit.z + vertex.z - eye.z);
+    return dvec_t(d.x * view.M[0][0] + d.y * view.M[1][0] + d.z * view.M[2][0],
+                  d.x * view.M[0][1] + d.y * view.M[1][1] + d.z * view.M[2][1],
+                  d.x * view.M[0][2] + d.y * view.M[1][2] + d.z * view.M[2][2]);
+  }
+
+  double error( vec_t const &point, dvec_t const &reference )
+  {
+    return (dvec_t(point.x, point.y, point.z) - reference).length();
+  }
+}
+
+bool world_origin_t::rebase( camera_t &camera )
+{
+  if (camera.location.length2() <= m_rebase_distance * m_rebase_distance)
+    return false;
+
+  dvec_t const location(camera.location.x, camera.location.y, camera.location.z);
+  dvec_t const step_offset = snap(location, c_rebase_step);
+  vec_t const offset((float)step_offset.x, (float)step_offset.y, (float)step_offset.z);
+  if (offset.x == 0 && offset.y == 0 && offset.z == 0)
+    return false;
+
+  m_position = world_position(offset);
+  camera.shift(-offset);
+  m_rebases_count++;
+  return true;
+}
+
+position_error_t measure_position_error( double distance, unsigned int samples )
+{
+  position_error_t result = {distance, 0, 0};
+  unsigned int seed = 1;
+
+  for (unsigned int i = 0; i < samples; ++i)
+  {
+    dvec_t direction = random_vector(seed);
+    if (direction.length2() == 0)
+      continue;
+    dvec_t const eye = direction * (distance / direction.length());
+    dvec_t const unit = eye + random_vector(seed) * c_units_distance;
+    vec_t const vertex = relative_position(random_vector(seed), dvec_t(0, 0, 0));
+    vec_t view_direction = relative_position(unit, eye), up(0, 1, 0);
+    if (view_direction.length2() == 0)
+      continue;
+
+    /* Camera and unit world positions in floats */
+    camera_t absolute;
+    vec_t absolute_eye = relative_position(eye, dvec_t(0, 0, 0));
+    absolute.set_camera(absolute_eye, view_direction, up, false);
+    transform_t absolute_world;
+    absolute_world.set_translate(relative_position(unit, dvec_t(0, 0, 0)));
+    vec_t const absolute_point = vertex * (absolute_world.matrix * absolute.get_view_matrix());
+
+    /* Camera has just crossed the rebase distance from the previous origin, the same rebase()
+     * as at runtime moves the origin under it */
+    world_origin_t origin;
+    origin.set_position(eye - direction * ((world_origin_t::c_rebase_distance + 1) / direction.length()));
+    camera_t relative;
+    vec_t relative_eye = relative_position(eye, origin.position());
+    relative.set_camera(relative_eye, view_direction, up, false);
+    origin.rebase(relative);
+    transform_t relative_world;
+    relative_world.set_translate(relative_position(unit, origin.position()));
+    vec_t const relative_point = vertex * (relative_world.matrix * relative.get_view_matrix());
+
+    dvec_t const reference = reference_view_point(relative.get_view_matrix(), eye, unit, vertex);
+    result.absolute_error = cglmath::Max(result.absolute_error, error(absolute_point, reference));
+    result.relative_error = cglmath::Max(result.relative_error, error(relative_point, reference));
+  }
+  return result;
+}
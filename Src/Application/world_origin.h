@@ -0,0 +1,72 @@
+/**
+@file     world_origin.h
+@brief    Render space origin of large worlds and positional precision measurement definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __WORLD_ORIGIN_INCLUDED__
+#define __WORLD_ORIGIN_INCLUDED__
+
+#include <cstddef>
+
+#include "Math/cglMath.h"
+
+/* Float offset of a world position from an origin. The difference is taken in doubles, so it
+ * is only rounded once however far both points are from the world origin */
+inline vec_t relative_position( dvec_t const &position, dvec_t const &origin )
+{
+  return vec_t((float)(position.x - origin.x), (float)(position.y - origin.y), (float)(position.z - origin.z));
+}
+
+/* World position of the render space origin. Units are placed relative to it (see world_stack_t)
+ * and the camera location is kept in render space: rebase() moves the origin under the camera
+ * when the camera gets far from it, so render space floats stay small in worlds of any size */
+class world_origin_t
+{
+public:
+  /* Camera distance from the origin which moves the origin, meters */
+  static const float c_rebase_distance;
+  /* Origin moves by multiples of it: shifted render space positions stay exact */
+  static const float c_rebase_step;
+
+  world_origin_t() : m_position(0, 0, 0), m_rebase_distance(c_rebase_distance), m_rebases_count(0) {}
+
+  dvec_t const & position( void ) const { return m_position; }
+  /* Place the origin at world 'position', render space contents move along with it */
+  void set_position( dvec_t const &position ) { m_position = position; }
+
+  /* 0 rebases whenever the camera moves by a step: rendering is camera relative */
+  void set_rebase_distance( float distance ) { m_rebase_distance = distance; }
+  float rebase_distance( void ) const { return m_rebase_distance; }
+
+  /* Move the origin under the camera when it is farther than the rebase distance, the camera
+   * is shifted back by the same offset. Returns true when the origin moved */
+  bool rebase( camera_t &camera );
+  unsigned int rebases_count( void ) const { return m_rebases_count; }
+
+  /* World position of a render space point */
+  dvec_t world_position( vec_t const &render_position ) const
+  {
+    return dvec_t(m_position.x + render_position.x, m_position.y + render_position.y, m_position.z + render_position.z);
+  }
+private:
+  dvec_t m_position;
+  float m_rebase_distance;
+  unsigned int m_rebases_count;
+};
+
+/* View space error of unit vertices near a camera far from the world origin */
+struct position_error_t
+{
+  double distance;              /* camera distance from the world origin, meters */
+  double absolute_error;        /* world and view matrices of world space floats, meters */
+  double relative_error;        /* unit position relative to a rebased origin, meters */
+};
+
+/* Largest errors of 'samples' vertices on units up to 100 meters from the camera, reference
+ * view space positions are computed in doubles by the same camera rotation */
+position_error_t measure_position_error( double distance, unsigned int samples );
+
+#endif /* __WORLD_ORIGIN_INCLUDED__ */
@@ -0,0 +1,1174 @@
+/**
+@file     x_parser.cpp
+@brief    DirectX .x files parser (D3DX independent) implementation
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include "Math/cglMath.h"
+#include "files.h"
+#include "stopwatch.h"
+#include "x_parser.h"
+
+namespace
+{
+  /* Binary encoding token codes */
+  enum binary_token_t
+  {
+    BINARY_TOKEN_NAME = 1,
+    BINARY_TOKEN_STRING = 2,
+    BINARY_TOKEN_INTEGER = 3,
+    BINARY_TOKEN_GUID = 5,
+    BINARY_TOKEN_INTEGER_LIST = 6,
+    BINARY_TOKEN_FLOAT_LIST = 7,
+    BINARY_TOKEN_OBRACE = 10,
+    BINARY_TOKEN_CBRACE = 11,
+    BINARY_TOKEN_COMMA = 19,
+    BINARY_TOKEN_SEMICOLON = 20,
+    BINARY_TOKEN_TEMPLATE = 31
+  };
+
+  /* Tokens as seen by the parser for both encodings */
+  enum token_t
+  {
+    TOKEN_END,
+    TOKEN_NAME,
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_GUID,
+    TOKEN_OBRACE,
+    TOKEN_CBRACE,
+    TOKEN_TEMPLATE,
+    TOKEN_OTHER
+  };
+
+  /* Character classes for the text tokenizer */
+  enum
+  {
+    CHAR_SEPARATOR = 1,         /* white space, commas and semicolons */
+    CHAR_DIGIT = 2,
+    CHAR_NAME_FIRST = 4,
+    CHAR_NAME = 8
+  };
+
+  struct char_classes_t
+  {
+    unsigned char classes[256];
+
+    char_classes_t()
+    {
+      memset(classes, 0, sizeof(classes));
+      for (int c = 0; c <= ' '; ++c)
+        classes[c] = CHAR_SEPARATOR;
+      classes[(int)','] = classes[(int)';'] = CHAR_SEPARATOR;
+      for (int c = '0'; c <= '9'; ++c)
+        classes[c] = CHAR_DIGIT | CHAR_NAME;
+      for (int c = 'a'; c <= 'z'; ++c)
+        classes[c] = classes[c - 'a' + 'A'] = CHAR_NAME_FIRST | CHAR_NAME;
+      classes[(int)'_'] = CHAR_NAME_FIRST | CHAR_NAME;
+      classes[(int)'-'] = classes[(int)'.'] = CHAR_NAME;
+    }
+  };
+
+  const char_classes_t s_chars;
+
+  /* Exact powers of ten representable in double */
+  const double c_powers_of_10[] =
+  {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  const float c_identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+  inline bool is_class( unsigned char c, int char_class )
+  {
+    return (s_chars.classes[c] & char_class) != 0;
+  }
+
+  inline unsigned int read_dword( unsigned char const *p )
+  {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+  }
+
+  /* .x matrices are 16 floats, 4 rows of the row vector convention */
+  typedef float (*rows_t)[4];
+  typedef float const (*const_rows_t)[4];
+
+  /* Inverse of affine matrix, identity for singular one */
+  void invert_affine( float const m[16], float res[16] )
+  {
+    float const c00 = m[5] * m[10] - m[6] * m[9], c01 = m[2] * m[9] - m[1] * m[10], c02 = m[1] * m[6] - m[2] * m[5];
+    float const det = m[0] * c00 + m[4] * c01 + m[8] * c02;
+
+    memcpy(res, c_identity, sizeof(c_identity));
+    if (det == 0)
+      return;
+    res[0] = c00 / det;
+    res[1] = c01 / det;
+    res[2] = c02 / det;
+    res[4] = (m[6] * m[8] - m[4] * m[10]) / det;
+    res[5] = (m[0] * m[10] - m[2] * m[8]) / det;
+    res[6] = (m[2] * m[4] - m[0] * m[6]) / det;
+    res[8] = (m[4] * m[9] - m[5] * m[8]) / det;
+    res[9] = (m[1] * m[8] - m[0] * m[9]) / det;
+    res[10] = (m[0] * m[5] - m[1] * m[4]) / det;
+    for (int c = 0; c < 3; ++c)
+      res[12 + c] = -(m[12] * res[c] + m[13] * res[4 + c] + m[14] * res[8 + c]);
+  }
+
+  /* Token stream over text or binary encoding. Separators are skipped, so the
+   * parser reads values by the known templates layout in both cases. */
+  class x_reader_t
+  {
+  public:
+    x_reader_t( unsigned char const *data, size_t size )
+      : m_cur(data)
+      , m_end(data + size)
+      , m_binary(false)
+      , m_double(false)
+      , m_list_count(0)
+      , m_list_float(false)
+    {
+    }
+
+    bool read_header( void )
+    {
+      if (m_end - m_cur < 16 || memcmp(m_cur, "xof ", 4) != 0)
+        return false;
+      if (memcmp(m_cur + 8, "txt ", 4) == 0)
+        m_binary = false;
+      else if (memcmp(m_cur + 8, "bin ", 4) == 0)
+        m_binary = true;
+      else
+        return false;           /* compressed files are not supported */
+      m_double = memcmp(m_cur + 12, "0064", 4) == 0;
+      m_cur += 16;
+      return true;
+    }
+
+    token_t peek( void )
+    {
+      return m_binary ? peek_binary() : peek_text();
+    }
+
+    bool expect( token_t token )
+    {
+      if (peek() != token)
+        return false;
+      if (m_binary)
+        m_cur += token == TOKEN_GUID ? 18 : 2;
+      else if (token == TOKEN_GUID)
+      {
+        while (m_cur < m_end && *m_cur != '>')
+          ++m_cur;
+        if (m_cur == m_end)
+          return false;
+        ++m_cur;
+      }
+      else
+        ++m_cur;
+      return true;
+    }
+
+    bool read_name( std::string &name )
+    {
+      token_t const token = peek();
+      if (token != TOKEN_NAME && token != TOKEN_TEMPLATE)
+        return false;
+      if (m_binary && token == TOKEN_TEMPLATE)
+      {
+        name = "template";
+        m_cur += 2;
+        return true;
+      }
+      if (m_binary)
+        return read_binary_chars(name);
+
+      unsigned char const *start = m_cur;
+      while (m_cur < m_end && is_class(*m_cur, CHAR_NAME))
+        ++m_cur;
+      name.assign((char const *)start, m_cur - start);
+      return true;
+    }
+
+    bool read_string( std::string &str )
+    {
+      if (peek() != TOKEN_STRING)
+        return false;
+      if (m_binary)
+        return read_binary_chars(str);
+
+      unsigned char const *start = ++m_cur;
+      while (m_cur < m_end && *m_cur != '"')
+        ++m_cur;
+      if (m_cur == m_end)
+        return false;
+      str.assign((char const *)start, m_cur - start);
+      ++m_cur;
+      return true;
+    }
+
+    bool read_uint( unsigned int &value )
+    {
+      if (peek() != TOKEN_NUMBER)
+        return false;
+      if (m_binary)
+      {
+        if (m_list_count == 0)
+        {
+          /* Single integer token */
+          value = read_dword(m_cur + 2);
+          m_cur += 6;
+          return true;
+        }
+        if (m_list_float)
+        {
+          float f;
+          read_list_float(f);
+          value = (unsigned int)f;
+        }
+        else
+        {
+          value = read_dword(m_cur);
+          m_cur += 4;
+          m_list_count--;
+        }
+        return true;
+      }
+
+      unsigned int result = 0;
+      unsigned char const *start = m_cur;
+      while (m_cur < m_end && is_class(*m_cur, CHAR_DIGIT))
+        result = result * 10 + (*m_cur++ - '0');
+      value = result;
+      return m_cur != start && (m_cur == m_end || *m_cur != '.');
+    }
+
+    bool read_float( float &value )
+    {
+      if (peek() != TOKEN_NUMBER)
+        return false;
+      if (m_binary)
+      {
+        if (m_list_count == 0)
+        {
+          value = (float)read_dword(m_cur + 2);
+          m_cur += 6;
+        }
+        else if (m_list_float)
+          read_list_float(value);
+        else
+        {
+          value = (float)read_dword(m_cur);
+          m_cur += 4;
+          m_list_count--;
+        }
+        return true;
+      }
+      return read_text_float(value);
+    }
+
+    bool read_floats( float *values, unsigned int count )
+    {
+      for (unsigned int i = 0; i < count; ++i)
+        if (!read_float(values[i]))
+          return false;
+      return true;
+    }
+
+    /* Skip current token */
+    bool skip( void )
+    {
+      token_t const token = peek();
+      std::string str;
+      float value;
+
+      switch (token)
+      {
+      case TOKEN_END:
+        return false;
+      case TOKEN_NAME:
+      case TOKEN_TEMPLATE:
+        return read_name(str);
+      case TOKEN_STRING:
+        return read_string(str);
+      case TOKEN_GUID:
+      case TOKEN_OBRACE:
+      case TOKEN_CBRACE:
+        return expect(token);
+      case TOKEN_NUMBER:
+        if (m_binary && m_list_count > 0)
+        {
+          /* Whole list at once */
+          size_t const element_size = m_list_float && m_double ? 8 : 4;
+          if ((size_t)(m_end - m_cur) / element_size < m_list_count)
+            return false;
+          m_cur += m_list_count * element_size;
+          m_list_count = 0;
+          return true;
+        }
+        return read_float(value);
+      default:
+        m_cur += m_binary ? 2 : 1;
+        return true;
+      }
+    }
+
+    /* Skip the rest of object, its opening brace is already read */
+    bool skip_block( void )
+    {
+      for (int depth = 1; depth > 0; )
+      {
+        token_t const token = peek();
+
+        if (token == TOKEN_OBRACE)
+          depth++;
+        else if (token == TOKEN_CBRACE)
+          depth--;
+        if (!skip())
+          return false;
+      }
+      return true;
+    }
+  private:
+    token_t peek_text( void )
+    {
+      for (;;)
+      {
+        while (m_cur < m_end && is_class(*m_cur, CHAR_SEPARATOR))
+          ++m_cur;
+        if (m_cur == m_end)
+          return TOKEN_END;
+        if (*m_cur != '#' && (*m_cur != '/' || m_cur + 1 == m_end || m_cur[1] != '/'))
+          break;
+        while (m_cur < m_end && *m_cur != '\n')
+          ++m_cur;
+      }
+
+      unsigned char const c = *m_cur;
+      if (is_class(c, CHAR_DIGIT))
+        return TOKEN_NUMBER;
+      if (is_class(c, CHAR_NAME_FIRST))
+      {
+        if (m_end - m_cur > 8 && memcmp(m_cur, "template", 8) == 0 && !is_class(m_cur[8], CHAR_NAME))
+          return TOKEN_TEMPLATE;
+        return TOKEN_NAME;
+      }
+      switch (c)
+      {
+      case '{':
+        return TOKEN_OBRACE;
+      case '}':
+        return TOKEN_CBRACE;
+      case '<':
+        return TOKEN_GUID;
+      case '"':
+        return TOKEN_STRING;
+      case '-':
+      case '+':
+      case '.':
+        return m_cur + 1 < m_end && (is_class(m_cur[1], CHAR_DIGIT) || m_cur[1] == '.') ? TOKEN_NUMBER : TOKEN_OTHER;
+      }
+      return TOKEN_OTHER;
+    }
+
+    token_t peek_binary( void )
+    {
+      for (;;)
+      {
+        if (m_list_count > 0)
+          return TOKEN_NUMBER;
+        if (m_end - m_cur < 2)
+          return TOKEN_END;
+
+        unsigned int const token = m_cur[0] | (m_cur[1] << 8);
+        switch (token)
+        {
+        case BINARY_TOKEN_COMMA:
+        case BINARY_TOKEN_SEMICOLON:
+          m_cur += 2;
+          continue;
+        case BINARY_TOKEN_INTEGER_LIST:
+        case BINARY_TOKEN_FLOAT_LIST:
+          /* Open the list, its elements are returned one by one */
+          if (m_end - m_cur < 6)
+            return TOKEN_END;
+          m_list_count = read_dword(m_cur + 2);
+          m_list_float = token == BINARY_TOKEN_FLOAT_LIST;
+          m_cur += 6;
+          if ((size_t)(m_end - m_cur) / (m_list_float && m_double ? 8 : 4) < m_list_count)
+          {
+            m_list_count = 0;
+            m_cur = m_end;
+            return TOKEN_END;
+          }
+          continue;
+        case BINARY_TOKEN_INTEGER:
+          return m_end - m_cur < 6 ? TOKEN_END : TOKEN_NUMBER;
+        case BINARY_TOKEN_NAME:
+          return TOKEN_NAME;
+        case BINARY_TOKEN_STRING:
+          return TOKEN_STRING;
+        case BINARY_TOKEN_GUID:
+          return m_end - m_cur < 18 ? TOKEN_END : TOKEN_GUID;
+        case BINARY_TOKEN_OBRACE:
+          return TOKEN_OBRACE;
+        case BINARY_TOKEN_CBRACE:
+          return TOKEN_CBRACE;
+        case BINARY_TOKEN_TEMPLATE:
+          return TOKEN_TEMPLATE;
+        }
+        return TOKEN_OTHER;
+      }
+    }
+
+    /* Name and string tokens payload: count and characters */
+    bool read_binary_chars( std::string &str )
+    {
+      if (m_end - m_cur < 6)
+        return false;
+
+      unsigned int const count = read_dword(m_cur + 2);
+      if ((size_t)(m_end - m_cur - 6) < count)
+        return false;
+      str.assign((char const *)m_cur + 6, count);
+      m_cur += 6 + count;
+      return true;
+    }
+
+    void read_list_float( float &value )
+    {
+      if (m_double)
+      {
+        double d;
+        memcpy(&d, m_cur, 8);
+        value = (float)d;
+        m_cur += 8;
+      }
+      else
+      {
+        memcpy(&value, m_cur, 4);
+        m_cur += 4;
+      }
+      m_list_count--;
+    }
+
+    /* Tokenizer fast path: decimal float without strtod and locale lookups */
+    bool read_text_float( float &value )
+    {
+      unsigned char const *p = m_cur;
+      bool const is_negative = *p == '-';
+      if (*p == '-' || *p == '+')
+        ++p;
+
+      unsigned long long mantissa = 0;
+      int digits = 0, exponent = 0;
+      unsigned char const *digits_start = p;
+
+      for (; p < m_end && is_class(*p, CHAR_DIGIT); ++p)
+        if (digits < 19)
+        {
+          mantissa = mantissa * 10 + (*p - '0');
+          digits += mantissa != 0;
+        }
+        else
+          exponent++;
+      if (p < m_end && *p == '.')
+        for (++p; p < m_end && is_class(*p, CHAR_DIGIT); ++p)
+          if (digits < 19)
+          {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+            exponent--;
+          }
+      if (p == digits_start)
+        return false;
+
+      if (p < m_end && (*p == 'e' || *p == 'E'))
+      {
+        unsigned char const *e = p + 1;
+        bool const is_exp_negative = e < m_end && *e == '-';
+        int exp_value = 0;
+
+        if (e < m_end && (*e == '-' || *e == '+'))
+          ++e;
+        if (e < m_end && is_class(*e, CHAR_DIGIT))
+        {
+          for (; e < m_end && is_class(*e, CHAR_DIGIT); ++e)
+            exp_value = exp_value < 10000 ? exp_value * 10 + (*e - '0') : exp_value;
+          exponent += is_exp_negative ? -exp_value : exp_value;
+          p = e;
+        }
+      }
+
+      double result = (double)mantissa;
+      if (mantissa != 0 && exponent != 0)
+      {
+        if (exponent > 0)
+          result *= exponent <= 22 ? c_powers_of_10[exponent] : pow(10.0, exponent);
+        else
+          result /= -exponent <= 22 ? c_powers_of_10[-exponent] : pow(10.0, -exponent);
+      }
+      value = (float)(is_negative ? -result : result);
+      m_cur = p;
+      return true;
+    }
+
+    unsigned char const *m_cur;
+    unsigned char const *m_end;
+    bool m_binary;
+    bool m_double;              /* binary floats are 64 bit */
+    unsigned int m_list_count;  /* elements left in the current binary list */
+    bool m_list_float;
+  };
+
+  struct x_vertex_t
+  {
+    float pos[3];
+    float normal[3];
+    float uv[2];
+  };
+
+  /* SkinWeights object: weights of mesh positions for bone frame with mesh to bone space offset */
+  struct x_skin_weights_t
+  {
+    std::string frame;
+    std::vector<unsigned int> indices;
+    std::vector<float> weights;
+    float offset[16];
+  };
+
+  struct x_triangle_t
+  {
+    unsigned int index[3];
+    unsigned int material;
+  };
+
+  bool operator<( x_triangle_t const &a, x_triangle_t const &b )
+  {
+    return a.material < b.material;
+  }
+
+  /* Builds collapsed scene mesh while walking data objects */
+  class x_parser_t
+  {
+  public:
+    x_parser_t( x_reader_t &reader, x_scene_t &scene )
+      : m_reader(reader)
+      , m_scene(scene)
+      , m_has_normals(false)
+      , m_has_uvs(false)
+      , m_has_skin(false)
+    {
+    }
+
+    bool parse( void )
+    {
+      m_scene = x_scene_t();
+      if (!m_reader.read_header())
+        return false;
+
+      for (;;)
+      {
+        switch (m_reader.peek())
+        {
+        case TOKEN_END:
+          finish();
+          return true;
+        case TOKEN_TEMPLATE:
+          if (!skip_template())
+            return false;
+          break;
+        case TOKEN_NAME:
+          if (!parse_data_object(-1))
+            return false;
+          break;
+        default:
+          return false;
+        }
+      }
+    }
+  private:
+    bool skip_template( void )
+    {
+      std::string name;
+      return m_reader.read_name(name) && m_reader.read_name(name) && m_reader.expect(TOKEN_OBRACE) && m_reader.skip_block();
+    }
+
+    /* Identifier [name] [guid] { */
+    bool parse_object_header( std::string &type, std::string &name )
+    {
+      if (!m_reader.read_name(type))
+        return false;
+      name.clear();
+      if (m_reader.peek() == TOKEN_NAME && !m_reader.read_name(name))
+        return false;
+      if (m_reader.peek() == TOKEN_GUID && !m_reader.expect(TOKEN_GUID))
+        return false;
+      return m_reader.expect(TOKEN_OBRACE);
+    }
+
+    /* { name [guid] } */
+    bool parse_reference( std::string &name )
+    {
+      name.clear();
+      if (!m_reader.expect(TOKEN_OBRACE))
+        return false;
+      if (m_reader.peek() == TOKEN_NAME && !m_reader.read_name(name))
+        return false;
+      if (m_reader.peek() == TOKEN_GUID && !m_reader.expect(TOKEN_GUID))
+        return false;
+      return m_reader.expect(TOKEN_CBRACE);
+    }
+
+    /* Object at top level or inside frame */
+    bool parse_data_object( int frame )
+    {
+      std::string type, name;
+      if (!parse_object_header(type, name))
+        return false;
+
+      if (type == "Frame")
+        return parse_frame(name, frame);
+      if (type == "Mesh")
+        return parse_mesh(frame);
+      if (type == "Material")
+        return parse_material(m_named_materials[name]);
+      if (type == "FrameTransformMatrix" && frame >= 0)
+      {
+        x_frame_t &f = m_scene.frames[frame];
+        if (!m_reader.read_floats(f.transform, 16) || !m_reader.expect(TOKEN_CBRACE))
+          return false;
+        matrix_t::multiply(const_rows_t(f.transform), const_rows_t(f.parent >= 0 ? m_scene.frames[f.parent].world : c_identity),
+                           rows_t(f.world));
+        return true;
+      }
+      return m_reader.skip_block();
+    }
+
+    bool parse_frame( std::string const &name, int parent )
+    {
+      x_frame_t frame;
+      frame.name = name;
+      frame.parent = parent;
+      memcpy(frame.transform, c_identity, sizeof(c_identity));
+      memcpy(frame.world, parent >= 0 ? m_scene.frames[parent].world : c_identity, sizeof(frame.world));
+
+      int const index = (int)m_scene.frames.size();
+      m_scene.frames.push_back(frame);
+
+      for (;;)
+      {
+        std::string reference;
+
+        switch (m_reader.peek())
+        {
+        case TOKEN_CBRACE:
+          return m_reader.expect(TOKEN_CBRACE);
+        case TOKEN_NAME:
+          if (!parse_data_object(index))
+            return false;
+          break;
+        case TOKEN_OBRACE:
+          if (!parse_reference(reference))
+            return false;
+          break;
+        default:
+          return false;
+        }
+      }
+    }
+
+    /* ColorRGBA faceColor; FLOAT power; ColorRGB specularColor; ColorRGB emissiveColor; [TextureFilename] */
+    bool parse_material( mesh_material_t &material )
+    {
+      material = mesh_material_t();
+      if (!m_reader.read_floats(material.diffuse, 4) || !m_reader.read_float(material.power) ||
+          !m_reader.read_floats(material.specular, 3) || !m_reader.read_floats(material.emissive, 3))
+        return false;
+      material.specular[3] = material.emissive[3] = 1;
+
+      for (;;)
+      {
+        std::string type, name;
+
+        switch (m_reader.peek())
+        {
+        case TOKEN_CBRACE:
+          return m_reader.expect(TOKEN_CBRACE);
+        case TOKEN_NAME:
+          if (!parse_object_header(type, name))
+            return false;
+          if (type == "TextureFilename")
+          {
+            if (!m_reader.read_string(material.texture_file) || !m_reader.expect(TOKEN_CBRACE))
+              return false;
+          }
+          else if (!m_reader.skip_block())
+            return false;
+          break;
+        default:
+          return false;
+        }
+      }
+    }
+
+    /* DWORD nFaces; array MeshFace faces[nFaces] */
+    bool parse_faces( unsigned int vertices_count, std::vector<unsigned int> &face_sizes, std::vector<unsigned int> &corners )
+    {
+      unsigned int faces_count;
+      if (!m_reader.read_uint(faces_count))
+        return false;
+
+      face_sizes.resize(faces_count);
+      corners.clear();
+      corners.reserve(faces_count * 3);
+      for (unsigned int i = 0; i < faces_count; ++i)
+      {
+        if (!m_reader.read_uint(face_sizes[i]))
+          return false;
+        for (unsigned int j = 0; j < face_sizes[i]; ++j)
+        {
+          unsigned int index;
+          if (!m_reader.read_uint(index) || index >= vertices_count)
+            return false;
+          corners.push_back(index);
+        }
+      }
+      return true;
+    }
+
+    bool parse_material_list( unsigned int faces_count, std::vector<unsigned int> &face_materials,
+                              std::vector<mesh_material_t> &materials )
+    {
+      unsigned int materials_count, indices_count;
+      if (!m_reader.read_uint(materials_count) || !m_reader.read_uint(indices_count))
+        return false;
+
+      face_materials.resize(faces_count);
+      for (unsigned int i = 0; i < indices_count; ++i)
+      {
+        unsigned int index;
+        if (!m_reader.read_uint(index) || index >= materials_count)
+          return false;
+        if (i < faces_count)
+          face_materials[i] = index;
+      }
+      /* Short list repeats the last index */
+      for (unsigned int i = indices_count; i < faces_count; ++i)
+        face_materials[i] = indices_count > 0 ? face_materials[indices_count - 1] : 0;
+
+      for (;;)
+      {
+        std::string type, name;
+
+        switch (m_reader.peek())
+        {
+        case TOKEN_CBRACE:
+          if (materials.size() < materials_count)
+            materials.resize(materials_count);
+          return m_reader.expect(TOKEN_CBRACE);
+        case TOKEN_NAME:
+          if (!parse_object_header(type, name))
+            return false;
+          if (type == "Material")
+          {
+            materials.push_back(mesh_material_t());
+            if (!parse_material(materials.back()))
+              return false;
+          }
+          else if (!m_reader.skip_block())
+            return false;
+          break;
+        case TOKEN_OBRACE:
+          if (!parse_reference(name))
+            return false;
+          materials.push_back(m_named_materials[name]);
+          break;
+        default:
+          return false;
+        }
+      }
+    }
+
+    bool parse_mesh( int frame )
+    {
+      unsigned int vertices_count;
+      std::vector<float> positions, normals, uvs;
+      std::vector<unsigned int> face_sizes, corners, normal_face_sizes, normal_corners, face_materials;
+      std::vector<mesh_material_t> materials;
+      std::vector<x_skin_weights_t> skins;
+
+      if (!m_reader.read_uint(vertices_count))
+        return false;
+      positions.resize(vertices_count * 3);
+      if (!m_reader.read_floats(positions.data(), (unsigned int)positions.size()) ||
+          !parse_faces(vertices_count, face_sizes, corners))
+        return false;
+
+      for (bool is_done = false; !is_done; )
+      {
+        std::string type, name;
+        unsigned int count;
+
+        switch (m_reader.peek())
+        {
+        case TOKEN_CBRACE:
+          if (!m_reader.expect(TOKEN_CBRACE))
+            return false;
+          is_done = true;
+          break;
+        case TOKEN_NAME:
+          if (!parse_object_header(type, name))
+            return false;
+          if (type == "MeshNormals")
+          {
+            if (!m_reader.read_uint(count))
+              return false;
+            normals.resize(count * 3);
+            if (!m_reader.read_floats(normals.data(), (unsigned int)normals.size()) ||
+                !parse_faces(count, normal_face_sizes, normal_corners) || normal_face_sizes != face_sizes ||
+                !m_reader.expect(TOKEN_CBRACE))
+              return false;
+          }
+          else if (type == "MeshTextureCoords")
+          {
+            if (!m_reader.read_uint(count) || count != vertices_count)
+              return false;
+            uvs.resize(count * 2);
+            if (!m_reader.read_floats(uvs.data(), (unsigned int)uvs.size()) || !m_reader.expect(TOKEN_CBRACE))
+              return false;
+          }
+          else if (type == "MeshMaterialList")
+          {
+            if (!parse_material_list((unsigned int)face_sizes.size(), face_materials, materials))
+              return false;
+          }
+          else if (type == "SkinWeights")
+          {
+            skins.push_back(x_skin_weights_t());
+            if (!parse_skin_weights(vertices_count, skins.back()))
+              return false;
+          }
+          else if (!m_reader.skip_block())
+            return false;
+          break;
+        case TOKEN_OBRACE:
+          if (!parse_reference(name))
+            return false;
+          break;
+        default:
+          return false;
+        }
+      }
+
+      if (materials.empty())
+      {
+        mesh_material_t material;
+        for (int c = 0; c < 4; ++c)
+          material.diffuse[c] = material.specular[c] = 1;
+        material.emissive[3] = 1;
+        materials.push_back(material);
+        face_materials.assign(face_sizes.size(), 0);
+      }
+
+      add_mesh(frame, positions, normals, uvs, face_sizes, corners, normal_corners, face_materials, materials, skins);
+      return true;
+    }
+
+    /* STRING transformNodeName; DWORD nWeights; array DWORD vertexIndices[nWeights];
+     * array FLOAT weights[nWeights]; Matrix4x4 matrixOffset */
+    bool parse_skin_weights( unsigned int vertices_count, x_skin_weights_t &skin )
+    {
+      unsigned int count;
+      if (!m_reader.read_string(skin.frame) || !m_reader.read_uint(count))
+        return false;
+
+      skin.indices.resize(count);
+      skin.weights.resize(count);
+      for (unsigned int i = 0; i < count; ++i)
+        if (!m_reader.read_uint(skin.indices[i]) || skin.indices[i] >= vertices_count)
+          return false;
+      return m_reader.read_floats(skin.weights.data(), count) && m_reader.read_floats(skin.offset, 16) &&
+             m_reader.expect(TOKEN_CBRACE);
+    }
+
+    /* Bone of the frame, vertices collapsed by 'world' are brought back by the inverse of it */
+    unsigned short add_bone( int frame, std::string const &frame_name, float const world[16], float const offset[16] )
+    {
+      x_bone_t bone;
+      float inv_world[16];
+
+      bone.frame = frame;
+      invert_affine(world, inv_world);
+      matrix_t::multiply(const_rows_t(inv_world), const_rows_t(offset), rows_t(bone.offset));
+      m_scene.bones.push_back(bone);
+      m_bone_frames.push_back(frame_name);
+      return (unsigned short)(m_scene.bones.size() - 1);
+    }
+
+    /* Influences of mesh positions: four largest skin weights renormalized, the mesh frame
+     * for positions without weights and for meshes without skin */
+    void add_influences( int frame, float const world[16], std::vector<x_skin_weights_t> const &skins,
+                         std::vector<x_influence_t> &influences )
+    {
+      x_influence_t none;
+      memset(&none, 0, sizeof(none));
+      influences.assign(influences.size(), none);
+      m_has_skin |= !skins.empty();
+
+      for (size_t s = 0; s < skins.size(); ++s)
+      {
+        x_skin_weights_t const &skin = skins[s];
+        unsigned short const bone = add_bone(-1, skin.frame, world, skin.offset);
+
+        for (size_t i = 0; i < skin.indices.size(); ++i)
+        {
+          x_influence_t &influence = influences[skin.indices[i]];
+          int smallest = 0;
+          for (int j = 1; j < 4; ++j)
+            if (influence.weights[j] < influence.weights[smallest])
+              smallest = j;
+          if (skin.weights[i] > influence.weights[smallest])
+          {
+            influence.bones[smallest] = bone;
+            influence.weights[smallest] = skin.weights[i];
+          }
+        }
+      }
+
+      bool has_rigid_bone = false;
+      unsigned short rigid_bone = 0;
+      for (size_t i = 0; i < influences.size(); ++i)
+      {
+        x_influence_t &influence = influences[i];
+        float const sum = influence.weights[0] + influence.weights[1] + influence.weights[2] + influence.weights[3];
+
+        if (sum > 0)
+        {
+          for (int j = 0; j < 4; ++j)
+            influence.weights[j] /= sum;
+          continue;
+        }
+        if (!has_rigid_bone)
+        {
+          rigid_bone = add_bone(frame, std::string(), world, c_identity);
+          has_rigid_bone = true;
+        }
+        influence.bones[0] = rigid_bone;
+        influence.weights[0] = 1;
+      }
+    }
+
+    /* Transform mesh to the frame space and append triangulated faces */
+    void add_mesh( int frame, std::vector<float> const &positions, std::vector<float> const &normals,
+                   std::vector<float> const &uvs, std::vector<unsigned int> const &face_sizes,
+                   std::vector<unsigned int> const &corners, std::vector<unsigned int> const &normal_corners,
+                   std::vector<unsigned int> const &face_materials, std::vector<mesh_material_t> const &materials,
+                   std::vector<x_skin_weights_t> const &skins )
+    {
+      float const *world = frame >= 0 ? m_scene.frames[frame].world : c_identity;
+      unsigned int const materials_base = (unsigned int)m_scene.mesh.materials.size();
+      bool const has_normals = !normals.empty();
+      float inv_world[16];
+      std::unordered_map<unsigned long long, unsigned int> vertex_map;
+      std::vector<x_influence_t> influences(positions.size() / 3);
+
+      add_influences(frame, world, skins, influences);
+      /* Normals are transformed by the inverse transpose, so non-uniform scales keep them perpendicular */
+      invert_affine(world, inv_world);
+
+      m_has_normals |= has_normals;
+      m_has_uvs |= !uvs.empty();
+      m_scene.mesh.materials.insert(m_scene.mesh.materials.end(), materials.begin(), materials.end());
+      vertex_map.reserve(positions.size() / 3);
+
+      /* Vertices are split where position and normal indices differ */
+      std::vector<unsigned int> face_vertices;
+      size_t corner = 0;
+      for (size_t f = 0; f < face_sizes.size(); ++f)
+      {
+        face_vertices.resize(face_sizes[f]);
+        for (unsigned int j = 0; j < face_sizes[f]; ++j, ++corner)
+        {
+          unsigned int const p = corners[corner], n = has_normals ? normal_corners[corner] : 0;
+          unsigned long long const key = ((unsigned long long)p << 32) | n;
+          std::unordered_map<unsigned long long, unsigned int>::iterator it = vertex_map.find(key);
+
+          if (it == vertex_map.end())
+          {
+            x_vertex_t v;
+            float const *src = &positions[p * 3];
+            for (int c = 0; c < 3; ++c)
+              v.pos[c] = src[0] * world[c] + src[1] * world[4 + c] + src[2] * world[8 + c] + world[12 + c];
+
+            v.normal[0] = v.normal[1] = v.normal[2] = 0;
+            if (has_normals)
+            {
+              float const *nrm = &normals[n * 3];
+              float length = 0;
+              for (int c = 0; c < 3; ++c)
+              {
+                v.normal[c] = nrm[0] * inv_world[c * 4] + nrm[1] * inv_world[c * 4 + 1] + nrm[2] * inv_world[c * 4 + 2];
+                length += v.normal[c] * v.normal[c];
+              }
+              length = sqrt(length);
+              for (int c = 0; c < 3 && length > 0; ++c)
+                v.normal[c] /= length;
+            }
+
+            v.uv[0] = uvs.empty() ? 0 : uvs[p * 2];
+            v.uv[1] = uvs.empty() ? 0 : uvs[p * 2 + 1];
+
+            it = vertex_map.insert(std::make_pair(key, (unsigned int)m_vertices.size())).first;
+            m_vertices.push_back(v);
+            m_influences.push_back(influences[p]);
+          }
+          face_vertices[j] = it->second;
+        }
+
+        /* Polygons are triangulated as fans */
+        for (unsigned int j = 2; j < face_sizes[f]; ++j)
+        {
+          x_triangle_t triangle;
+          triangle.index[0] = face_vertices[0];
+          triangle.index[1] = face_vertices[j - 1];
+          triangle.index[2] = face_vertices[j];
+          triangle.material = materials_base + face_materials[f];
+          m_triangles.push_back(triangle);
+        }
+      }
+    }
+
+    /* Pack vertices by the resulting FVF and group faces to subsets */
+    void finish( void )
+    {
+      mesh_data_t &mesh = m_scene.mesh;
+
+      mesh.fvf = c_mesh_fvf_position | (m_has_normals ? c_mesh_fvf_normal : 0) | (m_has_uvs ? c_mesh_fvf_tex1 : 0);
+      mesh.vertex_size = (3 + (m_has_normals ? 3 : 0) + (m_has_uvs ? 2 : 0)) * sizeof(float);
+      mesh.vertices.resize(m_vertices.size() * mesh.vertex_size);
+      for (size_t i = 0; i < m_vertices.size(); ++i)
+      {
+        float *dst = (float *)&mesh.vertices[i * mesh.vertex_size];
+
+        memcpy(dst, m_vertices[i].pos, sizeof(m_vertices[i].pos));
+        dst += 3;
+        if (m_has_normals)
+        {
+          memcpy(dst, m_vertices[i].normal, sizeof(m_vertices[i].normal));
+          dst += 3;
+        }
+        if (m_has_uvs)
+          memcpy(dst, m_vertices[i].uv, sizeof(m_vertices[i].uv));
+      }
+
+      std::stable_sort(m_triangles.begin(), m_triangles.end());
+      mesh.indices.resize(m_triangles.size() * 3);
+      for (size_t i = 0; i < m_triangles.size(); ++i)
+      {
+        x_triangle_t const &triangle = m_triangles[i];
+        mesh.indices[i * 3] = triangle.index[0];
+        mesh.indices[i * 3 + 1] = triangle.index[1];
+        mesh.indices[i * 3 + 2] = triangle.index[2];
+
+        if (mesh.subsets.empty() || mesh.subsets.back().material != triangle.material)
+        {
+          mesh_subset_t subset = {triangle.material, (unsigned int)i, 0, triangle.index[0], 0};
+          mesh.subsets.push_back(subset);
+        }
+
+        mesh_subset_t &subset = mesh.subsets.back();
+        unsigned int last = subset.vertex_start + subset.vertex_count;
+        subset.face_count++;
+        for (int j = 0; j < 3; ++j)
+        {
+          subset.vertex_start = std::min(subset.vertex_start, triangle.index[j]);
+          last = std::max(last, triangle.index[j] + 1);
+        }
+        subset.vertex_count = last - subset.vertex_start;
+      }
+      mesh.update_bounds();
+
+      if (!m_has_skin)
+      {
+        m_scene.bones.clear();
+        return;
+      }
+
+      /* Skin bones are bound to frames by name */
+      std::map<std::string, int> frames;
+      for (size_t i = 0; i < m_scene.frames.size(); ++i)
+        frames.insert(std::make_pair(m_scene.frames[i].name, (int)i));
+      for (size_t i = 0; i < m_scene.bones.size(); ++i)
+        if (!m_bone_frames[i].empty())
+        {
+          std::map<std::string, int>::const_iterator it = frames.find(m_bone_frames[i]);
+          m_scene.bones[i].frame = it != frames.end() ? it->second : -1;
+        }
+      m_scene.influences.swap(m_influences);
+    }
+
+    x_reader_t &m_reader;
+    x_scene_t &m_scene;
+    std::map<std::string, mesh_material_t> m_named_materials;
+    std::vector<x_vertex_t> m_vertices;
+    std::vector<x_triangle_t> m_triangles;
+    std::vector<x_influence_t> m_influences;  /* per vertex, kept when any mesh has skin */
+    std::vector<std::string> m_bone_frames;   /* skin bone frame names, empty for mesh frames */
+    bool m_has_normals;
+    bool m_has_uvs;
+    bool m_has_skin;
+  };
+}
+
+bool parse_x( unsigned char const *data, size_t size, x_scene_t &scene )
+{
+  x_reader_t reader(data, size);
+  x_parser_t parser(reader, scene);
+
+  return parser.parse();
+}
+
+bool parse_x_file( wchar_t const *file_name, x_scene_t &scene )
+{
+  mapped_file_t file;
+
+  return file.open(file_name) && parse_x(file.data(), file.size(), scene);
+}
+
+x_parse_benchmark_t benchmark_x_parse( wchar_t const *file_name, unsigned int repeats )
+{
+  x_parse_benchmark_t result;
+  mapped_file_t file;
+
+  result.is_parsed = false;
+  result.file_size = 0;
+  result.vertices_count = result.faces_count = 0;
+  result.parse_ms = 0;
+  if (!file.open(file_name) || repeats == 0)
+    return result;
+  result.file_size = file.size();
+
+  stopwatch_t timer;
+  for (unsigned int i = 0; i < repeats; ++i)
+  {
+    x_scene_t scene;
+
+    result.is_parsed = parse_x(file.data(), file.size(), scene);
+    if (!result.is_parsed)
+      return result;
+    result.vertices_count = scene.mesh.vertex_count();
+    result.faces_count = scene.mesh.face_count();
+  }
+  result.parse_ms = timer.elapsed_ms() / repeats;
+  return result;
+}
@@ -0,0 +1,74 @@
+/**
+@file     x_parser.h
+@brief    DirectX .x files parser (D3DX independent) definition
+@date     Created on 19/10/2026
+@project  Task4
+@author   Sergeev Artemiy
+*/
+
+#ifndef __X_PARSER_INCLUDED__
+#define __X_PARSER_INCLUDED__
+
+#include <string>
+#include <vector>
+
+#include "mesh_data.h"
+
+/* Frame of .x file hierarchy */
+struct x_frame_t
+{
+  std::string name;
+  int parent;                   /* index in x_scene_t::frames, -1 for root frames */
+  float transform[16];          /* local row-major matrix, D3D (row vector) convention */
+  float world[16];
+};
+
+/* Bone of skinned scene: vertices follow the frame world through 'offset' from collapsed mesh space */
+struct x_bone_t
+{
+  int frame;                    /* index in x_scene_t::frames, -1 for identity */
+  float offset[16];
+};
+
+/* Up to four bones of vertex, weights sum to 1 and unused slots have zero weight */
+struct x_influence_t
+{
+  unsigned short bones[4];
+  float weights[4];
+};
+
+/* Parsed .x file. As D3DXLoadMeshFromX does, all meshes are collapsed into one
+ * with frame transforms applied and faces sorted by material. */
+struct x_scene_t
+{
+  mesh_data_t mesh;
+  std::vector<x_frame_t> frames;
+
+  /* Filled when any mesh has SkinWeights, one influence per mesh vertex. Vertices of meshes
+   * without skin follow their own frames, so the whole hierarchy can be posed */
+  std::vector<x_bone_t> bones;
+  std::vector<x_influence_t> influences;
+};
+
+/* Parse text or binary (not compressed) .x file data */
+bool parse_x( unsigned char const *data, size_t size, x_scene_t &scene );
+
+/* Parse memory mapped .x file */
+bool parse_x_file( wchar_t const *file_name, x_scene_t &scene );
+
+/* Parse times of a .x file mapped once */
+struct x_parse_benchmark_t
+{
+  bool is_parsed;
+  size_t file_size;
+  unsigned int vertices_count;
+  unsigned int faces_count;
+  double parse_ms;              /* mean of repeats */
+
+  /* Megabytes of file data per second */
+  double rate( void ) const { return parse_ms > 0 ? file_size / parse_ms / 1000 : 0; }
+};
+
+x_parse_benchmark_t benchmark_x_parse( wchar_t const *file_name, unsigned int repeats );
+
+#endif /* __X_PARSER_INCLUDED__ */
@@ -50,10 +50,11 @@ LRESULT CALLBACK D3DBaseAppCallback(HWND hWnd, UINT nMsg, WPARAM wParam, LPARAM
 // *******************************************************************
 // Methods
 
-cglApp::cglApp(int nW, int nH, void* hInst, int nCmdShow) 
+cglApp::cglApp(int nW, int nH, void* hInst, int nCmdShow, bool bFloatDepth) 
   : m_hWnd(NULL)
   , m_hInstance(hInst)
   , m_nClearColor(0xFF007F00)
+  , m_rClearDepth(1.0f)
   , m_pD3D(NULL)
   , m_nFrameCount(0)
   , m_rPrevTime(0.0f)
@@ -105,6 +106,7 @@ cglApp::cglApp(int nW, int nH, void* hInst, int nCmdShow)
   params.nBPP    = (nBPP == 32) ? cglD3D::BPP_32 : cglD3D::BPP_16;
   params.nWidth  = nW;
   params.nHeight = nH;
+  params.bFloatDepth = bFloatDepth;
   m_pD3D = new cglD3D(params);
   // Check creation result
   if (m_pD3D == NULL || m_pD3D->isFailed())
@@ -198,7 +200,7 @@ void cglApp::render()
   if (m_pD3D->beginRender())
   {
     // Clear screen with current color
-    m_pD3D->clear(m_nClearColor);
+    m_pD3D->clear(m_nClearColor, m_rClearDepth);
     
     // Perform rendering internals
     renderInternal();
@@ -24,7 +24,7 @@ class cglApp
 {
 public:
   // Constructor
-  cglApp(int nW, int nH, void* hInst, int nCmdShow);
+  cglApp(int nW, int nH, void* hInst, int nCmdShow, bool bFloatDepth = false);
   // Destructor
   virtual ~cglApp();
   // Allows to check if constructor failed
@@ -49,6 +49,8 @@ protected:
   void*        m_hInstance;
   // Color to clear the back buffer
   unsigned int m_nClearColor;
+  // Depth to clear the depth buffer, 0 for reversed depth
+  float        m_rClearDepth;
   // D3D wrapper class
   class cglD3D *m_pD3D;
   // Timer
@@ -63,6 +63,7 @@ cglD3D::FormatRecord cglD3D::m_formats[BPP_LAST] =
 * This method creates Direct3D8, Direct3D8Device
 */
 cglD3D::cglD3D(const CreateParams &params)
+  : m_fmtDepth(m_formats[params.nBPP].fmtDepthBuffer)
 {
   D3DPRESENT_PARAMETERS ppParams;
   HRESULT               hRes;
@@ -84,6 +85,13 @@ cglD3D::cglD3D(const CreateParams &params)
   // Get caps for future use
   hRes = m_lpD3D9->GetDeviceCaps(0, D3DDEVTYPE_HAL, &m_caps);
 
+  // Floating point depth keeps precision at distance with reversed depth, if adapter supports it
+  D3DFORMAT fmtBackBuffer = m_formats[params.nBPP].fmtBackBuffer;
+  if (params.bFloatDepth && params.nBPP == BPP_32 &&
+      m_lpD3D9->CheckDeviceFormat(0, D3DDEVTYPE_HAL, fmtBackBuffer, D3DUSAGE_DEPTHSTENCIL, D3DRTYPE_SURFACE, D3DFMT_D24FS8) == D3D_OK &&
+      m_lpD3D9->CheckDepthStencilMatch(0, D3DDEVTYPE_HAL, fmtBackBuffer, fmtBackBuffer, D3DFMT_D24FS8) == D3D_OK)
+    m_fmtDepth = D3DFMT_D24FS8;
+
   // Simply fill presentation parameters
   memset(&ppParams, 0, sizeof(D3DPRESENT_PARAMETERS));
   ppParams.Windowed               = TRUE; // We choose windowed mode
@@ -91,7 +99,7 @@ cglD3D::cglD3D(const CreateParams &params)
   ppParams.MultiSampleType        = D3DMULTISAMPLE_NONE;
   ppParams.SwapEffect             = D3DSWAPEFFECT_DISCARD;
   ppParams.EnableAutoDepthStencil = TRUE; // We want to create depth (z-buffer)
-  ppParams.AutoDepthStencilFormat = m_formats[params.nBPP].fmtDepthBuffer;
+  ppParams.AutoDepthStencilFormat = m_fmtDepth;
   ppParams.hDeviceWindow          = HWND(params.hWnd);
   ppParams.BackBufferWidth        = params.nWidth;
   ppParams.BackBufferHeight       = params.nHeight;
@@ -102,6 +110,8 @@ cglD3D::cglD3D(const CreateParams &params)
     nBehaviour = D3DCREATE_HARDWARE_VERTEXPROCESSING;
   else
     nBehaviour = D3DCREATE_SOFTWARE_VERTEXPROCESSING;
+  // Resources are created by loading threads while rendering
+  nBehaviour |= D3DCREATE_MULTITHREADED;
 
   // Create the device
   hRes = m_lpD3D9->CreateDevice(0, D3DDEVTYPE_HAL, ppParams.hDeviceWindow, nBehaviour, 
@@ -142,7 +152,7 @@ void cglD3D::endRender()
   m_lpD3D9Device->Present(NULL, NULL, NULL, NULL);
 } 
 
-void cglD3D::clear(unsigned int nColor)
+void cglD3D::clear(unsigned int nColor, float rDepth)
 {
-  m_lpD3D9Device->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, nColor, 1.0f, 0);
+  m_lpD3D9Device->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, nColor, rDepth, 0);
 } 
@@ -53,6 +53,7 @@ public:
     DWORD   nWidth;    // Back buffer width
     DWORD   nHeight;   // Back buffer height
     BPP     nBPP;      // Back buffer bits per pixel: 16, 24, 32 allowed.
+    bool    bFloatDepth; // Prefer D3DFMT_D24FS8 depth buffer (for reversed depth), 32 bpp only
   };
 
   cglD3D(const CreateParams &params);
@@ -65,7 +66,9 @@ public:
   // This function should be called after all rendering on current frame
   void endRender();
   // This function clears target & depth buffer
-  void clear(unsigned int nColor);
+  void clear(unsigned int nColor, float rDepth = 1.0f);
+  // Return true if depth buffer is floating point
+  bool isFloatDepth() const { return m_fmtDepth == D3DFMT_D24FS8; }
   // Return device for external use
   LPDIRECT3DDEVICE9 getDevice() const { return m_lpD3D9Device; }
 
@@ -84,6 +87,7 @@ protected:
   LPDIRECT3D9        m_lpD3D9;        // D3D9 interface pointer
   LPDIRECT3DDEVICE9  m_lpD3D9Device;  // D3D9 device interface pointer
   D3DCAPS9           m_caps;          // D3D9 caps
+  D3DFORMAT          m_fmtDepth;      // Depth buffer format
 };
 
 // *******************************************************************
@@ -10,7 +10,11 @@
 
 // *******************************************************************
 // includes
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <time.h>
+#endif
 
 // this system
 #include "cglTimer.h"
@@ -28,14 +32,24 @@ cglTimer::cglTimer()
   : m_rTime(0.0f)
   , m_rDelta(0.0f)
 {
+#ifdef _WIN32
   QueryPerformanceFrequency((LARGE_INTEGER*)&m_freq);
+#else
+  m_freq = 1000000000;
+#endif
   m_rPrevTime = getCurTime();
 }
 
 float cglTimer::getCurTime()
 {
   UInt64 time;
+#ifdef _WIN32
   QueryPerformanceCounter((LARGE_INTEGER*)&time);
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  time = UInt64(ts.tv_sec) * m_freq + ts.tv_nsec;
+#endif
   return float(double(time) / double(m_freq));
 }
 
@@ -45,4 +59,11 @@ void cglTimer::update()
   m_rDelta = rCurTime - m_rPrevTime;
   m_rTime += m_rDelta;
   m_rPrevTime = rCurTime;
-}
\ No newline at end of file
+}
+
+void cglTimer::step(float rDelta)
+{
+  m_rDelta = rDelta;
+  m_rTime += m_rDelta;
+  m_rPrevTime = getCurTime();
+}
@@ -35,6 +35,8 @@ public:
   cglTimer();
   
   void update();
+  // Advance by fixed simulated step instead of real time (headless rendering)
+  void step(float rDelta);
   float getDelta() const { return m_rDelta; }
   float getTime() const { return m_rTime; }
 